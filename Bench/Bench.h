@@ -0,0 +1,80 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <latch>
+#include <string>
+#include <thread>
+#include <vector>
+
+// -n <iterations> and -j <threads> of a bench command line, anything else is left in args
+struct BenchOptions
+{
+    size_t                   iterations;
+    unsigned                 threads;
+    std::vector<std::string> args;
+
+    BenchOptions(int argc, char* argv[], size_t defaultIterations) :
+        iterations {defaultIterations}, threads {std::max(4u, std::thread::hardware_concurrency())}, args {}
+    {
+        for(int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if(arg == "-n" && i + 1 < argc)
+                iterations = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+            else if(arg == "-j" && i + 1 < argc)
+                threads = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+            else
+                args.push_back(arg);
+        }
+    }
+
+    // 1, 2, 4... up to threads
+    std::vector<unsigned> ThreadCounts() const
+    {
+        std::vector<unsigned> counts;
+        for(unsigned t = 1; t < threads; t *= 2)
+            counts.push_back(t);
+        counts.push_back(threads);
+        return counts;
+    }
+};
+
+inline double BenchNanoseconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+// ns per call(thread, i) as each of threads sees it, all start together and make iterations calls; more threads
+// than cores still contend for the same cache lines, only less often
+template<typename F> double BenchCalls(unsigned threads, size_t iterations, F call)
+{
+    std::latch               start(threads);
+    std::vector<double>      nanoseconds(threads);
+    std::vector<std::thread> workers;
+    for(unsigned t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&, t]() {
+            start.arrive_and_wait();
+            auto begin = std::chrono::steady_clock::now();
+            for(size_t i = 0; i < iterations; i++)
+                call(t, i);
+            nanoseconds[t] = BenchNanoseconds(begin) / iterations;
+        });
+    }
+    for(auto& worker : workers)
+        worker.join();
+
+    double sum = 0;
+    for(auto ns : nanoseconds)
+        sum += ns;
+    return sum / threads;
+}
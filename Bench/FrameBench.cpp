@@ -0,0 +1,94 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "Bench.h"
+#include "BuiltinLibrary.h"
+#include "NullRenderer.h"
+#include "PresetCost.h"
+
+#include <cstdio>
+#include <new>
+
+static size_t sAllocations = 0;
+
+// counts every allocation, the bench renders on one thread
+void* operator new(size_t size)
+{
+    sAllocations++;
+    if(auto p = malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+// CPU side of a frame of each built-in preset, or those whose name contains an argument: ns, allocations and device
+// calls per frame of NullRenderer, which renders each pass through the same PassFrame as ShaderPass; steady state,
+// after the first frames sized the chain, of -n frames from the input the default pixel size captures at 1080p
+int main(int argc, char* argv[])
+{
+    const BenchOptions options(argc, argv, 200);
+
+    const int originalWidth  = PresetCost::OutputWidth / PresetCost::InputScale;
+    const int originalHeight = PresetCost::OutputHeight / PresetCost::InputScale;
+
+    printf("per frame of %dx%d to %dx%d, %zu frames\n", originalWidth, originalHeight, PresetCost::OutputWidth, PresetCost::OutputHeight, options.iterations);
+    printf("%-48s %6s %10s %8s %8s %8s\n", "preset", "passes", "ns", "allocs", "calls", "mapped");
+
+    double totalNanoseconds = 0;
+    double totalAllocations = 0;
+    double totalCalls       = 0;
+    int    presets          = 0;
+    ForEachBuiltinPreset([&](const PresetDef& presetDef, const std::vector<const ShaderDef*>& shaderDefs) {
+        auto selected = options.args.empty();
+        for(const auto& arg : options.args)
+            selected |= presetDef.Name.find(arg) != std::string::npos;
+        if(!selected)
+            return;
+
+        NullRenderer renderer(presetDef);
+        for(int f = 0; f < 10; f++)
+            renderer.Render(originalWidth, originalHeight, PresetCost::OutputWidth, PresetCost::OutputHeight);
+        renderer.Device().ResetCounts();
+
+        const auto allocations = sAllocations;
+        const auto start       = std::chrono::steady_clock::now();
+        for(size_t f = 0; f < options.iterations; f++)
+            renderer.Render(originalWidth, originalHeight, PresetCost::OutputWidth, PresetCost::OutputHeight);
+        const auto nanoseconds = BenchNanoseconds(start) / options.iterations;
+
+        const auto& device      = renderer.Device();
+        const auto  frameAllocs = static_cast<double>(sAllocations - allocations) / options.iterations;
+        const auto  frameCalls  = static_cast<double>(device.TotalCalls()) / options.iterations;
+        printf("%-48s %6zu %10.0f %8.1f %8.1f %8.0f\n",
+               presetDef.Name.c_str(),
+               shaderDefs.size(),
+               nanoseconds,
+               frameAllocs,
+               frameCalls,
+               static_cast<double>(device.MappedBytes()) / options.iterations);
+
+        totalNanoseconds += nanoseconds;
+        totalAllocations += frameAllocs;
+        totalCalls += frameCalls;
+        presets++;
+    });
+
+    if(presets)
+        printf("%-48s %6s %10.0f %8.1f %8.1f\n", "mean", "", totalNanoseconds / presets, totalAllocations / presets, totalCalls / presets);
+    return 0;
+}
@@ -0,0 +1,56 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "Bench.h"
+#include "Metrics.h"
+
+#include <cstdio>
+#include <memory>
+#include <random>
+
+// ns per metric call from 1 up to -j threads recording into the same metric at once, next to each thread recording
+// into its own histogram, which is what Record would cost without contention; the render thread, capture callbacks
+// and the UI all record into one registry
+int main(int argc, char* argv[])
+{
+    const BenchOptions options(argc, argv, 1000000);
+
+    // frame times in us, as ShaderGlass records them
+    std::mt19937_64               random(1);
+    std::lognormal_distribution<> frameTimes(8.5, 0.3);
+    std::vector<uint64_t>         values(options.iterations);
+    for(auto& v : values)
+        v = static_cast<uint64_t>(frameTimes(random));
+
+    MetricsRegistry registry;
+    auto&           counter   = registry.Counter("counter");
+    auto&           histogram = registry.Histogram("histogram");
+
+    printf("ns per call, %u cores\n", std::thread::hardware_concurrency());
+    printf("%-8s %12s %12s %12s %12s\n", "threads", "counter", "histogram", "own", "timer");
+    for(auto threads : options.ThreadCounts())
+    {
+        std::vector<std::unique_ptr<MetricHistogram>> own;
+        for(unsigned t = 0; t < threads; t++)
+            own.push_back(std::make_unique<MetricHistogram>());
+
+        auto counterNs   = BenchCalls(threads, options.iterations, [&](unsigned, size_t) { counter.Add(); });
+        auto histogramNs = BenchCalls(threads, options.iterations, [&](unsigned, size_t i) { histogram.Record(values[i]); });
+        auto ownNs       = BenchCalls(threads, options.iterations, [&](unsigned t, size_t i) { own[t]->Record(values[i]); });
+        auto timerNs     = BenchCalls(threads, options.iterations, [&](unsigned, size_t) { MetricsRegistry::Timer timer(histogram); });
+        printf("%-8u %12.1f %12.1f %12.1f %12.1f\n", threads, counterNs, histogramNs, ownNs, timerNs);
+    }
+
+    // snapshots are taken once a second, by the UI and -metrics dumps
+    auto start = std::chrono::steady_clock::now();
+    for(int s = 0; s < 1000; s++)
+        histogram.Snapshot();
+    printf("snapshot of %d buckets: %.1f us\n", MetricHistogram::Buckets, BenchNanoseconds(start) / 1000 / 1000);
+    return 0;
+}
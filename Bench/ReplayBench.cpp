@@ -0,0 +1,201 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "Bench.h"
+#include "BuiltinLibrary.h"
+#include "CaptureRecording.h"
+#include "NullRenderer.h"
+#include "PresetCost.h"
+#include "SoftwareRenderer.h"
+#include "sha256.h"
+
+#include <cstdio>
+#include <stdexcept>
+
+// recorded frame reduced by the default pixel size, as ShaderGlass would pass it to the first pass
+static SoftwareTexture OriginalFrame(const CaptureFrame& frame)
+{
+    const int scale  = PresetCost::InputScale;
+    const int width  = std::max(static_cast<int>(frame.width) / scale, 1);
+    const int height = std::max(static_cast<int>(frame.height) / scale, 1);
+
+    std::vector<uint8_t> rgba(static_cast<size_t>(width) * height * 4);
+    for(int y = 0; y < height; y++)
+    {
+        const auto sourceY = std::min(y * scale + scale / 2, static_cast<int>(frame.height) - 1);
+        for(int x = 0; x < width; x++)
+        {
+            const auto sourceX = std::min(x * scale + scale / 2, static_cast<int>(frame.width) - 1);
+            const auto bgra    = frame.pixels + (static_cast<size_t>(sourceY) * frame.width + sourceX) * 4;
+            auto       target  = &rgba[(static_cast<size_t>(y) * width + x) * 4];
+            target[0]          = bgra[2];
+            target[1]          = bgra[1];
+            target[2]          = bgra[0];
+            target[3]          = bgra[3];
+        }
+    }
+    return SoftwareTexture::FromRGBA8(rgba.data(), width, height);
+}
+
+// stands in for a -record file: a gradient moving a pixel per frame
+static bool RecordGradient(const std::filesystem::path& path, uint32_t frames, uint32_t width, uint32_t height)
+{
+    CaptureRecording recording;
+    if(!recording.Create(path, frames, CaptureRecording::SlotBytes(width, height)))
+        return false;
+
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+    for(uint32_t f = 0; f < frames; f++)
+    {
+        for(uint32_t y = 0; y < height; y++)
+        {
+            for(uint32_t x = 0; x < width; x++)
+            {
+                auto bgra = &pixels[(static_cast<size_t>(y) * width + x) * 4];
+                bgra[0]   = static_cast<uint8_t>(x + f);
+                bgra[1]   = static_cast<uint8_t>(y);
+                bgra[2]   = static_cast<uint8_t>(x ^ y);
+                bgra[3]   = 0xFF;
+            }
+        }
+        recording.Write(f * 16667ull, width, height, pixels.data(), width * 4);
+    }
+    return true;
+}
+
+// replays the first -n frames of a ShaderGlass -record file given with -r, or of a moving gradient recorded here, through
+// each built-in preset whose name contains an argument, in order and with FrameCount counting from 0 as ShaderGlass
+// -replay shows them: on the CPU through SoftwareRenderer where the preset has SPIR-V, with a SHA-256 of all outputs
+// which only changes when rendering does, and through NullRenderer for the CPU side of a frame with its device calls
+int main(int argc, char* argv[])
+{
+    BenchOptions options(argc, argv, 60);
+
+    std::filesystem::path path;
+    std::vector<std::string> names;
+    for(size_t a = 0; a < options.args.size(); a++)
+    {
+        if(options.args[a] == "-r" && a + 1 < options.args.size())
+            path = options.args[++a];
+        else
+            names.push_back(options.args[a]);
+    }
+
+    const auto generated = path.empty();
+    if(generated)
+    {
+        path = std::filesystem::temp_directory_path() / "ReplayBench.sgcr";
+        if(!RecordGradient(path, static_cast<uint32_t>(options.iterations), 320, 240))
+        {
+            printf("Unable to write %s\n", path.string().c_str());
+            return 1;
+        }
+    }
+
+    CaptureRecording recording;
+    if(!recording.Open(path))
+    {
+        printf("Unable to open recording %s\n", path.string().c_str());
+        return 1;
+    }
+
+    CaptureFrame first;
+    const auto   frames = std::min<uint64_t>(recording.Frames(), options.iterations);
+    if(!frames || !recording.Frame(0, first))
+    {
+        printf("No frames in recording %s\n", path.string().c_str());
+        return 1;
+    }
+
+    printf("%llu frames of %ux%u from %s, input 1/%d, %u threads\n",
+           static_cast<unsigned long long>(frames),
+           first.width,
+           first.height,
+           generated ? "a gradient" : path.string().c_str(),
+           PresetCost::InputScale,
+           options.threads);
+    printf("%-48s %6s %10s %-16s %10s %8s\n", "preset", "passes", "cpu ms", "checksum", "null ns", "calls");
+
+    ForEachBuiltinPreset([&](const PresetDef& presetDef, const std::vector<const ShaderDef*>& shaderDefs) {
+        auto selected = names.empty();
+        for(const auto& name : names)
+            selected |= presetDef.Name.find(name) != std::string::npos;
+        if(!selected)
+            return;
+
+        NullRenderer                      nullRenderer(presetDef);
+        std::unique_ptr<SoftwareRenderer> softwareRenderer;
+        try
+        {
+            softwareRenderer = std::make_unique<SoftwareRenderer>(presetDef, options.threads);
+        }
+        catch(const std::runtime_error&)
+        {
+            // no SPIR-V until the library is regenerated, see Scripts/README.md
+        }
+
+        SHA256_CTX           hash;
+        std::vector<uint8_t> output;
+        double               softwareNanoseconds = 0;
+        double               nullNanoseconds     = 0;
+        sha256_init(&hash);
+        for(uint64_t f = 0; f < frames; f++)
+        {
+            CaptureFrame frame;
+            if(!recording.Frame(f, frame))
+            {
+                printf("%-48s damaged frame %llu\n", presetDef.Name.c_str(), static_cast<unsigned long long>(f));
+                return;
+            }
+
+            const auto original = OriginalFrame(frame);
+            auto       start    = std::chrono::steady_clock::now();
+            nullRenderer.Render(original.Width(), original.Height(), frame.width, frame.height);
+            nullNanoseconds += BenchNanoseconds(start);
+
+            if(softwareRenderer)
+            {
+                start                = std::chrono::steady_clock::now();
+                const auto& rendered = softwareRenderer->Render(original, frame.width, frame.height);
+                softwareNanoseconds += BenchNanoseconds(start);
+                rendered.ToRGBA8(output);
+                sha256_update(&hash, output.data(), output.size());
+            }
+        }
+
+        char checksum[2 * SHA256_BLOCK_SIZE + 1] = "-";
+        if(softwareRenderer)
+        {
+            BYTE digest[SHA256_BLOCK_SIZE];
+            sha256_final(&hash, digest);
+            for(int b = 0; b < SHA256_BLOCK_SIZE; b++)
+                snprintf(checksum + b * 2, 3, "%02x", digest[b]);
+        }
+
+        const auto calls = static_cast<double>(nullRenderer.Device().TotalCalls()) / frames;
+        if(softwareRenderer)
+            printf("%-48s %6zu %10.2f %-16.16s %10.0f %8.1f\n",
+                   presetDef.Name.c_str(),
+                   shaderDefs.size(),
+                   softwareNanoseconds / frames / 1000000,
+                   checksum,
+                   nullNanoseconds / frames,
+                   calls);
+        else
+            printf("%-48s %6zu %10s %-16s %10.0f %8.1f\n", presetDef.Name.c_str(), shaderDefs.size(), "-", checksum, nullNanoseconds / frames, calls);
+    });
+
+    recording.Close();
+    if(generated)
+    {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+    return 0;
+}
@@ -0,0 +1,62 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "Bench.h"
+#include "BuiltinLibrary.h"
+#include "PresetSearch.h"
+
+#include <cstdio>
+
+// the Shader Browser lists this many
+static const size_t sResults = 100;
+
+// what typing into the Shader Browser searches for: every prefix of a few names as they are typed, words found
+// inside names, several words at once and typos
+static const char* sQueries[] = {"c", "cr", "crt", "crt-", "crt-g", "crt-gu", "crt-gue", "crt-gues", "crt-guest", "royale",
+                                 "ntsc", "guest ntsc", "bezel", "curvy", "scanline", "gamma", "lottes", "scnaline",
+                                 "lottes fast", "zfast", "xbr", "crt royale glass"};
+
+// us per query over the built-in presets, indexed as the Shader Browser indexes them on the first search, by name
+// and category; queries are -n times each of those above, or of the arguments
+int main(int argc, char* argv[])
+{
+    const BenchOptions options(argc, argv, 100);
+
+    std::vector<std::string> queries(options.args);
+    if(queries.empty())
+        queries.assign(std::begin(sQueries), std::end(sQueries));
+
+    PresetSearch search;
+    auto         start   = std::chrono::steady_clock::now();
+    const auto&  presets = BuiltinLibrary();
+    for(size_t p = 0; p < presets.size(); p++)
+        search.Add(static_cast<uint32_t>(p), PresetSearch::Document(*presets[p]));
+    printf("indexed %zu presets in %.1f ms\n", search.Size(), BenchNanoseconds(start) / 1000000);
+
+    printf("%-24s %8s %10s %10s\n", "query", "results", "us", "max us");
+    double total = 0;
+    for(const auto& query : queries)
+    {
+        size_t results = 0;
+        double slowest = 0;
+        double sum     = 0;
+        for(size_t i = 0; i < options.iterations; i++)
+        {
+            start         = std::chrono::steady_clock::now();
+            results       = search.Find(query, sResults).size();
+            const auto ns = BenchNanoseconds(start);
+            slowest       = std::max(slowest, ns);
+            sum += ns;
+        }
+        printf("%-24s %8zu %10.1f %10.1f\n", query.c_str(), results, sum / options.iterations / 1000, slowest / 1000);
+        total += sum / options.iterations;
+    }
+    printf("%-24s %8s %10.1f\n", "mean", "", total / queries.size() / 1000);
+    return 0;
+}
@@ -0,0 +1,46 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "Bench.h"
+#include "Tracer.h"
+
+#include <cstdio>
+#include <sstream>
+
+// ns per Tracer::Span while tracing is off, which is what every traced scope costs normally, and while it is on,
+// from 1 up to -j threads each recording into its own ring; then the time to write all rings out
+int main(int argc, char* argv[])
+{
+    const BenchOptions options(argc, argv, 1000000);
+
+    printf("ns per span, %u cores\n", std::thread::hardware_concurrency());
+    printf("%-8s %12s %12s\n", "threads", "disabled", "enabled");
+    for(auto threads : options.ThreadCounts())
+    {
+        auto record = [](unsigned, size_t i) {
+            Tracer::Span span("bench", "Span", "i", static_cast<int>(i));
+        };
+
+        Tracer::Enable(false);
+        auto disabledNs = BenchCalls(threads, options.iterations, record);
+        // rings of the previous threads are free for these
+        Tracer::Clear();
+        Tracer::Enable(true);
+        auto enabledNs = BenchCalls(threads, options.iterations, record);
+        Tracer::Enable(false);
+        printf("%-8u %12.1f %12.1f\n", threads, disabledNs, enabledNs);
+    }
+
+    // rings of the last threads still hold their latest spans
+    std::ostringstream dump;
+    auto               start = std::chrono::steady_clock::now();
+    Tracer::WriteJson(dump);
+    printf("dump of %zu KB: %.1f ms\n", dump.str().size() / 1024, BenchNanoseconds(start) / 1000000);
+    return 0;
+}
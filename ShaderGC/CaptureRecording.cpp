@@ -0,0 +1,214 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "CaptureRecording.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+static_assert(sizeof(CaptureRecording::FileHeader) == 32);
+static_assert(sizeof(CaptureRecording::SlotHeader) == 32);
+
+// header and slots start on page boundaries
+static constexpr uint64_t sSlotAlignment = 4096;
+static constexpr uint64_t sHeaderBytes   = sSlotAlignment;
+
+CaptureRecording::~CaptureRecording()
+{
+    Close();
+}
+
+uint32_t CaptureRecording::SlotBytes(uint32_t width, uint32_t height)
+{
+    const auto bytes = sizeof(SlotHeader) + static_cast<uint64_t>(width) * height * 4;
+    return static_cast<uint32_t>((bytes + sSlotAlignment - 1) / sSlotAlignment * sSlotAlignment);
+}
+
+bool CaptureRecording::Map(const std::filesystem::path& path, uint64_t size, bool write)
+{
+#ifdef _WIN32
+    m_file = CreateFileW(path.c_str(), write ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ, nullptr, write ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(m_file == INVALID_HANDLE_VALUE)
+    {
+        m_file = nullptr;
+        return false;
+    }
+    if(!write)
+    {
+        LARGE_INTEGER fileSize;
+        if(!GetFileSizeEx(m_file, &fileSize))
+            return false;
+        size = static_cast<uint64_t>(fileSize.QuadPart);
+    }
+    if(size < sizeof(FileHeader))
+        return false;
+
+    // mapping a new file extends it to the given size
+    m_mapping = CreateFileMappingW(m_file, nullptr, write ? PAGE_READWRITE : PAGE_READONLY, static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), nullptr);
+    if(!m_mapping)
+        return false;
+    m_header = static_cast<FileHeader*>(MapViewOfFile(m_mapping, write ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0));
+#else
+    m_file = open(path.c_str(), write ? O_RDWR | O_CREAT | O_TRUNC : O_RDONLY, 0644);
+    if(m_file == -1)
+        return false;
+    if(write)
+    {
+        if(ftruncate(m_file, static_cast<off_t>(size)) != 0)
+            return false;
+    }
+    else
+    {
+        struct stat fileStat;
+        if(fstat(m_file, &fileStat) != 0)
+            return false;
+        size = static_cast<uint64_t>(fileStat.st_size);
+    }
+    if(size < sizeof(FileHeader))
+        return false;
+
+    auto data = mmap(nullptr, size, write ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, m_file, 0);
+    if(data == MAP_FAILED)
+        return false;
+    m_header = static_cast<FileHeader*>(data);
+#endif
+    m_size     = size;
+    m_writable = write;
+    return m_header != nullptr;
+}
+
+bool CaptureRecording::Create(const std::filesystem::path& path, uint32_t slots, uint32_t slotBytes)
+{
+    Close();
+    if(!slots || slotBytes <= sizeof(SlotHeader))
+        return false;
+
+    if(!Map(path, sHeaderBytes + static_cast<uint64_t>(slots) * slotBytes, true))
+    {
+        Close();
+        return false;
+    }
+
+    m_header->magic     = Magic;
+    m_header->version   = Version;
+    m_header->slots     = slots;
+    m_header->slotBytes = slotBytes;
+    m_header->written   = 0;
+    m_header->reserved  = 0;
+    return true;
+}
+
+bool CaptureRecording::Open(const std::filesystem::path& path)
+{
+    Close();
+    if(!Map(path, 0, false))
+    {
+        Close();
+        return false;
+    }
+
+    if(m_header->magic != Magic || m_header->version != Version || !m_header->slots || m_header->slotBytes <= sizeof(SlotHeader) ||
+       m_size < sHeaderBytes + static_cast<uint64_t>(m_header->slots) * m_header->slotBytes)
+    {
+        Close();
+        return false;
+    }
+    m_written = m_header->written;
+    return true;
+}
+
+void CaptureRecording::Close()
+{
+#ifdef _WIN32
+    if(m_header)
+        UnmapViewOfFile(m_header);
+    if(m_mapping)
+        CloseHandle(m_mapping);
+    if(m_file)
+        CloseHandle(m_file);
+    m_mapping = nullptr;
+    m_file    = nullptr;
+#else
+    if(m_header)
+        munmap(m_header, m_size);
+    if(m_file != -1)
+        close(m_file);
+    m_file = -1;
+#endif
+    m_header   = nullptr;
+    m_size     = 0;
+    m_written  = 0;
+    m_writable = false;
+}
+
+uint8_t* CaptureRecording::Slot(uint64_t index) const
+{
+    return reinterpret_cast<uint8_t*>(m_header) + sHeaderBytes + (index % m_header->slots) * m_header->slotBytes;
+}
+
+bool CaptureRecording::Write(uint64_t timestamp, uint32_t width, uint32_t height, const void* pixels, uint32_t pitch)
+{
+    const auto rowBytes = static_cast<uint64_t>(width) * 4;
+    const auto bytes    = rowBytes * height;
+    if(!m_writable || sizeof(SlotHeader) + bytes > m_header->slotBytes)
+        return false;
+
+    const auto index = m_header->written;
+    auto       slot  = Slot(index);
+
+    SlotHeader header {index, timestamp, width, height, static_cast<uint32_t>(bytes), 0};
+    memcpy(slot, &header, sizeof(header));
+
+    auto source = static_cast<const uint8_t*>(pixels);
+    auto target = slot + sizeof(SlotHeader);
+    for(uint32_t y = 0; y < height; y++)
+        memcpy(target + y * rowBytes, source + static_cast<uint64_t>(y) * pitch, rowBytes);
+
+    m_header->written = index + 1;
+    return true;
+}
+
+uint64_t CaptureRecording::Frames() const
+{
+    if(!m_header)
+        return 0;
+    return std::min<uint64_t>(m_writable ? m_header->written : m_written, m_header->slots);
+}
+
+bool CaptureRecording::Frame(uint64_t n, CaptureFrame& frame) const
+{
+    const auto frames = Frames();
+    if(n >= frames)
+        return false;
+
+    const auto written = m_writable ? m_header->written : m_written;
+    const auto index   = written - frames + n;
+    const auto slot    = Slot(index);
+
+    SlotHeader header;
+    memcpy(&header, slot, sizeof(header));
+    if(header.index != index || header.bytes != static_cast<uint64_t>(header.width) * header.height * 4 || sizeof(SlotHeader) + header.bytes > m_header->slotBytes)
+        return false;
+
+    frame.index     = header.index;
+    frame.timestamp = header.timestamp;
+    frame.width     = header.width;
+    frame.height    = header.height;
+    frame.pixels    = slot + sizeof(SlotHeader);
+    return true;
+}
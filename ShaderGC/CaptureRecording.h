@@ -0,0 +1,93 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+// one captured input frame, pixels point into the mapped file
+struct CaptureFrame
+{
+    uint64_t       index {0}; // frames recorded before this one
+    uint64_t       timestamp {0}; // microseconds, as given to Write
+    uint32_t       width {0};
+    uint32_t       height {0};
+    const uint8_t* pixels {nullptr}; // BGRA8, rows of width * 4 bytes
+};
+
+// memory-mapped ring file of captured input frames, keeping the latest Slots() frames; layout is a FileHeader followed by
+// slots of SlotBytes each holding a SlotHeader and the pixels; little endian throughout so recordings replay on any platform
+class CaptureRecording
+{
+public:
+    static constexpr uint32_t Magic   = 0x52434753; // "SGCR"
+    static constexpr uint32_t Version = 1;
+
+    struct FileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t slots;
+        uint32_t slotBytes;
+        uint64_t written; // updated after each frame is complete
+        uint64_t reserved;
+    };
+
+    struct SlotHeader
+    {
+        uint64_t index;
+        uint64_t timestamp;
+        uint32_t width;
+        uint32_t height;
+        uint32_t bytes;
+        uint32_t reserved;
+    };
+
+    CaptureRecording() = default;
+    CaptureRecording(const CaptureRecording&) = delete;
+    CaptureRecording& operator=(const CaptureRecording&) = delete;
+    ~CaptureRecording();
+
+    // slot size which holds a frame of given size
+    static uint32_t SlotBytes(uint32_t width, uint32_t height);
+
+    // new file replacing any existing one
+    bool Create(const std::filesystem::path& path, uint32_t slots, uint32_t slotBytes);
+
+    // existing file for reading, frames written after opening are not seen
+    bool Open(const std::filesystem::path& path);
+
+    void Close();
+
+    // copies rows of pitch bytes into the slot of the oldest frame, false if the frame is larger than a slot
+    bool Write(uint64_t timestamp, uint32_t width, uint32_t height, const void* pixels, uint32_t pitch);
+
+    // frames which can be read, oldest first
+    uint64_t Frames() const;
+    bool     Frame(uint64_t n, CaptureFrame& frame) const;
+
+    uint32_t Slots() const
+    {
+        return m_header ? m_header->slots : 0;
+    }
+
+private:
+    bool     Map(const std::filesystem::path& path, uint64_t size, bool write);
+    uint8_t* Slot(uint64_t index) const;
+
+    FileHeader* m_header {nullptr};
+    uint64_t    m_size {0};
+    uint64_t    m_written {0}; // when opened for reading
+    bool        m_writable {false};
+#ifdef _WIN32
+    void* m_file {nullptr};
+    void* m_mapping {nullptr};
+#else
+    int m_file {-1};
+#endif
+};
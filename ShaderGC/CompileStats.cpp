@@ -0,0 +1,213 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "CompileStats.h"
+#include "json.hpp"
+
+#include <algorithm>
+#include <iomanip>
+
+static thread_local CompileStats* sCurrentStats = nullptr;
+static thread_local StageStats*   sCurrentStage = nullptr;
+
+double CompileStats::TotalMilliseconds() const
+{
+    double total = 0.0;
+    for(const auto& stage : m_stages)
+        total += stage.milliseconds;
+    return total;
+}
+
+const char* CompileStats::StageName(CompileStage stage)
+{
+    switch(stage)
+    {
+    case CompileStage::Preprocess:
+        return "preprocess";
+    case CompileStage::GLSL:
+        return "glsl";
+    case CompileStage::SPIRV:
+        return "spirv";
+    case CompileStage::HLSL:
+        return "hlsl";
+    case CompileStage::Reflect:
+        return "reflect";
+    default:
+        return "unknown";
+    }
+}
+
+CompileStats CompileStats::Median(const std::vector<CompileStats>& runs)
+{
+    CompileStats median;
+    if(runs.empty())
+        return median;
+    std::vector<StageStats> stages(runs.size());
+    for(int s = 0; s < static_cast<int>(CompileStage::Count); s++)
+    {
+        const auto stage = static_cast<CompileStage>(s);
+        for(size_t r = 0; r < runs.size(); r++)
+            stages[r] = runs[r][stage];
+        const auto middle = stages.begin() + stages.size() / 2;
+        std::nth_element(stages.begin(), middle, stages.end(), [](const StageStats& a, const StageStats& b) { return a.milliseconds < b.milliseconds; });
+        median[stage] = *middle;
+    }
+    return median;
+}
+
+void CompileStats::CountAllocation(size_t size)
+{
+    if(sCurrentStage)
+    {
+        sCurrentStage->allocations++;
+        sCurrentStage->allocatedBytes += size;
+    }
+}
+
+CompileStats::Scope::Scope(CompileStats& stats) : m_previous {sCurrentStats}
+{
+    sCurrentStats = &stats;
+}
+
+CompileStats::Scope::~Scope()
+{
+    sCurrentStats = m_previous;
+}
+
+CompileStats::Timer::Timer(CompileStage stage) :
+    m_stats {sCurrentStats ? &(*sCurrentStats)[stage] : nullptr}, m_previous {sCurrentStage}, m_start {}, m_span {"compile", StageName(stage)}
+{
+    if(m_stats)
+    {
+        // nested stages keep their own allocations
+        sCurrentStage = m_stats;
+        m_start       = std::chrono::steady_clock::now();
+    }
+}
+
+CompileStats::Timer::~Timer()
+{
+    if(m_stats)
+    {
+        m_stats->milliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+        m_stats->calls++;
+        sCurrentStage = m_previous;
+    }
+}
+
+static const char* sAllocationsNote = "allocations are partial: only those counted by the host's operator new, compilers loaded from DLLs "
+                                      "(D3DCompile, vkd3d-shader) are missing";
+
+double CompileReport::Percentile(std::vector<double> values, double p)
+{
+    if(values.empty())
+        return 0.0;
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, static_cast<size_t>(p * values.size()))];
+}
+
+// times of each stage and the total over shaders which compiled
+static std::vector<std::vector<double>> StageTimes(const std::vector<CompileResult>& shaders)
+{
+    std::vector<std::vector<double>> times(static_cast<int>(CompileStage::Count) + 1);
+    for(const auto& r : shaders)
+    {
+        if(!r.error.empty())
+            continue;
+        for(int s = 0; s < static_cast<int>(CompileStage::Count); s++)
+            times[s].push_back(r.stats[static_cast<CompileStage>(s)].milliseconds);
+        times.back().push_back(r.stats.TotalMilliseconds());
+    }
+    return times;
+}
+
+static const char* StageTimesName(size_t s)
+{
+    return s < static_cast<size_t>(CompileStage::Count) ? CompileStats::StageName(static_cast<CompileStage>(s)) : "total";
+}
+
+void CompileReport::WriteJson(std::ostream& out) const
+{
+    const auto             times = StageTimes(shaders);
+    nlohmann::ordered_json json;
+    json["compiler"]    = compiler;
+    json["runs"]        = runs;
+    json["jobs"]        = jobs;
+    json["allocations"] = sAllocationsNote;
+    for(size_t s = 0; s < times.size(); s++)
+    {
+        auto& stage  = json["summary"][StageTimesName(s)];
+        stage["p50"] = Percentile(times[s], 0.5);
+        stage["p90"] = Percentile(times[s], 0.9);
+        stage["p99"] = Percentile(times[s], 0.99);
+        stage["max"] = Percentile(times[s], 1.0);
+        double sum   = 0.0;
+        for(auto t : times[s])
+            sum += t;
+        stage["sum"] = sum;
+    }
+    json["shaders"] = nlohmann::ordered_json::array();
+    for(const auto& r : shaders)
+    {
+        nlohmann::ordered_json shader;
+        shader["path"] = r.path;
+        if(!r.error.empty())
+            shader["error"] = r.error;
+        for(int s = 0; s < static_cast<int>(CompileStage::Count); s++)
+        {
+            const auto& stage    = r.stats[static_cast<CompileStage>(s)];
+            auto&       entry    = shader[StageTimesName(s)];
+            entry["ms"]          = stage.milliseconds;
+            entry["allocations"] = stage.allocations;
+            entry["bytes"]       = stage.allocatedBytes;
+        }
+        shader["total_ms"] = r.stats.TotalMilliseconds();
+        json["shaders"].push_back(shader);
+    }
+    out << json.dump(2) << std::endl;
+}
+
+void CompileReport::WriteCsv(std::ostream& out) const
+{
+    out << "shader";
+    for(int s = 0; s < static_cast<int>(CompileStage::Count); s++)
+        out << "," << StageTimesName(s) << "_ms," << StageTimesName(s) << "_allocations," << StageTimesName(s) << "_bytes";
+    out << ",total_ms,error" << std::endl;
+    for(const auto& r : shaders)
+    {
+        out << r.path;
+        for(int s = 0; s < static_cast<int>(CompileStage::Count); s++)
+        {
+            const auto& stage = r.stats[static_cast<CompileStage>(s)];
+            out << "," << stage.milliseconds << "," << stage.allocations << "," << stage.allocatedBytes;
+        }
+        out << "," << r.stats.TotalMilliseconds() << "," << (r.error.empty() ? "" : "1") << std::endl;
+    }
+}
+
+void CompileReport::WriteSummary(std::ostream& out) const
+{
+    const auto times = StageTimes(shaders);
+    const auto flags = out.flags();
+    const auto prec  = out.precision();
+    out << std::setw(12) << std::left << "stage" << std::right << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99" << std::setw(10) << "max"
+        << std::setw(12) << "sum" << std::endl;
+    for(size_t s = 0; s < times.size(); s++)
+    {
+        double sum = 0.0;
+        for(auto t : times[s])
+            sum += t;
+        out << std::setw(12) << std::left << StageTimesName(s) << std::right << std::fixed << std::setprecision(2) << std::setw(10) << Percentile(times[s], 0.5)
+            << std::setw(10) << Percentile(times[s], 0.9) << std::setw(10) << Percentile(times[s], 0.99) << std::setw(10) << Percentile(times[s], 1.0) << std::setw(12)
+            << sum << std::endl;
+    }
+    out << sAllocationsNote << std::endl;
+    out.flags(flags);
+    out.precision(prec);
+}
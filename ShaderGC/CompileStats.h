@@ -0,0 +1,111 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include "Tracer.h"
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+enum class CompileStage
+{
+    Preprocess,
+    GLSL,
+    SPIRV,
+    HLSL,
+    Reflect,
+    Count
+};
+
+struct StageStats
+{
+    double   milliseconds {0.0};
+    uint64_t allocations {0};
+    uint64_t allocatedBytes {0};
+    int      calls {0};
+};
+
+// time and allocations of each compile stage, collected on the current thread while a Scope is active
+class CompileStats
+{
+public:
+    StageStats& operator[](CompileStage stage)
+    {
+        return m_stages[static_cast<int>(stage)];
+    }
+
+    const StageStats& operator[](CompileStage stage) const
+    {
+        return m_stages[static_cast<int>(stage)];
+    }
+
+    double TotalMilliseconds() const;
+
+    static const char* StageName(CompileStage stage);
+
+    // median of each stage over runs so one slow run doesn't skew the comparison
+    static CompileStats Median(const std::vector<CompileStats>& runs);
+
+    // hosts which hook operator new report allocations through this
+    static void CountAllocation(size_t size);
+
+    class Scope
+    {
+    public:
+        explicit Scope(CompileStats& stats);
+        ~Scope();
+
+    private:
+        CompileStats* m_previous;
+    };
+
+    // adds the enclosed work to given stage of the current stats, does nothing outside of a Scope; also traced
+    class Timer
+    {
+    public:
+        explicit Timer(CompileStage stage);
+        ~Timer();
+
+    private:
+        StageStats*                           m_stats;
+        StageStats*                           m_previous;
+        std::chrono::steady_clock::time_point m_start;
+        Tracer::Span                          m_span;
+    };
+
+private:
+    StageStats m_stages[static_cast<int>(CompileStage::Count)];
+};
+
+struct CompileResult
+{
+    std::string  path;
+    std::string  error;
+    CompileStats stats;
+};
+
+// what ShaderGen -bench saves: per-stage time and allocations of each shader, and percentiles over those which
+// compiled; allocations are only those the host counts through CountAllocation, which misses compilers loaded
+// from DLLs, so the JSON and the summary say they are partial
+struct CompileReport
+{
+    std::string                compiler;
+    int                        runs {0};
+    unsigned                   jobs {0};
+    std::vector<CompileResult> shaders;
+
+    // nearest rank, 0 for no values
+    static double Percentile(std::vector<double> values, double p);
+
+    void WriteJson(std::ostream& out) const;
+    void WriteCsv(std::ostream& out) const;
+    // p50/p90/p99/max and sum of each stage as a table
+    void WriteSummary(std::ostream& out) const;
+};
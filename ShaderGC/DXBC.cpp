@@ -0,0 +1,302 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "DXBC.h"
+
+#include <algorithm>
+#include <cstring>
+
+#define DXBC_HEADER_SIZE 32
+#define RDEF_HEADER_SIZE 28
+#define RDEF_CBUFFER_SIZE 24
+#define RDEF_VARIABLE_SIZE_40 24
+#define RDEF_VARIABLE_SIZE_50 40
+#define RDEF_VARIABLE_USED 2
+#define SHEX_OPCODE_MASK 0x7ff
+#define SHEX_LENGTH_SHIFT 24
+#define SHEX_LENGTH_MASK 0x7f
+#define STAT_DYNAMIC_FLOW_CONTROL 8
+
+// opcodes from d3d11tokenizedprogramformat.hpp
+#define OPCODE_BREAK 2
+#define OPCODE_BREAKC 3
+#define OPCODE_CALL 4
+#define OPCODE_CALLC 5
+#define OPCODE_CASE 6
+#define OPCODE_CONTINUE 7
+#define OPCODE_CONTINUEC 8
+#define OPCODE_DEFAULT 10
+#define OPCODE_DISCARD 13
+#define OPCODE_DIV 14
+#define OPCODE_ELSE 18
+#define OPCODE_ENDIF 21
+#define OPCODE_ENDLOOP 22
+#define OPCODE_ENDSWITCH 23
+#define OPCODE_EXP 25
+#define OPCODE_IF 31
+#define OPCODE_LD 45
+#define OPCODE_LD_MS 46
+#define OPCODE_LOG 47
+#define OPCODE_LOOP 48
+#define OPCODE_CUSTOMDATA 53
+#define OPCODE_RET 62
+#define OPCODE_RETC 63
+#define OPCODE_RSQ 68
+#define OPCODE_SAMPLE 69
+#define OPCODE_SAMPLE_B 74
+#define OPCODE_SQRT 75
+#define OPCODE_SWITCH 76
+#define OPCODE_SINCOS 77
+#define OPCODE_DCL_FIRST 88
+#define OPCODE_DCL_TEMPS 104
+#define OPCODE_DCL_INDEXABLE_TEMP 105
+#define OPCODE_DCL_LAST 106
+#define OPCODE_GATHER4 109
+#define OPCODE_GATHER4_C 126
+#define OPCODE_GATHER4_PO_C 128
+#define OPCODE_RCP 129
+#define OPCODE_DCL_STREAM 143
+#define OPCODE_DCL_RESOURCE_STRUCTURED 162
+#define OPCODE_LD_UAV_TYPED 163
+#define OPCODE_LD_RAW 165
+#define OPCODE_LD_STRUCTURED 167
+
+// relative to a simple ALU instruction
+#define WEIGHT_SAMPLE 4.0f
+#define WEIGHT_LOAD 3.0f
+#define WEIGHT_TRANSCENDENTAL 4.0f
+#define WEIGHT_FLOW_CONTROL 2.0f
+
+enum class InstructionClass
+{
+    Declaration,
+    Alu,
+    Transcendental,
+    Sample,
+    Load,
+    FlowControl
+};
+
+static uint32_t ReadUInt(const uint8_t* data)
+{
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static InstructionClass Classify(uint32_t opcode)
+{
+    if((opcode >= OPCODE_DCL_FIRST && opcode <= OPCODE_DCL_LAST) || (opcode >= OPCODE_DCL_STREAM && opcode <= OPCODE_DCL_RESOURCE_STRUCTURED) || opcode == OPCODE_CUSTOMDATA)
+        return InstructionClass::Declaration;
+    if((opcode >= OPCODE_SAMPLE && opcode <= OPCODE_SAMPLE_B) || opcode == OPCODE_GATHER4 || (opcode >= OPCODE_GATHER4_C && opcode <= OPCODE_GATHER4_PO_C))
+        return InstructionClass::Sample;
+
+    switch(opcode)
+    {
+    case OPCODE_LD:
+    case OPCODE_LD_MS:
+    case OPCODE_LD_UAV_TYPED:
+    case OPCODE_LD_RAW:
+    case OPCODE_LD_STRUCTURED:
+        return InstructionClass::Load;
+    case OPCODE_DIV:
+    case OPCODE_EXP:
+    case OPCODE_LOG:
+    case OPCODE_RCP:
+    case OPCODE_RSQ:
+    case OPCODE_SQRT:
+    case OPCODE_SINCOS:
+        return InstructionClass::Transcendental;
+    case OPCODE_BREAK:
+    case OPCODE_BREAKC:
+    case OPCODE_CALL:
+    case OPCODE_CALLC:
+    case OPCODE_CASE:
+    case OPCODE_CONTINUE:
+    case OPCODE_CONTINUEC:
+    case OPCODE_DEFAULT:
+    case OPCODE_DISCARD:
+    case OPCODE_ELSE:
+    case OPCODE_ENDIF:
+    case OPCODE_ENDLOOP:
+    case OPCODE_ENDSWITCH:
+    case OPCODE_IF:
+    case OPCODE_LOOP:
+    case OPCODE_RET:
+    case OPCODE_RETC:
+    case OPCODE_SWITCH:
+        return InstructionClass::FlowControl;
+    default:
+        return InstructionClass::Alu;
+    }
+}
+
+const uint8_t* DXBC::FindChunk(const uint8_t* byteCode, size_t length, const char* fourCC, uint32_t& chunkLength)
+{
+    if(byteCode == nullptr || length < DXBC_HEADER_SIZE || memcmp(byteCode, "DXBC", 4) != 0)
+        return nullptr;
+
+    const auto chunkCount = ReadUInt(byteCode + 28);
+    if(DXBC_HEADER_SIZE + chunkCount * 4ull > length)
+        return nullptr;
+
+    for(uint32_t c = 0; c < chunkCount; c++)
+    {
+        const auto offset = ReadUInt(byteCode + DXBC_HEADER_SIZE + c * 4);
+        if(offset + 8ull > length)
+            return nullptr;
+
+        const auto size = ReadUInt(byteCode + offset + 4);
+        if(offset + 8ull + size > length)
+            return nullptr;
+
+        if(memcmp(byteCode + offset, fourCC, 4) == 0)
+        {
+            chunkLength = size;
+            return byteCode + offset + 8;
+        }
+    }
+    return nullptr;
+}
+
+bool DXBC::UsedConstants(const uint8_t* byteCode, size_t length, std::vector<std::string>& names)
+{
+    uint32_t rdefLength = 0;
+    auto     rdef       = FindChunk(byteCode, length, "RDEF", rdefLength);
+    if(rdef == nullptr || rdefLength < RDEF_HEADER_SIZE)
+        return false;
+
+    const auto cbufferCount  = ReadUInt(rdef);
+    const auto cbufferOffset = ReadUInt(rdef + 4);
+    const auto majorVersion  = rdef[17];
+    const auto variableSize  = majorVersion >= 5 ? RDEF_VARIABLE_SIZE_50 : RDEF_VARIABLE_SIZE_40;
+
+    auto readName = [&](uint32_t offset, std::string& name) {
+        if(offset >= rdefLength)
+            return false;
+        const auto maxLen = rdefLength - offset;
+        const auto len    = strnlen((const char*)rdef + offset, maxLen);
+        if(len == maxLen)
+            return false;
+        name.assign((const char*)rdef + offset, len);
+        return true;
+    };
+
+    if(cbufferOffset + cbufferCount * (uint64_t)RDEF_CBUFFER_SIZE > rdefLength)
+        return false;
+
+    for(uint32_t b = 0; b < cbufferCount; b++)
+    {
+        const auto cbuffer        = rdef + cbufferOffset + b * RDEF_CBUFFER_SIZE;
+        const auto variableCount  = ReadUInt(cbuffer + 4);
+        const auto variableOffset = ReadUInt(cbuffer + 8);
+        if(variableOffset + variableCount * (uint64_t)variableSize > rdefLength)
+            return false;
+
+        for(uint32_t v = 0; v < variableCount; v++)
+        {
+            const auto variable = rdef + variableOffset + v * variableSize;
+            if(ReadUInt(variable + 12) & RDEF_VARIABLE_USED)
+            {
+                std::string name;
+                if(!readName(ReadUInt(variable), name))
+                    return false;
+                names.push_back(name);
+            }
+        }
+    }
+    return true;
+}
+
+bool DXBC::Cost(const uint8_t* byteCode, size_t length, ShaderCost& cost)
+{
+    uint32_t shexLength = 0;
+    auto     shex       = FindChunk(byteCode, length, "SHEX", shexLength);
+    if(shex == nullptr)
+        shex = FindChunk(byteCode, length, "SHDR", shexLength);
+    if(shex == nullptr || shexLength < 8)
+        return false;
+
+    cost = {};
+
+    // version and length in dwords, then instructions each starting with its opcode and length
+    const auto tokens     = std::min<uint32_t>(ReadUInt(shex + 4), shexLength / 4);
+    auto       token      = [&](uint32_t t) { return ReadUInt(shex + t * 4); };
+    float      multiplier = 1.0f;
+    int        depth      = 0;
+    for(uint32_t t = 2; t < tokens;)
+    {
+        const auto opcode = token(t) & SHEX_OPCODE_MASK;
+        auto       size   = (token(t) >> SHEX_LENGTH_SHIFT) & SHEX_LENGTH_MASK;
+        if(opcode == OPCODE_CUSTOMDATA)
+            size = t + 1 < tokens ? token(t + 1) : 0;
+        if(size == 0 || t + size > tokens)
+            return false;
+
+        const auto type = Classify(opcode);
+        if(type == InstructionClass::Declaration)
+        {
+            if(opcode == OPCODE_DCL_TEMPS && size >= 2)
+                cost.tempRegisters = token(t + 1);
+            else if(opcode == OPCODE_DCL_INDEXABLE_TEMP && size >= 4)
+                cost.tempArrays += token(t + 2);
+            t += size;
+            continue;
+        }
+
+        // instructions of the loop body run more than once
+        if(opcode == OPCODE_ENDLOOP && depth > 0)
+        {
+            depth--;
+            multiplier /= LoopIterations;
+        }
+
+        cost.instructions++;
+        auto weight = 1.0f;
+        switch(type)
+        {
+        case InstructionClass::Sample:
+            cost.samples++;
+            weight = WEIGHT_SAMPLE;
+            break;
+        case InstructionClass::Load:
+            cost.loads++;
+            weight = WEIGHT_LOAD;
+            break;
+        case InstructionClass::Transcendental:
+            cost.transcendentals++;
+            weight = WEIGHT_TRANSCENDENTAL;
+            break;
+        case InstructionClass::FlowControl:
+            cost.flowControl++;
+            weight = WEIGHT_FLOW_CONTROL;
+            break;
+        default:
+            break;
+        }
+        cost.weighted += weight * multiplier;
+
+        if(opcode == OPCODE_LOOP)
+        {
+            depth++;
+            multiplier *= LoopIterations;
+            cost.loops++;
+            cost.loopDepth = std::max(cost.loopDepth, depth);
+        }
+        t += size;
+    }
+
+    // only the compiler knows which branches depend on values computed in the shader
+    uint32_t statLength = 0;
+    auto     stat       = FindChunk(byteCode, length, "STAT", statLength);
+    if(stat != nullptr && statLength >= (STAT_DYNAMIC_FLOW_CONTROL + 1) * 4)
+        cost.dynamicFlowControl = ReadUInt(stat + STAT_DYNAMIC_FLOW_CONTROL * 4);
+
+    return true;
+}
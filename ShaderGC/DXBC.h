@@ -0,0 +1,40 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+// static cost of a shader as compiled, a loop body is in the counts once however many times it runs
+struct ShaderCost
+{
+    int   instructions {0};       // excluding declarations
+    int   samples {0};            // sample and gather
+    int   loads {0};              // texel loads without filtering
+    int   transcendentals {0};    // div, exp, log, rcp, rsq, sqrt, sincos
+    int   flowControl {0};        // branches, loops, calls and returns
+    int   dynamicFlowControl {0}; // of these, ones depending on values computed in the shader
+    int   loops {0};
+    int   loopDepth {0};          // deepest nesting of loops
+    int   tempRegisters {0};
+    int   tempArrays {0};         // registers in indexable temp arrays
+    float weighted {0.0f};        // estimated cost per invocation in simple ALU instructions
+};
+
+class DXBC
+{
+public:
+    // unknown trip counts are taken as this many iterations per loop level when weighting
+    static constexpr int LoopIterations = 8;
+
+    // names of constant buffer variables the shader actually reads, false if bytecode couldn't be parsed
+    static bool UsedConstants(const uint8_t* byteCode, size_t length, std::vector<std::string>& names);
+
+    // instruction mix and structure from SHEX (or SHDR) and STAT chunks, false if bytecode couldn't be parsed
+    static bool Cost(const uint8_t* byteCode, size_t length, ShaderCost& cost);
+
+private:
+    static const uint8_t* FindChunk(const uint8_t* byteCode, size_t length, const char* fourCC, uint32_t& chunkLength);
+};
@@ -8,6 +8,7 @@ GNU General Public License v3.0
 #include "pch.h"
 
 #include "GLSL.h"
+#include "CompileStats.h"
 
 #include "include/glslang/Include/glslang_c_interface.h"
 #include "include/glslang/Public/resource_limits_c.h"
@@ -26,6 +27,7 @@ GNU General Public License v3.0
 std::vector<uint32_t> GLSL::GenerateSPIRV(const char* source, bool fragment, std::ostream& log, bool& warn)
 {
     //std::cout << "GenerateSPIRV...";
+    CompileStats::Timer timer(CompileStage::GLSL);
 
     std::vector<uint32_t> bin;
     auto                  stage = fragment ? GLSLANG_STAGE_FRAGMENT : GLSLANG_STAGE_VERTEX;
@@ -99,3 +101,13 @@ std::vector<uint32_t> GLSL::GenerateSPIRV(const char* source, bool fragment, std
 
     return bin;
 }
+
+void GLSL::Initialize()
+{
+    glslang_initialize_process();
+}
+
+void GLSL::Finalize()
+{
+    glslang_finalize_process();
+}
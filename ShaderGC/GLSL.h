@@ -11,4 +11,8 @@ class GLSL
 {
 public:
     static std::vector<uint32_t> GenerateSPIRV(const char* source, bool fragment, std::ostream& log, bool& warn);
+
+    // process-wide glslang state, needed before compiling from several threads
+    static void Initialize();
+    static void Finalize();
 };
\ No newline at end of file
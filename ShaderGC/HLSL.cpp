@@ -8,13 +8,22 @@ GNU General Public License v3.0
 #include "pch.h"
 
 #include "HLSL.h"
+#include "CompileStats.h"
 
+#include <cstring>
 #include <stdexcept>
-#include <d3dcompiler.h>
 
-#pragma comment(lib, "d3dcompiler.lib")
+#ifdef _WIN32
+#    include <d3dcompiler.h>
+#    pragma comment(lib, "d3dcompiler.lib")
+#endif
 
-std::vector<uint8_t> HLSL::CompileHLSL(const char* source, size_t size, const char* profile, std::ostream& log, bool& warn)
+#ifdef SHADERGC_VKD3D
+#    include <vkd3d_shader.h>
+#endif
+
+#ifdef _WIN32
+std::vector<uint8_t> FXCCompiler::Compile(const char* source, size_t size, const char* profile, std::ostream& log, bool& warn)
 {
     //std::cout << "CompileHLSL...";
 
@@ -51,3 +60,93 @@ std::vector<uint8_t> HLSL::CompileHLSL(const char* source, size_t size, const ch
 
     return bin;
 }
+#endif
+
+#ifdef SHADERGC_VKD3D
+std::vector<uint8_t> VKD3DCompiler::Compile(const char* source, size_t size, const char* profile, std::ostream& log, bool& warn)
+{
+    vkd3d_shader_hlsl_source_info hlslInfo {};
+    hlslInfo.type        = VKD3D_SHADER_STRUCTURE_TYPE_HLSL_SOURCE_INFO;
+    hlslInfo.entry_point = "main";
+    hlslInfo.profile     = profile;
+
+    vkd3d_shader_compile_info compileInfo {};
+    compileInfo.type        = VKD3D_SHADER_STRUCTURE_TYPE_COMPILE_INFO;
+    compileInfo.next        = &hlslInfo;
+    compileInfo.source.code = source;
+    compileInfo.source.size = size;
+    compileInfo.source_type = VKD3D_SHADER_SOURCE_HLSL;
+    compileInfo.target_type = VKD3D_SHADER_TARGET_DXBC_TPF;
+    compileInfo.log_level   = VKD3D_SHADER_LOG_WARNING;
+
+    vkd3d_shader_code dxbc {};
+    char*             messages = nullptr;
+    const auto        result   = vkd3d_shader_compile(&compileInfo, &dxbc, &messages);
+
+    std::string output(messages ? messages : "");
+    vkd3d_shader_free_messages(messages);
+    if(result < 0)
+    {
+        std::ostringstream msg;
+        msg << "VKD3D Compilation Error" << std::endl;
+        msg << output << std::endl;
+        throw std::runtime_error(msg.str());
+    }
+    if(!output.empty())
+    {
+        log << output << std::endl;
+        warn = true;
+    }
+
+    std::vector<uint8_t> bin(static_cast<const uint8_t*>(dxbc.code), static_cast<const uint8_t*>(dxbc.code) + dxbc.size);
+    vkd3d_shader_free_shader_code(&dxbc);
+    return bin;
+}
+#endif
+
+std::unique_ptr<HLSLCompiler>& HLSL::Compiler()
+{
+#if defined(_WIN32)
+    static std::unique_ptr<HLSLCompiler> compiler = std::make_unique<FXCCompiler>();
+#elif defined(SHADERGC_VKD3D)
+    static std::unique_ptr<HLSLCompiler> compiler = std::make_unique<VKD3DCompiler>();
+#else
+    static std::unique_ptr<HLSLCompiler> compiler;
+#endif
+    return compiler;
+}
+
+std::vector<uint8_t> HLSL::CompileHLSL(const char* source, size_t size, const char* profile, std::ostream& log, bool& warn)
+{
+    CompileStats::Timer timer(CompileStage::HLSL);
+
+    auto& compiler = Compiler();
+    if(!compiler)
+        throw std::runtime_error("No HLSL compiler available");
+    return compiler->Compile(source, size, profile, log, warn);
+}
+
+bool HLSL::SelectCompiler([[maybe_unused]] const std::string& name)
+{
+#ifdef _WIN32
+    if(name == "fxc")
+    {
+        Compiler() = std::make_unique<FXCCompiler>();
+        return true;
+    }
+#endif
+#ifdef SHADERGC_VKD3D
+    if(name == "vkd3d")
+    {
+        Compiler() = std::make_unique<VKD3DCompiler>();
+        return true;
+    }
+#endif
+    return false;
+}
+
+const char* HLSL::CompilerName()
+{
+    const auto& compiler = Compiler();
+    return compiler ? compiler->Name() : "none";
+}
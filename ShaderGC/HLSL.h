@@ -7,8 +7,57 @@ GNU General Public License v3.0
 
 #pragma once
 
+#include <memory>
+
+// turns HLSL into DXBC for given profile, throws on errors
+class HLSLCompiler
+{
+public:
+    virtual ~HLSLCompiler() = default;
+
+    virtual const char* Name() const = 0;
+
+    virtual std::vector<uint8_t> Compile(const char* source, size_t size, const char* profile, std::ostream& log, bool& warn) = 0;
+};
+
+#ifdef _WIN32
+// D3DCompile from d3dcompiler_47
+class FXCCompiler : public HLSLCompiler
+{
+public:
+    const char* Name() const override
+    {
+        return "fxc";
+    }
+
+    std::vector<uint8_t> Compile(const char* source, size_t size, const char* profile, std::ostream& log, bool& warn) override;
+};
+#endif
+
+#ifdef SHADERGC_VKD3D
+// vkd3d-shader, DXBC without d3dcompiler_47
+class VKD3DCompiler : public HLSLCompiler
+{
+public:
+    const char* Name() const override
+    {
+        return "vkd3d";
+    }
+
+    std::vector<uint8_t> Compile(const char* source, size_t size, const char* profile, std::ostream& log, bool& warn) override;
+};
+#endif
+
 class HLSL
 {
 public:
+    // compiles with the selected compiler, fxc on Windows and vkd3d elsewhere unless changed
     static std::vector<uint8_t> CompileHLSL(const char* source, size_t size, const char* profile, std::ostream& log, bool& warn);
-};
\ No newline at end of file
+
+    // by name as returned by Name(), false if not built in
+    static bool        SelectCompiler(const std::string& name);
+    static const char* CompilerName();
+
+private:
+    static std::unique_ptr<HLSLCompiler>& Compiler();
+};
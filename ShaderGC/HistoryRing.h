@@ -0,0 +1,44 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+// slots of a fixed ring of Original textures, current frame plus requested history
+class HistoryRing
+{
+public:
+    HistoryRing() : m_size {1}, m_head {0} { }
+
+    void Resize(int depth)
+    {
+        m_size = depth + 1;
+        m_head = 0;
+    }
+
+    int Size() const
+    {
+        return m_size;
+    }
+
+    // move to the slot which will receive next Original
+    void Advance()
+    {
+        m_head = (m_head + 1) % m_size;
+    }
+
+    // slot holding Original from given number of frames ago
+    int Slot(int age) const
+    {
+        if(age >= m_size)
+            age = m_size - 1;
+        return (m_head + m_size - age) % m_size;
+    }
+
+private:
+    int m_size;
+    int m_head;
+};
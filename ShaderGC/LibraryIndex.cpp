@@ -0,0 +1,706 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "LibraryIndex.h"
+#include "ShaderGC.h"
+#include "sha256.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+// little endian like CaptureRecording, lengths are 32-bit
+namespace
+{
+class Writer
+{
+public:
+    template<typename T> void Write(const T& value)
+    {
+        const auto bytes = reinterpret_cast<const uint8_t*>(&value);
+        m_data.insert(m_data.end(), bytes, bytes + sizeof(T));
+    }
+
+    void Write(const void* data, size_t length)
+    {
+        Write(static_cast<uint32_t>(length));
+        if(length)
+            m_data.insert(m_data.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + length);
+    }
+
+    void Write(const std::string& value)
+    {
+        Write(value.data(), value.size());
+    }
+
+    void Write(const std::filesystem::path& value)
+    {
+        const auto utf8 = value.u8string();
+        Write(utf8.data(), utf8.size());
+    }
+
+    void Write(const std::map<std::string, std::string>& values)
+    {
+        Write(static_cast<uint32_t>(values.size()));
+        for(const auto& value : values)
+        {
+            Write(value.first);
+            Write(value.second);
+        }
+    }
+
+    std::vector<uint8_t>& Data()
+    {
+        return m_data;
+    }
+
+private:
+    std::vector<uint8_t> m_data;
+};
+
+class Reader
+{
+public:
+    Reader(const uint8_t* data, size_t length) : m_data {data}, m_length {length}, m_offset {0} { }
+
+    template<typename T> T Read()
+    {
+        T value;
+        memcpy(&value, Take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    // a count of items taking at least itemBytes each, checked against what is left so a corrupt count cannot
+    // reserve more than the file holds
+    size_t Count(size_t itemBytes)
+    {
+        const auto count = Read<uint32_t>();
+        if(count * itemBytes > m_length - m_offset)
+            throw std::runtime_error("Malformed library index");
+        return count;
+    }
+
+    std::pair<const uint8_t*, size_t> Bytes()
+    {
+        const auto length = Read<uint32_t>();
+        return std::make_pair(Take(length), static_cast<size_t>(length));
+    }
+
+    std::string String()
+    {
+        const auto bytes = Bytes();
+        return std::string(reinterpret_cast<const char*>(bytes.first), bytes.second);
+    }
+
+    std::filesystem::path Path()
+    {
+        const auto bytes = Bytes();
+        return std::filesystem::path(std::u8string(reinterpret_cast<const char8_t*>(bytes.first), bytes.second));
+    }
+
+    std::map<std::string, std::string> Map()
+    {
+        std::map<std::string, std::string> values;
+        for(auto count = Count(8); count; count--)
+        {
+            auto key    = String();
+            values[key] = String();
+        }
+        return values;
+    }
+
+    bool End() const
+    {
+        return m_offset == m_length;
+    }
+
+private:
+    const uint8_t* Take(size_t length)
+    {
+        if(length > m_length - m_offset)
+            throw std::runtime_error("Malformed library index");
+        const auto data = m_data + m_offset;
+        m_offset += length;
+        return data;
+    }
+
+    const uint8_t* m_data;
+    size_t         m_length;
+    size_t         m_offset;
+};
+} // namespace
+
+static int64_t ModifiedTime(const std::filesystem::path& path, uint64_t& size)
+{
+    std::error_code ec;
+    const auto      mtime = std::filesystem::last_write_time(path, ec);
+    if(ec)
+    {
+        size = 0;
+        return 0;
+    }
+    size = std::filesystem::file_size(path, ec);
+    if(ec)
+        size = 0;
+    return static_cast<int64_t>(mtime.time_since_epoch().count());
+}
+
+// false if already there, which also stops include cycles
+static bool AddDependency(std::vector<LibraryDependency>& dependencies, const std::filesystem::path& path)
+{
+    const auto normal = path.lexically_normal();
+    for(const auto& dependency : dependencies)
+    {
+        if(dependency.path == normal)
+            return false;
+    }
+    dependencies.push_back(LibraryDependency {normal});
+    return true;
+}
+
+// files pulled in by lines starting with directive, resolved like ShaderGC::LoadSource and ParsePreset do
+static void AddDirectives(std::vector<LibraryDependency>& dependencies, const std::filesystem::path& path, const char* directive)
+{
+    if(!AddDependency(dependencies, path))
+        return;
+
+    std::ifstream infile(path.lexically_normal());
+    std::string   line;
+    while(std::getline(infile, line))
+    {
+        if(!line.starts_with(directive))
+            continue;
+
+        std::istringstream iss(line);
+        std::string        lineDirective, file;
+        iss >> lineDirective;
+        iss >> std::quoted(file);
+        if(lineDirective != directive || file.empty())
+            continue;
+        auto includePath = path;
+        includePath.remove_filename();
+        AddDirectives(dependencies, includePath / std::filesystem::path(file), directive);
+    }
+}
+
+// name shown for the preset, files of a bulk import keep their folders to tell apart presets of the same name
+static std::string PresetName(const std::filesystem::path& path, const std::filesystem::path& root)
+{
+    try
+    {
+        if(root.empty())
+            return path.filename().string();
+        return path.lexically_relative(root).generic_string();
+    }
+    catch(...)
+    {
+        return std::string("???"); // unicode...
+    }
+}
+
+std::vector<LibraryDependency> LibraryIndex::Dependencies(const std::filesystem::path& path)
+{
+    std::vector<LibraryDependency> dependencies;
+    try
+    {
+        if(path.extension() == ".slang")
+        {
+            AddDirectives(dependencies, path, "#include");
+        }
+        else
+        {
+            AddDirectives(dependencies, path, "#reference");
+
+            SourcePresetDef    sp(path, SourceShaderInfo());
+            std::ostringstream log;
+            bool               warn = false;
+            ShaderGC::ProcessSourcePreset(sp, log, warn);
+            for(const auto& s : sp.shaders)
+                AddDirectives(dependencies, s.input, "#include");
+            for(const auto& t : sp.textures)
+                AddDependency(dependencies, t.input);
+        }
+    }
+    catch(...)
+    {
+        // compiling fails the same way and records why
+    }
+    if(dependencies.empty())
+        AddDependency(dependencies, path);
+
+    for(auto& dependency : dependencies)
+        dependency.mtime = ModifiedTime(dependency.path, dependency.size);
+    return dependencies;
+}
+
+std::vector<uint32_t> LibraryIndex::Hash(const std::vector<LibraryDependency>& dependencies)
+{
+    std::vector<uint32_t> hash(HASH_LEN);
+    SHA256_CTX            ctx;
+    sha256_init(&ctx);
+    std::vector<char> buffer(65536);
+    for(const auto& dependency : dependencies)
+    {
+        // missing files hash differently from empty ones
+        std::ifstream infile(dependency.path, std::ios::binary);
+        const uint8_t found = infile.good() ? 1 : 0;
+        sha256_update(&ctx, &found, 1);
+        while(infile.read(buffer.data(), buffer.size()) || infile.gcount())
+            sha256_update(&ctx, reinterpret_cast<const BYTE*>(buffer.data()), static_cast<size_t>(infile.gcount()));
+    }
+    sha256_final(&ctx, reinterpret_cast<BYTE*>(hash.data()));
+    return hash;
+}
+
+std::vector<uint8_t> LibraryIndex::Serialize(const PresetDef& presetDef)
+{
+    Writer writer;
+    writer.Write(presetDef.Name);
+    writer.Write(presetDef.Category);
+    writer.Write(presetDef.ImportPath);
+    writer.Write(presetDef.Cost);
+
+    // SPIR-V is left out, only the software renderer reads it
+    writer.Write(static_cast<uint32_t>(presetDef.ShaderDefs.size()));
+    for(const auto& shaderDef : presetDef.ShaderDefs)
+    {
+        writer.Write(shaderDef.Name);
+        writer.Write(std::string(shaderDef.Format ? shaderDef.Format : ""));
+        writer.Write(shaderDef.VertexByteCode, shaderDef.VertexLength);
+        writer.Write(shaderDef.FragmentByteCode, shaderDef.FragmentLength);
+        writer.Write(static_cast<uint32_t>(shaderDef.Params.size()));
+        for(const auto& param : shaderDef.Params)
+        {
+            writer.Write(param.name);
+            writer.Write(param.buffer);
+            writer.Write(param.offset);
+            writer.Write(param.size);
+            writer.Write(param.minValue);
+            writer.Write(param.maxValue);
+            writer.Write(param.defaultValue);
+            writer.Write(param.stepValue);
+            writer.Write(param.description);
+        }
+        writer.Write(static_cast<uint32_t>(shaderDef.Samplers.size()));
+        for(const auto& sampler : shaderDef.Samplers)
+        {
+            writer.Write(sampler.name);
+            writer.Write(sampler.binding);
+        }
+        writer.Write(shaderDef.PresetParams);
+    }
+
+    writer.Write(static_cast<uint32_t>(presetDef.TextureDefs.size()));
+    for(const auto& textureDef : presetDef.TextureDefs)
+    {
+        writer.Write(textureDef.Name);
+        writer.Write(textureDef.Data, textureDef.DataLength);
+        writer.Write(textureDef.PresetParams);
+    }
+
+    writer.Write(static_cast<uint32_t>(presetDef.Overrides.size()));
+    for(const auto& o : presetDef.Overrides)
+    {
+        writer.Write(o.name);
+        writer.Write(o.value);
+    }
+    return std::move(writer.Data());
+}
+
+static uint8_t* CopyBytes(const std::pair<const uint8_t*, size_t>& bytes)
+{
+    if(!bytes.second)
+        return nullptr;
+    auto copy = new uint8_t[bytes.second];
+    memcpy(copy, bytes.first, bytes.second);
+    return copy;
+}
+
+PresetDef* LibraryIndex::Deserialize(const uint8_t* data, size_t length)
+{
+    try
+    {
+        Reader                     reader(data, length);
+        std::unique_ptr<PresetDef> presetDef(new PresetDef());
+        presetDef->Name       = reader.String();
+        presetDef->Category   = reader.String();
+        presetDef->ImportPath = reader.Path();
+        presetDef->Cost       = reader.Read<float>();
+
+        // reserved up front, dynamic defs free their data when a reallocating vector destroys the copies
+        const auto shaders = reader.Count(28);
+        presetDef->ShaderDefs.reserve(shaders);
+        for(size_t s = 0; s < shaders; s++)
+        {
+            auto& shaderDef            = presetDef->ShaderDefs.emplace_back();
+            shaderDef.Dynamic          = true;
+            shaderDef.Name             = reader.String();
+            const auto format          = reader.String();
+            const auto vertex          = reader.Bytes();
+            const auto fragment        = reader.Bytes();
+            shaderDef.Format           = new char[format.size() + 1];
+            shaderDef.VertexByteCode   = CopyBytes(vertex);
+            shaderDef.VertexLength     = vertex.second;
+            shaderDef.FragmentByteCode = CopyBytes(fragment);
+            shaderDef.FragmentLength   = fragment.second;
+            memcpy(shaderDef.Format, format.c_str(), format.size() + 1);
+
+            for(auto params = reader.Count(36); params; params--)
+            {
+                const auto name         = reader.String();
+                const auto buffer       = reader.Read<int>();
+                const auto offset       = reader.Read<int>();
+                const auto size         = reader.Read<int>();
+                const auto minValue     = reader.Read<float>();
+                const auto maxValue     = reader.Read<float>();
+                const auto defaultValue = reader.Read<float>();
+                const auto stepValue    = reader.Read<float>();
+                const auto description  = reader.String();
+                shaderDef.Params.emplace_back(name.c_str(), buffer, offset, size, minValue, maxValue, defaultValue, stepValue, description.c_str());
+            }
+            for(auto samplers = reader.Count(8); samplers; samplers--)
+            {
+                const auto name    = reader.String();
+                const auto binding = reader.Read<int>();
+                shaderDef.Samplers.emplace_back(name.c_str(), binding);
+            }
+            shaderDef.PresetParams = reader.Map();
+        }
+
+        const auto textures = reader.Count(12);
+        presetDef->TextureDefs.reserve(textures);
+        for(size_t t = 0; t < textures; t++)
+        {
+            auto& textureDef        = presetDef->TextureDefs.emplace_back();
+            textureDef.Dynamic      = true;
+            textureDef.Name         = reader.String();
+            const auto bytes        = reader.Bytes();
+            textureDef.Data         = CopyBytes(bytes);
+            textureDef.DataLength   = static_cast<int>(bytes.second);
+            textureDef.PresetParams = reader.Map();
+        }
+
+        for(auto overrides = reader.Count(8); overrides; overrides--)
+        {
+            const auto name  = reader.String();
+            const auto value = reader.Read<float>();
+            presetDef->OverrideParam(name.c_str(), value);
+        }
+
+        if(!reader.End())
+            return nullptr;
+        return presetDef.release();
+    }
+    catch(std::exception&)
+    {
+        return nullptr;
+    }
+}
+
+bool LibraryIndex::Load(const std::filesystem::path& path)
+{
+    std::unique_lock lock(m_mutex);
+    m_entries.clear();
+
+    std::ifstream infile(path, std::ios::binary);
+    if(!infile.good())
+        return false;
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(infile)), std::istreambuf_iterator<char>());
+
+    // the hash of everything before it ends the file, so damage which still parses is caught too
+    const auto hashBytes = HASH_LEN * sizeof(uint32_t);
+    if(data.size() < hashBytes || memcmp(ShaderCache::CalculateHash(data.data(), data.size() - hashBytes).data(), data.data() + data.size() - hashBytes, hashBytes))
+        return false;
+
+    try
+    {
+        Reader reader(data.data(), data.size() - hashBytes);
+        if(reader.Read<uint32_t>() != Magic || reader.Read<uint32_t>() != Version)
+            return false;
+
+        for(auto entries = reader.Count(24); entries; entries--)
+        {
+            LibraryEntry entry;
+            entry.path = reader.Path();
+            entry.root = reader.Path();
+            for(auto dependencies = reader.Count(20); dependencies; dependencies--)
+            {
+                LibraryDependency dependency;
+                dependency.path  = reader.Path();
+                dependency.mtime = reader.Read<int64_t>();
+                dependency.size  = reader.Read<uint64_t>();
+                entry.dependencies.push_back(dependency);
+            }
+            for(auto words = reader.Count(4); words; words--)
+                entry.hash.push_back(reader.Read<uint32_t>());
+            entry.error       = reader.String();
+            const auto preset = reader.Bytes();
+            entry.preset.assign(preset.first, preset.first + preset.second);
+            m_entries[entry.path] = std::move(entry);
+        }
+        if(!reader.End())
+            throw std::runtime_error("Malformed library index");
+    }
+    catch(std::exception&)
+    {
+        m_entries.clear();
+        return false;
+    }
+    return true;
+}
+
+bool LibraryIndex::Save(const std::filesystem::path& path) const
+{
+    Writer writer;
+    {
+        std::unique_lock lock(m_mutex);
+        writer.Write(Magic);
+        writer.Write(Version);
+        writer.Write(static_cast<uint32_t>(m_entries.size()));
+        for(const auto& [key, entry] : m_entries)
+        {
+            writer.Write(entry.path);
+            writer.Write(entry.root);
+            writer.Write(static_cast<uint32_t>(entry.dependencies.size()));
+            for(const auto& dependency : entry.dependencies)
+            {
+                writer.Write(dependency.path);
+                writer.Write(dependency.mtime);
+                writer.Write(dependency.size);
+            }
+            writer.Write(static_cast<uint32_t>(entry.hash.size()));
+            for(auto word : entry.hash)
+                writer.Write(word);
+            writer.Write(entry.error);
+            writer.Write(entry.preset.data(), entry.preset.size());
+        }
+    }
+    for(auto word : ShaderCache::CalculateHash(writer.Data().data(), writer.Data().size()))
+        writer.Write(word);
+
+    auto tempPath = path;
+    tempPath += ".tmp";
+    {
+        std::ofstream outfile(tempPath, std::ios::binary | std::ios::trunc);
+        outfile.write(reinterpret_cast<const char*>(writer.Data().data()), writer.Data().size());
+        if(!outfile.good())
+            return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    return !ec;
+}
+
+bool LibraryIndex::Unchanged(LibraryEntry& entry)
+{
+    auto touched = false;
+    for(const auto& dependency : entry.dependencies)
+    {
+        uint64_t size;
+        touched |= ModifiedTime(dependency.path, size) != dependency.mtime || size != dependency.size;
+    }
+    if(!touched)
+        return true;
+    if(Hash(entry.dependencies) != entry.hash)
+        return false;
+
+    for(auto& dependency : entry.dependencies)
+        dependency.mtime = ModifiedTime(dependency.path, dependency.size);
+    return true;
+}
+
+bool LibraryIndex::Current(const std::filesystem::path& path)
+{
+    std::unique_lock lock(m_mutex);
+    auto             entry = m_entries.find(path.lexically_normal());
+    return entry != m_entries.end() && Unchanged(entry->second);
+}
+
+std::unique_ptr<PresetDef> LibraryIndex::Compile(LibraryEntry& entry, std::ostream& log, bool& warn, const ShaderCache& cache)
+{
+    entry.dependencies = Dependencies(entry.path);
+    entry.hash         = Hash(entry.dependencies);
+    entry.error.clear();
+    entry.preset.clear();
+
+    std::unique_ptr<PresetDef> presetDef(ShaderGC::CompilePreset(entry.path, log, warn, cache));
+    if(!presetDef)
+        throw std::runtime_error("Internal error");
+    presetDef->MakeDynamic();
+    presetDef->Name = PresetName(entry.path, entry.root);
+    entry.preset    = Serialize(*presetDef);
+    return presetDef;
+}
+
+PresetDef* LibraryIndex::Import(const std::filesystem::path& path, std::ostream& log, bool& warn, const ShaderCache& cache)
+{
+    LibraryEntry entry;
+    entry.path = path.lexically_normal();
+    {
+        // importing a file of a bulk import again keeps it there
+        std::unique_lock lock(m_mutex);
+        auto             existing = m_entries.find(entry.path);
+        if(existing != m_entries.end())
+            entry.root = existing->second.root;
+    }
+
+    std::unique_ptr<PresetDef> presetDef;
+    try
+    {
+        presetDef = Compile(entry, log, warn, cache);
+    }
+    catch(...)
+    {
+        Remove(entry.path);
+        throw;
+    }
+
+    std::unique_lock lock(m_mutex);
+    m_entries[entry.path] = std::move(entry);
+    return presetDef.release();
+}
+
+LibraryImport LibraryIndex::ImportDirectory(const std::filesystem::path& root, unsigned jobs, const ShaderCache& cache, const std::function<void(size_t, size_t)>& progress)
+{
+    LibraryImport result;
+    const auto    normalRoot = root.lexically_normal();
+
+    std::vector<std::filesystem::path> inputs;
+    std::error_code                    ec;
+    for(std::filesystem::recursive_directory_iterator p(normalRoot, std::filesystem::directory_options::skip_permission_denied, ec), end; !ec && p != end; p.increment(ec))
+    {
+        if(p->path().extension() == ".slangp" && p->is_regular_file(ec))
+            inputs.push_back(p->path().lexically_normal());
+    }
+    std::sort(inputs.begin(), inputs.end());
+    result.scanned = inputs.size();
+
+    // unchanged files are settled here, only the rest goes to the workers
+    std::vector<LibraryEntry> compiles;
+    {
+        std::unique_lock lock(m_mutex);
+        for(const auto& input : inputs)
+        {
+            auto existing = m_entries.find(input);
+            if(existing != m_entries.end() && existing->second.root == normalRoot && Unchanged(existing->second))
+            {
+                result.unchanged++;
+                continue;
+            }
+            LibraryEntry entry;
+            entry.path = input;
+            entry.root = normalRoot;
+            compiles.push_back(std::move(entry));
+        }
+
+        for(auto entry = m_entries.begin(); entry != m_entries.end();)
+        {
+            if(entry->second.root == normalRoot && !std::binary_search(inputs.begin(), inputs.end(), entry->first))
+            {
+                entry = m_entries.erase(entry);
+                result.removed++;
+            }
+            else
+                entry++;
+        }
+    }
+
+    std::atomic<size_t> next {0};
+    size_t              done = 0;
+    std::mutex          progressMutex;
+    auto                worker = [&]() {
+        for(auto i = next++; i < compiles.size(); i = next++)
+        {
+            auto& entry = compiles[i];
+            try
+            {
+                std::ostringstream log;
+                bool               warn = false;
+                Compile(entry, log, warn, cache);
+            }
+            catch(std::exception& e)
+            {
+                entry.error = e.what();
+            }
+            catch(...)
+            {
+                entry.error = "Internal error";
+            }
+
+            std::unique_lock lock(progressMutex);
+            done++;
+            if(progress)
+                progress(done, compiles.size());
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for(unsigned j = 1; j < std::min<size_t>(jobs, compiles.size()); j++)
+        workers.emplace_back(worker);
+    worker();
+    for(auto& w : workers)
+        w.join();
+
+    std::unique_lock lock(m_mutex);
+    for(auto& entry : compiles)
+    {
+        if(entry.error.empty())
+        {
+            result.compiled++;
+            result.changed.push_back(entry.path);
+        }
+        else
+        {
+            result.failed++;
+            result.errors.push_back(entry.path);
+        }
+        m_entries[entry.path] = std::move(entry);
+    }
+    return result;
+}
+
+PresetDef* LibraryIndex::Preset(const std::filesystem::path& path) const
+{
+    std::unique_lock lock(m_mutex);
+    auto             entry = m_entries.find(path.lexically_normal());
+    if(entry == m_entries.end() || !entry->second.error.empty() || entry->second.preset.empty())
+        return nullptr;
+    return Deserialize(entry->second.preset.data(), entry->second.preset.size());
+}
+
+std::string LibraryIndex::Error(const std::filesystem::path& path) const
+{
+    std::unique_lock lock(m_mutex);
+    auto             entry = m_entries.find(path.lexically_normal());
+    return entry != m_entries.end() ? entry->second.error : std::string();
+}
+
+std::vector<std::filesystem::path> LibraryIndex::Paths() const
+{
+    std::unique_lock                   lock(m_mutex);
+    std::vector<std::filesystem::path> paths;
+    for(const auto& entry : m_entries)
+        paths.push_back(entry.first);
+    return paths;
+}
+
+void LibraryIndex::Remove(const std::filesystem::path& path)
+{
+    std::unique_lock lock(m_mutex);
+    m_entries.erase(path.lexically_normal());
+}
+
+size_t LibraryIndex::Size() const
+{
+    std::unique_lock lock(m_mutex);
+    return m_entries.size();
+}
@@ -0,0 +1,114 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include "PresetDef.h"
+#include "ShaderCache.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// a file read while compiling a preset, with its state when it was read
+struct LibraryDependency
+{
+    std::filesystem::path path;
+    int64_t               mtime {0}; // 0 if the file was missing
+    uint64_t              size {0};
+};
+
+// one imported preset file
+struct LibraryEntry
+{
+    std::filesystem::path          path;
+    std::filesystem::path          root; // folder of a bulk import, empty for files imported one by one
+    std::vector<LibraryDependency> dependencies; // the file itself first, then referenced presets, shaders with their includes and textures
+    std::vector<uint32_t>          hash; // of the contents of all dependencies
+    std::string                    error; // why it did not compile, there is no preset then
+    std::vector<uint8_t>           preset; // serialized PresetDef
+};
+
+// outcome of a bulk import
+struct LibraryImport
+{
+    size_t                             scanned {0};
+    size_t                             unchanged {0};
+    size_t                             compiled {0};
+    size_t                             failed {0};
+    size_t                             removed {0};
+    std::vector<std::filesystem::path> changed; // compiled without error, to be reloaded
+    std::vector<std::filesystem::path> errors; // failed to compile, see Error
+};
+
+// compiled presets of everything the user imported, kept on disk so they load without compiling; an entry is
+// current while none of its dependencies changed, checking mtime and size first and the content hash only when
+// those differ, so touched but identical files are not recompiled; thread-safe, a bulk import does not hold the
+// lock while compiling
+class LibraryIndex
+{
+public:
+    static constexpr uint32_t Magic   = 0x494C4753; // "SGLI"
+    static constexpr uint32_t Version = 2;
+
+    // false if there is no index or it is not a valid one, including one damaged anywhere, the index is empty then
+    bool Load(const std::filesystem::path& path);
+
+    // written next to path first, so an interrupted save keeps the previous index
+    bool Save(const std::filesystem::path& path) const;
+
+    // imported and none of its files changed since
+    bool Current(const std::filesystem::path& path);
+
+    // compiles one file and stores it; throws like ShaderGC::CompilePreset and a file which no longer compiles
+    // leaves the index then, the returned preset is dynamic and owned by the caller
+    PresetDef* Import(const std::filesystem::path& path, std::ostream& log, bool& warn, const ShaderCache& cache);
+
+    // compiles new and changed .slangp files under root on up to jobs threads, a file failing to compile is recorded
+    // with its error and does not stop the others; entries of earlier imports of root whose file is gone are removed;
+    // progress is called with files done out of files to compile, one call at a time from the worker threads
+    LibraryImport ImportDirectory(const std::filesystem::path&               root,
+                                  unsigned                                   jobs,
+                                  const ShaderCache&                         cache,
+                                  const std::function<void(size_t, size_t)>& progress = {});
+
+    // preset of an entry which compiled, nullptr otherwise; dynamic and owned by the caller
+    PresetDef* Preset(const std::filesystem::path& path) const;
+
+    std::string Error(const std::filesystem::path& path) const;
+
+    std::vector<std::filesystem::path> Paths() const;
+
+    void Remove(const std::filesystem::path& path);
+
+    size_t Size() const;
+
+    // files compiling path reads, stat'ed; never throws, what cannot be parsed is left out
+    static std::vector<LibraryDependency> Dependencies(const std::filesystem::path& path);
+    static std::vector<uint32_t>          Hash(const std::vector<LibraryDependency>& dependencies);
+
+    static std::vector<uint8_t> Serialize(const PresetDef& presetDef);
+
+    // nullptr if malformed
+    static PresetDef* Deserialize(const uint8_t* data, size_t length);
+
+private:
+    // refreshes mtime and size of dependencies whose contents did not change, expects the lock held
+    static bool Unchanged(LibraryEntry& entry);
+
+    // fills in dependencies and hash of an entry with path and root set before compiling it, so they are there
+    // for an entry recording the error when it throws
+    static std::unique_ptr<PresetDef> Compile(LibraryEntry& entry, std::ostream& log, bool& warn, const ShaderCache& cache);
+
+    mutable std::mutex                            m_mutex;
+    std::map<std::filesystem::path, LibraryEntry> m_entries;
+};
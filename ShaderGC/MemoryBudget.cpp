@@ -0,0 +1,277 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "MemoryBudget.h"
+#include "PassChain.h"
+
+#include <algorithm>
+#include <cstring>
+
+// cheapest degradation first, history goes before passes drop to a quarter of their size
+static const MemoryPlan sLevels[] = {{0, 1.0f, true}, {1, 0.75f, true}, {2, 0.5f, true}, {3, 0.5f, false}, {4, 0.25f, false}};
+
+static const char* sKindNames[] = {"original", "history", "pass_output", "pass_feedback", "texture", "buffer", "shader"};
+
+// input textures are BGRA8 captures and preset images are loaded as RGBA8
+static const int sInputBytes   = 4;
+static const int sTextureBytes = 4;
+
+void MemoryFootprint::Add(MemoryKind kind, int pass, uint64_t bytes)
+{
+    kinds[static_cast<int>(kind)] += bytes;
+    if(pass >= 0)
+    {
+        if(passes.size() <= static_cast<size_t>(pass))
+            passes.resize(pass + 1);
+        passes[pass] += bytes;
+    }
+}
+
+uint64_t MemoryFootprint::Total() const
+{
+    uint64_t total = 0;
+    for(auto bytes : kinds)
+        total += bytes;
+    return total;
+}
+
+MemoryLedger::Allocation::Allocation(Allocation&& other) noexcept : m_ledger {other.m_ledger}, m_id {other.m_id}
+{
+    other.m_ledger = nullptr;
+    other.m_id     = 0;
+}
+
+MemoryLedger::Allocation& MemoryLedger::Allocation::operator=(Allocation&& other) noexcept
+{
+    if(this != &other)
+    {
+        Release();
+        m_ledger       = other.m_ledger;
+        m_id           = other.m_id;
+        other.m_ledger = nullptr;
+        other.m_id     = 0;
+    }
+    return *this;
+}
+
+MemoryLedger::Allocation::~Allocation()
+{
+    Release();
+}
+
+void MemoryLedger::Allocation::Adopt()
+{
+    if(m_ledger)
+        m_ledger->Adopt(m_id);
+}
+
+void MemoryLedger::Allocation::Release()
+{
+    if(m_ledger)
+        m_ledger->Release(m_id);
+    m_ledger = nullptr;
+    m_id     = 0;
+}
+
+MemoryLedger::Allocation MemoryLedger::Allocate(MemoryKind kind, int pass, uint64_t bytes)
+{
+    std::unique_lock lock(m_mutex);
+    const auto       id = m_nextId++;
+    m_entries.emplace(id, Entry {kind, pass, bytes, m_preset});
+    m_live += bytes;
+    m_peak = std::max(m_peak, m_live);
+    return Allocation(this, id);
+}
+
+void MemoryLedger::Release(uint64_t id)
+{
+    std::unique_lock lock(m_mutex);
+    auto             entry = m_entries.find(id);
+    if(entry != m_entries.end())
+    {
+        m_live -= entry->second.bytes;
+        m_entries.erase(entry);
+    }
+}
+
+void MemoryLedger::Adopt(uint64_t id)
+{
+    std::unique_lock lock(m_mutex);
+    auto             entry = m_entries.find(id);
+    if(entry != m_entries.end())
+        entry->second.preset = m_preset;
+}
+
+void MemoryLedger::SetPreset(const std::string& preset)
+{
+    std::unique_lock lock(m_mutex);
+    m_preset = preset;
+}
+
+uint64_t MemoryLedger::Live() const
+{
+    std::unique_lock lock(m_mutex);
+    return m_live;
+}
+
+uint64_t MemoryLedger::Peak() const
+{
+    std::unique_lock lock(m_mutex);
+    return m_peak;
+}
+
+void MemoryLedger::ResetPeak()
+{
+    std::unique_lock lock(m_mutex);
+    m_peak = m_live;
+}
+
+MemoryFootprint MemoryLedger::Footprint(const std::string& preset) const
+{
+    std::unique_lock lock(m_mutex);
+    MemoryFootprint  footprint;
+    for(const auto& entry : m_entries)
+    {
+        if(preset.empty() || entry.second.preset == preset)
+            footprint.Add(entry.second.kind, entry.second.pass, entry.second.bytes);
+    }
+    return footprint;
+}
+
+uint64_t MemoryLedger::Budget() const
+{
+    std::unique_lock lock(m_mutex);
+    return m_budget;
+}
+
+void MemoryLedger::SetBudget(uint64_t bytes)
+{
+    std::unique_lock lock(m_mutex);
+    m_budget = bytes;
+}
+
+const char* MemoryLedger::KindName(MemoryKind kind)
+{
+    return sKindNames[static_cast<int>(kind)];
+}
+
+int MemoryBudget::FormatBytes(const std::string& format)
+{
+    // sum of channel bits up to the type suffix, A2B10G10R10 included
+    int bits = 0, channel = 0;
+    for(auto c : format)
+    {
+        if(c == '_')
+            break;
+        if(c >= '0' && c <= '9')
+        {
+            channel = channel * 10 + (c - '0');
+        }
+        else
+        {
+            bits += channel;
+            channel = 0;
+        }
+    }
+    bits += channel;
+    return bits ? std::max(bits / 8, 1) : 4;
+}
+
+bool MemoryBudget::ImageSize(const uint8_t* data, size_t length, int& width, int& height)
+{
+    // signature followed by the IHDR chunk, big endian
+    static const uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    if(!data || length < 24 || memcmp(data, signature, sizeof(signature)) != 0 || memcmp(data + 12, "IHDR", 4) != 0)
+        return false;
+
+    auto read = [&](size_t offset) {
+        return static_cast<int>((uint32_t)data[offset] << 24 | (uint32_t)data[offset + 1] << 16 | (uint32_t)data[offset + 2] << 8 | data[offset + 3]);
+    };
+    width  = read(16);
+    height = read(20);
+    return width > 0 && height > 0;
+}
+
+MemoryFootprint MemoryBudget::Predict(const PresetDef& presetDef, int originalWidth, int originalHeight, int viewportWidth, int viewportHeight, float passScale, bool history)
+{
+    MemoryFootprint footprint;
+    if(presetDef.ShaderDefs.empty())
+        return footprint;
+
+    PassChain chain(presetDef);
+    chain.Resize(originalWidth, originalHeight, viewportWidth, viewportHeight, passScale);
+
+    const auto& nodes      = chain.Graph().Nodes();
+    const auto& passes     = chain.Passes();
+    const auto  inputBytes = static_cast<uint64_t>(originalWidth) * originalHeight * sInputBytes;
+
+    // ring of inputs, the preprocessed one is its first slot
+    int historyDepth = 0;
+    for(const auto& node : nodes)
+    {
+        if(node.live)
+            historyDepth = std::max(historyDepth, node.history);
+    }
+    footprint.Add(MemoryKind::Original, -1, inputBytes);
+    if(history)
+        footprint.Add(MemoryKind::History, -1, inputBytes * historyDepth);
+
+    for(size_t p = 0; p < passes.size(); p++)
+    {
+        const auto& pass = passes[p];
+        const auto  last = p == passes.size() - 1;
+        if(!nodes[p].live)
+            continue;
+
+        // last pass renders to the swap chain unless it is fed back, then it renders offscreen in the display format
+        const auto pixels = static_cast<uint64_t>(pass.width) * pass.height;
+        const auto bytes  = pixels * (last ? sInputBytes : FormatBytes(pass.format));
+        if(nodes[p].fedBack)
+            footprint.Add(MemoryKind::PassFeedback, static_cast<int>(p), bytes * 2);
+        else if(!last)
+            footprint.Add(MemoryKind::PassOutput, static_cast<int>(p), bytes);
+
+        footprint.Add(MemoryKind::Buffer, static_cast<int>(p), pass.ubo.size() + pass.push.size());
+        footprint.Add(MemoryKind::Shader, static_cast<int>(p), pass.shaderDef->VertexLength + pass.shaderDef->FragmentLength);
+    }
+
+    // only images sampled by a live pass are decoded
+    for(const auto& textureDef : presetDef.TextureDefs)
+    {
+        auto name = textureDef.PresetParams.find("name");
+        int  width, height;
+        if(name != textureDef.PresetParams.end() && chain.Graph().Samples(name->second) && ImageSize(textureDef.Data, textureDef.DataLength, width, height))
+            footprint.Add(MemoryKind::Texture, -1, static_cast<uint64_t>(width) * height * sTextureBytes);
+    }
+    return footprint;
+}
+
+int MemoryBudget::Levels()
+{
+    return static_cast<int>(std::size(sLevels));
+}
+
+MemoryPlan MemoryBudget::Level(int level)
+{
+    return sLevels[std::clamp(level, 0, Levels() - 1)];
+}
+
+MemoryPlan MemoryBudget::Plan(const PresetDef& presetDef, int originalWidth, int originalHeight, int viewportWidth, int viewportHeight, float passScale, uint64_t budget)
+{
+    MemoryPlan plan;
+    for(const auto& level : sLevels)
+    {
+        plan           = level;
+        plan.footprint = Predict(presetDef, originalWidth, originalHeight, viewportWidth, viewportHeight, passScale * level.passScale, level.history);
+        plan.fits      = !budget || plan.footprint.Total() <= budget;
+        if(plan.fits)
+            break;
+    }
+    return plan;
+}
@@ -0,0 +1,148 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include "PresetDef.h"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class MemoryKind
+{
+    Original, // preprocessed input
+    History, // earlier inputs kept for OriginalHistory
+    PassOutput,
+    PassFeedback, // both targets of a pass whose previous output is sampled
+    Texture, // preset images
+    Buffer, // param buffers
+    Shader, // compiled shaders, approximated by bytecode size
+    Count
+};
+
+// bytes of a preset by kind and by pass
+struct MemoryFootprint
+{
+    uint64_t              kinds[static_cast<int>(MemoryKind::Count)] {};
+    std::vector<uint64_t> passes {};
+
+    void Add(MemoryKind kind, int pass, uint64_t bytes);
+
+    uint64_t Kind(MemoryKind kind) const
+    {
+        return kinds[static_cast<int>(kind)];
+    }
+
+    uint64_t Total() const;
+};
+
+// degradation which brings a preset within budget, levels go from none to dropping history and quarter-size passes
+struct MemoryPlan
+{
+    int             level {0};
+    float           passScale {1.0f}; // multiplies viewport-scaled intermediate pass sizes
+    bool            history {true}; // OriginalHistory textures are created, otherwise they read the current input
+    bool            fits {true}; // false if even the last level is over budget
+    MemoryFootprint footprint {};
+};
+
+// live device memory attributed to the preset which allocated it; thread-safe, so totals can be read from the UI
+// while the render thread allocates
+class MemoryLedger
+{
+public:
+    // releases its bytes when destroyed
+    class Allocation
+    {
+    public:
+        Allocation() = default;
+        Allocation(Allocation&& other) noexcept;
+        Allocation& operator=(Allocation&& other) noexcept;
+        Allocation(const Allocation&) = delete;
+        Allocation& operator=(const Allocation&) = delete;
+        ~Allocation();
+
+        // attributes the bytes to the current preset, for objects a new preset shares with the previous one
+        void Adopt();
+        void Release();
+
+    private:
+        friend class MemoryLedger;
+        Allocation(MemoryLedger* ledger, uint64_t id) : m_ledger {ledger}, m_id {id} { }
+
+        MemoryLedger* m_ledger {nullptr};
+        uint64_t      m_id {0};
+    };
+
+    // pass is -1 for what all passes share
+    Allocation Allocate(MemoryKind kind, int pass, uint64_t bytes);
+
+    // preset later allocations are attributed to
+    void SetPreset(const std::string& preset);
+
+    uint64_t Live() const;
+    uint64_t Peak() const;
+    void     ResetPeak();
+
+    // live bytes of one preset, or of all if empty
+    MemoryFootprint Footprint(const std::string& preset = {}) const;
+
+    // 0 when unlimited
+    uint64_t Budget() const;
+    void     SetBudget(uint64_t bytes);
+
+    static const char* KindName(MemoryKind kind);
+
+private:
+    struct Entry
+    {
+        MemoryKind  kind;
+        int         pass;
+        uint64_t    bytes;
+        std::string preset;
+    };
+
+    void Release(uint64_t id);
+    void Adopt(uint64_t id);
+
+    mutable std::mutex                  m_mutex;
+    std::unordered_map<uint64_t, Entry> m_entries;
+    std::string                         m_preset;
+    uint64_t                            m_nextId {1};
+    uint64_t                            m_live {0};
+    uint64_t                            m_peak {0};
+    uint64_t                            m_budget {0};
+};
+
+// footprint of a preset worked out from its definition alone, before anything is loaded or compiled
+class MemoryBudget
+{
+public:
+    // the same textures ShaderGlass creates for the preset at given input and viewport size, passScale as in QualityLevel
+    static MemoryFootprint Predict(const PresetDef& presetDef,
+                                   int              originalWidth,
+                                   int              originalHeight,
+                                   int              viewportWidth,
+                                   int              viewportHeight,
+                                   float            passScale = 1.0f,
+                                   bool             history   = true);
+
+    // first level which fits in budget bytes, budget 0 always fits at level 0
+    static MemoryPlan Plan(const PresetDef& presetDef, int originalWidth, int originalHeight, int viewportWidth, int viewportHeight, float passScale, uint64_t budget);
+
+    static int        Levels();
+    static MemoryPlan Level(int level);
+
+    // bytes per pixel of a slang format name like R16G16B16A16_SFLOAT
+    static int FormatBytes(const std::string& format);
+
+    // size of a PNG image from its header, false for anything else
+    static bool ImageSize(const uint8_t* data, size_t length, int& width, int& height);
+};
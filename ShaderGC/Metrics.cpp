@@ -0,0 +1,179 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "Metrics.h"
+
+#include <bit>
+#include <chrono>
+#include <cmath>
+
+static void WriteName(std::ostream& out, const std::string& name)
+{
+    out << '"';
+    for(auto c : name)
+    {
+        if(c == '"' || c == '\\')
+            out << '\\';
+        out << c;
+    }
+    out << '"';
+}
+
+uint64_t HistogramSnapshot::Percentile(double quantile) const
+{
+    if(count == 0)
+        return 0;
+
+    auto rank = static_cast<uint64_t>(std::ceil(quantile * count));
+    if(rank < 1)
+        rank = 1;
+
+    uint64_t seen = 0;
+    for(int i = 0; i < static_cast<int>(buckets.size()); i++)
+    {
+        seen += buckets[i];
+        if(seen >= rank)
+        {
+            // middle of the bucket halves the error, but no more than was ever recorded
+            auto low  = MetricHistogram::BucketLow(i);
+            auto high = MetricHistogram::BucketHigh(i);
+            auto mid  = low + (high - low) / 2;
+            return mid < max ? mid : max;
+        }
+    }
+    return max;
+}
+
+int MetricHistogram::BucketIndex(uint64_t value)
+{
+    if(value > MaxValue)
+        value = MaxValue;
+    if(value < SubBuckets)
+        return static_cast<int>(value);
+
+    // top SubBits + 1 bits of the value, the leading one selects the power of two
+    auto shift = static_cast<int>(std::bit_width(value)) - 1 - SubBits;
+    return shift * SubBuckets + static_cast<int>(value >> shift);
+}
+
+uint64_t MetricHistogram::BucketLow(int index)
+{
+    if(index < 2 * SubBuckets)
+        return index;
+
+    auto shift = index / SubBuckets - 1;
+    return static_cast<uint64_t>(index % SubBuckets + SubBuckets) << shift;
+}
+
+uint64_t MetricHistogram::BucketHigh(int index)
+{
+    if(index < 2 * SubBuckets)
+        return index;
+
+    auto shift = index / SubBuckets - 1;
+    return BucketLow(index) + (1ull << shift) - 1;
+}
+
+void MetricHistogram::Record(uint64_t value)
+{
+    if(value > MaxValue)
+        value = MaxValue;
+
+    m_buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+
+    auto max = m_max.load(std::memory_order_relaxed);
+    while(value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+    { }
+}
+
+HistogramSnapshot MetricHistogram::Snapshot() const
+{
+    // values recorded while copying may be in the buckets but not the sum or the other way round,
+    // count comes from the buckets so percentiles are consistent
+    HistogramSnapshot snapshot;
+    snapshot.buckets.resize(Buckets);
+    for(int i = 0; i < Buckets; i++)
+    {
+        snapshot.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+        snapshot.count += snapshot.buckets[i];
+    }
+    snapshot.sum = m_sum.load(std::memory_order_relaxed);
+    snapshot.max = m_max.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+void MetricsSnapshot::WriteJson(std::ostream& out) const
+{
+    out << "{\n  \"uptime_us\": " << uptime << ",\n  \"counters\": {";
+    for(size_t i = 0; i < counters.size(); i++)
+    {
+        out << (i ? ",\n    " : "\n    ");
+        WriteName(out, counters[i].first);
+        out << ": " << counters[i].second;
+    }
+    out << "\n  },\n  \"gauges\": {";
+    for(size_t i = 0; i < gauges.size(); i++)
+    {
+        out << (i ? ",\n    " : "\n    ");
+        WriteName(out, gauges[i].first);
+        out << ": " << gauges[i].second;
+    }
+    out << "\n  },\n  \"histograms\": {";
+    for(size_t i = 0; i < histograms.size(); i++)
+    {
+        const auto& h = histograms[i].second;
+        out << (i ? ",\n    " : "\n    ");
+        WriteName(out, histograms[i].first);
+        out << ": {\"count\": " << h.count << ", \"mean\": " << static_cast<uint64_t>(std::llround(h.Mean())) << ", \"p50\": " << h.Percentile(0.5)
+            << ", \"p90\": " << h.Percentile(0.9) << ", \"p99\": " << h.Percentile(0.99) << ", \"p999\": " << h.Percentile(0.999) << ", \"max\": " << h.max << "}";
+    }
+    out << "\n  }\n}\n";
+}
+
+MetricsRegistry::MetricsRegistry() : m_mutex {}, m_counters {}, m_gauges {}, m_histograms {}, m_start {Now()} { }
+
+MetricCounter& MetricsRegistry::Counter(const std::string& name)
+{
+    std::lock_guard lock(m_mutex);
+    return m_counters.try_emplace(name).first->second;
+}
+
+MetricGauge& MetricsRegistry::Gauge(const std::string& name)
+{
+    std::lock_guard lock(m_mutex);
+    return m_gauges.try_emplace(name).first->second;
+}
+
+MetricHistogram& MetricsRegistry::Histogram(const std::string& name)
+{
+    std::lock_guard lock(m_mutex);
+    return m_histograms.try_emplace(name).first->second;
+}
+
+MetricsSnapshot MetricsRegistry::Snapshot() const
+{
+    MetricsSnapshot snapshot;
+    snapshot.uptime = Now() - m_start;
+
+    // only keeps names from being added meanwhile, recording goes on
+    std::lock_guard lock(m_mutex);
+    for(const auto& c : m_counters)
+        snapshot.counters.emplace_back(c.first, c.second.Value());
+    for(const auto& g : m_gauges)
+        snapshot.gauges.emplace_back(g.first, g.second.Value());
+    for(const auto& h : m_histograms)
+        snapshot.histograms.emplace_back(h.first, h.second.Snapshot());
+    return snapshot;
+}
+
+uint64_t MetricsRegistry::Now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
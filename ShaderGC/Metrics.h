@@ -0,0 +1,150 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// number of events so far
+class MetricCounter
+{
+public:
+    void Add(uint64_t count = 1)
+    {
+        m_value.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    uint64_t Value() const
+    {
+        return m_value.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> m_value {0};
+};
+
+// current level of something which goes up and down
+class MetricGauge
+{
+public:
+    void Set(int64_t value)
+    {
+        m_value.store(value, std::memory_order_relaxed);
+    }
+
+    void Add(int64_t delta)
+    {
+        m_value.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    int64_t Value() const
+    {
+        return m_value.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<int64_t> m_value {0};
+};
+
+struct HistogramSnapshot
+{
+    uint64_t              count {0};
+    uint64_t              sum {0};
+    uint64_t              max {0};
+    std::vector<uint64_t> buckets;
+
+    double Mean() const
+    {
+        return count ? static_cast<double>(sum) / count : 0.0;
+    }
+
+    // value at given quantile (0..1), within half a bucket of the recorded one
+    uint64_t Percentile(double quantile) const;
+};
+
+// distribution of values (microseconds by convention) in log-linear buckets like HdrHistogram: values below
+// SubBuckets are exact, each power of two above is split into SubBuckets so buckets are at most 1/SubBuckets wide
+class MetricHistogram
+{
+public:
+    static constexpr int      SubBits    = 5;
+    static constexpr int      SubBuckets = 1 << SubBits;
+    static constexpr int      MaxBits    = 40;
+    static constexpr int      Buckets    = (MaxBits - SubBits + 1) * SubBuckets;
+    static constexpr uint64_t MaxValue   = (1ull << MaxBits) - 1;
+
+    // larger values are counted as MaxValue
+    void Record(uint64_t value);
+
+    HistogramSnapshot Snapshot() const;
+
+    static int      BucketIndex(uint64_t value);
+    static uint64_t BucketLow(int index);
+    static uint64_t BucketHigh(int index);
+
+private:
+    std::atomic<uint64_t> m_buckets[Buckets] {};
+    std::atomic<uint64_t> m_sum {0};
+    std::atomic<uint64_t> m_max {0};
+};
+
+struct MetricsSnapshot
+{
+    uint64_t                                               uptime {0};
+    std::vector<std::pair<std::string, uint64_t>>          counters;
+    std::vector<std::pair<std::string, int64_t>>           gauges;
+    std::vector<std::pair<std::string, HistogramSnapshot>> histograms;
+
+    // counters and gauges as they are, histograms as count, mean, p50/p90/p99/p99.9 and max
+    void WriteJson(std::ostream& out) const;
+};
+
+// named metrics recorded without locks from any thread; only registering a new name locks, so look them up
+// once and keep the reference, which stays valid for the lifetime of the registry
+class MetricsRegistry
+{
+public:
+    MetricsRegistry();
+
+    // the same name always gives the same metric
+    MetricCounter&   Counter(const std::string& name);
+    MetricGauge&     Gauge(const std::string& name);
+    MetricHistogram& Histogram(const std::string& name);
+
+    MetricsSnapshot Snapshot() const;
+
+    // steady clock in microseconds
+    static uint64_t Now();
+
+    // records microseconds spent in its scope
+    class Timer
+    {
+    public:
+        explicit Timer(MetricHistogram& histogram) : m_histogram {histogram}, m_start {Now()} { }
+        ~Timer()
+        {
+            m_histogram.Record(Now() - m_start);
+        }
+
+    private:
+        MetricHistogram& m_histogram;
+        uint64_t         m_start;
+    };
+
+private:
+    mutable std::mutex                     m_mutex;
+    std::map<std::string, MetricCounter>   m_counters;
+    std::map<std::string, MetricGauge>     m_gauges;
+    std::map<std::string, MetricHistogram> m_histograms;
+    uint64_t                               m_start;
+};
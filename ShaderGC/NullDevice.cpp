@@ -0,0 +1,59 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "NullDevice.h"
+
+static const char* sCallNames[] = {
+    "Map", "Unmap", "SetViewport", "SetRenderTarget", "SetInputAssembler", "SetShader", "SetShaderResource", "SetSampler", "SetConstantBuffer", "Draw"};
+
+static_assert(sizeof(sCallNames) / sizeof(sCallNames[0]) == static_cast<size_t>(NullCall::Count));
+
+int NullDevice::CreateBuffer(size_t size)
+{
+    m_buffers.emplace_back(size);
+    return static_cast<int>(m_buffers.size()) - 1;
+}
+
+int NullDevice::CreateTexture()
+{
+    return m_textures++;
+}
+
+void* NullDevice::Map(int buffer)
+{
+    Call(NullCall::Map);
+    auto& data = m_buffers[buffer];
+    m_mappedBytes += data.size();
+    return data.data();
+}
+
+void NullDevice::Unmap(int)
+{
+    Call(NullCall::Unmap);
+}
+
+uint64_t NullDevice::TotalCalls() const
+{
+    uint64_t total = 0;
+    for(auto calls : m_calls)
+        total += calls;
+    return total;
+}
+
+void NullDevice::ResetCounts()
+{
+    for(auto& calls : m_calls)
+        calls = 0;
+    m_mappedBytes = 0;
+}
+
+const char* NullDevice::CallName(NullCall call)
+{
+    return sCallNames[static_cast<int>(call)];
+}
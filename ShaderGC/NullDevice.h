@@ -0,0 +1,67 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include <cstdint>
+
+// device context calls ShaderPass makes to render a pass
+enum class NullCall
+{
+    Map,
+    Unmap,
+    SetViewport,
+    SetRenderTarget,
+    SetInputAssembler,
+    SetShader,
+    SetShaderResource,
+    SetSampler,
+    SetConstantBuffer,
+    Draw,
+    Count
+};
+
+// graphics device which only counts calls, so the CPU side of rendering can be measured without a GPU;
+// resources are plain handles and mapped buffers are scratch memory
+class NullDevice
+{
+public:
+    int CreateBuffer(size_t size);
+    int CreateTexture();
+
+    // scratch memory of the buffer, contents are kept between maps
+    void* Map(int buffer);
+    void  Unmap(int buffer);
+
+    void Call(NullCall call, int count = 1)
+    {
+        m_calls[static_cast<int>(call)] += count;
+    }
+
+    uint64_t Calls(NullCall call) const
+    {
+        return m_calls[static_cast<int>(call)];
+    }
+
+    uint64_t TotalCalls() const;
+
+    // sizes of buffers mapped, ShaderPass fills them whole
+    uint64_t MappedBytes() const
+    {
+        return m_mappedBytes;
+    }
+
+    void ResetCounts();
+
+    static const char* CallName(NullCall call);
+
+private:
+    std::vector<std::vector<uint8_t>> m_buffers;
+    int                               m_textures {0};
+    uint64_t                          m_calls[static_cast<int>(NullCall::Count)] {};
+    uint64_t                          m_mappedBytes {0};
+};
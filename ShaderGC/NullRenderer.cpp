@@ -0,0 +1,238 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "NullRenderer.h"
+#include "Tracer.h"
+
+NullRenderer::NullRenderer(const PresetDef& presetDef) :
+    m_device {}, m_shaderDefs {presetDef.ShaderDefs}, m_passGraph {}, m_passes {}, m_passResources {}, m_history {}, m_historyViews {}, m_historyRing {},
+    m_frameCount {0}, m_originalWidth {0}, m_originalHeight {0}, m_viewportWidth {0}, m_viewportHeight {0}
+{
+    std::vector<const ShaderDef*> shaderDefs;
+    for(const auto& shaderDef : m_shaderDefs)
+        shaderDefs.push_back(&shaderDef);
+    m_passGraph = PassGraph(shaderDefs);
+
+    for(const auto& textureDef : presetDef.TextureDefs)
+    {
+        auto name = textureDef.PresetParams.find("name");
+        if(name != textureDef.PresetParams.end())
+            m_passResources[name->second] = m_device.CreateTexture();
+    }
+
+    int historyDepth = 0;
+    for(size_t p = 0; p < m_shaderDefs.size(); p++)
+    {
+        auto& pass   = m_passes.emplace_back(m_device, m_shaderDefs[p]);
+        pass.options = PassChain::Options(m_shaderDefs[p]);
+        for(const auto& texture : m_shaderDefs[p].Samplers)
+            pass.frame.m_samplers.insert(std::make_pair(texture.binding, static_cast<int>(pass.frame.m_samplers.size())));
+        pass.frame.Initialize(m_shaderDefs[p], pass.options.frameCountMod);
+
+        // rounded up as constant buffers are
+        if(pass.params.BufferSize(UBO_BUFFER) > 0)
+            pass.ubo = m_device.CreateBuffer((pass.params.BufferSize(UBO_BUFFER) + 0xf) & ~0xf);
+        if(pass.params.BufferSize(PUSH_BUFFER) > 0)
+            pass.push = m_device.CreateBuffer((pass.params.BufferSize(PUSH_BUFFER) + 0xf) & ~0xf);
+
+        const auto& node = m_passGraph.Nodes()[p];
+        if(node.live)
+            historyDepth = std::max(historyDepth, node.history);
+    }
+
+    // outputs are bound by name as in ShaderGlass::Process, feedback entries are rebound when the targets swap
+    for(size_t p = 0; p < m_passes.size(); p++)
+    {
+        auto&       pass = m_passes[p];
+        const auto& node = m_passGraph.Nodes()[p];
+        if(!node.live)
+            continue;
+
+        const auto last = p == m_passes.size() - 1;
+        pass.output     = m_device.CreateTexture();
+        if(node.fedBack)
+        {
+            pass.feedback = m_device.CreateTexture();
+            if(!last)
+            {
+                pass.outputBindings.push_back(&m_passResources["PassOutput" + std::to_string(p)]);
+                if(!pass.options.alias.empty())
+                    pass.outputBindings.push_back(&m_passResources[pass.options.alias]);
+            }
+            pass.feedbackBindings.push_back(&m_passResources["PassFeedback" + std::to_string(p)]);
+            if(!pass.options.alias.empty())
+                pass.feedbackBindings.push_back(&m_passResources[pass.options.alias + "Feedback"]);
+        }
+        else if(!last)
+        {
+            m_passResources.insert(std::make_pair("PassOutput" + std::to_string(p), pass.output));
+            if(!pass.options.alias.empty())
+                m_passResources.insert(std::make_pair(pass.options.alias, pass.output));
+        }
+        if(!last)
+            m_passes[p + 1].source = pass.output;
+    }
+
+    m_historyRing.Resize(historyDepth);
+    for(int h = 0; h < m_historyRing.Size(); h++)
+        m_history.push_back(m_device.CreateTexture());
+    m_historyViews.resize(m_history.size());
+
+    for(const auto& o : presetDef.Overrides)
+        SetParam(o.name, o.value);
+}
+
+void NullRenderer::SetParam(const std::string& name, float value)
+{
+    for(auto& pass : m_passes)
+        pass.params.SetParam(name, &value);
+}
+
+void NullRenderer::Reset()
+{
+    m_frameCount = 0;
+}
+
+void NullRenderer::Resize(int originalWidth, int originalHeight, int viewportWidth, int viewportHeight)
+{
+    m_originalWidth  = originalWidth;
+    m_originalHeight = originalHeight;
+    m_viewportWidth  = viewportWidth;
+    m_viewportHeight = viewportHeight;
+
+    std::map<std::string, float4> textureSizes;
+    textureSizes.insert(std::make_pair("Original", float4 {(float)originalWidth, (float)originalHeight, 1.0f / originalWidth, 1.0f / originalHeight}));
+    textureSizes.insert(std::make_pair("FinalViewport", float4 {(float)viewportWidth, (float)viewportHeight, 1.0f / viewportWidth, 1.0f / viewportHeight}));
+
+    std::vector<std::array<unsigned, 4>> passSizes;
+    unsigned                             sourceWidth  = originalWidth;
+    unsigned                             sourceHeight = originalHeight;
+    for(size_t p = 0; p < m_passes.size(); p++)
+    {
+        const auto& pass = m_passes[p];
+        if(p == m_passes.size() - 1)
+        {
+            // last shader scales source to viewport
+            passSizes.push_back({sourceWidth, sourceHeight, (unsigned)viewportWidth, (unsigned)viewportHeight});
+            break;
+        }
+
+        float width, height;
+        PassChain::Size(pass.options, (float)sourceWidth, (float)sourceHeight, (float)viewportWidth, (float)viewportHeight, 1.0f, width, height);
+        const auto outputWidth  = static_cast<unsigned>(std::max(static_cast<int>(width), 1));
+        const auto outputHeight = static_cast<unsigned>(std::max(static_cast<int>(height), 1));
+        passSizes.push_back({sourceWidth, sourceHeight, outputWidth, outputHeight});
+        if(!pass.options.alias.empty())
+            textureSizes.insert(std::make_pair(pass.options.alias, float4 {(float)outputWidth, (float)outputHeight, 1.0f / outputWidth, 1.0f / outputHeight}));
+        sourceWidth  = outputWidth;
+        sourceHeight = outputHeight;
+    }
+
+    // once all textureSizes are determined
+    for(size_t p = 0; p < m_passes.size(); p++)
+    {
+        auto& pass = m_passes[p];
+        pass.frame.Resize(pass.params, passSizes[p][0], passSizes[p][1], passSizes[p][2], passSizes[p][3], textureSizes, passSizes);
+    }
+}
+
+void NullRenderer::Render(int originalWidth, int originalHeight, int viewportWidth, int viewportHeight)
+{
+    if(originalWidth != m_originalWidth || originalHeight != m_originalHeight || viewportWidth != m_viewportWidth || viewportHeight != m_viewportHeight)
+        Resize(originalWidth, originalHeight, viewportWidth, viewportHeight);
+
+    m_historyRing.Advance();
+    for(size_t h = 0; h < m_historyViews.size(); h++)
+        m_historyViews[h] = m_history[m_historyRing.Slot(static_cast<int>(h))];
+
+    // previous outputs become feedback
+    for(size_t p = 0; p < m_passes.size(); p++)
+    {
+        auto& pass = m_passes[p];
+        if(pass.feedback == -1)
+            continue;
+
+        std::swap(pass.output, pass.feedback);
+        for(auto binding : pass.outputBindings)
+            *binding = pass.output;
+        for(auto binding : pass.feedbackBindings)
+            *binding = pass.feedback;
+        if(p + 1 < m_passes.size())
+            m_passes[p + 1].source = pass.output;
+    }
+
+    int p = 0;
+    for(auto& pass : m_passes)
+    {
+        if(!m_passGraph.Nodes()[p].live)
+        {
+            p++;
+            continue;
+        }
+
+        Tracer::Span passSpan("render", "Pass", "pass", p);
+        pass.frame.Render(pass, pass.params, p == 0 ? m_historyViews[0] : pass.source, m_passResources, m_historyViews, m_frameCount, 0, 0);
+        p++;
+    }
+    m_frameCount++;
+}
+
+bool NullRenderer::Pass::Map(int buffer, void*& data)
+{
+    auto handle = buffer == UBO_BUFFER ? ubo : push;
+    if(handle == -1)
+        return false;
+
+    data = device.Map(handle);
+    return true;
+}
+
+void NullRenderer::Pass::Unmap(int buffer)
+{
+    device.Unmap(buffer == UBO_BUFFER ? ubo : push);
+}
+
+void NullRenderer::Pass::SetTarget(int, int)
+{
+    // viewport, target, then topology, input layout and vertex buffer
+    device.Call(NullCall::SetViewport);
+    device.Call(NullCall::SetRenderTarget);
+    device.Call(NullCall::SetInputAssembler, 3);
+    device.Call(NullCall::SetShader, 2);
+}
+
+void NullRenderer::Pass::SetResource(int, int)
+{
+    device.Call(NullCall::SetShaderResource);
+}
+
+void NullRenderer::Pass::SetSampler(int, int)
+{
+    device.Call(NullCall::SetSampler);
+}
+
+void NullRenderer::Pass::SetConstantBuffers()
+{
+    // both stages see each buffer
+    if(ubo != -1)
+        device.Call(NullCall::SetConstantBuffer, 2);
+    if(push != -1)
+        device.Call(NullCall::SetConstantBuffer, 2);
+}
+
+void NullRenderer::Pass::Draw()
+{
+    device.Call(NullCall::Draw);
+}
+
+void NullRenderer::Pass::Unbind(const std::vector<int>& bindings)
+{
+    device.Call(NullCall::SetShaderResource, static_cast<int>(bindings.size()));
+    device.Call(NullCall::SetRenderTarget);
+}
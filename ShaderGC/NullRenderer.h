@@ -0,0 +1,85 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include "PresetDef.h"
+#include "PassChain.h"
+#include "PassFrame.h"
+#include "HistoryRing.h"
+#include "NullDevice.h"
+
+#include <deque>
+
+// runs the per-frame work of a preset against a NullDevice the way ShaderGlass::Process does, each pass rendering
+// through the same PassFrame as ShaderPass with the same string-keyed pass resources
+class NullRenderer
+{
+public:
+    NullRenderer(const PresetDef& presetDef);
+
+    void SetParam(const std::string& name, float value);
+
+    // renders one frame from an input of given size
+    void Render(int originalWidth, int originalHeight, int viewportWidth, int viewportHeight);
+
+    NullDevice& Device()
+    {
+        return m_device;
+    }
+
+    void Reset();
+
+private:
+    // device side of PassFrame, the calls ShaderPass makes on a D3D11 context
+    struct Pass
+    {
+        Pass(NullDevice& device, ShaderDef& shaderDef) : device {device}, params {shaderDef} { }
+
+        bool Map(int buffer, void*& data);
+        void Unmap(int buffer);
+        void SetTarget(int boxX, int boxY);
+        void SetResource(int binding, int view);
+        int  ResourceView(int resource)
+        {
+            return resource;
+        }
+        void SetSampler(int binding, int sampler);
+        void SetConstantBuffers();
+        void Draw();
+        void Unbind(const std::vector<int>& bindings);
+        void Unresolved(const std::string&) { }
+
+        NullDevice&       device;
+        ShaderParams      params;
+        PassFrame<int>    frame {};
+        ChainPass         options {};
+        int               ubo {-1};
+        int               push {-1};
+        int               source {-1};
+        int               output {-1};
+        int               feedback {-1};
+        std::vector<int*> outputBindings {};
+        std::vector<int*> feedbackBindings {};
+    };
+
+    void Resize(int originalWidth, int originalHeight, int viewportWidth, int viewportHeight);
+
+    NullDevice                 m_device;
+    std::vector<ShaderDef>     m_shaderDefs;
+    PassGraph                  m_passGraph;
+    std::deque<Pass>           m_passes;
+    std::map<std::string, int> m_passResources;
+    std::vector<int>           m_history;
+    std::vector<int>           m_historyViews;
+    HistoryRing                m_historyRing;
+    int                        m_frameCount;
+    int                        m_originalWidth;
+    int                        m_originalHeight;
+    int                        m_viewportWidth;
+    int                        m_viewportHeight;
+};
@@ -0,0 +1,103 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// shares immutable device objects by key, objects still referenced are always kept and unreferenced ones
+// are kept for reuse up to capacity, least recently used are evicted first
+template<typename T> class ObjectCache
+{
+public:
+    explicit ObjectCache(size_t capacity) : m_entries {}, m_capacity {capacity}, m_clock {0}, m_hits {0}, m_misses {0}, m_bytes {0} { }
+
+    // create() is only called on a miss and returns the new T, whatever device it uses; bytes is its size for Bytes()
+    template<typename F> std::shared_ptr<const T> Acquire(const std::string& key, F create, uint64_t bytes = 0)
+    {
+        auto it = m_entries.find(key);
+        if(it != m_entries.end())
+        {
+            it->second.lastUse = ++m_clock;
+            m_hits++;
+            return it->second.object;
+        }
+
+        m_misses++;
+        auto object    = std::make_shared<const T>(create());
+        m_entries[key] = {object, ++m_clock, bytes};
+        m_bytes += bytes;
+        return object;
+    }
+
+    // drops unreferenced objects over capacity
+    void Trim()
+    {
+        std::vector<typename std::map<std::string, Entry>::iterator> unused;
+        for(auto it = m_entries.begin(); it != m_entries.end(); it++)
+        {
+            if(it->second.object.use_count() == 1)
+                unused.push_back(it);
+        }
+        if(unused.size() <= m_capacity)
+            return;
+
+        std::sort(unused.begin(), unused.end(), [](const auto& a, const auto& b) { return a->second.lastUse < b->second.lastUse; });
+        for(size_t i = 0; i < unused.size() - m_capacity; i++)
+        {
+            m_bytes -= unused[i]->second.bytes;
+            m_entries.erase(unused[i]);
+        }
+    }
+
+    void Clear()
+    {
+        m_entries.clear();
+        m_bytes = 0;
+    }
+
+    size_t Size() const
+    {
+        return m_entries.size();
+    }
+
+    uint64_t Hits() const
+    {
+        return m_hits;
+    }
+
+    uint64_t Misses() const
+    {
+        return m_misses;
+    }
+
+    // of all cached objects, referenced or not
+    uint64_t Bytes() const
+    {
+        return m_bytes;
+    }
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<const T> object;
+        uint64_t                 lastUse;
+        uint64_t                 bytes;
+    };
+
+    std::map<std::string, Entry> m_entries;
+    size_t                       m_capacity;
+    uint64_t                     m_clock;
+    uint64_t                     m_hits;
+    uint64_t                     m_misses;
+    uint64_t                     m_bytes;
+};
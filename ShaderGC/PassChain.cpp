@@ -0,0 +1,266 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "PassChain.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+
+// column-major like the MVP of ShaderPass
+static const float sModelViewProj[16] = {2.0f, 0.0f, 0.0f, 0.0f, 0.0f, 2.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, -1.0f, 0.0f, 1.0f};
+
+static bool Get(const ShaderDef& shaderDef, const std::string& presetParam, std::string& value)
+{
+    auto it = shaderDef.PresetParams.find(presetParam);
+    if(it != shaderDef.PresetParams.end())
+    {
+        value = it->second;
+        return true;
+    }
+    return false;
+}
+
+// unparsable or non-positive scales are 1 so a bad preset still renders
+static float ParseScale(const std::string& value)
+{
+    const auto scale = strtof(value.c_str(), nullptr);
+    return scale > 0.0f ? scale : 1.0f;
+}
+
+static bool IsTrue(const ShaderDef& shaderDef, const std::string& presetParam)
+{
+    std::string value;
+    return Get(shaderDef, presetParam, value) && (value == "true" || value == "1");
+}
+
+PassChain::PassChain(const PresetDef& presetDef) :
+    m_passes {}, m_passGraph {}, m_textureSamplers {}, m_historyDepth {0}, m_originalWidth {0}, m_originalHeight {0}, m_viewportWidth {0}, m_viewportHeight {0},
+    m_passScale {1.0f}
+{
+    for(const auto& textureDef : presetDef.TextureDefs)
+    {
+        auto            name = textureDef.PresetParams.find("name");
+        SoftwareSampler sampler;
+        auto            linear = textureDef.PresetParams.find("linear");
+        auto            wrap   = textureDef.PresetParams.find("wrap_mode");
+        sampler.linear         = linear != textureDef.PresetParams.end() && linear->second == "true";
+        if(wrap != textureDef.PresetParams.end())
+        {
+            if(wrap->second == "repeat")
+                sampler.wrap = SoftwareWrap::Repeat;
+            else if(wrap->second == "clamp_to_border")
+                sampler.wrap = SoftwareWrap::Clamp;
+            else if(wrap->second == "mirrored_repeat")
+                sampler.wrap = SoftwareWrap::Mirror;
+        }
+        if(name != textureDef.PresetParams.end())
+            m_textureSamplers[name->second] = sampler;
+    }
+
+    std::vector<const ShaderDef*> shaderDefs;
+    for(const auto& shaderDef : presetDef.ShaderDefs)
+    {
+        auto pass = Options(shaderDef);
+        pass.ubo.resize((shaderDef.ParamsSize(0) + 0xf) & ~0xf);
+        pass.push.resize((shaderDef.ParamsSize(-1) + 0xf) & ~0xf);
+        for(const auto& p : shaderDef.Params)
+            SetParam(pass, p.name, &p.defaultValue, sizeof(float));
+
+        m_passes.push_back(std::move(pass));
+        shaderDefs.push_back(&shaderDef);
+    }
+
+    for(const auto& o : presetDef.Overrides)
+        SetParam(o.name, o.value);
+
+    m_passGraph = PassGraph(shaderDefs);
+    for(const auto& node : m_passGraph.Nodes())
+        m_historyDepth = std::max(m_historyDepth, node.history);
+}
+
+ChainPass PassChain::Options(const ShaderDef& shaderDef)
+{
+    ChainPass   pass;
+    std::string value;
+    pass.shaderDef = &shaderDef;
+    pass.linear    = IsTrue(shaderDef, "filter_linear");
+    if(IsTrue(shaderDef, "srgb_framebuffer"))
+        pass.format = "R8G8B8A8_SRGB";
+    if(IsTrue(shaderDef, "float_framebuffer"))
+        pass.format = "R16G16B16A16_SFLOAT";
+    if(shaderDef.Format && strlen(shaderDef.Format) > 0)
+        pass.format = shaderDef.Format;
+    if(Get(shaderDef, "scale_x", value))
+        pass.scaleX = ParseScale(value);
+    if(Get(shaderDef, "scale_y", value))
+        pass.scaleY = ParseScale(value);
+    if(Get(shaderDef, "scale", value))
+        pass.scaleX = pass.scaleY = ParseScale(value);
+    if(Get(shaderDef, "scale_type_x", value))
+    {
+        pass.viewportX = value == "viewport";
+        pass.absoluteX = value == "absolute";
+    }
+    if(Get(shaderDef, "scale_type_y", value))
+    {
+        pass.viewportY = value == "viewport";
+        pass.absoluteY = value == "absolute";
+    }
+    if(Get(shaderDef, "scale_type", value))
+    {
+        pass.viewportX = pass.viewportY = value == "viewport";
+        pass.absoluteX = pass.absoluteY = value == "absolute";
+    }
+    if(Get(shaderDef, "alias", value))
+        pass.alias = value;
+    if(Get(shaderDef, "framecount_mod", value))
+        pass.frameCountMod = static_cast<int>(atof(value.c_str()));
+    if(Get(shaderDef, "wrap_mode", value))
+        pass.clamp = value == "clamp_to_edge";
+    return pass;
+}
+
+void PassChain::Size(const ChainPass& pass, float sourceWidth, float sourceHeight, float viewportWidth, float viewportHeight, float passScale, float& width, float& height)
+{
+    width  = pass.viewportX ? viewportWidth * pass.scaleX * passScale : (pass.absoluteX ? pass.scaleX : sourceWidth * pass.scaleX);
+    height = pass.viewportY ? viewportHeight * pass.scaleY * passScale : (pass.absoluteY ? pass.scaleY : sourceHeight * pass.scaleY);
+}
+
+void PassChain::SetParam(const std::string& name, float value)
+{
+    for(auto& pass : m_passes)
+        SetParam(pass, name, &value, sizeof(float));
+}
+
+void PassChain::SetParam(ChainPass& pass, const std::string& name, const void* value, size_t size)
+{
+    // same param can be in both buffers
+    for(const auto& p : pass.shaderDef->Params)
+    {
+        if(p.name != name)
+            continue;
+        auto& buffer = p.buffer == -1 ? pass.push : pass.ubo;
+        if(p.offset + std::min<size_t>(p.size, size) <= buffer.size())
+            memcpy(buffer.data() + p.offset, value, std::min<size_t>(p.size, size));
+    }
+}
+
+bool PassChain::Resize(int originalWidth, int originalHeight, int viewportWidth, int viewportHeight, float passScale)
+{
+    if(originalWidth == m_originalWidth && originalHeight == m_originalHeight && viewportWidth == m_viewportWidth && viewportHeight == m_viewportHeight &&
+       passScale == m_passScale)
+        return false;
+
+    m_originalWidth  = originalWidth;
+    m_originalHeight = originalHeight;
+    m_viewportWidth  = viewportWidth;
+    m_viewportHeight = viewportHeight;
+    m_passScale      = passScale;
+
+    auto size = [](int width, int height) {
+        return std::array<float, 4> {(float)width, (float)height, 1.0f / width, 1.0f / height};
+    };
+
+    std::map<std::string, std::array<float, 4>> textureSizes;
+    textureSizes.insert(std::make_pair("Original", size(originalWidth, originalHeight)));
+    textureSizes.insert(std::make_pair("FinalViewport", size(viewportWidth, viewportHeight)));
+
+    int sourceWidth  = originalWidth;
+    int sourceHeight = originalHeight;
+    for(size_t p = 0; p < m_passes.size(); p++)
+    {
+        auto& pass = m_passes[p];
+        if(p == m_passes.size() - 1)
+        {
+            // last shader scales source to viewport
+            pass.width  = viewportWidth;
+            pass.height = viewportHeight;
+        }
+        else
+        {
+            float width, height;
+            Size(pass, (float)sourceWidth, (float)sourceHeight, (float)viewportWidth, (float)viewportHeight, passScale, width, height);
+            pass.width  = std::max(static_cast<int>(width), 1);
+            pass.height = std::max(static_cast<int>(height), 1);
+            if(!pass.alias.empty())
+                textureSizes.insert(std::make_pair(pass.alias, size(pass.width, pass.height)));
+        }
+
+        auto sourceSize = size(sourceWidth, sourceHeight);
+        auto outputSize = size(pass.width, pass.height);
+        SetParam(pass, "SourceSize", sourceSize.data(), sizeof(sourceSize));
+        SetParam(pass, "OutputSize", outputSize.data(), sizeof(outputSize));
+        sourceWidth  = pass.width;
+        sourceHeight = pass.height;
+    }
+
+    for(auto& pass : m_passes)
+    {
+        for(const auto& texture : textureSizes)
+            SetParam(pass, texture.first + "Size", texture.second.data(), sizeof(texture.second));
+        for(size_t p = 0; p < m_passes.size(); p++)
+        {
+            auto passSize = size(m_passes[p].width, m_passes[p].height);
+            SetParam(pass, "PassOutputSize" + std::to_string(p), passSize.data(), sizeof(passSize));
+        }
+    }
+    return true;
+}
+
+void PassChain::BeginPass(ChainPass& pass, int frameCount)
+{
+    if(pass.frameCountMod > 0)
+        frameCount %= pass.frameCountMod;
+    SetParam(pass, "FrameCount", &frameCount, sizeof(frameCount));
+    SetParam(pass, "MVP", sModelViewProj, sizeof(sModelViewProj));
+}
+
+ChainResource PassChain::Resolve(int p, const std::string& name, int& index) const
+{
+    index = 0;
+    if(name == "Source")
+        return p == 0 ? ChainResource::History : ChainResource::Source;
+    if(name == "Original")
+        return ChainResource::History;
+    if(PassGraph::ParseIndex(name, "OriginalHistory", index))
+        return ChainResource::History;
+    if(PassGraph::ParseIndex(name, "PassOutput", index))
+        return index < p ? ChainResource::PassOutput : ChainResource::None;
+    if(PassGraph::ParseIndex(name, "PassFeedback", index))
+        return index < static_cast<int>(m_passes.size()) ? ChainResource::PassFeedback : ChainResource::None;
+    if(m_textureSamplers.count(name))
+        return ChainResource::Texture;
+    for(index = 0; index < static_cast<int>(m_passes.size()); index++)
+    {
+        const auto& alias = m_passes[index].alias;
+        if(alias.empty())
+            continue;
+        if(name == alias && index < p)
+            return ChainResource::PassOutput;
+        if(name == alias + "Feedback")
+            return ChainResource::PassFeedback;
+    }
+    return ChainResource::None;
+}
+
+SoftwareSampler PassChain::Sampler(const ChainPass& pass, const std::string& name) const
+{
+    // preset textures have their own settings, everything else follows the pass
+    auto preset = m_textureSamplers.find(name);
+    if(preset != m_textureSamplers.end())
+        return preset->second;
+
+    SoftwareSampler sampler;
+    sampler.linear = pass.linear;
+    if(pass.clamp)
+        sampler.wrap = SoftwareWrap::Clamp;
+    return sampler;
+}
@@ -0,0 +1,96 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include "PresetDef.h"
+#include "PassGraph.h"
+#include "SoftwareTexture.h"
+
+struct ChainPass
+{
+    const ShaderDef*     shaderDef {nullptr};
+    std::vector<uint8_t> ubo {};
+    std::vector<uint8_t> push {};
+    std::string          alias {};
+    std::string          format {"R8G8B8A8_UNORM"}; // slang format name
+    float                scaleX {1.0f};
+    float                scaleY {1.0f};
+    bool                 viewportX {false};
+    bool                 viewportY {false};
+    bool                 absoluteX {false};
+    bool                 absoluteY {false};
+    bool                 linear {false};
+    bool                 clamp {false};
+    int                  frameCountMod {0};
+    int                  width {0};
+    int                  height {0};
+};
+
+enum class ChainResource
+{
+    None,
+    Source,
+    History,
+    PassOutput,
+    PassFeedback,
+    Texture
+};
+
+// backend-independent state of a preset chain: pass options, sizes, param buffers and what each sampler reads
+class PassChain
+{
+public:
+    PassChain(const PresetDef& presetDef);
+
+    // options the preset sets for a pass, Shader of ShaderGlass reads them from here too
+    static ChainPass Options(const ShaderDef& shaderDef);
+
+    // unrounded size of a pass other than the last, from its source and the viewport
+    static void Size(const ChainPass& pass, float sourceWidth, float sourceHeight, float viewportWidth, float viewportHeight, float passScale, float& width, float& height);
+
+    std::vector<ChainPass>& Passes()
+    {
+        return m_passes;
+    }
+
+    const PassGraph& Graph() const
+    {
+        return m_passGraph;
+    }
+
+    // deepest OriginalHistory sampled by any pass
+    int HistoryDepth() const
+    {
+        return m_historyDepth;
+    }
+
+    void SetParam(const std::string& name, float value);
+    void SetParam(ChainPass& pass, const std::string& name, const void* value, size_t size);
+
+    // recalculates pass sizes and size params, returns false if nothing changed; passScale multiplies
+    // viewport-scaled intermediate passes as in QualityLevel
+    bool Resize(int originalWidth, int originalHeight, int viewportWidth, int viewportHeight, float passScale = 1.0f);
+
+    // per-frame params of a pass
+    void BeginPass(ChainPass& pass, int frameCount);
+
+    // what a sampler of pass p reads, index is the pass or history age
+    ChainResource   Resolve(int p, const std::string& name, int& index) const;
+    SoftwareSampler Sampler(const ChainPass& pass, const std::string& name) const;
+
+private:
+    std::vector<ChainPass>                 m_passes;
+    PassGraph                              m_passGraph;
+    std::map<std::string, SoftwareSampler> m_textureSamplers;
+    int                                    m_historyDepth;
+    int                                    m_originalWidth;
+    int                                    m_originalHeight;
+    int                                    m_viewportWidth;
+    int                                    m_viewportHeight;
+    float                                  m_passScale;
+};
@@ -0,0 +1,182 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include "ShaderParams.h"
+#include "PassGraph.h"
+
+#include <array>
+#include <cstring>
+
+// per-frame work of one pass: params set by name, buffers filled, samplers resolved and bound, drawn and unbound;
+// ShaderPass of ShaderGlass renders through this, and NullRenderer on a NullDevice, so what NullRenderer measures
+// is what ShaderPass costs on the CPU. A Device provides
+//   bool Map(int buffer, void*& data), Unmap(int buffer)  UBO_BUFFER or PUSH_BUFFER, false if the pass has none
+//   SetTarget(int boxX, int boxY)                          viewport, render target, input assembler and shaders
+//   SetResource(int binding, View view)                    View ResourceView(resource) of the Resources map values
+//   SetSampler(int binding, const Sampler& sampler)
+//   SetConstantBuffers(), Draw(), Unbind(bindings)         bound resources and the render target
+//   Unresolved(const std::string& name)                    sampler with nothing to read
+template<typename Sampler> class PassFrame
+{
+public:
+    PassFrame()
+    {
+        ResetMVP();
+    }
+
+    // keyed by binding
+    std::map<int, Sampler> m_samplers;
+    int                    m_frameCountMod {0};
+
+    void Initialize(const ShaderDef& shaderDef, int frameCountMod)
+    {
+        m_frameCountMod = frameCountMod;
+        m_samplerHistory.clear();
+        for(const auto& texture : shaderDef.Samplers)
+        {
+            // Original is the current frame of history
+            int history = -1;
+            if(texture.name == "Original")
+                history = 0;
+            else
+                PassGraph::ParseIndex(texture.name, "OriginalHistory", history);
+            m_samplerHistory.push_back(history);
+        }
+        ResetMVP();
+    }
+
+    // has effect only on the preprocess pass
+    void UpdateMVP(float sx, float sy, float tx, float ty)
+    {
+        m_modelViewProj.m[0][0] = sx;
+        m_modelViewProj.m[1][1] = sy;
+        m_modelViewProj.m[3][0] = tx;
+        m_modelViewProj.m[3][1] = ty;
+    }
+
+    // size params, whether any changed
+    bool Resize(ShaderParams&                               params,
+                int                                         sourceWidth,
+                int                                         sourceHeight,
+                int                                         destWidth,
+                int                                         destHeight,
+                const std::map<std::string, float4>&        textureSizes,
+                const std::vector<std::array<unsigned, 4>>& passSizes)
+    {
+        params_SourceSize[0] = static_cast<float>(sourceWidth);
+        params_SourceSize[1] = static_cast<float>(sourceHeight);
+        params_SourceSize[2] = 1.0f / sourceWidth;
+        params_SourceSize[3] = 1.0f / sourceHeight;
+        params_OutputSize[0] = static_cast<float>(destWidth);
+        params_OutputSize[1] = static_cast<float>(destHeight);
+        params_OutputSize[2] = 1.0f / destWidth;
+        params_OutputSize[3] = 1.0f / destHeight;
+        auto changed         = params.SetParam("SourceSize", params_SourceSize);
+        changed |= params.SetParam("OutputSize", params_OutputSize);
+
+        for(const auto& tx : textureSizes)
+        {
+            auto sizeParam = tx.first + "Size";
+            changed |= params.SetParam(sizeParam, (void*)&tx.second);
+        }
+        for(size_t p = 0; p < passSizes.size(); p++)
+        {
+            const auto& passSize = passSizes.at(p);
+            if(passSize[2] != 0 && passSize[3] != 0)
+            {
+                auto  sizeParam    = "PassOutputSize" + std::to_string(p);
+                float passSizeF[4] = {(float)passSize[2], (float)passSize[3], 1.0f / passSize[2], 1.0f / passSize[3]};
+                changed |= params.SetParam(sizeParam, passSizeF);
+            }
+        }
+        return changed;
+    }
+
+    template<typename Device, typename View, typename Resources>
+    void Render(Device& device, ShaderParams& params, View sourceView, Resources& resources, const std::vector<View>& history, int frameNo, int boxX, int boxY)
+    {
+        params_FrameCount = frameNo;
+        if(m_frameCountMod > 0)
+        {
+            while(params_FrameCount >= m_frameCountMod)
+                params_FrameCount -= m_frameCountMod;
+        }
+
+        params.SetParam("FrameCount", &params_FrameCount);
+        params.SetParam("MVP", &m_modelViewProj);
+
+        void* data;
+        if(device.Map(UBO_BUFFER, data))
+        {
+            params.FillParams(UBO_BUFFER, data);
+            device.Unmap(UBO_BUFFER);
+        }
+        if(device.Map(PUSH_BUFFER, data))
+        {
+            params.FillParams(PUSH_BUFFER, data);
+            device.Unmap(PUSH_BUFFER);
+        }
+
+        device.SetTarget(boxX, boxY);
+
+        std::vector<int> bindings;
+        for(size_t t = 0; t < params.m_shaderDef.Samplers.size(); t++)
+        {
+            const auto& texture = params.m_shaderDef.Samplers[t];
+            auto&       sampler = m_samplers.at(texture.binding);
+            if(texture.name == "Source")
+            {
+                device.SetResource(texture.binding, sourceView);
+                bindings.push_back(texture.binding);
+            }
+            else if(m_samplerHistory[t] >= 0 && !history.empty())
+            {
+                // deeper history than available maps to the oldest frame
+                const auto oldest = static_cast<int>(history.size()) - 1;
+                device.SetResource(texture.binding, history[m_samplerHistory[t] < oldest ? m_samplerHistory[t] : oldest]);
+                bindings.push_back(texture.binding);
+            }
+            else
+            {
+                auto it = resources.find(texture.name);
+                if(it != resources.end())
+                {
+                    device.SetResource(texture.binding, device.ResourceView(it->second));
+                    bindings.push_back(texture.binding);
+                }
+                else
+                {
+                    device.Unresolved(texture.name);
+                }
+            }
+            device.SetSampler(texture.binding, sampler);
+        }
+
+        device.SetConstantBuffers();
+        device.Draw();
+
+        // unbind to allow rebinding as input/output
+        device.Unbind(bindings);
+    }
+
+private:
+    // maps the unit quad to the whole target
+    void ResetMVP()
+    {
+        memset(m_modelViewProj.m, 0, sizeof(m_modelViewProj.m));
+        m_modelViewProj.m[3][3] = 1.0f;
+        UpdateMVP(2.0f, 2.0f, -1.0f, -1.0f);
+    }
+
+    float4x4         m_modelViewProj {};
+    std::vector<int> m_samplerHistory;
+    float            params_SourceSize[4] {0, 0, 0, 0};
+    float            params_OutputSize[4] {0, 0, 0, 0};
+    int              params_FrameCount {0};
+};
@@ -0,0 +1,233 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "PassGraph.h"
+#include "DXBC.h"
+
+#include <algorithm>
+
+PassGraph::PassGraph(const std::vector<const ShaderDef*>& shaderDefs) : m_nodes {}, m_firstVariantPass {static_cast<int>(shaderDefs.size())}
+{
+    const auto                 passes = static_cast<int>(shaderDefs.size());
+    std::map<std::string, int> aliases;
+    for(int p = 0; p < passes; p++)
+    {
+        const auto& shaderDef = *shaderDefs[p];
+
+        PassNode node;
+        node.params     = UsedParams(shaderDef);
+        node.frameCount = std::find(node.params.begin(), node.params.end(), "FrameCount") != node.params.end();
+        for(const auto& sampler : shaderDef.Samplers)
+        {
+            node.textures.push_back(sampler.name);
+
+            int index;
+            if(sampler.name == "Source")
+            {
+                if(p == 0)
+                    node.original = true;
+                else
+                    node.inputs.push_back(p - 1);
+            }
+            else if(sampler.name == "Original")
+            {
+                node.original = true;
+            }
+            else if(ParseIndex(sampler.name, "OriginalHistory", index))
+            {
+                if(index == 0)
+                    node.original = true;
+                else
+                    node.history = std::max(node.history, index);
+            }
+            else if(ParseIndex(sampler.name, "PassOutput", index))
+            {
+                if(index < p)
+                    node.inputs.push_back(index);
+            }
+            else if(sampler.name.ends_with("Feedback") || sampler.name.starts_with("PassFeedback"))
+            {
+                node.feedback = true;
+            }
+            else
+            {
+                auto alias = aliases.find(sampler.name);
+                if(alias != aliases.end())
+                    node.inputs.push_back(alias->second);
+            }
+        }
+
+        node.variant = node.frameCount || node.feedback || node.history > 0;
+        for(auto input : node.inputs)
+            node.variant |= m_nodes[input].variant;
+
+        auto alias = shaderDef.PresetParams.find("alias");
+        if(alias != shaderDef.PresetParams.end())
+            aliases[alias->second] = p;
+
+        m_nodes.push_back(node);
+    }
+
+    // feedback can come from any pass, including later ones
+    for(int p = 0; p < passes; p++)
+    {
+        for(const auto& sampler : shaderDefs[p]->Samplers)
+        {
+            int index;
+            if(ParseIndex(sampler.name, "PassFeedback", index))
+            {
+                if(index < passes)
+                {
+                    m_nodes[index].fedBack = true;
+                    m_nodes[p].feedbacks.push_back(index);
+                }
+            }
+            else if(sampler.name.ends_with("Feedback"))
+            {
+                auto alias = aliases.find(sampler.name.substr(0, sampler.name.size() - 8));
+                if(alias != aliases.end())
+                {
+                    m_nodes[alias->second].fedBack = true;
+                    m_nodes[p].feedbacks.push_back(alias->second);
+                }
+            }
+        }
+    }
+
+    FindLivePasses();
+
+    // dead passes are not rendered so can't make the frame change
+    for(int p = 0; p < passes; p++)
+    {
+        if(m_nodes[p].live && m_nodes[p].variant)
+        {
+            m_firstVariantPass = p;
+            break;
+        }
+    }
+}
+
+void PassGraph::FindLivePasses()
+{
+    if(m_nodes.empty())
+        return;
+
+    // walk back from the final pass, feedback edges may also point forward
+    for(auto& node : m_nodes)
+        node.live = false;
+    std::vector<int> pending {static_cast<int>(m_nodes.size()) - 1};
+    m_nodes.back().live = true;
+    while(!pending.empty())
+    {
+        const auto& node = m_nodes[pending.back()];
+        pending.pop_back();
+
+        std::vector<int> reads(node.inputs);
+        reads.insert(reads.end(), node.feedbacks.begin(), node.feedbacks.end());
+        for(auto r : reads)
+        {
+            if(!m_nodes[r].live)
+            {
+                m_nodes[r].live = true;
+                pending.push_back(r);
+            }
+        }
+    }
+}
+
+std::vector<int> PassGraph::DeadPasses() const
+{
+    std::vector<int> dead;
+    for(int p = 0; p < static_cast<int>(m_nodes.size()); p++)
+    {
+        if(!m_nodes[p].live)
+            dead.push_back(p);
+    }
+    return dead;
+}
+
+bool PassGraph::Samples(const std::string& name) const
+{
+    for(const auto& node : m_nodes)
+    {
+        if(node.live && std::find(node.textures.begin(), node.textures.end(), name) != node.textures.end())
+            return true;
+    }
+    return false;
+}
+
+int PassGraph::FirstAffectedPass(const std::vector<std::string>& names) const
+{
+    for(int p = 0; p < static_cast<int>(m_nodes.size()); p++)
+    {
+        const auto& node = m_nodes[p];
+        for(const auto& name : names)
+        {
+            if(std::find(node.params.begin(), node.params.end(), name) != node.params.end() ||
+               std::find(node.textures.begin(), node.textures.end(), name) != node.textures.end())
+                return p;
+        }
+    }
+    return static_cast<int>(m_nodes.size());
+}
+
+bool PassGraph::OriginalOnlyInFirstPass() const
+{
+    for(int p = 0; p < static_cast<int>(m_nodes.size()); p++)
+    {
+        const auto& node = m_nodes[p];
+        if(node.history > 0 || (p > 0 && node.original))
+            return false;
+    }
+    return true;
+}
+
+std::vector<std::string> PassGraph::UsedParams(const ShaderDef& shaderDef)
+{
+    std::vector<std::string> params;
+
+    // declared members are often left unused, check what the compiled shaders actually read
+    std::vector<std::string> used;
+    if(!DXBC::UsedConstants(shaderDef.VertexByteCode, shaderDef.VertexLength, used) || !DXBC::UsedConstants(shaderDef.FragmentByteCode, shaderDef.FragmentLength, used))
+    {
+        for(const auto& p : shaderDef.Params)
+            params.push_back(p.name);
+        return params;
+    }
+
+    for(const auto& p : shaderDef.Params)
+    {
+        // cross-compiled constants are prefixed with block name
+        const auto suffix = "_" + p.name;
+        for(const auto& u : used)
+        {
+            if(u == p.name || u.ends_with(suffix))
+            {
+                params.push_back(p.name);
+                break;
+            }
+        }
+    }
+    return params;
+}
+
+bool PassGraph::ParseIndex(const std::string& name, const std::string& prefix, int& index)
+{
+    if(!name.starts_with(prefix) || name.size() == prefix.size() || name.size() > prefix.size() + 2)
+        return false;
+
+    index = 0;
+    for(auto i = prefix.size(); i < name.size(); i++)
+    {
+        if(name[i] < '0' || name[i] > '9')
+            return false;
+        index = index * 10 + (name[i] - '0');
+    }
+    return true;
+}
@@ -0,0 +1,64 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include "ShaderDef.h"
+
+struct PassNode
+{
+    bool                     frameCount {false}; // reads FrameCount
+    bool                     feedback {false};   // samples any feedback texture
+    int                      history {0};        // deepest OriginalHistory sampled
+    bool                     original {false};   // samples Original (or Source of the first pass)
+    std::vector<int>         inputs {};          // earlier pass outputs sampled
+    std::vector<std::string> params {};          // params the pass reads
+    std::vector<std::string> textures {};        // names of sampled textures
+    bool                     variant {false};    // output can change even if the input doesn't
+    bool                     fedBack {false};    // previous output is sampled as feedback
+    std::vector<int>         feedbacks {};       // pass outputs sampled as feedback
+    bool                     live {true};        // output reaches the final pass
+};
+
+class PassGraph
+{
+public:
+    PassGraph() : m_nodes {}, m_firstVariantPass {0} { }
+    PassGraph(const std::vector<const ShaderDef*>& shaderDefs);
+
+    const std::vector<PassNode>& Nodes() const
+    {
+        return m_nodes;
+    }
+
+    // first pass which has to be rendered every frame, size() if the whole chain is static
+    int FirstVariantPass() const
+    {
+        return m_firstVariantPass;
+    }
+
+    // first pass reading any of the named params or textures, size() if none
+    int FirstAffectedPass(const std::vector<std::string>& names) const;
+
+    // passes whose output is never read on the way to the final pass, they don't need rendering
+    std::vector<int> DeadPasses() const;
+
+    // whether any live pass samples the named texture
+    bool Samples(const std::string& name) const;
+
+    // no history and only the first pass reads Original, so it could sample the input directly
+    bool OriginalOnlyInFirstPass() const;
+
+    static std::vector<std::string> UsedParams(const ShaderDef& shaderDef);
+    static bool ParseIndex(const std::string& name, const std::string& prefix, int& index);
+
+private:
+    void FindLivePasses();
+
+    std::vector<PassNode> m_nodes;
+    int                   m_firstVariantPass;
+};
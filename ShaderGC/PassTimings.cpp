@@ -0,0 +1,143 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "PassTimings.h"
+
+#include <algorithm>
+#include <cmath>
+
+TimestampQueue::TimestampQueue(int slots) : m_ended(slots) { }
+
+void TimestampQueue::Reset()
+{
+    m_oldest  = 0;
+    m_waiting = 0;
+}
+
+int TimestampQueue::Begin()
+{
+    m_frame++;
+    if(m_waiting == Slots())
+    {
+        m_untimed++;
+        return -1;
+    }
+    return (m_oldest + m_waiting) % Slots();
+}
+
+void TimestampQueue::End(int slot)
+{
+    m_ended[slot] = m_frame;
+    m_waiting++;
+}
+
+int TimestampQueue::Oldest() const
+{
+    return m_waiting ? m_oldest : -1;
+}
+
+void TimestampQueue::Retire(bool valid)
+{
+    if(!m_waiting)
+        return;
+
+    if(valid)
+    {
+        m_timed++;
+        m_maxLatency = std::max(m_maxLatency, m_frame - m_ended[m_oldest]);
+    }
+    else
+    {
+        m_dropped++;
+    }
+    m_oldest = (m_oldest + 1) % Slots();
+    m_waiting--;
+}
+
+void PassTimings::Reset(const std::vector<std::string>& names)
+{
+    std::lock_guard lock(m_mutex);
+    m_passes.clear();
+    m_passes.resize(names.size());
+    for(size_t p = 0; p < names.size(); p++)
+        m_passes[p].name = names[p];
+}
+
+void PassTimings::AddFrame(const std::vector<PassTimestamps>& timestamps, uint64_t frequency)
+{
+    if(frequency == 0)
+        return;
+
+    std::lock_guard lock(m_mutex);
+    for(const auto& t : timestamps)
+    {
+        // a timestamp can be from before the chain was reset, or out of order on a broken driver
+        if(t.pass < 0 || t.pass >= static_cast<int>(m_passes.size()) || t.end < t.begin)
+            continue;
+
+        auto& pass = m_passes[t.pass];
+        auto  time = static_cast<float>((t.end - t.begin) * 1000.0 / frequency);
+        if(pass.samples.size() < Window)
+        {
+            pass.samples.push_back(time);
+        }
+        else
+        {
+            pass.samples[pass.next] = time;
+            pass.next               = (pass.next + 1) % Window;
+        }
+    }
+}
+
+std::vector<PassCost> PassTimings::Costs() const
+{
+    std::vector<PassCost> costs;
+    std::vector<float>    sorted;
+
+    std::lock_guard lock(m_mutex);
+    for(size_t p = 0; p < m_passes.size(); p++)
+    {
+        const auto& pass = m_passes[p];
+        PassCost    cost {static_cast<int>(p), pass.name, static_cast<int>(pass.samples.size()), 0.0f, 0.0f, 0.0f};
+        if(!pass.samples.empty())
+        {
+            sorted.assign(pass.samples.begin(), pass.samples.end());
+            std::sort(sorted.begin(), sorted.end());
+
+            double sum = 0.0;
+            for(auto s : sorted)
+                sum += s;
+
+            // nearest rank
+            auto rank = static_cast<size_t>(std::ceil(0.95 * sorted.size()));
+            cost.min  = sorted.front();
+            cost.avg  = static_cast<float>(sum / sorted.size());
+            cost.p95  = sorted[std::max<size_t>(rank, 1) - 1];
+        }
+        costs.push_back(cost);
+    }
+    return costs;
+}
+
+void PassTimings::WriteCsv(std::ostream& out, const std::vector<PassCost>& costs)
+{
+    out << "pass,name,samples,min_ms,avg_ms,p95_ms\n";
+    for(const auto& c : costs)
+    {
+        // pass names are shader paths or aliases, quoted in case they have commas
+        out << c.pass << ",\"";
+        for(auto ch : c.name)
+        {
+            if(ch == '"')
+                out << '"';
+            out << ch;
+        }
+        out << "\"," << c.samples << "," << c.min << "," << c.avg << "," << c.p95 << "\n";
+    }
+}
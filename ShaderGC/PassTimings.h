@@ -0,0 +1,115 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+
+// slots of per-frame GPU queries in the order they were issued; the renderer owns the queries of each slot and
+// polls the oldest one every frame without waiting, a slot is only reused once read back so a GPU which runs
+// several frames behind delays results instead of losing them
+class TimestampQueue
+{
+public:
+    explicit TimestampQueue(int slots);
+
+    void Reset();
+
+    // slot for this frame's queries, -1 if all of them are still waiting and the frame goes untimed
+    int  Begin();
+    void End(int slot);
+
+    // slot to read back next, -1 if none are waiting
+    int Oldest() const;
+
+    // oldest slot was read back, valid if its timestamps could be used
+    void Retire(bool valid);
+
+    int Slots() const
+    {
+        return static_cast<int>(m_ended.size());
+    }
+
+    uint64_t Timed() const
+    {
+        return m_timed;
+    }
+
+    uint64_t Untimed() const
+    {
+        return m_untimed;
+    }
+
+    uint64_t Dropped() const
+    {
+        return m_dropped;
+    }
+
+    // most frames a readback came after its own, including frames which went untimed
+    uint64_t MaxLatency() const
+    {
+        return m_maxLatency;
+    }
+
+private:
+    std::vector<uint64_t> m_ended; // frame number each waiting slot was ended in
+    uint64_t              m_frame {0};
+    int                   m_oldest {0};
+    int                   m_waiting {0};
+    uint64_t              m_timed {0};
+    uint64_t              m_untimed {0};
+    uint64_t              m_dropped {0};
+    uint64_t              m_maxLatency {0};
+};
+
+// GPU timestamps of one pass as read back, in ticks of the frame's frequency
+struct PassTimestamps
+{
+    int      pass;
+    uint64_t begin;
+    uint64_t end;
+};
+
+struct PassCost
+{
+    int         pass;
+    std::string name;
+    int         samples; // frames the pass was rendered in, up to Window
+    float       min;     // ms
+    float       avg;     // ms
+    float       p95;     // ms
+};
+
+// GPU time of each pass of a chain over the last Window frames it was rendered in, fed by the render thread and
+// read by the UI
+class PassTimings
+{
+public:
+    static constexpr int Window = 240;
+
+    // new chain or sizes, forgets all samples
+    void Reset(const std::vector<std::string>& names);
+
+    void AddFrame(const std::vector<PassTimestamps>& timestamps, uint64_t frequency);
+
+    std::vector<PassCost> Costs() const;
+
+    static void WriteCsv(std::ostream& out, const std::vector<PassCost>& costs);
+
+private:
+    struct PassSamples
+    {
+        std::string        name;
+        std::vector<float> samples; // ring of the latest Window
+        int                next {0};
+    };
+
+    mutable std::mutex       m_mutex;
+    std::vector<PassSamples> m_passes;
+};
@@ -0,0 +1,48 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "PresetCost.h"
+#include "DXBC.h"
+#include "PassChain.h"
+
+float PresetCost::Estimate(const std::vector<const ShaderDef*>& shaderDefs)
+{
+    const float outputPixels = static_cast<float>(OutputWidth) * OutputHeight;
+    float       sourceWidth  = static_cast<float>(OutputWidth) / InputScale;
+    float       sourceHeight = static_cast<float>(OutputHeight) / InputScale;
+    float       cost         = 0.0f;
+    for(size_t p = 0; p < shaderDefs.size(); p++)
+    {
+        const auto& shaderDef = *shaderDefs[p];
+        ShaderCost  shaderCost;
+        if(!DXBC::Cost(shaderDef.FragmentByteCode, shaderDef.FragmentLength, shaderCost))
+            return 0.0f;
+
+        // last pass renders to the viewport
+        auto width  = static_cast<float>(OutputWidth);
+        auto height = static_cast<float>(OutputHeight);
+        if(p != shaderDefs.size() - 1)
+            PassChain::Size(PassChain::Options(shaderDef), sourceWidth, sourceHeight, static_cast<float>(OutputWidth), static_cast<float>(OutputHeight), 1.0f, width, height);
+        cost += shaderCost.weighted * (width * height / outputPixels);
+        sourceWidth  = width;
+        sourceHeight = height;
+    }
+    return cost;
+}
+
+float PresetCost::Of(const PresetDef& presetDef)
+{
+    if(presetDef.Cost > 0.0f)
+        return presetDef.Cost;
+
+    std::vector<const ShaderDef*> shaderDefs;
+    for(const auto& sd : presetDef.ShaderDefs)
+        shaderDefs.push_back(&sd);
+    return shaderDefs.empty() ? 0.0f : Estimate(shaderDefs);
+}
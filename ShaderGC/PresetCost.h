@@ -0,0 +1,28 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include "PresetDef.h"
+
+// expected GPU cost of a preset in weighted instructions per pixel of output, from the static cost of each pass's pixel
+// shader times the pixels it renders relative to the output; passes are sized as PassChain does, from an input of
+// 1/InputScale of the output, which is what the default pixel size captures
+class PresetCost
+{
+public:
+    static constexpr int OutputWidth  = 1920;
+    static constexpr int OutputHeight = 1080;
+    static constexpr int InputScale   = 3;
+
+    // 0 if any pass has no bytecode which could be parsed
+    static float Estimate(const std::vector<const ShaderDef*>& shaderDefs);
+
+    // the catalog value if the preset was generated with one, otherwise estimated from its passes; presets built on
+    // the render thread must not be passed here unless they already carry a cost
+    static float Of(const PresetDef& presetDef);
+};
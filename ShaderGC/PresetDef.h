@@ -14,7 +14,7 @@ GNU General Public License v3.0
 class PresetDef
 {
 public:
-    PresetDef() : ShaderDefs {}, TextureDefs {}, Overrides {}, Name {}, Category {}, ImportPath {} { }
+    PresetDef() : ShaderDefs {}, TextureDefs {}, Overrides {}, Name {}, Category {}, ImportPath {}, Cost {0.0f} { }
 
     virtual void Build() { }
 
@@ -37,4 +37,5 @@ public:
     std::string                Name;
     std::string                Category;
     std::filesystem::path      ImportPath;
+    float                      Cost; // see PresetCost, 0 if not known
 };
\ No newline at end of file
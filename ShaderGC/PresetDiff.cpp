@@ -0,0 +1,154 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "PresetDiff.h"
+#include "PassGraph.h"
+#include "ShaderCache.h"
+#include "sha256.h"
+
+#include <algorithm>
+
+static void HashBytes(SHA256_CTX& ctx, const void* data, size_t size)
+{
+    // length first so adjacent fields can't run into each other
+    uint64_t length = size;
+    sha256_update(&ctx, (const BYTE*)&length, sizeof(length));
+    if(size)
+        sha256_update(&ctx, (const BYTE*)data, size);
+}
+
+static void HashString(SHA256_CTX& ctx, const std::string& value)
+{
+    HashBytes(ctx, value.data(), value.size());
+}
+
+static std::vector<uint32_t> FinalHash(SHA256_CTX& ctx)
+{
+    std::vector<uint32_t> buffer;
+    buffer.resize(HASH_LEN);
+    sha256_final(&ctx, (BYTE*)buffer.data());
+    return buffer;
+}
+
+static const TextureDef* FindTexture(const PresetDef& presetDef, const std::string& name)
+{
+    for(const auto& t : presetDef.TextureDefs)
+    {
+        auto it = t.PresetParams.find("name");
+        if(it != t.PresetParams.end() && it->second == name)
+            return &t;
+    }
+    return nullptr;
+}
+
+std::vector<uint32_t> PresetDiff::PassHash(const ShaderDef& shaderDef)
+{
+    SHA256_CTX ctx;
+    sha256_init(&ctx);
+    if(shaderDef.VertexLength)
+    {
+        HashBytes(ctx, shaderDef.VertexByteCode, shaderDef.VertexLength);
+        HashBytes(ctx, shaderDef.FragmentByteCode, shaderDef.FragmentLength);
+    }
+    else
+    {
+        // compiled on first use, same source gives the same bytecode
+        HashString(ctx, shaderDef.VertexSource ? shaderDef.VertexSource : "");
+        HashString(ctx, shaderDef.FragmentSource ? shaderDef.FragmentSource : "");
+    }
+    HashString(ctx, shaderDef.Format ? shaderDef.Format : "");
+    for(const auto& pp : shaderDef.PresetParams)
+    {
+        HashString(ctx, pp.first);
+        HashString(ctx, pp.second);
+    }
+    for(const auto& p : shaderDef.Params)
+    {
+        HashString(ctx, p.name);
+        HashBytes(ctx, &p.defaultValue, sizeof(p.defaultValue));
+    }
+    return FinalHash(ctx);
+}
+
+std::vector<uint32_t> PresetDiff::TextureHash(const TextureDef& textureDef)
+{
+    SHA256_CTX ctx;
+    sha256_init(&ctx);
+    HashBytes(ctx, textureDef.Data, textureDef.Data ? textureDef.DataLength : 0);
+    for(const auto& pp : textureDef.PresetParams)
+    {
+        HashString(ctx, pp.first);
+        HashString(ctx, pp.second);
+    }
+    return FinalHash(ctx);
+}
+
+PresetDiff::PresetDiff(const PresetDef& from, const PresetDef& to) : m_sharedPasses {0}, m_sharedTextures {}
+{
+    for(const auto& t : to.TextureDefs)
+    {
+        auto name = t.PresetParams.find("name");
+        if(name == t.PresetParams.end())
+            continue;
+
+        auto previous = FindTexture(from, name->second);
+        if(previous && TextureHash(*previous) == TextureHash(t))
+            m_sharedTextures.push_back(name->second);
+    }
+
+    // a pass is shared if it and all passes before it are, the last pass is sized to the viewport so it
+    // can only match another last pass
+    const auto fromLast = static_cast<int>(from.ShaderDefs.size()) - 1;
+    const auto toLast   = static_cast<int>(to.ShaderDefs.size()) - 1;
+    for(int p = 0; p <= std::min(fromLast, toLast); p++)
+    {
+        const auto& fromDef = from.ShaderDefs[p];
+        const auto& toDef   = to.ShaderDefs[p];
+        if((p == fromLast) != (p == toLast))
+            break;
+        if(PassHash(fromDef) != PassHash(toDef))
+            break;
+
+        auto sameTextures = true;
+        for(const auto& sampler : toDef.Samplers)
+        {
+            if((FindTexture(from, sampler.name) || FindTexture(to, sampler.name)) && !SharesTexture(sampler.name))
+                sameTextures = false;
+        }
+        if(!sameTextures)
+            break;
+
+        m_sharedPasses = p + 1;
+    }
+
+    // feedback from a later pass which differs changes the output too
+    std::vector<const ShaderDef*> shaderDefs;
+    for(const auto& s : to.ShaderDefs)
+        shaderDefs.push_back(&s);
+    PassGraph graph(shaderDefs);
+    for(auto shrunk = true; shrunk;)
+    {
+        shrunk = false;
+        for(int p = 0; p < m_sharedPasses; p++)
+        {
+            const auto& feedbacks = graph.Nodes()[p].feedbacks;
+            if(std::any_of(feedbacks.begin(), feedbacks.end(), [this](int f) { return f >= m_sharedPasses; }))
+            {
+                m_sharedPasses = p;
+                shrunk         = true;
+                break;
+            }
+        }
+    }
+}
+
+bool PresetDiff::SharesTexture(const std::string& name) const
+{
+    return std::find(m_sharedTextures.begin(), m_sharedTextures.end(), name) != m_sharedTextures.end();
+}
@@ -0,0 +1,43 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include "PresetDef.h"
+
+// what two presets have in common, so switching from one to the other only rebuilds what differs
+class PresetDiff
+{
+public:
+    PresetDiff() : m_sharedPasses {0}, m_sharedTextures {} { }
+    PresetDiff(const PresetDef& from, const PresetDef& to);
+
+    // leading passes which render the same output in both presets given the same input and param values,
+    // they can keep their state and targets; ShaderGlass keeps their outputs too and doesn't render them after
+    // a switch until the input, their sizes or their param values change
+    int SharedPasses() const
+    {
+        return m_sharedPasses;
+    }
+
+    // textures with the same name, contents and sampling in both presets
+    const std::vector<std::string>& SharedTextures() const
+    {
+        return m_sharedTextures;
+    }
+
+    bool SharesTexture(const std::string& name) const;
+
+    // covers bytecode (or source if not compiled yet), format, preset params and param defaults
+    static std::vector<uint32_t> PassHash(const ShaderDef& shaderDef);
+    // covers image data and preset params
+    static std::vector<uint32_t> TextureHash(const TextureDef& textureDef);
+
+private:
+    int                      m_sharedPasses;
+    std::vector<std::string> m_sharedTextures;
+};
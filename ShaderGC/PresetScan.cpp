@@ -0,0 +1,280 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "PresetScan.h"
+#include "ShaderGC.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <sstream>
+#include <thread>
+
+static bool IsWord(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+// removes block and line comments, an open block comment carries over to the next line
+static std::string StripComments(const std::string& line, bool& inComment)
+{
+    std::string code;
+    for(size_t i = 0; i < line.size(); i++)
+    {
+        if(inComment)
+        {
+            if(line.compare(i, 2, "*/") == 0)
+            {
+                inComment = false;
+                i++;
+            }
+        }
+        else if(line.compare(i, 2, "/*") == 0)
+        {
+            inComment = true;
+            code += ' ';
+            i++;
+        }
+        else if(line.compare(i, 2, "//") == 0)
+        {
+            break;
+        }
+        else
+        {
+            code += line[i];
+        }
+    }
+    return code;
+}
+
+// uniform sampler declarations with the binding of their layout qualifier, which may be on an earlier line
+static void AddSamplers(const std::string& code, std::vector<SourceShaderSampler>& samplers)
+{
+    std::vector<std::string> tokens;
+    for(size_t i = 0; i < code.size();)
+    {
+        if(IsWord(code[i]))
+        {
+            auto end = i;
+            while(end < code.size() && IsWord(code[end]))
+                end++;
+            tokens.push_back(code.substr(i, end - i));
+            i = end;
+        }
+        else
+        {
+            if(!std::isspace(static_cast<unsigned char>(code[i])))
+                tokens.emplace_back(1, code[i]);
+            i++;
+        }
+    }
+
+    int binding = -1;
+    for(size_t t = 0; t < tokens.size(); t++)
+    {
+        const auto& token = tokens[t];
+        if(token == ";" || token == "{" || token == "}")
+        {
+            binding = -1;
+        }
+        else if(token == "binding" && t + 2 < tokens.size() && tokens[t + 1] == "=" && std::isdigit(static_cast<unsigned char>(tokens[t + 2][0])))
+        {
+            binding = atoi(tokens[t + 2].c_str());
+        }
+        else if(token == "uniform" && t + 2 < tokens.size() && tokens[t + 1].starts_with("sampler") && IsWord(tokens[t + 2][0]))
+        {
+            const auto& name = tokens[t + 2];
+            if(std::none_of(samplers.begin(), samplers.end(), [&](const auto& s) { return s.name == name; }))
+                samplers.emplace_back(name, binding);
+        }
+    }
+}
+
+std::vector<SourceShaderParam> ScannedPreset::Params() const
+{
+    std::vector<SourceShaderParam> params;
+    for(const auto& pass : passes)
+    {
+        for(const auto& param : pass.shader->params)
+        {
+            if(std::none_of(params.begin(), params.end(), [&](const auto& p) { return p.name == param.name; }))
+                params.push_back(param);
+        }
+    }
+    for(const auto& o : overrides)
+    {
+        for(auto& p : params)
+        {
+            if(p.name == o.name)
+                p.def = o.def;
+        }
+    }
+    return params;
+}
+
+void PresetScanner::ScanSource(const std::vector<std::string>& source, ScannedShader& shader)
+{
+    // only lines which can be part of a sampler declaration are tokenized, others just end the statement
+    std::string fragment;
+    bool        isFragment = true, inComment = false;
+    for(const auto& line : source)
+    {
+        auto trimLine = trim(line);
+        if(line.starts_with("#pragma parameter"))
+        {
+            auto param = SourceShaderParam(line, 1, 0);
+            if(std::none_of(shader.params.begin(), shader.params.end(), [&](const auto& p) { return p.name == param.name; }))
+                shader.params.push_back(param);
+            continue;
+        }
+        else if(line.starts_with("#pragma stage vertex"))
+        {
+            isFragment = false;
+            inComment  = false;
+            continue;
+        }
+        else if(line.starts_with("#pragma stage fragment"))
+        {
+            isFragment = true;
+            inComment  = false;
+            continue;
+        }
+        else if(trimLine.starts_with("#pragma format"))
+        {
+            shader.format = trim(trimLine.substr(14));
+            continue;
+        }
+        else if(trimLine.starts_with("#pragma name"))
+        {
+            shader.name = trim(trimLine.substr(12));
+            continue;
+        }
+        if(!isFragment || trimLine.starts_with("#"))
+            continue;
+
+        const auto code = StripComments(line, inComment);
+        if(code.find("uniform") != std::string::npos || code.find("layout") != std::string::npos)
+            fragment += code + '\n';
+        else if(code.find_first_of(";{}") != std::string::npos)
+            fragment += ";\n";
+    }
+    AddSamplers(fragment, shader.samplers);
+}
+
+std::shared_ptr<const ScannedShader> PresetScanner::Shader(const std::filesystem::path& path)
+{
+    const auto normalPath = path.lexically_normal();
+    {
+        std::unique_lock lock(m_mutex);
+        auto             existing = m_shaders.find(normalPath);
+        if(existing != m_shaders.end())
+            return existing->second;
+    }
+
+    // read without the lock, a shader two threads read at once is kept from the first one
+    auto shader  = std::make_shared<ScannedShader>();
+    shader->path = normalPath;
+    try
+    {
+        ScanSource(ShaderGC::LoadSource(normalPath, true), *shader);
+    }
+    catch(std::exception& e)
+    {
+        shader->error = e.what();
+    }
+
+    std::unique_lock lock(m_mutex);
+    return m_shaders.emplace(normalPath, shader).first->second;
+}
+
+size_t PresetScanner::Shaders() const
+{
+    std::unique_lock lock(m_mutex);
+    return m_shaders.size();
+}
+
+ScannedPreset PresetScanner::Scan(const std::filesystem::path& path)
+{
+    ScannedPreset preset;
+    preset.path = path.lexically_normal();
+    try
+    {
+        if(_stricmp(preset.path.extension().string().c_str(), ".slang") == 0)
+        {
+            preset.passes.push_back(ScannedPass {Shader(preset.path), {}});
+        }
+        else
+        {
+            SourcePresetDef    sp(preset.path, SourceShaderInfo());
+            std::ostringstream log;
+            bool               warn = false;
+            ShaderGC::ProcessSourcePreset(sp, log, warn);
+            for(auto& s : sp.shaders)
+                preset.passes.push_back(ScannedPass {Shader(s.input), std::move(s.presetParams)});
+            preset.textures  = std::move(sp.textures);
+            preset.overrides = std::move(sp.overrides);
+        }
+
+        for(const auto& pass : preset.passes)
+        {
+            if(!pass.shader->error.empty())
+            {
+                preset.error = pass.shader->error;
+                break;
+            }
+        }
+    }
+    catch(std::exception& e)
+    {
+        preset.error = e.what();
+    }
+    catch(...)
+    {
+        preset.error = "Internal error";
+    }
+    return preset;
+}
+
+std::vector<ScannedPreset> PresetScanner::ScanDirectory(const std::filesystem::path& root, unsigned jobs, const std::function<void(size_t, size_t)>& progress)
+{
+    std::vector<std::filesystem::path> inputs;
+    std::error_code                    ec;
+    for(std::filesystem::recursive_directory_iterator p(root.lexically_normal(), std::filesystem::directory_options::skip_permission_denied, ec), end; !ec && p != end;
+        p.increment(ec))
+    {
+        if(p->path().extension() == ".slangp" && p->is_regular_file(ec))
+            inputs.push_back(p->path().lexically_normal());
+    }
+    std::sort(inputs.begin(), inputs.end());
+
+    std::vector<ScannedPreset> presets(inputs.size());
+    std::atomic<size_t>        next {0};
+    size_t                     done = 0;
+    std::mutex                 progressMutex;
+    auto                       worker = [&]() {
+        for(auto i = next++; i < inputs.size(); i = next++)
+        {
+            presets[i] = Scan(inputs[i]);
+
+            std::unique_lock lock(progressMutex);
+            done++;
+            if(progress)
+                progress(done, inputs.size());
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for(unsigned j = 1; j < std::min<size_t>(jobs, inputs.size()); j++)
+        workers.emplace_back(worker);
+    worker();
+    for(auto& w : workers)
+        w.join();
+
+    return presets;
+}
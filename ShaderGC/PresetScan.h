@@ -0,0 +1,76 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include "SourceDefs.h"
+
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// declarations of one .slang file with its includes, as read from the source
+struct ScannedShader
+{
+    std::filesystem::path            path;
+    std::string                      name; // #pragma name, empty if not set
+    std::string                      format; // #pragma format, empty for the default
+    std::vector<SourceShaderParam>   params; // #pragma parameter, first declaration of each name
+    std::vector<SourceShaderSampler> samplers; // fragment stage, binding -1 if not given
+    std::string                      error; // why the source could not be read
+};
+
+struct ScannedPass
+{
+    std::shared_ptr<const ScannedShader> shader;
+    std::map<std::string, std::string>   presetParams;
+};
+
+// what a preset declares without compiling it; samplers and params are all those declared, the compiled preset
+// keeps only the ones the shaders use
+struct ScannedPreset
+{
+    std::filesystem::path          path;
+    std::vector<ScannedPass>       passes;
+    std::vector<SourceTextureDef>  textures; // not loaded, data is empty
+    std::vector<SourceShaderParam> overrides;
+    std::string                    error; // set if the preset or one of its shaders could not be read, the rest may be partial
+
+    // params of all passes as the compiled preset lists them, first declaration of each name with preset overrides applied
+    std::vector<SourceShaderParam> Params() const;
+};
+
+// metadata of .slangp and .slang files parsed straight from the preset graph and the preprocessed GLSL, without
+// glslang, SPIRV-Cross or FXC; shaders are read once per scanner and shared by presets referencing them, so make
+// a new one to pick up changed files; thread-safe
+class PresetScanner
+{
+public:
+    // never throws, errors are recorded in the preset
+    ScannedPreset Scan(const std::filesystem::path& path);
+
+    // every .slangp under root sorted by path on up to jobs threads; progress is called with files done out of
+    // files found, one call at a time from the worker threads
+    std::vector<ScannedPreset> ScanDirectory(const std::filesystem::path& root, unsigned jobs, const std::function<void(size_t, size_t)>& progress = {});
+
+    // cached by normalized path
+    std::shared_ptr<const ScannedShader> Shader(const std::filesystem::path& path);
+
+    // number of distinct shaders read
+    size_t Shaders() const;
+
+    // declarations of preprocessed source lines, as ShaderGC::ProcessSourceShader finds them
+    static void ScanSource(const std::vector<std::string>& source, ScannedShader& shader);
+
+private:
+    mutable std::mutex                                                    m_mutex;
+    std::map<std::filesystem::path, std::shared_ptr<const ScannedShader>> m_shaders;
+};
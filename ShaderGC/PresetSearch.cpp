@@ -0,0 +1,319 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "PresetSearch.h"
+
+#include <algorithm>
+#include <cctype>
+
+// by field, the name also goes in as one word so "crtguest" finds crt-guest-advanced
+static const float sNameWeight        = 10.0f;
+static const float sCategoryWeight    = 4.0f;
+static const float sPassWeight        = 3.0f;
+static const float sParamWeight       = 2.0f;
+static const float sDescriptionWeight = 1.0f;
+
+// of a term by how it matches a query word, prefix and inside matches grow with the share of the term covered
+static const float sExactMatch    = 1.0f;
+static const float sPrefixMatch   = 0.6f;
+static const float sInsideMatch   = 0.4f;
+static const float sSimilarMatch  = 0.3f;
+static const float sMinSimilarity = 0.4f; // of trigram sets, for words which match nothing otherwise
+
+static std::vector<uint32_t> Trigrams(const std::string& word)
+{
+    std::vector<uint32_t> trigrams;
+    for(size_t i = 0; i + 3 <= word.size(); i++)
+        trigrams.push_back(static_cast<uint8_t>(word[i]) << 16 | static_cast<uint8_t>(word[i + 1]) << 8 | static_cast<uint8_t>(word[i + 2]));
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
+
+static std::string Join(const std::vector<std::string>& words, const char* separator)
+{
+    std::string joined;
+    for(const auto& word : words)
+    {
+        if(!joined.empty())
+            joined += separator;
+        joined += word;
+    }
+    return joined;
+}
+
+std::vector<std::string> PresetSearch::Words(const std::string& text)
+{
+    // bytes above ASCII are kept as letters so names in other scripts can still be found
+    std::vector<std::string> words;
+    std::string              word;
+    for(auto c : text)
+    {
+        const auto u = static_cast<unsigned char>(c);
+        if(std::isalnum(u) || u >= 0x80)
+        {
+            word += static_cast<char>(u < 0x80 ? std::tolower(u) : u);
+        }
+        else if(!word.empty())
+        {
+            words.push_back(word);
+            word.clear();
+        }
+    }
+    if(!word.empty())
+        words.push_back(word);
+    return words;
+}
+
+void PresetSearch::Index(uint32_t entry, const std::string& word, float weight)
+{
+    auto term = m_dictionary.find(word);
+    if(term == m_dictionary.end())
+    {
+        const auto id       = static_cast<uint32_t>(m_terms.size());
+        const auto trigrams = Trigrams(word);
+        for(auto trigram : trigrams)
+            m_trigrams[trigram].push_back(id);
+        m_terms.push_back(word);
+        m_termTrigrams.push_back(static_cast<uint32_t>(trigrams.size()));
+        m_postings.emplace_back();
+        term = m_dictionary.emplace(word, id).first;
+    }
+
+    auto& postings = m_postings[term->second];
+    if(!postings.empty() && postings.back().entry == entry)
+        postings.back().weight = std::max(postings.back().weight, weight);
+    else
+        postings.push_back(Posting {entry, weight});
+}
+
+void PresetSearch::Add(uint32_t id, const SearchDocument& document)
+{
+    Remove(id);
+
+    const auto entry = static_cast<uint32_t>(m_entries.size());
+    const auto name  = Words(document.name);
+    m_entries.push_back(Entry {id, Join(name, " "), false});
+    m_ids[id] = entry;
+
+    for(const auto& word : name)
+        Index(entry, word, sNameWeight);
+    if(name.size() > 1)
+        Index(entry, Join(name, ""), sNameWeight);
+    for(const auto& word : Words(document.category))
+        Index(entry, word, sCategoryWeight);
+    for(const auto& pass : document.passes)
+    {
+        for(const auto& word : Words(pass))
+            Index(entry, word, sPassWeight);
+    }
+    for(const auto& param : document.params)
+    {
+        for(const auto& word : Words(param))
+            Index(entry, word, sParamWeight);
+    }
+    for(const auto& description : document.descriptions)
+    {
+        for(const auto& word : Words(description))
+            Index(entry, word, sDescriptionWeight);
+    }
+}
+
+void PresetSearch::Remove(uint32_t id)
+{
+    // postings of a removed entry stay and are skipped
+    auto existing = m_ids.find(id);
+    if(existing != m_ids.end())
+    {
+        m_entries[existing->second].removed = true;
+        m_ids.erase(existing);
+    }
+}
+
+size_t PresetSearch::Size() const
+{
+    return m_ids.size();
+}
+
+std::vector<std::pair<uint32_t, float>> PresetSearch::Match(const std::string& word) const
+{
+    std::vector<std::pair<uint32_t, float>> terms;
+    const auto                              share = [&](uint32_t term) { return static_cast<float>(word.size()) / m_terms[term].size(); };
+
+    for(auto term = m_dictionary.lower_bound(word); term != m_dictionary.end() && term->first.starts_with(word); term++)
+    {
+        if(term->first.size() == word.size())
+            terms.emplace_back(term->second, sExactMatch);
+        else
+            terms.emplace_back(term->second, sPrefixMatch + (sExactMatch - sPrefixMatch) * 0.5f * share(term->second));
+    }
+
+    const auto trigrams = Trigrams(word);
+    if(trigrams.empty())
+        return terms;
+
+    // terms having every trigram of the word, rarest trigram first
+    std::vector<const std::vector<uint32_t>*> lists;
+    for(auto trigram : trigrams)
+    {
+        auto list = m_trigrams.find(trigram);
+        if(list != m_trigrams.end())
+            lists.push_back(&list->second);
+    }
+    if(lists.size() == trigrams.size())
+    {
+        std::sort(lists.begin(), lists.end(), [](const auto* l1, const auto* l2) { return l1->size() < l2->size(); });
+        for(auto term : *lists[0])
+        {
+            if(std::all_of(lists.begin() + 1, lists.end(), [&](const auto* list) { return std::binary_search(list->begin(), list->end(), term); }))
+            {
+                const auto& text = m_terms[term];
+                if(!text.starts_with(word) && text.find(word) != std::string::npos)
+                    terms.emplace_back(term, sInsideMatch + (sPrefixMatch - sInsideMatch) * 0.5f * share(term));
+            }
+        }
+    }
+    if(!terms.empty() || word.size() < 4)
+        return terms;
+
+    // no term contains the word, take those sharing most of its trigrams
+    std::unordered_map<uint32_t, uint32_t> shared;
+    for(const auto* list : lists)
+    {
+        for(auto term : *list)
+            shared[term]++;
+    }
+    for(const auto& s : shared)
+    {
+        const auto similarity = static_cast<float>(s.second) / (trigrams.size() + m_termTrigrams[s.first] - s.second);
+        if(similarity >= sMinSimilarity)
+            terms.emplace_back(s.first, sSimilarMatch * similarity);
+    }
+    return terms;
+}
+
+std::vector<SearchResult> PresetSearch::Find(const std::string& query, size_t limit) const
+{
+    std::vector<SearchResult> results;
+    const auto                words = Words(query);
+    if(words.empty() || !limit)
+        return results;
+
+    // entries have to match every word, each adding the score of its best matching term
+    std::vector<float>    scores(m_entries.size(), 0.0f);
+    std::vector<float>    best(m_entries.size(), 0.0f);
+    std::vector<uint32_t> matched(m_entries.size(), 0);
+    std::vector<uint32_t> touched;
+    for(uint32_t w = 0; w < words.size(); w++)
+    {
+        for(const auto& term : Match(words[w]))
+        {
+            for(const auto& posting : m_postings[term.first])
+            {
+                if(matched[posting.entry] != w)
+                    continue;
+                if(best[posting.entry] == 0.0f)
+                    touched.push_back(posting.entry);
+                best[posting.entry] = std::max(best[posting.entry], term.second * posting.weight);
+            }
+        }
+        if(touched.empty())
+            return results;
+        for(auto entry : touched)
+        {
+            scores[entry] += best[entry];
+            best[entry] = 0.0f;
+            matched[entry]++;
+        }
+        touched.clear();
+    }
+
+    // ids are entries until the results are sorted
+    const auto phrase = Join(words, " ");
+    for(uint32_t entry = 0; entry < m_entries.size(); entry++)
+    {
+        const auto& e = m_entries[entry];
+        if(matched[entry] != words.size() || e.removed)
+            continue;
+        auto score = scores[entry];
+        if(e.name == phrase)
+            score += 2.0f * sNameWeight;
+        else if(e.name.starts_with(phrase))
+            score += sNameWeight;
+        results.push_back(SearchResult {entry, score});
+    }
+
+    // shorter names first among equal scores, so "crt-geom" comes before "crt-geom-deluxe"
+    const auto better = [&](const SearchResult& r1, const SearchResult& r2) {
+        if(r1.score != r2.score)
+            return r1.score > r2.score;
+        const auto& n1 = m_entries[r1.id].name;
+        const auto& n2 = m_entries[r2.id].name;
+        if(n1.size() != n2.size())
+            return n1.size() < n2.size();
+        return n1 < n2;
+    };
+    if(results.size() > limit)
+    {
+        std::partial_sort(results.begin(), results.begin() + limit, results.end(), better);
+        results.resize(limit);
+    }
+    else
+    {
+        std::sort(results.begin(), results.end(), better);
+    }
+    for(auto& result : results)
+        result.id = m_entries[result.id].id;
+    return results;
+}
+
+SearchDocument PresetSearch::Document(const PresetDef& presetDef)
+{
+    SearchDocument document;
+    document.name     = presetDef.Name;
+    document.category = presetDef.Category;
+
+    // built-in presets are built on the render thread when first used, only imported ones have their passes already
+    if(presetDef.ImportPath.empty())
+        return document;
+
+    for(const auto& sd : presetDef.ShaderDefs)
+    {
+        // imported shaders are named after their file
+        auto name = sd.Name;
+        if(name.ends_with(".slang"))
+            name.resize(name.size() - 6);
+        document.passes.push_back(name);
+
+        // built-in ones like MVP have no description
+        for(const auto& p : sd.Params)
+        {
+            if(p.description.empty() || std::find(document.params.begin(), document.params.end(), p.name) != document.params.end())
+                continue;
+            document.params.push_back(p.name);
+            document.descriptions.push_back(p.description);
+        }
+    }
+    return document;
+}
+
+SearchDocument PresetSearch::Document(const ScannedPreset& preset)
+{
+    SearchDocument document;
+    document.name     = preset.path.stem().string();
+    document.category = preset.path.parent_path().filename().string();
+    for(const auto& pass : preset.passes)
+        document.passes.push_back(pass.shader->path.stem().string());
+    for(const auto& p : preset.Params())
+    {
+        document.params.push_back(p.name);
+        document.descriptions.push_back(p.desc);
+    }
+    return document;
+}
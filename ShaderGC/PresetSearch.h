@@ -0,0 +1,87 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include "PresetDef.h"
+#include "PresetScan.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// searchable text of a preset
+struct SearchDocument
+{
+    std::string              name;
+    std::string              category;
+    std::vector<std::string> passes; // shader names
+    std::vector<std::string> params;
+    std::vector<std::string> descriptions; // of params
+};
+
+struct SearchResult
+{
+    uint32_t id;
+    float    score;
+};
+
+// typeahead over preset names, categories, pass shader names and parameter names and descriptions; every word of
+// the query has to match a word of the preset exactly, as a prefix or, from three letters on, anywhere inside it
+// through a trigram index, and a word matching nothing falls back to words sharing most of its trigrams to cover
+// typos; presets can be added and replaced at any time
+class PresetSearch
+{
+public:
+    // replaces the document of an id added before
+    void   Add(uint32_t id, const SearchDocument& document);
+    void   Remove(uint32_t id);
+    size_t Size() const;
+
+    // best first; a match in the name ranks above the category, pass names, param names and descriptions in that order,
+    // then exact above prefix above inside matches, and names starting with the query come first
+    std::vector<SearchResult> Find(const std::string& query, size_t limit) const;
+
+    // by name and category, and for an imported preset its passes, params and descriptions too; built-in presets are
+    // only built on the render thread, so theirs aren't read
+    static SearchDocument Document(const PresetDef& presetDef);
+
+    // named after its file, in the category of its folder
+    static SearchDocument Document(const ScannedPreset& preset);
+
+    // lowercase words, anything but letters and digits separates them
+    static std::vector<std::string> Words(const std::string& text);
+
+private:
+    struct Posting
+    {
+        uint32_t entry;
+        float    weight; // of the best field the term is in
+    };
+
+    struct Entry
+    {
+        uint32_t    id;
+        std::string name; // words joined by spaces
+        bool        removed;
+    };
+
+    void Index(uint32_t entry, const std::string& word, float weight);
+
+    // terms matching a query word with how well they match, up to 1 for the word itself
+    std::vector<std::pair<uint32_t, float>> Match(const std::string& word) const;
+
+    std::vector<Entry>                                  m_entries;
+    std::unordered_map<uint32_t, uint32_t>              m_ids; // to the live entry
+    std::vector<std::string>                            m_terms;
+    std::vector<uint32_t>                               m_termTrigrams; // distinct trigrams of each term
+    std::vector<std::vector<Posting>>                   m_postings; // of each term, by entry
+    std::map<std::string, uint32_t>                     m_dictionary; // sorted for prefix ranges
+    std::unordered_map<uint32_t, std::vector<uint32_t>> m_trigrams; // to terms containing them, ascending
+};
@@ -0,0 +1,140 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "QualityController.h"
+
+// cheapest levers first: intermediate passes, then frame rate, then input resolution
+static const std::vector<QualityLevel> qualityLevels = {{1.0f, 1.0f, 0},
+                                                        {1.0f, 0.75f, 0},
+                                                        {1.0f, 0.5f, 0},
+                                                        {1.0f, 0.5f, 1},
+                                                        {1.5f, 0.5f, 1},
+                                                        {2.0f, 0.5f, 1},
+                                                        {2.0f, 0.5f, 2}};
+
+// longest wait before retrying a failed level is upgradeFrames << maxBackoff
+static const int maxBackoff = 4;
+
+// changes kept for the log, a session runs for days
+static const size_t maxChanges = 64;
+
+QualityController::QualityController() : QualityController(QualitySettings {}) { }
+
+QualityController::QualityController(const QualitySettings& settings) : m_settings {settings}
+{
+    Reset();
+}
+
+void QualityController::Reset()
+{
+    m_level        = 0;
+    m_frame        = 0;
+    m_settle       = 0;
+    m_overFrames   = 0;
+    m_underFrames  = 0;
+    m_hasFrameTime = false;
+    m_frameTime    = 0.0f;
+    m_failures.assign(qualityLevels.size(), 0);
+    m_changes.clear();
+    m_changeCount = 0;
+}
+
+const std::vector<QualityLevel>& QualityController::Levels()
+{
+    return qualityLevels;
+}
+
+void QualityController::SetRefreshRate(float refreshRate)
+{
+    if(refreshRate > 0.0f)
+        m_settings.refreshRate = refreshRate;
+}
+
+std::vector<QualityChange> QualityController::Changes() const
+{
+    std::vector<QualityChange> changes;
+    for(auto c = m_changeCount - m_changes.size(); c < m_changeCount; c++)
+        changes.push_back(m_changes[c % m_changes.size()]);
+    return changes;
+}
+
+bool QualityController::AddFrame(float frameTime)
+{
+    m_frame++;
+    if(m_settle > 0)
+    {
+        // let the new level take effect before judging it
+        m_settle--;
+        return false;
+    }
+
+    if(m_hasFrameTime)
+    {
+        m_frameTime += m_settings.smoothing * (frameTime - m_frameTime);
+    }
+    else
+    {
+        m_frameTime    = frameTime;
+        m_hasFrameTime = true;
+    }
+
+    const auto budget = Budget();
+    if(m_frameTime > budget * m_settings.degradeRatio)
+    {
+        m_overFrames++;
+        m_underFrames = 0;
+    }
+    else if(m_frameTime < budget * m_settings.upgradeRatio)
+    {
+        m_underFrames++;
+        m_overFrames = 0;
+    }
+    else
+    {
+        m_overFrames  = 0;
+        m_underFrames = 0;
+    }
+
+    if(m_overFrames >= m_settings.degradeFrames && m_level < (int)qualityLevels.size() - 1)
+    {
+        m_failures[m_level]++;
+        ChangeLevel(m_level + 1);
+        return true;
+    }
+
+    if(m_level > 0)
+    {
+        // first failure is expected when stepping down, repeated ones mean oscillation
+        auto backoff = m_failures[m_level - 1] - 1;
+        if(backoff > maxBackoff)
+            backoff = maxBackoff;
+        if(m_underFrames >= (m_settings.upgradeFrames << backoff))
+        {
+            ChangeLevel(m_level - 1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void QualityController::ChangeLevel(int level)
+{
+    const QualityChange change {m_frame, m_level, level, m_frameTime};
+    if(m_changes.size() < maxChanges)
+        m_changes.push_back(change);
+    else
+        m_changes[m_changeCount % maxChanges] = change;
+    m_changeCount++;
+    m_level        = level;
+    m_settle       = m_settings.settleFrames;
+    m_overFrames   = 0;
+    m_underFrames  = 0;
+    m_hasFrameTime = false;
+}
@@ -0,0 +1,100 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+// one step of the quality ladder, relative to user settings
+struct QualityLevel
+{
+    float inputScale; // multiplies pixel size, lowering input resolution
+    float passScale;  // multiplies viewport-scaled intermediate pass sizes
+    int   frameSkip;  // minimum frame skip
+};
+
+struct QualityChange
+{
+    int   frame;     // frame sample which triggered the change
+    int   fromLevel;
+    int   toLevel;
+    float frameTime; // smoothed frame time at the time of change
+};
+
+struct QualitySettings
+{
+    float refreshRate {60.0f};   // of the output in Hz, until the monitor showing it is known
+    float budgetShare {0.75f};   // of the refresh interval to render in, the rest is left for capture and composition
+    float degradeRatio {1.1f};   // step down when above this fraction of budget
+    float upgradeRatio {0.7f};   // step up when below this fraction of budget
+    int   degradeFrames {30};    // consecutive frames over budget before stepping down
+    int   upgradeFrames {180};   // consecutive frames under budget before stepping up
+    int   settleFrames {15};     // frames ignored after a change
+    float smoothing {0.1f};      // weight of a new sample in the moving average
+};
+
+// steps quality down when frame time is over budget and back up when there's headroom,
+// a level that turned out too slow needs longer and longer headroom to be retried
+class QualityController
+{
+public:
+    QualityController();
+    QualityController(const QualitySettings& settings);
+
+    void Reset();
+
+    // feed time of one frame in ms, returns true if level changed
+    bool AddFrame(float frameTime);
+
+    // moves the budget, e.g. when the output moves to another monitor
+    void SetRefreshRate(float refreshRate);
+
+    // target frame time in ms
+    float Budget() const
+    {
+        return m_settings.budgetShare * 1000.0f / m_settings.refreshRate;
+    }
+
+    int Level() const
+    {
+        return m_level;
+    }
+
+    const QualityLevel& Current() const
+    {
+        return Levels()[m_level];
+    }
+
+    float FrameTime() const
+    {
+        return m_frameTime;
+    }
+
+    // latest changes, oldest first
+    std::vector<QualityChange> Changes() const;
+
+    // valid once AddFrame returned true
+    const QualityChange& LastChange() const
+    {
+        return m_changes[(m_changeCount - 1) % m_changes.size()];
+    }
+
+    static const std::vector<QualityLevel>& Levels();
+
+private:
+    void ChangeLevel(int level);
+
+    QualitySettings            m_settings;
+    int                        m_level;
+    int                        m_frame;
+    int                        m_settle;
+    int                        m_overFrames;
+    int                        m_underFrames;
+    bool                       m_hasFrameTime;
+    float                      m_frameTime;
+    std::vector<int>           m_failures;
+    std::vector<QualityChange> m_changes; // ring of the latest ones
+    size_t                     m_changeCount;
+};
@@ -8,6 +8,7 @@ GNU General Public License v3.0
 #include "pch.h"
 
 #include "SPIRV.h"
+#include "CompileStats.h"
 
 #include "include/spirv_hlsl.hpp"
 #include "include/spirv_reflect.hpp"
@@ -26,9 +27,10 @@ GNU General Public License v3.0
 
 using namespace SPIRV_CROSS_NAMESPACE;
 
-std::pair<std::string, std::string> SPIRV::GenerateHLSL(const std::vector<uint32_t>& bin, bool fragment, std::ostream& log, bool& warn)
+std::pair<std::string, std::string> SPIRV::GenerateHLSL(const std::vector<uint32_t>& bin, bool reflect, std::ostream& log, bool& warn)
 {
     //std::cout << "GenerateHLSL...";
+    CompileStats::Timer timer(CompileStage::SPIRV);
 
     try
     {
@@ -40,7 +42,7 @@ std::pair<std::string, std::string> SPIRV::GenerateHLSL(const std::vector<uint32
         std::string source = hlsl.compile();
 
         std::string metadata;
-        if(fragment)
+        if(reflect)
         {
             CompilerReflection refl(bin);
             metadata = refl.compile();
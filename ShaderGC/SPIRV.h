@@ -10,5 +10,5 @@ GNU General Public License v3.0
 class SPIRV
 {
 public:
-    static std::pair<std::string, std::string> GenerateHLSL(const std::vector<uint32_t>& bin, bool fragment, std::ostream& log, bool& warn);
+    static std::pair<std::string, std::string> GenerateHLSL(const std::vector<uint32_t>& bin, bool reflect, std::ostream& log, bool& warn);
 };
\ No newline at end of file
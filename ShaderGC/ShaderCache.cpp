@@ -12,15 +12,17 @@ GNU General Public License v3.0
 
 std::vector<uint32_t> ShaderCache::CalculateHash(const std::string& source)
 {
-    auto* data = (const uint8_t*)source.data();
-    auto  size = source.size();
+    return CalculateHash(source.data(), source.size());
+}
 
+std::vector<uint32_t> ShaderCache::CalculateHash(const void* data, size_t size)
+{
     std::vector<uint32_t> buffer;
     buffer.resize(HASH_LEN);
     static_assert(HASH_LEN == SHA256_BLOCK_SIZE / 4);
     SHA256_CTX ctx;
     sha256_init(&ctx);
-    sha256_update(&ctx, data, size);
+    sha256_update(&ctx, (const BYTE*)data, size);
     sha256_final(&ctx, (BYTE*)buffer.data());
     return buffer;
 }
@@ -26,6 +26,7 @@ public:
     }
 
     static std::vector<uint32_t> CalculateHash(const std::string& source);
+    static std::vector<uint32_t> CalculateHash(const void* data, size_t size);
 
     const CachedShader* FindCachedShader(const std::string& source) const;
 
@@ -10,7 +10,7 @@ GNU General Public License v3.0
 struct ShaderParam
 {
     ShaderParam(const char* name, int buffer, int offset, int size, float minValue, float maxValue, float defaultValue, float stepValue = 0.0f, const char* description = "") :
-        name {name}, buffer {buffer}, offset {offset}, size {size}, minValue {minValue}, maxValue {maxValue}, defaultValue {defaultValue}, currentValue {defaultValue},
+        name {name}, buffer {buffer}, size {size}, offset {offset}, minValue {minValue}, maxValue {maxValue}, currentValue {defaultValue}, defaultValue {defaultValue},
         stepValue {stepValue}, description {description}
     { }
 
@@ -46,7 +46,8 @@ class ShaderDef
 public:
     ShaderDef() :
         Params {}, Samplers {}, Name {}, VertexSource {}, FragmentSource {}, VertexByteCode {}, FragmentByteCode {}, VertexHash {}, FragmentHash {}, VertexLength {},
-        FragmentLength {}, Format {}, Dynamic {false}
+        FragmentLength {}, VertexSPIRV {}, FragmentSPIRV {}, VertexSPIRVLength {}, FragmentSPIRVLength {}, VertexSPIRVHash {}, FragmentSPIRVHash {}, VertexReflection {},
+        FragmentReflection {}, VertexReflectionLength {}, FragmentReflectionLength {}, Format {}, Dynamic {false}
     { }
 
     std::vector<ShaderParam>           Params;
@@ -61,10 +62,20 @@ public:
     const uint32_t*                    FragmentHash;
     size_t                             VertexLength;
     size_t                             FragmentLength;
+    const uint32_t*                    VertexSPIRV; // null for built-in shaders until the library is regenerated
+    const uint32_t*                    FragmentSPIRV;
+    size_t                             VertexSPIRVLength; // in words
+    size_t                             FragmentSPIRVLength;
+    const uint32_t*                    VertexSPIRVHash; // generated shaders only
+    const uint32_t*                    FragmentSPIRVHash;
+    const uint8_t*                     VertexReflection; // see ShaderReflection
+    const uint8_t*                     FragmentReflection;
+    size_t                             VertexReflectionLength;
+    size_t                             FragmentReflectionLength;
     char*                              Format;
     bool                               Dynamic;
 
-    size_t ParamsSize(int buffer)
+    size_t ParamsSize(int buffer) const
     {
         int maxLen = 0;
         for(const auto& p : Params)
@@ -92,6 +103,10 @@ public:
                 free((void*)VertexByteCode);
             if(FragmentByteCode)
                 free((void*)FragmentByteCode);
+            if(VertexSPIRV)
+                free((void*)VertexSPIRV);
+            if(FragmentSPIRV)
+                free((void*)FragmentSPIRV);
         }
     }
 };
\ No newline at end of file
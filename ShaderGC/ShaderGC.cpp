@@ -12,6 +12,8 @@ GNU General Public License v3.0
 #include "GLSL.h"
 #include "HLSL.h"
 #include "SPIRV.h"
+#include "CompileStats.h"
+#include "PresetCost.h"
 
 #include "json.hpp"
 
@@ -32,6 +34,13 @@ static uint8_t* CopyVector(const std::vector<uint8_t>& d)
     return copy;
 }
 
+static uint32_t* CopyVector(const std::vector<uint32_t>& d)
+{
+    auto copy = new uint32_t[d.size()];
+    memcpy(copy, d.data(), d.size() * sizeof(uint32_t));
+    return copy;
+}
+
 ShaderDef ShaderGC::CompileSourceShader(SourceShaderDef& def, ostream& log, bool& warn, const ShaderCache& cache)
 {
     // convert GLSL to SPIRV
@@ -79,6 +88,12 @@ ShaderDef ShaderGC::CompileSourceShader(SourceShaderDef& def, ostream& log, bool
     sd.FragmentLength   = fragmentDXBC.size();
     sd.Name             = def.input.filename().string();
 
+    // kept for the software renderer
+    sd.VertexSPIRV         = CopyVector(vertexSPIRV);
+    sd.VertexSPIRVLength   = vertexSPIRV.size();
+    sd.FragmentSPIRV       = CopyVector(fragmentSPIRV);
+    sd.FragmentSPIRVLength = fragmentSPIRV.size();
+
     for(const auto& p : def.params)
     {
         sd.Params.push_back(ShaderParam(CopyString(p.name), p.buffer, p.offset, p.size, p.min, p.max, p.def, p.step, CopyString(p.desc)));
@@ -111,6 +126,7 @@ PresetDef* ShaderGC::CompileShader(std::filesystem::path source, ostream& log, b
     pdef->Category = "Imported";
     pdef->ShaderDefs.push_back(shaderDef);
     pdef->ImportPath = source;
+    pdef->Cost       = PresetCost::Of(*pdef);
 
     return pdef;
 }
@@ -145,8 +161,10 @@ vector<string> ShaderGC::LoadSource(const filesystem::path& input, bool followIn
     return lines;
 }
 
-void ShaderGC::ProcessSourceShader(SourceShaderDef& def, ostream& log, bool& warn)
+void ShaderGC::ProcessSourceShader(SourceShaderDef& def, ostream&, bool&)
 {
+    CompileStats::Timer timer(CompileStage::Preprocess);
+
     ostringstream vertexSource;
     ostringstream fragmentSource;
 
@@ -314,6 +332,8 @@ void AddParams(vector<SourceShaderParam>& actualParams, const vector<SourceShade
 
 std::vector<SourceShaderParam> ShaderGC::LookupParams(const std::vector<SourceShaderParam>& declaredParams, vector<SourceShaderSampler>& textures, const std::string& metadata)
 {
+    CompileStats::Timer timer(CompileStage::Reflect);
+
     vector<SourceShaderParam> actualParams;
 
     auto j     = json::parse(metadata);
@@ -545,6 +565,7 @@ PresetDef* ShaderGC::CompilePreset(std::filesystem::path input, ostream& log, bo
     }
 
     def->ImportPath = input;
+    def->Cost       = PresetCost::Of(*def);
 
     return def;
 }
@@ -612,7 +633,7 @@ void ShaderGC::ProcessSourcePreset(SourcePresetDef& def, std::ostream& log, bool
     }
 }
 
-TextureDef ShaderGC::CompileTexture(std::filesystem::path source, std::ostream& log, bool& warn)
+TextureDef ShaderGC::CompileTexture(std::filesystem::path source, std::ostream&, bool&)
 {
     TextureDef def;
 
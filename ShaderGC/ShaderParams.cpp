@@ -0,0 +1,79 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "ShaderParams.h"
+
+#include <cstring>
+
+ShaderParams::ShaderParams(ShaderDef& shaderDef) : m_shaderDef(shaderDef)
+{
+    m_pushBuffer = std::make_unique<int[]>(BufferSize(PUSH_BUFFER));
+    m_uboBuffer  = std::make_unique<int[]>(BufferSize(UBO_BUFFER));
+    for(auto& p : shaderDef.Params)
+    {
+        SetParam(p.name, &p.defaultValue);
+    }
+}
+
+void ShaderParams::FillParams(int buffer, void* data)
+{
+    if(buffer == PUSH_BUFFER)
+        memcpy(data, m_pushBuffer.get(), BufferSize(buffer));
+    else
+        memcpy(data, m_uboBuffer.get(), BufferSize(buffer));
+}
+
+std::vector<ShaderParam*> ShaderParams::Params()
+{
+    std::vector<ShaderParam*> params;
+    for(auto& p : m_shaderDef.Params)
+        params.push_back(&p);
+    return params;
+}
+
+bool ShaderParams::SetParam(ShaderParam* p, void* v)
+{
+    char* buf = (char*)(p->buffer == PUSH_BUFFER ? m_pushBuffer.get() : m_uboBuffer.get());
+
+    // if it's float remember value (user parameter)
+    if(p->size == 4)
+        p->currentValue = *((float*)v);
+
+    if(memcmp(buf + p->offset, v, p->size) == 0)
+        return false;
+
+    memcpy(buf + p->offset, v, p->size);
+    return true;
+}
+
+bool ShaderParams::SetParam(std::string name, void* v)
+{
+    auto changed = false;
+    for(auto& p : m_shaderDef.Params)
+    {
+        if(p.name == name)
+        {
+            changed |= SetParam(&p, v);
+            // return; // same param can be in both bufs
+        }
+    }
+    return changed;
+}
+
+void ShaderParams::CopyParams(const ShaderParams& params)
+{
+    // buffers of the same shader of another preset, laid out the same
+    memcpy(m_pushBuffer.get(), params.m_pushBuffer.get(), BufferSize(PUSH_BUFFER));
+    memcpy(m_uboBuffer.get(), params.m_uboBuffer.get(), BufferSize(UBO_BUFFER));
+}
+
+size_t ShaderParams::BufferSize(int buffer)
+{
+    return m_shaderDef.ParamsSize(buffer);
+}
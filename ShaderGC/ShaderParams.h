@@ -0,0 +1,54 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include "ShaderDef.h"
+
+#include <memory>
+
+constexpr auto PUSH_BUFFER = -1;
+constexpr auto UBO_BUFFER  = 0;
+
+struct float4
+{
+    float x, y, z, w;
+};
+
+union float4x4
+{
+    float4x4() { }
+
+    float  m[4][4];
+    float4 cols[4];
+
+    inline float4 row(int i)
+    {
+        return {m[0][i], m[1][i], m[2][i], m[3][i]};
+    }
+};
+
+// UBO and push constant contents of a pass, Shader of ShaderGlass and NullRenderer fill them the same way
+class ShaderParams
+{
+public:
+    ShaderParams(ShaderDef& shaderDef);
+
+    ShaderDef& m_shaderDef;
+
+    std::vector<ShaderParam*> Params();
+    void                      FillParams(int buffer, void* data);
+    bool                      SetParam(ShaderParam* p, void* v);
+    // every param of that name, a linear scan as names can repeat across buffers
+    bool   SetParam(std::string name, void* v);
+    void   CopyParams(const ShaderParams& params);
+    size_t BufferSize(int buffer);
+
+private:
+    std::unique_ptr<int[]> m_pushBuffer;
+    std::unique_ptr<int[]> m_uboBuffer;
+};
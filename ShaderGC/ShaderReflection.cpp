@@ -0,0 +1,112 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "ShaderReflection.h"
+
+#include <algorithm>
+#include <cstring>
+
+// "SGRF", version, counts, then params (buffer, offset, size, name) and samplers (binding, name), all little-endian
+static const uint8_t sMagic[4] = {'S', 'G', 'R', 'F'};
+static const uint8_t sVersion  = 1;
+
+static void Write16(std::vector<uint8_t>& out, int value)
+{
+    out.push_back(static_cast<uint8_t>(value & 0xff));
+    out.push_back(static_cast<uint8_t>((value >> 8) & 0xff));
+}
+
+static void WriteName(std::vector<uint8_t>& out, const std::string& name)
+{
+    const auto length = std::min<size_t>(name.size(), 255);
+    out.push_back(static_cast<uint8_t>(length));
+    out.insert(out.end(), name.begin(), name.begin() + length);
+}
+
+std::vector<uint8_t> ShaderReflection::Encode(const std::vector<SourceShaderParam>& params, const std::vector<SourceShaderSampler>& samplers)
+{
+    std::vector<uint8_t> out(sMagic, sMagic + sizeof(sMagic));
+    out.push_back(sVersion);
+
+    // declared but unused params are not bound
+    int paramCount = 0;
+    for(const auto& p : params)
+    {
+        if(p.i != -1)
+            paramCount++;
+    }
+    Write16(out, paramCount);
+    Write16(out, static_cast<int>(samplers.size()));
+
+    for(const auto& p : params)
+    {
+        if(p.i == -1)
+            continue;
+        out.push_back(static_cast<uint8_t>(static_cast<int8_t>(p.buffer)));
+        Write16(out, p.offset);
+        Write16(out, p.size);
+        WriteName(out, p.name);
+    }
+    for(const auto& s : samplers)
+    {
+        out.push_back(static_cast<uint8_t>(s.binding));
+        WriteName(out, s.name);
+    }
+    return out;
+}
+
+bool ShaderReflection::Decode(const uint8_t* data, size_t size, std::vector<ShaderParam>& params, std::vector<ShaderSampler>& samplers)
+{
+    size_t pos    = 0;
+    auto   read16 = [&](int& value) {
+        if(pos + 2 > size)
+            return false;
+        value = data[pos] | (data[pos + 1] << 8);
+        pos += 2;
+        return true;
+    };
+    auto readName = [&](std::string& name) {
+        if(pos >= size || pos + 1 + data[pos] > size)
+            return false;
+        name.assign(reinterpret_cast<const char*>(data + pos + 1), data[pos]);
+        pos += 1 + data[pos];
+        return true;
+    };
+
+    if(!data || size < sizeof(sMagic) + 5 || memcmp(data, sMagic, sizeof(sMagic)) != 0 || data[sizeof(sMagic)] != sVersion)
+        return false;
+    pos = sizeof(sMagic) + 1;
+
+    int paramCount, samplerCount;
+    if(!read16(paramCount) || !read16(samplerCount))
+        return false;
+
+    for(int i = 0; i < paramCount; i++)
+    {
+        if(pos >= size)
+            return false;
+        const int   buffer = static_cast<int8_t>(data[pos++]);
+        int         offset, paramSize;
+        std::string name;
+        if(!read16(offset) || !read16(paramSize) || !readName(name))
+            return false;
+        params.push_back(ShaderParam(name.c_str(), buffer, offset, paramSize, 0.0f, 0.0f, 0.0f));
+    }
+    for(int i = 0; i < samplerCount; i++)
+    {
+        if(pos >= size)
+            return false;
+        const int   binding = data[pos++];
+        std::string name;
+        if(!readName(name))
+            return false;
+        samplers.push_back(ShaderSampler(name.c_str(), binding));
+    }
+    return pos == size;
+}
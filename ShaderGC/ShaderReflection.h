@@ -0,0 +1,21 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include "ShaderDef.h"
+#include "SourceDefs.h"
+
+// compact binary record of the params and samplers a stage binds, stored next to its SPIR-V and DXBC
+class ShaderReflection
+{
+public:
+    static std::vector<uint8_t> Encode(const std::vector<SourceShaderParam>& params, const std::vector<SourceShaderSampler>& samplers);
+
+    // params only carry layout, returns false if the record is not valid
+    static bool Decode(const uint8_t* data, size_t size, std::vector<ShaderParam>& params, std::vector<ShaderSampler>& samplers);
+};
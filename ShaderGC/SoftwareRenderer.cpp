@@ -0,0 +1,372 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "SoftwareRenderer.h"
+#include "spirv.hpp"
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+// same strip and texture coordinates as the shader vertex buffer of ShaderPass
+static const float sVertices[4][4] = {{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 1.0f, 1.0f}, {1.0f, 1.0f, 1.0f, 0.0f}};
+
+static float SrgbToLinear(float c)
+{
+    return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+static float LinearToSrgb(float c)
+{
+    return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+}
+
+// what a render target of given format would store
+static float Quantize(float value, SoftwareFormat format)
+{
+    switch(format)
+    {
+    case SoftwareFormat::Unorm8:
+        value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+        return std::round(value * 255.0f) / 255.0f;
+    case SoftwareFormat::Srgb8:
+        value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+        return SrgbToLinear(std::round(LinearToSrgb(value) * 255.0f) / 255.0f);
+    case SoftwareFormat::Half: {
+        if(std::isnan(value))
+            return value;
+        if(std::fabs(value) >= 65504.0f)
+            return value < 0.0f ? -65504.0f : 65504.0f;
+        int exponent;
+        std::frexp(value, &exponent);
+        if(exponent < -13)
+            return std::round(value * 16777216.0f) / 16777216.0f;
+        return std::ldexp(std::round(std::ldexp(value, 11 - exponent)), exponent - 11);
+    }
+    default:
+        return value;
+    }
+}
+
+// render target formats are named like Vulkan formats
+static SoftwareFormat FormatOf(const std::string& format)
+{
+    if(format.ends_with("_SRGB"))
+        return SoftwareFormat::Srgb8;
+    if(format.starts_with("R16") && format.ends_with("_SFLOAT"))
+        return SoftwareFormat::Half;
+    if(!format.ends_with("_UNORM"))
+        return SoftwareFormat::Float;
+    return SoftwareFormat::Unorm8;
+}
+
+SoftwareRenderer::SoftwareRenderer(const PresetDef& presetDef, unsigned threads) :
+    m_chain {presetDef}, m_passes {}, m_textures {}, m_history {}, m_historyRing {}, m_output {},
+    m_threads {threads ? threads : std::max(1u, std::thread::hardware_concurrency())}, m_frameCount {0}
+{
+    for(const auto& chainPass : m_chain.Passes())
+    {
+        const auto& shaderDef = *chainPass.shaderDef;
+        if(!shaderDef.VertexSPIRV || !shaderDef.FragmentSPIRV)
+            throw std::runtime_error("No SPIR-V for " + shaderDef.Name);
+
+        Pass pass;
+        pass.vertex   = std::make_unique<SoftwareShader>(shaderDef.VertexSPIRV, shaderDef.VertexSPIRVLength);
+        pass.fragment = std::make_unique<SoftwareShader>(shaderDef.FragmentSPIRV, shaderDef.FragmentSPIRVLength);
+        pass.format   = FormatOf(chainPass.format);
+        m_passes.push_back(std::move(pass));
+    }
+
+    m_historyRing.Resize(m_chain.HistoryDepth());
+    m_history.resize(m_historyRing.Size());
+}
+
+void SoftwareRenderer::SetTexture(const std::string& name, SoftwareTexture texture)
+{
+    m_textures[name] = std::move(texture);
+}
+
+void SoftwareRenderer::SetParam(const std::string& name, float value)
+{
+    m_chain.SetParam(name, value);
+}
+
+void SoftwareRenderer::Reset()
+{
+    m_frameCount = 0;
+    for(auto& history : m_history)
+        history = SoftwareTexture();
+    for(auto& pass : m_passes)
+        pass.feedback = SoftwareTexture();
+}
+
+const SoftwareTexture* SoftwareRenderer::Resolve(int p, const std::string& name, const SoftwareTexture& source)
+{
+    const SoftwareTexture* texture = nullptr;
+    int                    index;
+    switch(m_chain.Resolve(p, name, index))
+    {
+    case ChainResource::Source:
+        texture = &source;
+        break;
+    case ChainResource::History:
+        texture = &m_history[m_historyRing.Slot(index)];
+        break;
+    case ChainResource::PassOutput:
+        texture = &m_passes[index].output;
+        break;
+    case ChainResource::PassFeedback:
+        texture = &m_passes[index].feedback;
+        break;
+    case ChainResource::Texture: {
+        auto preset = m_textures.find(name);
+        if(preset != m_textures.end())
+            texture = &preset->second;
+        break;
+    }
+    default:
+        break;
+    }
+    return texture && !texture->Empty() ? texture : nullptr;
+}
+
+const SoftwareTexture& SoftwareRenderer::Render(const SoftwareTexture& original, int viewportWidth, int viewportHeight)
+{
+    m_chain.Resize(original.Width(), original.Height(), viewportWidth, viewportHeight);
+
+    m_historyRing.Advance();
+    m_history[m_historyRing.Slot(0)] = original;
+
+    // previous outputs become feedback
+    for(size_t p = 0; p < m_passes.size(); p++)
+    {
+        if(m_chain.Graph().Nodes()[p].fedBack)
+            std::swap(m_passes[p].output, m_passes[p].feedback);
+    }
+
+    const SoftwareTexture* source = &m_history[m_historyRing.Slot(0)];
+    for(size_t p = 0; p < m_passes.size(); p++)
+    {
+        // nothing downstream reads it
+        if(!m_chain.Graph().Nodes()[p].live)
+            continue;
+
+        auto& pass      = m_passes[p];
+        auto& chainPass = m_chain.Passes()[p];
+        m_chain.BeginPass(chainPass, m_frameCount);
+
+        SoftwareBindings bindings;
+        bindings.uniforms.push_back(chainPass.ubo.empty() ? nullptr : chainPass.ubo.data());
+        bindings.pushConstants = chainPass.push.empty() ? nullptr : chainPass.push.data();
+        for(const auto& sampler : chainPass.shaderDef->Samplers)
+        {
+            if(sampler.binding < 0)
+                continue;
+            if(bindings.textures.size() <= (size_t)sampler.binding)
+            {
+                bindings.textures.resize(sampler.binding + 1);
+                bindings.samplers.resize(sampler.binding + 1);
+            }
+            bindings.textures[sampler.binding] = Resolve(static_cast<int>(p), sampler.name, *source);
+            bindings.samplers[sampler.binding] = m_chain.Sampler(chainPass, sampler.name);
+        }
+
+        if(p == m_passes.size() - 1)
+        {
+            // final output goes to an 8-bit display surface
+            if(m_output.Width() != chainPass.width || m_output.Height() != chainPass.height)
+                m_output = SoftwareTexture(chainPass.width, chainPass.height);
+            RenderPass(chainPass, pass, bindings, m_output, SoftwareFormat::Unorm8);
+        }
+        else
+        {
+            if(pass.output.Width() != chainPass.width || pass.output.Height() != chainPass.height)
+                pass.output = SoftwareTexture(chainPass.width, chainPass.height);
+            RenderPass(chainPass, pass, bindings, pass.output, pass.format);
+            source = &pass.output;
+        }
+    }
+
+    // last pass can be fed back too
+    if(m_chain.Graph().Nodes().back().fedBack)
+        m_passes.back().output = m_output;
+
+    m_frameCount++;
+    return m_output;
+}
+
+void SoftwareRenderer::RenderPass(const ChainPass& chainPass, const Pass& pass, const SoftwareBindings& bindings, SoftwareTexture& target, SoftwareFormat format)
+{
+    const auto& vertexShader   = *pass.vertex;
+    const auto& fragmentShader = *pass.fragment;
+
+    // run the four vertices of the strip together
+    SoftwareShader::Invocation vertex(vertexShader);
+    uint32_t                   variable;
+    if(vertexShader.Input(0, variable))
+    {
+        for(uint32_t s = 0; s < 4 && s < vertexShader.Scalars(variable); s++)
+        {
+            auto* lanes = vertex.Lanes(variable, s);
+            for(int l = 0; l < SoftwareLanes; l++)
+                lanes[l].f = s < 2 ? sVertices[l & 3][s] : (s == 3 ? 1.0f : 0.0f);
+        }
+    }
+    if(vertexShader.Input(1, variable))
+    {
+        for(uint32_t s = 0; s < 2 && s < vertexShader.Scalars(variable); s++)
+        {
+            auto* lanes = vertex.Lanes(variable, s);
+            for(int l = 0; l < SoftwareLanes; l++)
+                lanes[l].f = sVertices[l & 3][2 + s];
+        }
+    }
+    vertex.Run(SoftwareAllLanes, bindings);
+
+    uint32_t position, positionOffset;
+    if(!vertexShader.BuiltIn(spv::BuiltInPosition, position, positionOffset))
+        throw std::runtime_error("No vertex position in " + chainPass.shaderDef->Name);
+
+    float corners[4][2];
+    for(int v = 0; v < 4; v++)
+    {
+        const auto w  = vertex.Lanes(position, positionOffset + 3)[v].f;
+        corners[v][0] = vertex.Lanes(position, positionOffset)[v].f / w;
+        corners[v][1] = vertex.Lanes(position, positionOffset + 1)[v].f / w;
+    }
+
+    // varyings are affine across each triangle of the strip, keep them as planes in NDC
+    struct Varying
+    {
+        uint32_t           variable;
+        uint32_t           scalars;
+        std::vector<float> planes[2];
+    };
+    std::vector<Varying> varyings;
+    const int            triangles[2][3] = {{0, 1, 2}, {2, 1, 3}};
+    for(auto location : fragmentShader.InputLocations())
+    {
+        uint32_t output, input;
+        if(!vertexShader.Output(location, output) || !fragmentShader.Input(location, input))
+            continue;
+        Varying varying {input, std::min(vertexShader.Scalars(output), fragmentShader.Scalars(input)), {}};
+        for(int t = 0; t < 2; t++)
+        {
+            const auto* p0    = corners[triangles[t][0]];
+            const auto* p1    = corners[triangles[t][1]];
+            const auto* p2    = corners[triangles[t][2]];
+            const auto  denom = (p1[0] - p0[0]) * (p2[1] - p0[1]) - (p2[0] - p0[0]) * (p1[1] - p0[1]);
+            for(uint32_t s = 0; s < varying.scalars; s++)
+            {
+                const auto* lanes = vertex.Lanes(output, s);
+                const auto  v0    = lanes[triangles[t][0]].f;
+                const auto  v1    = lanes[triangles[t][1]].f;
+                const auto  v2    = lanes[triangles[t][2]].f;
+                const auto  a     = denom != 0.0f ? ((v1 - v0) * (p2[1] - p0[1]) - (v2 - v0) * (p1[1] - p0[1])) / denom : 0.0f;
+                const auto  b     = denom != 0.0f ? ((v2 - v0) * (p1[0] - p0[0]) - (v1 - v0) * (p2[0] - p0[0])) / denom : 0.0f;
+                varying.planes[t].push_back(a);
+                varying.planes[t].push_back(b);
+                varying.planes[t].push_back(v0 - a * p0[0] - b * p0[1]);
+            }
+        }
+        varyings.push_back(std::move(varying));
+    }
+
+    // which side of the shared edge a pixel is on, and whether it's covered at all
+    auto inside = [&](int t, float x, float y) {
+        const auto* p0 = corners[triangles[t][0]];
+        const auto* p1 = corners[triangles[t][1]];
+        const auto* p2 = corners[triangles[t][2]];
+        auto        e0 = (p1[0] - p0[0]) * (y - p0[1]) - (p1[1] - p0[1]) * (x - p0[0]);
+        auto        e1 = (p2[0] - p1[0]) * (y - p1[1]) - (p2[1] - p1[1]) * (x - p1[0]);
+        auto        e2 = (p0[0] - p2[0]) * (y - p2[1]) - (p0[1] - p2[1]) * (x - p2[0]);
+        return (e0 >= 0.0f && e1 >= 0.0f && e2 >= 0.0f) || (e0 <= 0.0f && e1 <= 0.0f && e2 <= 0.0f);
+    };
+
+    uint32_t fragCoord = 0, fragCoordOffset = 0, color = 0;
+    const bool hasFragCoord = fragmentShader.BuiltIn(spv::BuiltInFragCoord, fragCoord, fragCoordOffset);
+    if(!fragmentShader.Output(0, color))
+        throw std::runtime_error("No fragment output in " + chainPass.shaderDef->Name);
+    const auto colorScalars = std::min(4u, fragmentShader.Scalars(color));
+
+    const int        width  = target.Width();
+    const int        height = target.Height();
+    std::atomic<int> nextRow {0};
+
+    // each worker takes pairs of rows, lanes cover 4x2 pixel blocks
+    auto worker = [&]() {
+        SoftwareShader::Invocation fragment(fragmentShader);
+        for(int y0 = nextRow.fetch_add(2); y0 < height; y0 = nextRow.fetch_add(2))
+        {
+            for(int x0 = 0; x0 < width; x0 += 4)
+            {
+                int      px[SoftwareLanes], py[SoftwareLanes], triangle[SoftwareLanes];
+                float    nx[SoftwareLanes], ny[SoftwareLanes];
+                uint32_t covered = 0;
+                for(int l = 0; l < SoftwareLanes; l++)
+                {
+                    px[l]       = x0 + 2 * (l >> 2) + (l & 1);
+                    py[l]       = y0 + ((l >> 1) & 1);
+                    nx[l]       = (px[l] + 0.5f) / width * 2.0f - 1.0f;
+                    ny[l]       = 1.0f - (py[l] + 0.5f) / height * 2.0f;
+                    triangle[l] = inside(0, nx[l], ny[l]) ? 0 : 1;
+                    if(px[l] < width && py[l] < height && (triangle[l] == 0 || inside(1, nx[l], ny[l])))
+                        covered |= 1 << l;
+                }
+                if(!covered)
+                    continue;
+
+                for(const auto& varying : varyings)
+                {
+                    for(uint32_t s = 0; s < varying.scalars; s++)
+                    {
+                        auto* lanes = fragment.Lanes(varying.variable, s);
+                        for(int l = 0; l < SoftwareLanes; l++)
+                        {
+                            const auto* plane = &varying.planes[triangle[l]][s * 3];
+                            lanes[l].f        = plane[0] * nx[l] + plane[1] * ny[l] + plane[2];
+                        }
+                    }
+                }
+                if(hasFragCoord)
+                {
+                    for(int l = 0; l < SoftwareLanes; l++)
+                    {
+                        fragment.Lanes(fragCoord, fragCoordOffset)[l].f     = px[l] + 0.5f;
+                        fragment.Lanes(fragCoord, fragCoordOffset + 1)[l].f = py[l] + 0.5f;
+                        fragment.Lanes(fragCoord, fragCoordOffset + 2)[l].f = 0.0f;
+                        fragment.Lanes(fragCoord, fragCoordOffset + 3)[l].f = 1.0f;
+                    }
+                }
+
+                // uncovered lanes still run so derivatives have all four pixels of a quad
+                const auto written = covered & ~fragment.Run(SoftwareAllLanes, bindings);
+                for(int l = 0; l < SoftwareLanes; l++)
+                {
+                    if(!(written & (1 << l)))
+                        continue;
+                    auto* texel = target.Texel(px[l], py[l]);
+                    for(uint32_t c = 0; c < colorScalars; c++)
+                        texel[c] = Quantize(fragment.Lanes(color, c)[l].f, format);
+                }
+            }
+        }
+    };
+
+    const auto               workers = std::min<unsigned>(m_threads, (height + 1) / 2);
+    std::vector<std::thread> threads;
+    for(unsigned t = 1; t < workers; t++)
+        threads.emplace_back(worker);
+    worker();
+    for(auto& thread : threads)
+        thread.join();
+}
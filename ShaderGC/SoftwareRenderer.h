@@ -0,0 +1,65 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include "PassChain.h"
+#include "HistoryRing.h"
+#include "SoftwareShader.h"
+
+#include <memory>
+
+enum class SoftwareFormat
+{
+    Unorm8,
+    Srgb8,
+    Half,
+    Float
+};
+
+// renders a preset chain on the CPU from SPIR-V of its passes, mirrors sizing and bindings of ShaderGlass
+class SoftwareRenderer
+{
+public:
+    SoftwareRenderer(const PresetDef& presetDef, unsigned threads = 0);
+
+    // preset textures are decoded by the caller
+    void SetTexture(const std::string& name, SoftwareTexture texture);
+    void SetParam(const std::string& name, float value);
+
+    // renders one frame, original is the input already scaled to pixel size
+    const SoftwareTexture& Render(const SoftwareTexture& original, int viewportWidth, int viewportHeight);
+
+    const SoftwareTexture& Output() const
+    {
+        return m_output;
+    }
+
+    void Reset();
+
+private:
+    struct Pass
+    {
+        std::unique_ptr<SoftwareShader> vertex {};
+        std::unique_ptr<SoftwareShader> fragment {};
+        SoftwareFormat                  format {SoftwareFormat::Unorm8};
+        SoftwareTexture                 output {};
+        SoftwareTexture                 feedback {};
+    };
+
+    const SoftwareTexture* Resolve(int p, const std::string& name, const SoftwareTexture& source);
+    void                   RenderPass(const ChainPass& chainPass, const Pass& pass, const SoftwareBindings& bindings, SoftwareTexture& target, SoftwareFormat format);
+
+    PassChain                              m_chain;
+    std::vector<Pass>                      m_passes;
+    std::map<std::string, SoftwareTexture> m_textures;
+    std::vector<SoftwareTexture>           m_history;
+    HistoryRing                            m_historyRing;
+    SoftwareTexture                        m_output;
+    unsigned                               m_threads;
+    int                                    m_frameCount;
+};
@@ -0,0 +1,2018 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "SoftwareShader.h"
+
+#define SPV_ENABLE_UTILITY_CODE
+#include "spirv.hpp"
+#include "GLSL.std.450.h"
+
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
+// float ops take four lanes at a time where SSE2 is there, scalars of a value are stored lane after lane
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOFTWARE_SSE2
+#endif
+
+using namespace spv;
+
+constexpr int W = SoftwareLanes;
+
+#ifdef SOFTWARE_SSE2
+static_assert(W % 4 == 0);
+
+static inline __m128 LoadLanes(const SoftwareScalar* s)
+{
+    return _mm_loadu_ps(&s->f);
+}
+
+static inline void StoreLanes(SoftwareScalar* s, __m128 v)
+{
+    _mm_storeu_ps(&s->f, v);
+}
+
+// comparison masks to the 1 a true boolean holds
+static inline __m128 Bool(__m128 mask)
+{
+    return _mm_and_ps(mask, _mm_castsi128_ps(_mm_set1_epi32(1)));
+}
+#endif
+
+enum PointerKind : uint8_t
+{
+    MemoryPointer,
+    BufferPointer,
+    HandlePointer
+};
+
+static bool IsSupported(uint32_t op)
+{
+    switch(op)
+    {
+    case OpNop:
+    case OpUndef:
+    case OpLine:
+    case OpNoLine:
+    case OpVariable:
+    case OpLoad:
+    case OpStore:
+    case OpCopyMemory:
+    case OpAccessChain:
+    case OpInBoundsAccessChain:
+    case OpFunctionCall:
+    case OpCopyObject:
+    case OpCompositeConstruct:
+    case OpCompositeExtract:
+    case OpCompositeInsert:
+    case OpVectorShuffle:
+    case OpVectorExtractDynamic:
+    case OpVectorInsertDynamic:
+    case OpTranspose:
+    case OpConvertFToU:
+    case OpConvertFToS:
+    case OpConvertSToF:
+    case OpConvertUToF:
+    case OpUConvert:
+    case OpSConvert:
+    case OpFConvert:
+    case OpQuantizeToF16:
+    case OpBitcast:
+    case OpSNegate:
+    case OpFNegate:
+    case OpIAdd:
+    case OpFAdd:
+    case OpISub:
+    case OpFSub:
+    case OpIMul:
+    case OpFMul:
+    case OpUDiv:
+    case OpSDiv:
+    case OpFDiv:
+    case OpUMod:
+    case OpSRem:
+    case OpSMod:
+    case OpFRem:
+    case OpFMod:
+    case OpVectorTimesScalar:
+    case OpMatrixTimesScalar:
+    case OpVectorTimesMatrix:
+    case OpMatrixTimesVector:
+    case OpMatrixTimesMatrix:
+    case OpOuterProduct:
+    case OpDot:
+    case OpAny:
+    case OpAll:
+    case OpIsNan:
+    case OpIsInf:
+    case OpLogicalEqual:
+    case OpLogicalNotEqual:
+    case OpLogicalOr:
+    case OpLogicalAnd:
+    case OpLogicalNot:
+    case OpSelect:
+    case OpIEqual:
+    case OpINotEqual:
+    case OpUGreaterThan:
+    case OpSGreaterThan:
+    case OpUGreaterThanEqual:
+    case OpSGreaterThanEqual:
+    case OpULessThan:
+    case OpSLessThan:
+    case OpULessThanEqual:
+    case OpSLessThanEqual:
+    case OpFOrdEqual:
+    case OpFUnordEqual:
+    case OpFOrdNotEqual:
+    case OpFUnordNotEqual:
+    case OpFOrdLessThan:
+    case OpFUnordLessThan:
+    case OpFOrdGreaterThan:
+    case OpFUnordGreaterThan:
+    case OpFOrdLessThanEqual:
+    case OpFUnordLessThanEqual:
+    case OpFOrdGreaterThanEqual:
+    case OpFUnordGreaterThanEqual:
+    case OpShiftRightLogical:
+    case OpShiftRightArithmetic:
+    case OpShiftLeftLogical:
+    case OpBitwiseOr:
+    case OpBitwiseXor:
+    case OpBitwiseAnd:
+    case OpNot:
+    case OpBitCount:
+    case OpDPdx:
+    case OpDPdy:
+    case OpFwidth:
+    case OpDPdxFine:
+    case OpDPdyFine:
+    case OpFwidthFine:
+    case OpDPdxCoarse:
+    case OpDPdyCoarse:
+    case OpFwidthCoarse:
+    case OpPhi:
+    case OpLoopMerge:
+    case OpSelectionMerge:
+    case OpLabel:
+    case OpBranch:
+    case OpBranchConditional:
+    case OpSwitch:
+    case OpKill:
+    case OpTerminateInvocation:
+    case OpDemoteToHelperInvocation:
+    case OpReturn:
+    case OpReturnValue:
+    case OpUnreachable:
+    case OpSampledImage:
+    case OpImage:
+    case OpImageSampleImplicitLod:
+    case OpImageSampleExplicitLod:
+    case OpImageSampleProjImplicitLod:
+    case OpImageSampleProjExplicitLod:
+    case OpImageFetch:
+    case OpImageQuerySizeLod:
+    case OpImageQuerySize:
+    case OpImageQueryLevels:
+    case OpExtInst:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool IsSupportedExt(uint32_t op)
+{
+    switch(op)
+    {
+    case GLSLstd450Round:
+    case GLSLstd450RoundEven:
+    case GLSLstd450Trunc:
+    case GLSLstd450FAbs:
+    case GLSLstd450SAbs:
+    case GLSLstd450FSign:
+    case GLSLstd450SSign:
+    case GLSLstd450Floor:
+    case GLSLstd450Ceil:
+    case GLSLstd450Fract:
+    case GLSLstd450Radians:
+    case GLSLstd450Degrees:
+    case GLSLstd450Sin:
+    case GLSLstd450Cos:
+    case GLSLstd450Tan:
+    case GLSLstd450Asin:
+    case GLSLstd450Acos:
+    case GLSLstd450Atan:
+    case GLSLstd450Sinh:
+    case GLSLstd450Cosh:
+    case GLSLstd450Tanh:
+    case GLSLstd450Asinh:
+    case GLSLstd450Acosh:
+    case GLSLstd450Atanh:
+    case GLSLstd450Atan2:
+    case GLSLstd450Pow:
+    case GLSLstd450Exp:
+    case GLSLstd450Log:
+    case GLSLstd450Exp2:
+    case GLSLstd450Log2:
+    case GLSLstd450Sqrt:
+    case GLSLstd450InverseSqrt:
+    case GLSLstd450Determinant:
+    case GLSLstd450MatrixInverse:
+    case GLSLstd450Modf:
+    case GLSLstd450FMin:
+    case GLSLstd450UMin:
+    case GLSLstd450SMin:
+    case GLSLstd450FMax:
+    case GLSLstd450UMax:
+    case GLSLstd450SMax:
+    case GLSLstd450FClamp:
+    case GLSLstd450UClamp:
+    case GLSLstd450SClamp:
+    case GLSLstd450FMix:
+    case GLSLstd450Step:
+    case GLSLstd450SmoothStep:
+    case GLSLstd450Fma:
+    case GLSLstd450Ldexp:
+    case GLSLstd450Length:
+    case GLSLstd450Distance:
+    case GLSLstd450Cross:
+    case GLSLstd450Normalize:
+    case GLSLstd450FaceForward:
+    case GLSLstd450Reflect:
+    case GLSLstd450Refract:
+    case GLSLstd450NMin:
+    case GLSLstd450NMax:
+    case GLSLstd450NClamp:
+        return true;
+    default:
+        return false;
+    }
+}
+
+SoftwareShader::SoftwareShader(const uint32_t* code, size_t words) :
+    m_code(code, code + words), m_entry {0}, m_glsl {0}, m_valueScalars {0}, m_memoryScalars {0}, m_pointerCount {0}
+{
+    if(words < 5 || code[0] != MagicNumber)
+        throw std::runtime_error("Invalid SPIR-V module");
+
+    Parse(code, words);
+}
+
+void SoftwareShader::Parse(const uint32_t* code, size_t words)
+{
+    const auto bound = code[3];
+    m_types.resize(bound);
+    m_ids.resize(bound);
+    m_labels.assign(bound, 0);
+    m_merges.assign(bound, false);
+
+    std::map<uint32_t, std::map<uint32_t, uint32_t>>                       decorations;
+    std::map<std::pair<uint32_t, uint32_t>, std::map<uint32_t, uint32_t>> memberDecorations;
+
+    uint32_t function = 0;
+    for(size_t i = 5; i < words;)
+    {
+        const auto     op    = static_cast<uint16_t>(code[i] & 0xffff);
+        const auto     count = static_cast<uint16_t>(code[i] >> 16);
+        const uint32_t index = static_cast<uint32_t>(m_instructions.size());
+        if(count == 0 || i + count > words)
+            throw std::runtime_error("Truncated SPIR-V module");
+
+        const uint32_t* o = &code[i + 1];
+        const int       n = count - 1;
+        m_instructions.push_back({op, count, static_cast<uint32_t>(i)});
+        i += count;
+
+        switch(op)
+        {
+        case OpExtInstImport:
+            if(strcmp(reinterpret_cast<const char*>(&o[1]), "GLSL.std.450") == 0)
+                m_glsl = o[0];
+            continue;
+        case OpEntryPoint:
+            if(m_entry == 0)
+                m_entry = o[1];
+            continue;
+        case OpDecorate:
+            decorations[o[0]][o[1]] = n > 2 ? o[2] : 1;
+            continue;
+        case OpMemberDecorate:
+            memberDecorations[{o[0], o[1]}][o[2]] = n > 3 ? o[3] : 1;
+            continue;
+        case OpTypeVoid:
+        case OpTypeBool:
+        case OpTypeInt:
+        case OpTypeFloat:
+        case OpTypeVector:
+        case OpTypeMatrix:
+        case OpTypeImage:
+        case OpTypeSampler:
+        case OpTypeSampledImage:
+        case OpTypeArray:
+        case OpTypeRuntimeArray:
+        case OpTypeStruct:
+        case OpTypePointer:
+        case OpTypeFunction: {
+            AddType(o, op, n);
+            auto& type = m_types[o[0]];
+            if(op == OpTypeArray || op == OpTypeRuntimeArray)
+            {
+                auto stride = decorations[o[0]].find(DecorationArrayStride);
+                if(stride != decorations[o[0]].end())
+                    type.arrayStride = stride->second;
+            }
+            else if(op == OpTypeStruct)
+            {
+                for(uint32_t m = 0; m < type.members.size(); m++)
+                {
+                    const auto& member = memberDecorations[{o[0], m}];
+                    auto        offset = member.find(DecorationOffset);
+                    auto        stride = member.find(DecorationMatrixStride);
+                    auto        builtIn = member.find(DecorationBuiltIn);
+                    type.memberOffsets.push_back(offset != member.end() ? offset->second : 0);
+                    type.memberMatrixStrides.push_back(stride != member.end() ? stride->second : 16);
+                    type.memberRowMajor.push_back(member.find(DecorationRowMajor) != member.end());
+                    type.memberBuiltIns.push_back(builtIn != member.end() ? static_cast<int>(builtIn->second) : -1);
+                }
+            }
+            continue;
+        }
+        case OpConstant:
+        case OpConstantTrue:
+        case OpConstantFalse:
+        case OpConstantComposite:
+        case OpConstantNull:
+        case OpSpecConstant:
+        case OpSpecConstantTrue:
+        case OpSpecConstantFalse:
+        case OpSpecConstantComposite:
+        case OpUndef:
+            AllocateValue(o[1], o[0]);
+            AddConstant(o, op, n);
+            continue;
+        case OpVariable: {
+            auto& id       = m_ids[o[1]];
+            id.type        = o[0];
+            id.storage     = o[2];
+            id.initializer = n > 3 ? o[3] : 0;
+            id.pointer     = static_cast<int32_t>(m_pointerCount++);
+            const auto& pointee = m_types[m_types[o[0]].element];
+            if(id.storage != StorageClassUniform && id.storage != StorageClassPushConstant && id.storage != StorageClassUniformConstant)
+            {
+                id.memory = static_cast<int32_t>(m_memoryScalars);
+                m_memoryScalars += pointee.scalars;
+            }
+            auto& decoration = decorations[o[1]];
+            if(decoration.count(DecorationBinding))
+                id.binding = static_cast<int32_t>(decoration[DecorationBinding]);
+            if(decoration.count(DecorationLocation))
+                id.location = static_cast<int32_t>(decoration[DecorationLocation]);
+            if(decoration.count(DecorationBuiltIn))
+                id.builtIn = static_cast<int32_t>(decoration[DecorationBuiltIn]);
+            m_variables.push_back(o[1]);
+            continue;
+        }
+        case OpFunction:
+            function = o[1];
+            m_functions.resize(std::max<size_t>(m_functions.size(), function + 1));
+            continue;
+        case OpFunctionParameter:
+            AllocateValue(o[1], o[0]);
+            m_functions[function].params.push_back(o[1]);
+            continue;
+        case OpFunctionEnd:
+            function = 0;
+            continue;
+        case OpLabel:
+            m_labels[o[0]] = index;
+            if(m_functions[function].first == 0)
+                m_functions[function].first = index;
+            continue;
+        case OpSelectionMerge:
+        case OpLoopMerge:
+            m_merges[o[0]] = true;
+            continue;
+        case OpSpecConstantOp:
+            throw std::runtime_error("Unsupported SPIR-V instruction " + std::to_string(op));
+        case OpExtInst:
+            if(o[2] != m_glsl || !IsSupportedExt(o[3]))
+                throw std::runtime_error("Unsupported extended instruction " + std::to_string(o[3]));
+            break;
+        default:
+            break;
+        }
+
+        if(function == 0)
+            continue;
+
+        if(!IsSupported(op))
+            throw std::runtime_error("Unsupported SPIR-V instruction " + std::to_string(op));
+
+        bool hasResult, hasResultType;
+        HasResultAndType(static_cast<Op>(op), &hasResult, &hasResultType);
+        if(hasResult && hasResultType)
+            AllocateValue(o[1], o[0]);
+    }
+
+    if(m_entry == 0 || m_entry >= m_functions.size())
+        throw std::runtime_error("No entry point in SPIR-V module");
+}
+
+void SoftwareShader::AddType(const uint32_t* o, uint16_t op, int n)
+{
+    auto& type = m_types[o[0]];
+    type.op    = op;
+    switch(op)
+    {
+    case OpTypeBool:
+    case OpTypeFloat:
+    case OpTypeImage:
+    case OpTypeSampler:
+    case OpTypeSampledImage:
+        type.scalars = 1;
+        break;
+    case OpTypeInt:
+        type.scalars  = 1;
+        type.isSigned = o[2] != 0;
+        break;
+    case OpTypeVector:
+    case OpTypeMatrix:
+        type.element = o[1];
+        type.count   = o[2];
+        type.scalars = m_types[o[1]].scalars * o[2];
+        break;
+    case OpTypeArray:
+        type.element = o[1];
+        type.count   = m_constants[m_ids[o[2]].value * W].u;
+        type.scalars = m_types[o[1]].scalars * type.count;
+        break;
+    case OpTypeRuntimeArray:
+        type.element = o[1];
+        type.count   = 0;
+        break;
+    case OpTypeStruct:
+        for(int m = 1; m < n; m++)
+        {
+            type.members.push_back(o[m]);
+            type.memberScalars.push_back(type.scalars);
+            type.scalars += m_types[o[m]].scalars;
+        }
+        break;
+    case OpTypePointer:
+        type.storage = o[1];
+        type.element = o[2];
+        break;
+    default:
+        break;
+    }
+}
+
+uint32_t SoftwareShader::AllocateValue(uint32_t id, uint32_t type)
+{
+    auto& value = m_ids[id];
+    value.type  = type;
+    if(m_types[type].op == OpTypePointer)
+    {
+        value.pointer = static_cast<int32_t>(m_pointerCount++);
+        return 0;
+    }
+    value.value = static_cast<int32_t>(m_valueScalars);
+    m_valueScalars += m_types[type].scalars;
+    m_constants.resize(static_cast<size_t>(m_valueScalars) * W);
+    return value.value;
+}
+
+void SoftwareShader::AddConstant(const uint32_t* o, uint16_t op, int n)
+{
+    auto*       value   = &m_constants[static_cast<size_t>(m_ids[o[1]].value) * W];
+    const auto& type    = m_types[o[0]];
+    auto        scalars = std::vector<SoftwareScalar>(type.scalars);
+    switch(op)
+    {
+    case OpConstant:
+    case OpSpecConstant:
+        scalars[0].u = o[2];
+        break;
+    case OpConstantTrue:
+    case OpSpecConstantTrue:
+        scalars[0].u = 1;
+        break;
+    case OpConstantComposite:
+    case OpSpecConstantComposite: {
+        size_t s = 0;
+        for(int c = 2; c < n; c++)
+        {
+            const auto& constituent = m_ids[o[c]];
+            const auto* source      = &m_constants[static_cast<size_t>(constituent.value) * W];
+            for(uint32_t i = 0; i < m_types[constituent.type].scalars && s < scalars.size(); i++)
+                scalars[s++] = source[i * W];
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    for(size_t s = 0; s < scalars.size(); s++)
+        for(int l = 0; l < W; l++)
+            value[s * W + l] = scalars[s];
+}
+
+uint32_t SoftwareShader::ScalarOffset(uint32_t type, uint32_t index, uint32_t& subType) const
+{
+    const auto& t = m_types[type];
+    if(t.op == OpTypeStruct)
+    {
+        subType = t.members[index];
+        return t.memberScalars[index];
+    }
+    subType = t.element;
+    return index * m_types[t.element].scalars;
+}
+
+bool SoftwareShader::Input(int location, uint32_t& variable) const
+{
+    for(auto v : m_variables)
+    {
+        if(m_ids[v].storage == StorageClassInput && m_ids[v].location == location)
+        {
+            variable = v;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SoftwareShader::Output(int location, uint32_t& variable) const
+{
+    for(auto v : m_variables)
+    {
+        if(m_ids[v].storage == StorageClassOutput && m_ids[v].location == location)
+        {
+            variable = v;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SoftwareShader::BuiltIn(uint32_t builtIn, uint32_t& variable, uint32_t& offset) const
+{
+    for(auto v : m_variables)
+    {
+        const auto& id = m_ids[v];
+        if(id.storage != StorageClassInput && id.storage != StorageClassOutput)
+            continue;
+        if(id.builtIn == static_cast<int32_t>(builtIn))
+        {
+            variable = v;
+            offset   = 0;
+            return true;
+        }
+        // gl_PerVertex block
+        const auto& pointee = m_types[m_types[id.type].element];
+        for(size_t m = 0; m < pointee.memberBuiltIns.size(); m++)
+        {
+            if(pointee.memberBuiltIns[m] == static_cast<int>(builtIn))
+            {
+                variable = v;
+                offset   = pointee.memberScalars[m];
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+uint32_t SoftwareShader::Scalars(uint32_t variable) const
+{
+    return m_types[m_types[m_ids[variable].type].element].scalars;
+}
+
+std::vector<int> SoftwareShader::InputLocations() const
+{
+    std::vector<int> locations;
+    for(auto v : m_variables)
+        if(m_ids[v].storage == StorageClassInput && m_ids[v].location >= 0)
+            locations.push_back(m_ids[v].location);
+    return locations;
+}
+
+std::vector<int> SoftwareShader::OutputLocations() const
+{
+    std::vector<int> locations;
+    for(auto v : m_variables)
+        if(m_ids[v].storage == StorageClassOutput && m_ids[v].location >= 0)
+            locations.push_back(m_ids[v].location);
+    return locations;
+}
+
+SoftwareShader::Invocation::Invocation(const SoftwareShader& shader) :
+    m_shader {shader}, m_bindings {nullptr}, m_values(shader.m_constants), m_memory(static_cast<size_t>(shader.m_memoryScalars) * W),
+    m_scratch {}, m_pointers(shader.m_pointerCount), m_states {}, m_prevBlock {}, m_discarded {0}
+{
+    // variables never move, only pointers derived from them do
+    for(auto v : shader.m_variables)
+    {
+        const auto& id      = shader.m_ids[v];
+        auto&       pointer = m_pointers[id.pointer];
+        pointer.buffer       = id.binding;
+        pointer.matrixStride = 16;
+        pointer.rowMajor     = false;
+        int32_t base         = id.memory;
+        if(id.storage == StorageClassUniform)
+        {
+            pointer.kind = BufferPointer;
+            base         = 0;
+        }
+        else if(id.storage == StorageClassPushConstant)
+        {
+            pointer.kind   = BufferPointer;
+            pointer.buffer = -1;
+            base           = 0;
+        }
+        else if(id.storage == StorageClassUniformConstant)
+        {
+            pointer.kind = HandlePointer;
+            base         = id.binding;
+        }
+        else
+        {
+            pointer.kind = MemoryPointer;
+        }
+        for(int l = 0; l < W; l++)
+            pointer.offset[l] = base;
+    }
+}
+
+SoftwareScalar* SoftwareShader::Invocation::Lanes(uint32_t variable, uint32_t scalar)
+{
+    return &m_memory[(static_cast<size_t>(m_shader.m_ids[variable].memory) + scalar) * W];
+}
+
+SoftwareScalar* SoftwareShader::Invocation::Value(uint32_t id)
+{
+    return &m_values[static_cast<size_t>(m_shader.m_ids[id].value) * W];
+}
+
+SoftwareScalar* SoftwareShader::Invocation::Out(uint32_t count)
+{
+    if(m_scratch.size() < static_cast<size_t>(count) * W)
+        m_scratch.resize(static_cast<size_t>(count) * W);
+    return m_scratch.data();
+}
+
+void SoftwareShader::Invocation::Commit(uint32_t id, uint32_t count, uint32_t mask)
+{
+    auto* value = Value(id);
+    if(mask == SoftwareAllLanes)
+    {
+        memcpy(value, m_scratch.data(), sizeof(SoftwareScalar) * count * W);
+        return;
+    }
+    for(uint32_t s = 0; s < count; s++)
+        for(int l = 0; l < W; l++)
+            if(mask & (1 << l))
+                value[s * W + l] = m_scratch[s * W + l];
+}
+
+uint32_t SoftwareShader::Invocation::Run(uint32_t mask, const SoftwareBindings& bindings)
+{
+    m_bindings  = &bindings;
+    m_discarded = 0;
+
+    // private and output variables start from scratch every time
+    for(auto v : m_shader.m_variables)
+    {
+        const auto& id = m_shader.m_ids[v];
+        if(id.storage != StorageClassPrivate && id.storage != StorageClassOutput)
+            continue;
+        auto*      memory = Lanes(v, 0);
+        const auto size   = sizeof(SoftwareScalar) * m_shader.Scalars(v) * W;
+        if(id.initializer)
+            memcpy(memory, Value(id.initializer), size);
+        else
+            memset(memory, 0, size);
+    }
+
+    m_states.clear();
+    State entry {{}, mask, false};
+    Enter(entry, m_shader.m_entry, 0);
+    m_states.push_back(std::move(entry));
+
+    while(!m_states.empty())
+    {
+        auto next = m_states.size();
+        for(size_t s = m_states.size(); s-- > 0;)
+        {
+            if(!m_states[s].suspended)
+            {
+                next = s;
+                break;
+            }
+        }
+
+        if(next == m_states.size())
+        {
+            // everyone is waiting at a merge, reconverge lanes which got to the same place
+            for(size_t a = 0; a < m_states.size(); a++)
+            {
+                for(size_t b = m_states.size(); b-- > a + 1;)
+                {
+                    const auto& sa = m_states[a].stack;
+                    const auto& sb = m_states[b].stack;
+                    if(sa.size() != sb.size())
+                        continue;
+                    bool same = true;
+                    for(size_t f = 0; f < sa.size() && same; f++)
+                        same = sa[f].ip == sb[f].ip && sa[f].function == sb[f].function;
+                    if(same)
+                    {
+                        m_states[a].mask |= m_states[b].mask;
+                        m_states.erase(m_states.begin() + b);
+                    }
+                }
+            }
+
+            // innermost call first, then earliest in the function so outer merges wait for inner ones
+            next = 0;
+            for(size_t s = 1; s < m_states.size(); s++)
+            {
+                const auto& candidate = m_states[s].stack;
+                const auto& best      = m_states[next].stack;
+                if(candidate.size() != best.size())
+                {
+                    if(candidate.size() > best.size())
+                        next = s;
+                    continue;
+                }
+                for(size_t f = 0; f < candidate.size(); f++)
+                {
+                    if(candidate[f].ip != best[f].ip)
+                    {
+                        if(candidate[f].ip < best[f].ip)
+                            next = s;
+                        break;
+                    }
+                }
+            }
+            m_states[next].suspended = false;
+        }
+
+        State state = std::move(m_states[next]);
+        m_states.erase(m_states.begin() + next);
+        Execute(state);
+        if(!state.stack.empty())
+            m_states.push_back(std::move(state));
+    }
+
+    return m_discarded;
+}
+
+void SoftwareShader::Invocation::Enter(State& state, uint32_t function, uint32_t result)
+{
+    const auto first = m_shader.m_functions[function].first;
+    state.stack.push_back({function, first + 1, m_shader.Operands(m_shader.m_instructions[first])[0], result});
+}
+
+bool SoftwareShader::Invocation::Jump(State& state, uint32_t label, bool others)
+{
+    auto& frame = state.stack.back();
+    for(int l = 0; l < W; l++)
+        if(state.mask & (1 << l))
+            m_prevBlock[l] = frame.block;
+    frame.block = label;
+    frame.ip    = m_shader.m_labels[label] + 1;
+    if(others && m_shader.m_merges[label])
+    {
+        state.suspended = true;
+        return true;
+    }
+    return false;
+}
+
+void SoftwareShader::Invocation::Branch(State& state, uint32_t mask, uint32_t label)
+{
+    State other = state;
+    other.mask  = mask;
+    Jump(other, label, true);
+    m_states.push_back(std::move(other));
+}
+
+void SoftwareShader::Invocation::Load(uint32_t result, const Pointer& pointer, uint32_t mask)
+{
+    const auto  type  = m_shader.m_ids[result].type;
+    const auto  count = m_shader.m_types[type].scalars;
+    auto*       value = Value(result);
+    for(int l = 0; l < W; l++)
+    {
+        if(!(mask & (1 << l)))
+            continue;
+        switch(pointer.kind)
+        {
+        case MemoryPointer:
+            for(uint32_t s = 0; s < count; s++)
+                value[s * W + l] = m_memory[(static_cast<size_t>(pointer.offset[l]) + s) * W + l];
+            break;
+        case BufferPointer: {
+            const uint8_t* data = pointer.buffer < 0 ? m_bindings->pushConstants :
+                                  (pointer.buffer < static_cast<int32_t>(m_bindings->uniforms.size()) ? m_bindings->uniforms[pointer.buffer] : nullptr);
+            if(data)
+                LoadBuffer(value, data, pointer.offset[l], type, pointer.matrixStride, pointer.rowMajor, l);
+            else
+                for(uint32_t s = 0; s < count; s++)
+                    value[s * W + l].u = 0;
+            break;
+        }
+        case HandlePointer:
+            value[l].i = pointer.offset[l];
+            break;
+        }
+    }
+}
+
+void SoftwareShader::Invocation::LoadBuffer(SoftwareScalar* out, const uint8_t* data, uint32_t offset, uint32_t type, uint32_t matrixStride, bool rowMajor, int lane)
+{
+    const auto& t = m_shader.m_types[type];
+    switch(t.op)
+    {
+    case OpTypeMatrix: {
+        const auto rows = m_shader.m_types[t.element].count;
+        for(uint32_t c = 0; c < t.count; c++)
+            for(uint32_t r = 0; r < rows; r++)
+                memcpy(&out[(c * rows + r) * W + lane], data + offset + (rowMajor ? r * matrixStride + c * 4 : c * matrixStride + r * 4), 4);
+        break;
+    }
+    case OpTypeVector:
+        // a column of a row-major matrix is strided
+        for(uint32_t c = 0; c < t.count; c++)
+            memcpy(&out[c * W + lane], data + offset + c * (rowMajor ? matrixStride : 4), 4);
+        break;
+    case OpTypeArray: {
+        const auto scalars = m_shader.m_types[t.element].scalars;
+        for(uint32_t i = 0; i < t.count; i++)
+            LoadBuffer(out + i * scalars * W, data, offset + i * t.arrayStride, t.element, matrixStride, rowMajor, lane);
+        break;
+    }
+    case OpTypeStruct:
+        for(size_t m = 0; m < t.members.size(); m++)
+            LoadBuffer(out + t.memberScalars[m] * W, data, offset + t.memberOffsets[m], t.members[m], t.memberMatrixStrides[m], t.memberRowMajor[m], lane);
+        break;
+    default:
+        memcpy(&out[lane], data + offset, 4);
+        break;
+    }
+}
+
+void SoftwareShader::Invocation::Store(const Pointer& pointer, const SoftwareScalar* value, uint32_t count, uint32_t mask)
+{
+    if(pointer.kind != MemoryPointer)
+        return;
+    for(int l = 0; l < W; l++)
+    {
+        if(!(mask & (1 << l)))
+            continue;
+        for(uint32_t s = 0; s < count; s++)
+            m_memory[(static_cast<size_t>(pointer.offset[l]) + s) * W + l] = value[s * W + l];
+    }
+}
+
+void SoftwareShader::Invocation::AccessChain(uint32_t result, const uint32_t* indices, int count, uint32_t base, uint32_t mask)
+{
+    const auto& source = m_pointers[m_shader.m_ids[base].pointer];
+    auto&       target = m_pointers[m_shader.m_ids[result].pointer];
+    auto        chain  = source;
+    for(int l = 0; l < W; l++)
+    {
+        auto type = m_shader.m_types[m_shader.m_ids[base].type].element;
+        for(int i = 0; i < count; i++)
+        {
+            const auto  index = Value(indices[i])[l].u;
+            const auto& t     = m_shader.m_types[type];
+            uint32_t    subType;
+            switch(chain.kind)
+            {
+            case MemoryPointer:
+                chain.offset[l] += m_shader.ScalarOffset(type, index, subType);
+                break;
+            case BufferPointer:
+                if(t.op == OpTypeStruct)
+                {
+                    chain.offset[l] += t.memberOffsets[index];
+                    chain.matrixStride = t.memberMatrixStrides[index];
+                    chain.rowMajor     = t.memberRowMajor[index];
+                    subType            = t.members[index];
+                }
+                else if(t.op == OpTypeArray || t.op == OpTypeRuntimeArray)
+                {
+                    chain.offset[l] += index * t.arrayStride;
+                    subType = t.element;
+                }
+                else if(t.op == OpTypeMatrix)
+                {
+                    chain.offset[l] += index * (chain.rowMajor ? 4 : chain.matrixStride);
+                    subType = t.element;
+                }
+                else
+                {
+                    chain.offset[l] += index * (chain.rowMajor ? chain.matrixStride : 4);
+                    subType = t.element;
+                }
+                break;
+            default:
+                chain.offset[l] += index;
+                subType = t.element;
+                break;
+            }
+            type = subType;
+        }
+    }
+
+    target.kind         = chain.kind;
+    target.buffer       = chain.buffer;
+    target.matrixStride = chain.matrixStride;
+    target.rowMajor     = chain.rowMajor;
+    for(int l = 0; l < W; l++)
+        if(mask & (1 << l))
+            target.offset[l] = chain.offset[l];
+}
+
+static float Derivative(const SoftwareScalar* a, int lane, int axis)
+{
+    const auto base = lane & ~axis;
+    return a[base + axis].f - a[base].f;
+}
+
+void SoftwareShader::Invocation::Sample(uint32_t result, const uint32_t* o, int n, uint16_t op, uint32_t mask)
+{
+    const auto* image  = Value(o[2]);
+    const auto* coord  = Value(o[3]);
+    const auto  coords = m_shader.m_types[m_shader.m_ids[o[3]].type].scalars;
+    auto*       r      = Out(4);
+
+    // only offsets matter without mipmaps
+    const SoftwareScalar* offset = nullptr;
+    if(n > 4)
+    {
+        const auto operands = o[4];
+        int        next     = 5;
+        for(int bit = 0; bit < 8 && next < n; bit++)
+        {
+            if(!(operands & (1 << bit)))
+                continue;
+            if(bit == ImageOperandsConstOffsetShift || bit == ImageOperandsOffsetShift)
+                offset = Value(o[next]);
+            next += bit == ImageOperandsGradShift ? 2 : 1;
+        }
+    }
+
+    for(int l = 0; l < W; l++)
+    {
+        float      rgba[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        const auto binding = image[l].i;
+        if((mask & (1 << l)) && binding >= 0 && binding < static_cast<int>(m_bindings->textures.size()) && m_bindings->textures[binding])
+        {
+            const auto* texture = m_bindings->textures[binding];
+            const auto  ox      = offset ? offset[l].i : 0;
+            const auto  oy      = offset ? offset[W + l].i : 0;
+            if(op == OpImageFetch)
+            {
+                texture->Fetch(coord[l].i + ox, coord[W + l].i + oy, rgba);
+            }
+            else
+            {
+                float u = coord[l].f;
+                float v = coord[W + l].f;
+                if(op == OpImageSampleProjImplicitLod || op == OpImageSampleProjExplicitLod)
+                {
+                    const auto q = coord[(coords - 1) * W + l].f;
+                    u /= q;
+                    v /= q;
+                }
+                texture->Sample(m_bindings->samplers[binding], u, v, ox, oy, rgba);
+            }
+        }
+        for(int c = 0; c < 4; c++)
+            r[c * W + l].f = rgba[c];
+    }
+    Commit(result, 4, mask);
+}
+
+void SoftwareShader::Invocation::ExtInst(uint32_t result, uint32_t type, const uint32_t* o, int n, uint32_t mask)
+{
+    const auto  count = m_shader.m_types[type].scalars;
+    const auto  size  = count * W;
+    const auto* a     = n > 4 ? Value(o[4]) : nullptr;
+    const auto* b     = n > 5 ? Value(o[5]) : nullptr;
+    const auto* c     = n > 6 ? Value(o[6]) : nullptr;
+    auto*       r     = Out(count);
+
+#define FLOAT1(expr)                   \
+    for(uint32_t i = 0; i < size; i++) \
+    {                                  \
+        const float x = a[i].f;        \
+        r[i].f        = (expr);        \
+    }                                  \
+    break;
+#define FLOAT2(expr)                   \
+    for(uint32_t i = 0; i < size; i++) \
+    {                                  \
+        const float x = a[i].f;        \
+        const float y = b[i].f;        \
+        r[i].f        = (expr);        \
+    }                                  \
+    break;
+#define FLOAT3(expr)                   \
+    for(uint32_t i = 0; i < size; i++) \
+    {                                  \
+        const float x = a[i].f;        \
+        const float y = b[i].f;        \
+        const float z = c[i].f;        \
+        r[i].f        = (expr);        \
+    }                                  \
+    break;
+#ifdef SOFTWARE_SSE2
+#define FLOAT1_LANES(vector, scalar)      \
+    for(uint32_t i = 0; i < size; i += 4) \
+    {                                     \
+        const auto x = LoadLanes(a + i);  \
+        StoreLanes(r + i, (vector));      \
+    }                                     \
+    break;
+#define FLOAT2_LANES(vector, scalar)      \
+    for(uint32_t i = 0; i < size; i += 4) \
+    {                                     \
+        const auto x = LoadLanes(a + i);  \
+        const auto y = LoadLanes(b + i);  \
+        StoreLanes(r + i, (vector));      \
+    }                                     \
+    break;
+#define FLOAT3_LANES(vector, scalar)      \
+    for(uint32_t i = 0; i < size; i += 4) \
+    {                                     \
+        const auto x = LoadLanes(a + i);  \
+        const auto y = LoadLanes(b + i);  \
+        const auto z = LoadLanes(c + i);  \
+        StoreLanes(r + i, (vector));      \
+    }                                     \
+    break;
+#else
+#define FLOAT1_LANES(vector, scalar) FLOAT1(scalar)
+#define FLOAT2_LANES(vector, scalar) FLOAT2(scalar)
+#define FLOAT3_LANES(vector, scalar) FLOAT3(scalar)
+#endif
+#define INT2(field, expr)              \
+    for(uint32_t i = 0; i < size; i++) \
+    {                                  \
+        const auto x = a[i].field;     \
+        const auto y = b[i].field;     \
+        r[i].field   = (expr);         \
+    }                                  \
+    break;
+
+    const auto vectorSize = n > 4 ? m_shader.m_types[m_shader.m_ids[o[4]].type].scalars : 0;
+    auto       dot        = [&](const SoftwareScalar* x, const SoftwareScalar* y, int l) {
+        float sum = 0.0f;
+        for(uint32_t i = 0; i < vectorSize; i++)
+            sum += x[i * W + l].f * y[i * W + l].f;
+        return sum;
+    };
+
+    switch(o[3])
+    {
+    case GLSLstd450Round:
+        FLOAT1(std::round(x))
+    case GLSLstd450RoundEven:
+        FLOAT1(std::nearbyint(x))
+    case GLSLstd450Trunc:
+        FLOAT1(std::trunc(x))
+    case GLSLstd450FAbs:
+        FLOAT1_LANES(_mm_andnot_ps(_mm_set1_ps(-0.0f), x), std::fabs(x))
+    case GLSLstd450SAbs:
+        for(uint32_t i = 0; i < size; i++)
+            r[i].i = a[i].i < 0 ? -a[i].i : a[i].i;
+        break;
+    case GLSLstd450FSign:
+        FLOAT1(x > 0.0f ? 1.0f : (x < 0.0f ? -1.0f : 0.0f))
+    case GLSLstd450SSign:
+        for(uint32_t i = 0; i < size; i++)
+            r[i].i = a[i].i > 0 ? 1 : (a[i].i < 0 ? -1 : 0);
+        break;
+    case GLSLstd450Floor:
+        FLOAT1(std::floor(x))
+    case GLSLstd450Ceil:
+        FLOAT1(std::ceil(x))
+    case GLSLstd450Fract:
+        FLOAT1(x - std::floor(x))
+    case GLSLstd450Radians:
+        FLOAT1_LANES(_mm_mul_ps(x, _mm_set1_ps(0.01745329251994329577f)), x * 0.01745329251994329577f)
+    case GLSLstd450Degrees:
+        FLOAT1_LANES(_mm_mul_ps(x, _mm_set1_ps(57.2957795130823208768f)), x * 57.2957795130823208768f)
+    case GLSLstd450Sin:
+        FLOAT1(std::sin(x))
+    case GLSLstd450Cos:
+        FLOAT1(std::cos(x))
+    case GLSLstd450Tan:
+        FLOAT1(std::tan(x))
+    case GLSLstd450Asin:
+        FLOAT1(std::asin(x))
+    case GLSLstd450Acos:
+        FLOAT1(std::acos(x))
+    case GLSLstd450Atan:
+        FLOAT1(std::atan(x))
+    case GLSLstd450Sinh:
+        FLOAT1(std::sinh(x))
+    case GLSLstd450Cosh:
+        FLOAT1(std::cosh(x))
+    case GLSLstd450Tanh:
+        FLOAT1(std::tanh(x))
+    case GLSLstd450Asinh:
+        FLOAT1(std::asinh(x))
+    case GLSLstd450Acosh:
+        FLOAT1(std::acosh(x))
+    case GLSLstd450Atanh:
+        FLOAT1(std::atanh(x))
+    case GLSLstd450Atan2:
+        FLOAT2(std::atan2(x, y))
+    case GLSLstd450Pow:
+        FLOAT2(std::pow(x, y))
+    case GLSLstd450Exp:
+        FLOAT1(std::exp(x))
+    case GLSLstd450Log:
+        FLOAT1(std::log(x))
+    case GLSLstd450Exp2:
+        FLOAT1(std::exp2(x))
+    case GLSLstd450Log2:
+        FLOAT1(std::log2(x))
+    case GLSLstd450Sqrt:
+        FLOAT1_LANES(_mm_sqrt_ps(x), std::sqrt(x))
+    case GLSLstd450InverseSqrt:
+        FLOAT1_LANES(_mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(x)), 1.0f / std::sqrt(x))
+    // minps and maxps return the second operand when either is NaN, as these do
+    case GLSLstd450FMin:
+    case GLSLstd450NMin:
+        FLOAT2_LANES(_mm_min_ps(y, x), y < x ? y : x)
+    case GLSLstd450FMax:
+    case GLSLstd450NMax:
+        FLOAT2_LANES(_mm_max_ps(y, x), x < y ? y : x)
+    case GLSLstd450UMin:
+        INT2(u, y < x ? y : x)
+    case GLSLstd450SMin:
+        INT2(i, y < x ? y : x)
+    case GLSLstd450UMax:
+        INT2(u, x < y ? y : x)
+    case GLSLstd450SMax:
+        INT2(i, x < y ? y : x)
+    case GLSLstd450FClamp:
+    case GLSLstd450NClamp:
+        FLOAT3_LANES(_mm_min_ps(z, _mm_max_ps(y, x)), std::min(std::max(x, y), z))
+    case GLSLstd450UClamp:
+        for(uint32_t i = 0; i < size; i++)
+            r[i].u = std::min(std::max(a[i].u, b[i].u), c[i].u);
+        break;
+    case GLSLstd450SClamp:
+        for(uint32_t i = 0; i < size; i++)
+            r[i].i = std::min(std::max(a[i].i, b[i].i), c[i].i);
+        break;
+    case GLSLstd450FMix:
+        FLOAT3_LANES(_mm_add_ps(x, _mm_mul_ps(_mm_sub_ps(y, x), z)), x + (y - x) * z)
+    case GLSLstd450Step:
+        FLOAT2_LANES(_mm_and_ps(_mm_cmpnlt_ps(y, x), _mm_set1_ps(1.0f)), y < x ? 0.0f : 1.0f)
+    case GLSLstd450SmoothStep:
+        for(uint32_t i = 0; i < size; i++)
+        {
+            auto t = (c[i].f - a[i].f) / (b[i].f - a[i].f);
+            t      = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+            r[i].f = t * t * (3.0f - 2.0f * t);
+        }
+        break;
+    case GLSLstd450Fma:
+        FLOAT3_LANES(_mm_add_ps(_mm_mul_ps(x, y), z), x * y + z)
+    case GLSLstd450Ldexp:
+        for(uint32_t i = 0; i < size; i++)
+            r[i].f = std::ldexp(a[i].f, b[i].i);
+        break;
+    case GLSLstd450Modf: {
+        // whole part goes through a pointer
+        auto* whole = &m_scratch[size];
+        if(m_scratch.size() < 2 * static_cast<size_t>(size))
+        {
+            m_scratch.resize(2 * static_cast<size_t>(size));
+            r     = m_scratch.data();
+            whole = &m_scratch[size];
+        }
+        for(uint32_t i = 0; i < size; i++)
+        {
+            float part;
+            r[i].f     = std::modf(a[i].f, &part);
+            whole[i].f = part;
+        }
+        Store(m_pointers[m_shader.m_ids[o[5]].pointer], whole, count, mask);
+        break;
+    }
+    case GLSLstd450Length:
+        for(int l = 0; l < W; l++)
+            r[l].f = std::sqrt(dot(a, a, l));
+        break;
+    case GLSLstd450Distance:
+        for(int l = 0; l < W; l++)
+        {
+            float sum = 0.0f;
+            for(uint32_t i = 0; i < vectorSize; i++)
+            {
+                const auto d = a[i * W + l].f - b[i * W + l].f;
+                sum += d * d;
+            }
+            r[l].f = std::sqrt(sum);
+        }
+        break;
+    case GLSLstd450Cross:
+        for(int l = 0; l < W; l++)
+        {
+            const float ax = a[l].f, ay = a[W + l].f, az = a[2 * W + l].f;
+            const float bx = b[l].f, by = b[W + l].f, bz = b[2 * W + l].f;
+            r[l].f         = ay * bz - az * by;
+            r[W + l].f     = az * bx - ax * bz;
+            r[2 * W + l].f = ax * by - ay * bx;
+        }
+        break;
+    case GLSLstd450Normalize:
+        for(int l = 0; l < W; l++)
+        {
+            const auto scale = 1.0f / std::sqrt(dot(a, a, l));
+            for(uint32_t i = 0; i < count; i++)
+                r[i * W + l].f = a[i * W + l].f * scale;
+        }
+        break;
+    case GLSLstd450FaceForward:
+        for(int l = 0; l < W; l++)
+        {
+            const auto sign = dot(c, b, l) < 0.0f ? 1.0f : -1.0f;
+            for(uint32_t i = 0; i < count; i++)
+                r[i * W + l].f = a[i * W + l].f * sign;
+        }
+        break;
+    case GLSLstd450Reflect:
+        for(int l = 0; l < W; l++)
+        {
+            const auto d = 2.0f * dot(b, a, l);
+            for(uint32_t i = 0; i < count; i++)
+                r[i * W + l].f = a[i * W + l].f - d * b[i * W + l].f;
+        }
+        break;
+    case GLSLstd450Refract:
+        for(int l = 0; l < W; l++)
+        {
+            const auto eta = c[l].f;
+            const auto d   = dot(b, a, l);
+            const auto k   = 1.0f - eta * eta * (1.0f - d * d);
+            for(uint32_t i = 0; i < count; i++)
+                r[i * W + l].f = k < 0.0f ? 0.0f : eta * a[i * W + l].f - (eta * d + std::sqrt(k)) * b[i * W + l].f;
+        }
+        break;
+    case GLSLstd450Determinant:
+    case GLSLstd450MatrixInverse: {
+        // Gauss-Jordan on each lane, matrices are column-major
+        const auto dim = m_shader.m_types[m_shader.m_types[m_shader.m_ids[o[4]].type].element].count;
+        for(int l = 0; l < W; l++)
+        {
+            float m[4][8];
+            for(uint32_t row = 0; row < dim; row++)
+                for(uint32_t col = 0; col < dim; col++)
+                {
+                    m[row][col]       = a[(col * dim + row) * W + l].f;
+                    m[row][col + dim] = row == col ? 1.0f : 0.0f;
+                }
+            float det = 1.0f;
+            for(uint32_t col = 0; col < dim; col++)
+            {
+                auto pivot = col;
+                for(uint32_t row = col + 1; row < dim; row++)
+                    if(std::fabs(m[row][col]) > std::fabs(m[pivot][col]))
+                        pivot = row;
+                if(pivot != col)
+                {
+                    for(uint32_t k = 0; k < 2 * dim; k++)
+                        std::swap(m[pivot][k], m[col][k]);
+                    det = -det;
+                }
+                const auto p = m[col][col];
+                det *= p;
+                if(p == 0.0f)
+                    break;
+                for(uint32_t k = 0; k < 2 * dim; k++)
+                    m[col][k] /= p;
+                for(uint32_t row = 0; row < dim; row++)
+                {
+                    if(row == col)
+                        continue;
+                    const auto f = m[row][col];
+                    for(uint32_t k = 0; k < 2 * dim; k++)
+                        m[row][k] -= f * m[col][k];
+                }
+            }
+            if(o[3] == GLSLstd450Determinant)
+                r[l].f = det;
+            else
+                for(uint32_t row = 0; row < dim; row++)
+                    for(uint32_t col = 0; col < dim; col++)
+                        r[(col * dim + row) * W + l].f = m[row][col + dim];
+        }
+        break;
+    }
+    default:
+        throw std::runtime_error("Unsupported extended instruction " + std::to_string(o[3]));
+    }
+
+#undef FLOAT1
+#undef FLOAT2
+#undef FLOAT3
+#undef FLOAT1_LANES
+#undef FLOAT2_LANES
+#undef FLOAT3_LANES
+#undef INT2
+
+    Commit(result, count, mask);
+}
+
+void SoftwareShader::Invocation::Execute(State& state)
+{
+    while(!state.stack.empty() && !state.suspended)
+    {
+        auto&           frame       = state.stack.back();
+        const auto&     instruction = m_shader.m_instructions[frame.ip];
+        const uint32_t* o           = m_shader.Operands(instruction);
+        const int       n           = instruction.words - 1;
+        const auto      mask        = state.mask;
+        const auto      op          = instruction.op;
+
+        // operand counts are in scalars, each scalar has a value for every lane
+        const auto  count = n > 0 ? m_shader.m_types[o[0]].scalars : 0;
+        const auto  size  = count * W;
+        const auto  bound = m_shader.m_ids.size();
+        const auto* a     = n > 2 && o[2] < bound && m_shader.m_ids[o[2]].value >= 0 ? Value(o[2]) : nullptr;
+        const auto* b     = n > 3 && o[3] < bound && m_shader.m_ids[o[3]].value >= 0 ? Value(o[3]) : nullptr;
+
+#define UNARY(in, out, expr)           \
+    {                                  \
+        auto* r = Out(count);          \
+        for(uint32_t i = 0; i < size; i++) \
+        {                              \
+            const auto x = a[i].in;    \
+            r[i].out     = (expr);     \
+        }                              \
+        Commit(o[1], count, mask);     \
+        break;                         \
+    }
+#define BINARY(in, out, expr)          \
+    {                                  \
+        auto* r = Out(count);          \
+        for(uint32_t i = 0; i < size; i++) \
+        {                              \
+            const auto x = a[i].in;    \
+            const auto y = b[i].in;    \
+            r[i].out     = (expr);     \
+        }                              \
+        Commit(o[1], count, mask);     \
+        break;                         \
+    }
+#ifdef SOFTWARE_SSE2
+#define BINARY_LANES(out, vector, scalar)     \
+    {                                         \
+        auto* r = Out(count);                 \
+        for(uint32_t i = 0; i < size; i += 4) \
+        {                                     \
+            const auto x = LoadLanes(a + i);  \
+            const auto y = LoadLanes(b + i);  \
+            StoreLanes(r + i, (vector));      \
+        }                                     \
+        Commit(o[1], count, mask);            \
+        break;                                \
+    }
+#else
+#define BINARY_LANES(out, vector, scalar) BINARY(f, out, scalar)
+#endif
+
+        frame.ip++;
+        switch(op)
+        {
+        case OpNop:
+        case OpLine:
+        case OpNoLine:
+        case OpUndef:
+        case OpSelectionMerge:
+        case OpLoopMerge:
+        case OpLabel:
+            break;
+
+        case OpVariable: {
+            const auto& id = m_shader.m_ids[o[1]];
+            if(id.initializer)
+                Store(m_pointers[id.pointer], Value(id.initializer), m_shader.Scalars(o[1]), mask);
+            break;
+        }
+        case OpLoad:
+            Load(o[1], m_pointers[m_shader.m_ids[o[2]].pointer], mask);
+            break;
+        case OpStore: {
+            const auto& value = m_shader.m_ids[o[1]];
+            Store(m_pointers[m_shader.m_ids[o[0]].pointer], Value(o[1]), m_shader.m_types[value.type].scalars, mask);
+            break;
+        }
+        case OpCopyMemory: {
+            const auto& source = m_pointers[m_shader.m_ids[o[1]].pointer];
+            const auto  scalars = m_shader.m_types[m_shader.m_types[m_shader.m_ids[o[1]].type].element].scalars;
+            auto*       r       = Out(scalars);
+            for(int l = 0; l < W; l++)
+                if(mask & (1 << l))
+                    for(uint32_t s = 0; s < scalars; s++)
+                        r[s * W + l] = m_memory[(static_cast<size_t>(source.offset[l]) + s) * W + l];
+            Store(m_pointers[m_shader.m_ids[o[0]].pointer], r, scalars, mask);
+            break;
+        }
+        case OpAccessChain:
+        case OpInBoundsAccessChain:
+            AccessChain(o[1], &o[3], n - 3, o[2], mask);
+            break;
+        case OpCopyObject:
+            if(m_shader.m_ids[o[1]].pointer >= 0)
+            {
+                const auto& source = m_pointers[m_shader.m_ids[o[2]].pointer];
+                auto&       target = m_pointers[m_shader.m_ids[o[1]].pointer];
+                target.kind         = source.kind;
+                target.buffer       = source.buffer;
+                target.matrixStride = source.matrixStride;
+                target.rowMajor     = source.rowMajor;
+                for(int l = 0; l < W; l++)
+                    if(mask & (1 << l))
+                        target.offset[l] = source.offset[l];
+                break;
+            }
+            UNARY(u, u, x)
+
+        case OpCompositeConstruct: {
+            auto*    r = Out(count);
+            uint32_t s = 0;
+            for(int c = 2; c < n; c++)
+            {
+                const auto  scalars = m_shader.m_types[m_shader.m_ids[o[c]].type].scalars;
+                const auto* source  = Value(o[c]);
+                memcpy(&r[s * W], source, sizeof(SoftwareScalar) * scalars * W);
+                s += scalars;
+            }
+            Commit(o[1], count, mask);
+            break;
+        }
+        case OpCompositeExtract: {
+            auto     type   = m_shader.m_ids[o[2]].type;
+            uint32_t offset = 0;
+            for(int i = 3; i < n; i++)
+            {
+                uint32_t subType;
+                offset += m_shader.ScalarOffset(type, o[i], subType);
+                type = subType;
+            }
+            auto* r = Out(count);
+            memcpy(r, a + offset * W, sizeof(SoftwareScalar) * size);
+            Commit(o[1], count, mask);
+            break;
+        }
+        case OpCompositeInsert: {
+            auto     type   = m_shader.m_ids[o[3]].type;
+            uint32_t offset = 0;
+            for(int i = 4; i < n; i++)
+            {
+                uint32_t subType;
+                offset += m_shader.ScalarOffset(type, o[i], subType);
+                type = subType;
+            }
+            auto* r = Out(count);
+            memcpy(r, b, sizeof(SoftwareScalar) * size);
+            memcpy(r + offset * W, a, sizeof(SoftwareScalar) * m_shader.m_types[m_shader.m_ids[o[2]].type].scalars * W);
+            Commit(o[1], count, mask);
+            break;
+        }
+        case OpVectorShuffle: {
+            const auto first = m_shader.m_types[m_shader.m_ids[o[2]].type].scalars;
+            auto*      r     = Out(count);
+            for(int c = 4; c < n; c++)
+            {
+                const auto component = o[c];
+                auto*      target    = &r[(c - 4) * W];
+                if(component == 0xffffffff)
+                    memset(target, 0, sizeof(SoftwareScalar) * W);
+                else
+                    memcpy(target, component < first ? a + component * W : b + (component - first) * W, sizeof(SoftwareScalar) * W);
+            }
+            Commit(o[1], count, mask);
+            break;
+        }
+        case OpVectorExtractDynamic: {
+            const auto components = m_shader.m_types[m_shader.m_ids[o[2]].type].scalars;
+            auto*      r          = Out(count);
+            for(int l = 0; l < W; l++)
+                r[l] = b[l].u < components ? a[b[l].u * W + l] : SoftwareScalar {};
+            Commit(o[1], count, mask);
+            break;
+        }
+        case OpVectorInsertDynamic: {
+            const auto* index = Value(o[4]);
+            auto*       r     = Out(count);
+            memcpy(r, a, sizeof(SoftwareScalar) * size);
+            for(int l = 0; l < W; l++)
+                if(index[l].u < count)
+                    r[index[l].u * W + l] = b[l];
+            Commit(o[1], count, mask);
+            break;
+        }
+        case OpTranspose: {
+            const auto& type = m_shader.m_types[o[0]];
+            const auto  rows = m_shader.m_types[type.element].count;
+            auto*       r    = Out(count);
+            for(uint32_t c = 0; c < type.count; c++)
+                for(uint32_t row = 0; row < rows; row++)
+                    memcpy(&r[(c * rows + row) * W], &a[(row * type.count + c) * W], sizeof(SoftwareScalar) * W);
+            Commit(o[1], count, mask);
+            break;
+        }
+
+        case OpConvertFToU:
+            UNARY(f, u, x != x || x <= 0.0f ? 0u : (x >= 4294967295.0f ? 0xffffffffu : static_cast<uint32_t>(x)))
+        case OpConvertFToS:
+            UNARY(f, i, x != x ? 0 : (x >= 2147483647.0f ? INT32_MAX : (x <= -2147483648.0f ? INT32_MIN : static_cast<int32_t>(x))))
+        case OpConvertSToF:
+            UNARY(i, f, static_cast<float>(x))
+        case OpConvertUToF:
+            UNARY(u, f, static_cast<float>(x))
+        case OpUConvert:
+        case OpSConvert:
+        case OpFConvert:
+        case OpQuantizeToF16:
+        case OpBitcast:
+            UNARY(u, u, x)
+
+        case OpSNegate:
+            UNARY(u, u, 0u - x)
+        case OpFNegate:
+            UNARY(f, f, -x)
+        case OpIAdd:
+            BINARY(u, u, x + y)
+        case OpFAdd:
+            BINARY_LANES(f, _mm_add_ps(x, y), x + y)
+        case OpISub:
+            BINARY(u, u, x - y)
+        case OpFSub:
+            BINARY_LANES(f, _mm_sub_ps(x, y), x - y)
+        case OpIMul:
+            BINARY(u, u, x * y)
+        case OpFMul:
+            BINARY_LANES(f, _mm_mul_ps(x, y), x * y)
+        case OpFDiv:
+            BINARY_LANES(f, _mm_div_ps(x, y), x / y)
+        // inactive lanes hold anything, integer division must not trap on them
+        case OpUDiv:
+            BINARY(u, u, y == 0 ? 0u : x / y)
+        case OpSDiv:
+            BINARY(i, i, y == 0 || (x == INT32_MIN && y == -1) ? 0 : x / y)
+        case OpUMod:
+            BINARY(u, u, y == 0 ? 0u : x % y)
+        case OpSRem:
+            BINARY(i, i, y == 0 || y == -1 ? 0 : x % y)
+        case OpSMod:
+            BINARY(i, i, y == 0 || y == -1 ? 0 : ((x % y) != 0 && ((x % y) < 0) != (y < 0) ? x % y + y : x % y))
+        case OpFRem:
+            BINARY(f, f, std::fmod(x, y))
+        case OpFMod:
+            BINARY(f, f, x - y * std::floor(x / y))
+
+        case OpVectorTimesScalar:
+        case OpMatrixTimesScalar: {
+            auto* r = Out(count);
+#ifdef SOFTWARE_SSE2
+            for(uint32_t s = 0; s < count; s++)
+                for(int l = 0; l < W; l += 4)
+                    StoreLanes(r + s * W + l, _mm_mul_ps(LoadLanes(a + s * W + l), LoadLanes(b + l)));
+#else
+            for(uint32_t s = 0; s < count; s++)
+                for(int l = 0; l < W; l++)
+                    r[s * W + l].f = a[s * W + l].f * b[l].f;
+#endif
+            Commit(o[1], count, mask);
+            break;
+        }
+        case OpMatrixTimesVector: {
+            const auto& matrix = m_shader.m_types[m_shader.m_ids[o[2]].type];
+            const auto  rows   = m_shader.m_types[matrix.element].count;
+            auto*       r      = Out(count);
+#ifdef SOFTWARE_SSE2
+            for(uint32_t row = 0; row < rows; row++)
+                for(int l = 0; l < W; l += 4)
+                {
+                    auto sum = _mm_setzero_ps();
+                    for(uint32_t c = 0; c < matrix.count; c++)
+                        sum = _mm_add_ps(sum, _mm_mul_ps(LoadLanes(a + (c * rows + row) * W + l), LoadLanes(b + c * W + l)));
+                    StoreLanes(r + row * W + l, sum);
+                }
+#else
+            for(uint32_t row = 0; row < rows; row++)
+                for(int l = 0; l < W; l++)
+                {
+                    float sum = 0.0f;
+                    for(uint32_t c = 0; c < matrix.count; c++)
+                        sum += a[(c * rows + row) * W + l].f * b[c * W + l].f;
+                    r[row * W + l].f = sum;
+                }
+#endif
+            Commit(o[1], count, mask);
+            break;
+        }
+        case OpVectorTimesMatrix: {
+            const auto& matrix = m_shader.m_types[m_shader.m_ids[o[3]].type];
+            const auto  rows   = m_shader.m_types[matrix.element].count;
+            auto*       r      = Out(count);
+            for(uint32_t c = 0; c < matrix.count; c++)
+                for(int l = 0; l < W; l++)
+                {
+                    float sum = 0.0f;
+                    for(uint32_t row = 0; row < rows; row++)
+                        sum += a[row * W + l].f * b[(c * rows + row) * W + l].f;
+                    r[c * W + l].f = sum;
+                }
+            Commit(o[1], count, mask);
+            break;
+        }
+        case OpMatrixTimesMatrix: {
+            const auto& left    = m_shader.m_types[m_shader.m_ids[o[2]].type];
+            const auto& result  = m_shader.m_types[o[0]];
+            const auto  rows    = m_shader.m_types[left.element].count;
+            const auto  inner   = left.count;
+            auto*       r       = Out(count);
+            for(uint32_t c = 0; c < result.count; c++)
+                for(uint32_t row = 0; row < rows; row++)
+                    for(int l = 0; l < W; l++)
+                    {
+                        float sum = 0.0f;
+                        for(uint32_t k = 0; k < inner; k++)
+                            sum += a[(k * rows + row) * W + l].f * b[(c * inner + k) * W + l].f;
+                        r[(c * rows + row) * W + l].f = sum;
+                    }
+            Commit(o[1], count, mask);
+            break;
+        }
+        case OpOuterProduct: {
+            const auto rows    = m_shader.m_types[m_shader.m_ids[o[2]].type].scalars;
+            const auto columns = m_shader.m_types[m_shader.m_ids[o[3]].type].scalars;
+            auto*      r       = Out(count);
+            for(uint32_t c = 0; c < columns; c++)
+                for(uint32_t row = 0; row < rows; row++)
+                    for(int l = 0; l < W; l++)
+                        r[(c * rows + row) * W + l].f = a[row * W + l].f * b[c * W + l].f;
+            Commit(o[1], count, mask);
+            break;
+        }
+        case OpDot: {
+            const auto components = m_shader.m_types[m_shader.m_ids[o[2]].type].scalars;
+            auto*      r          = Out(1);
+#ifdef SOFTWARE_SSE2
+            for(int l = 0; l < W; l += 4)
+            {
+                auto sum = _mm_setzero_ps();
+                for(uint32_t c = 0; c < components; c++)
+                    sum = _mm_add_ps(sum, _mm_mul_ps(LoadLanes(a + c * W + l), LoadLanes(b + c * W + l)));
+                StoreLanes(r + l, sum);
+            }
+#else
+            for(int l = 0; l < W; l++)
+            {
+                float sum = 0.0f;
+                for(uint32_t c = 0; c < components; c++)
+                    sum += a[c * W + l].f * b[c * W + l].f;
+                r[l].f = sum;
+            }
+#endif
+            Commit(o[1], 1, mask);
+            break;
+        }
+
+        case OpAny:
+        case OpAll: {
+            const auto components = m_shader.m_types[m_shader.m_ids[o[2]].type].scalars;
+            auto*      r          = Out(1);
+            for(int l = 0; l < W; l++)
+            {
+                bool any = false, all = true;
+                for(uint32_t c = 0; c < components; c++)
+                {
+                    any = any || a[c * W + l].u;
+                    all = all && a[c * W + l].u;
+                }
+                r[l].u = op == OpAny ? any : all;
+            }
+            Commit(o[1], 1, mask);
+            break;
+        }
+        case OpIsNan:
+            UNARY(f, u, std::isnan(x) ? 1u : 0u)
+        case OpIsInf:
+            UNARY(f, u, std::isinf(x) ? 1u : 0u)
+        case OpLogicalEqual:
+            BINARY(u, u, (x != 0) == (y != 0))
+        case OpLogicalNotEqual:
+            BINARY(u, u, (x != 0) != (y != 0))
+        case OpLogicalOr:
+            BINARY(u, u, x || y)
+        case OpLogicalAnd:
+            BINARY(u, u, x && y)
+        case OpLogicalNot:
+            UNARY(u, u, !x)
+        case OpSelect: {
+            const auto* condition  = a;
+            const auto  conditions = m_shader.m_types[m_shader.m_ids[o[2]].type].scalars;
+            const auto* left       = b;
+            const auto* right      = Value(o[4]);
+            auto*       r          = Out(count);
+            for(uint32_t i = 0; i < size; i++)
+                r[i] = condition[conditions == 1 ? i % W : i].u ? left[i] : right[i];
+            Commit(o[1], count, mask);
+            break;
+        }
+        case OpIEqual:
+            BINARY(u, u, x == y)
+        case OpINotEqual:
+            BINARY(u, u, x != y)
+        case OpUGreaterThan:
+            BINARY(u, u, x > y)
+        case OpSGreaterThan:
+            BINARY(i, u, x > y)
+        case OpUGreaterThanEqual:
+            BINARY(u, u, x >= y)
+        case OpSGreaterThanEqual:
+            BINARY(i, u, x >= y)
+        case OpULessThan:
+            BINARY(u, u, x < y)
+        case OpSLessThan:
+            BINARY(i, u, x < y)
+        case OpULessThanEqual:
+            BINARY(u, u, x <= y)
+        case OpSLessThanEqual:
+            BINARY(i, u, x <= y)
+        case OpFOrdEqual:
+            BINARY_LANES(u, Bool(_mm_cmpeq_ps(x, y)), x == y)
+        case OpFUnordEqual:
+            BINARY_LANES(u, Bool(_mm_or_ps(_mm_cmpeq_ps(x, y), _mm_cmpunord_ps(x, y))), x == y || x != x || y != y)
+        case OpFOrdNotEqual:
+            BINARY_LANES(u, Bool(_mm_and_ps(_mm_cmpneq_ps(x, y), _mm_cmpord_ps(x, y))), x != y && x == x && y == y)
+        case OpFUnordNotEqual:
+            BINARY_LANES(u, Bool(_mm_cmpneq_ps(x, y)), x != y)
+        case OpFOrdLessThan:
+            BINARY_LANES(u, Bool(_mm_cmplt_ps(x, y)), x < y)
+        case OpFUnordLessThan:
+            BINARY_LANES(u, Bool(_mm_cmpnge_ps(x, y)), !(x >= y))
+        case OpFOrdGreaterThan:
+            BINARY_LANES(u, Bool(_mm_cmpgt_ps(x, y)), x > y)
+        case OpFUnordGreaterThan:
+            BINARY_LANES(u, Bool(_mm_cmpnle_ps(x, y)), !(x <= y))
+        case OpFOrdLessThanEqual:
+            BINARY_LANES(u, Bool(_mm_cmple_ps(x, y)), x <= y)
+        case OpFUnordLessThanEqual:
+            BINARY_LANES(u, Bool(_mm_cmpngt_ps(x, y)), !(x > y))
+        case OpFOrdGreaterThanEqual:
+            BINARY_LANES(u, Bool(_mm_cmpge_ps(x, y)), x >= y)
+        case OpFUnordGreaterThanEqual:
+            BINARY_LANES(u, Bool(_mm_cmpnlt_ps(x, y)), !(x < y))
+
+        case OpShiftRightLogical:
+            BINARY(u, u, x >> (y & 31))
+        case OpShiftRightArithmetic:
+            BINARY(i, i, x >> (y & 31))
+        case OpShiftLeftLogical:
+            BINARY(u, u, x << (y & 31))
+        case OpBitwiseOr:
+            BINARY(u, u, x | y)
+        case OpBitwiseXor:
+            BINARY(u, u, x ^ y)
+        case OpBitwiseAnd:
+            BINARY(u, u, x & y)
+        case OpNot:
+            UNARY(u, u, ~x)
+        case OpBitCount: {
+            auto* r = Out(count);
+            for(uint32_t i = 0; i < size; i++)
+            {
+                uint32_t bits = 0;
+                for(auto x = a[i].u; x; x &= x - 1)
+                    bits++;
+                r[i].u = bits;
+            }
+            Commit(o[1], count, mask);
+            break;
+        }
+
+        // lanes are two 2x2 quads, bit 0 of the lane steps in x and bit 1 in y
+        case OpDPdx:
+        case OpDPdxFine:
+        case OpDPdxCoarse:
+        case OpDPdy:
+        case OpDPdyFine:
+        case OpDPdyCoarse:
+        case OpFwidth:
+        case OpFwidthFine:
+        case OpFwidthCoarse: {
+            const bool x = op == OpDPdx || op == OpDPdxFine || op == OpDPdxCoarse;
+            const bool y = op == OpDPdy || op == OpDPdyFine || op == OpDPdyCoarse;
+            auto*      r = Out(count);
+            for(uint32_t s = 0; s < count; s++)
+                for(int l = 0; l < W; l++)
+                {
+                    const auto* component = a + s * W;
+                    r[s * W + l].f        = x ? Derivative(component, l, 1) :
+                                            (y ? Derivative(component, l, 2) : std::fabs(Derivative(component, l, 1)) + std::fabs(Derivative(component, l, 2)));
+                }
+            Commit(o[1], count, mask);
+            break;
+        }
+
+        case OpPhi: {
+            auto* r = Out(count);
+            for(int l = 0; l < W; l++)
+            {
+                if(!(mask & (1 << l)))
+                    continue;
+                for(int p = 2; p + 1 < n; p += 2)
+                {
+                    if(o[p + 1] == m_prevBlock[l])
+                    {
+                        const auto* source = Value(o[p]);
+                        for(uint32_t s = 0; s < count; s++)
+                            r[s * W + l] = source[s * W + l];
+                        break;
+                    }
+                }
+            }
+            Commit(o[1], count, mask);
+            break;
+        }
+        case OpBranch:
+            Jump(state, o[0], !m_states.empty());
+            break;
+        case OpBranchConditional: {
+            const auto* condition = Value(o[0]);
+            uint32_t    taken     = 0;
+            for(int l = 0; l < W; l++)
+                if(condition[l].u)
+                    taken |= 1 << l;
+            taken &= mask;
+            if(taken == mask)
+                Jump(state, o[1], !m_states.empty());
+            else if(taken == 0)
+                Jump(state, o[2], !m_states.empty());
+            else
+            {
+                Branch(state, mask & ~taken, o[2]);
+                state.mask = taken;
+                Jump(state, o[1], true);
+            }
+            break;
+        }
+        case OpSwitch: {
+            const auto* selector  = Value(o[0]);
+            uint32_t    remaining = mask;
+            uint32_t    first     = 0;
+            uint32_t    firstMask = 0;
+            auto        route     = [&](uint32_t label, uint32_t lanes) {
+                if(!lanes)
+                    return;
+                if(!firstMask)
+                {
+                    first     = label;
+                    firstMask = lanes;
+                }
+                else
+                    Branch(state, lanes, label);
+            };
+            for(int c = 2; c + 1 < n && remaining; c += 2)
+            {
+                uint32_t lanes = 0;
+                for(int l = 0; l < W; l++)
+                    if((remaining & (1 << l)) && selector[l].u == o[c])
+                        lanes |= 1 << l;
+                remaining &= ~lanes;
+                route(o[c + 1], lanes);
+            }
+            route(o[1], remaining);
+            const bool others = !m_states.empty();
+            state.mask        = firstMask;
+            Jump(state, first, others);
+            break;
+        }
+        case OpKill:
+        case OpTerminateInvocation:
+        case OpDemoteToHelperInvocation:
+            m_discarded |= mask;
+            state.stack.clear();
+            break;
+        case OpUnreachable:
+            state.stack.clear();
+            break;
+        case OpReturnValue: {
+            const auto target = frame.result;
+            state.stack.pop_back();
+            if(!state.stack.empty() && target)
+            {
+                const auto  scalars = m_shader.m_types[m_shader.m_ids[target].type].scalars;
+                auto*       r       = Out(scalars);
+                memcpy(r, Value(o[0]), sizeof(SoftwareScalar) * scalars * W);
+                Commit(target, scalars, mask);
+            }
+            break;
+        }
+        case OpReturn:
+            state.stack.pop_back();
+            break;
+        case OpFunctionCall: {
+            const auto& params = m_shader.m_functions[o[2]].params;
+            for(size_t p = 0; p < params.size(); p++)
+            {
+                const auto& param    = m_shader.m_ids[params[p]];
+                const auto& argument = m_shader.m_ids[o[3 + p]];
+                if(param.pointer >= 0)
+                {
+                    const auto& source  = m_pointers[argument.pointer];
+                    auto&       target  = m_pointers[param.pointer];
+                    target.kind         = source.kind;
+                    target.buffer       = source.buffer;
+                    target.matrixStride = source.matrixStride;
+                    target.rowMajor     = source.rowMajor;
+                    for(int l = 0; l < W; l++)
+                        if(mask & (1 << l))
+                            target.offset[l] = source.offset[l];
+                }
+                else
+                {
+                    const auto scalars = m_shader.m_types[param.type].scalars;
+                    auto*      r       = Out(scalars);
+                    memcpy(r, Value(o[3 + p]), sizeof(SoftwareScalar) * scalars * W);
+                    Commit(params[p], scalars, mask);
+                }
+            }
+            Enter(state, o[2], o[1]);
+            break;
+        }
+
+        case OpSampledImage:
+        case OpImage:
+            UNARY(u, u, x)
+        case OpImageSampleImplicitLod:
+        case OpImageSampleExplicitLod:
+        case OpImageSampleProjImplicitLod:
+        case OpImageSampleProjExplicitLod:
+        case OpImageFetch:
+            Sample(o[1], o, n, op, mask);
+            break;
+        case OpImageQuerySizeLod:
+        case OpImageQuerySize: {
+            auto* r = Out(count);
+            for(int l = 0; l < W; l++)
+            {
+                const auto binding = a[l].i;
+                const auto lod     = op == OpImageQuerySizeLod ? b[l].i : 0;
+                int        width = 0, height = 0;
+                if(binding >= 0 && binding < static_cast<int>(m_bindings->textures.size()) && m_bindings->textures[binding] && lod >= 0 && lod < 31)
+                {
+                    width  = std::max(1, m_bindings->textures[binding]->Width() >> lod);
+                    height = std::max(1, m_bindings->textures[binding]->Height() >> lod);
+                }
+                r[l].i     = width;
+                r[W + l].i = height;
+            }
+            Commit(o[1], count, mask);
+            break;
+        }
+        case OpImageQueryLevels: {
+            auto* r = Out(1);
+            for(int l = 0; l < W; l++)
+                r[l].i = 1;
+            Commit(o[1], 1, mask);
+            break;
+        }
+        case OpExtInst:
+            ExtInst(o[1], o[0], o, n, mask);
+            break;
+
+        default:
+            throw std::runtime_error("Unsupported SPIR-V instruction " + std::to_string(op));
+        }
+
+#undef UNARY
+#undef BINARY
+#undef BINARY_LANES
+    }
+}
@@ -0,0 +1,179 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include "SoftwareTexture.h"
+
+// pixels run together, two 2x2 quads side by side so derivatives can be taken within a quad
+constexpr int SoftwareLanes    = 8;
+constexpr int SoftwareAllLanes = (1 << SoftwareLanes) - 1;
+
+union SoftwareScalar
+{
+    float    f;
+    int32_t  i;
+    uint32_t u;
+};
+
+// resources visible to an invocation, indexed by binding
+struct SoftwareBindings
+{
+    std::vector<const uint8_t*>         uniforms;
+    const uint8_t*                      pushConstants {nullptr};
+    std::vector<const SoftwareTexture*> textures;
+    std::vector<SoftwareSampler>        samplers;
+};
+
+// SPIR-V module executed by a lane-parallel interpreter, immutable and shared between threads
+class SoftwareShader
+{
+public:
+    SoftwareShader(const uint32_t* code, size_t words);
+
+    // variable id and scalar offset of an input, output or built-in, false if not declared
+    bool Input(int location, uint32_t& variable) const;
+    bool Output(int location, uint32_t& variable) const;
+    bool BuiltIn(uint32_t builtIn, uint32_t& variable, uint32_t& offset) const;
+
+    // number of scalars in a variable
+    uint32_t Scalars(uint32_t variable) const;
+
+    std::vector<int> InputLocations() const;
+    std::vector<int> OutputLocations() const;
+
+    // per-thread state of execution
+    class Invocation
+    {
+    public:
+        Invocation(const SoftwareShader& shader);
+
+        // SoA storage of a variable's scalar, one value per lane
+        SoftwareScalar* Lanes(uint32_t variable, uint32_t scalar);
+
+        // run entry point for lanes in mask, returns lanes which were discarded
+        uint32_t Run(uint32_t mask, const SoftwareBindings& bindings);
+
+    private:
+        struct Pointer
+        {
+            uint8_t  kind;
+            int32_t  buffer;
+            uint32_t matrixStride;
+            bool     rowMajor;
+            int32_t  offset[SoftwareLanes];
+        };
+
+        struct Frame
+        {
+            uint32_t function;
+            uint32_t ip;
+            uint32_t block;
+            uint32_t result;
+        };
+
+        struct State
+        {
+            std::vector<Frame> stack;
+            uint32_t           mask;
+            bool               suspended;
+        };
+
+        void            Execute(State& state);
+        bool            Jump(State& state, uint32_t label, bool others);
+        void            Branch(State& state, uint32_t mask, uint32_t label);
+        void            Enter(State& state, uint32_t function, uint32_t result);
+        SoftwareScalar* Value(uint32_t id);
+        SoftwareScalar* Out(uint32_t count);
+        void            Commit(uint32_t id, uint32_t count, uint32_t mask);
+        void            Load(uint32_t result, const Pointer& pointer, uint32_t mask);
+        void            LoadBuffer(SoftwareScalar* out, const uint8_t* data, uint32_t offset, uint32_t type, uint32_t matrixStride, bool rowMajor, int lane);
+        void            Store(const Pointer& pointer, const SoftwareScalar* value, uint32_t count, uint32_t mask);
+        void            AccessChain(uint32_t result, const uint32_t* indices, int count, uint32_t base, uint32_t mask);
+        void            ExtInst(uint32_t result, uint32_t type, const uint32_t* operands, int count, uint32_t mask);
+        void            Sample(uint32_t result, const uint32_t* operands, int count, uint16_t op, uint32_t mask);
+
+        const SoftwareShader&       m_shader;
+        const SoftwareBindings*     m_bindings;
+        std::vector<SoftwareScalar> m_values;
+        std::vector<SoftwareScalar> m_memory;
+        std::vector<SoftwareScalar> m_scratch;
+        std::vector<Pointer>        m_pointers;
+        std::vector<State>          m_states;
+        uint32_t                    m_prevBlock[SoftwareLanes];
+        uint32_t                    m_discarded;
+    };
+
+private:
+    struct Type
+    {
+        uint32_t              op {0};
+        uint32_t              element {0};
+        uint32_t              count {1};
+        uint32_t              scalars {0};
+        uint32_t              storage {0};
+        bool                  isSigned {false};
+        uint32_t              arrayStride {0};
+        std::vector<uint32_t> members {};
+        std::vector<uint32_t> memberScalars {};
+        std::vector<uint32_t> memberOffsets {};
+        std::vector<uint32_t> memberMatrixStrides {};
+        std::vector<bool>     memberRowMajor {};
+        std::vector<int>      memberBuiltIns {};
+    };
+
+    struct Id
+    {
+        uint32_t type {0};
+        int32_t  value {-1};
+        int32_t  pointer {-1};
+        int32_t  memory {-1};
+        uint32_t storage {0};
+        int32_t  binding {-1};
+        int32_t  location {-1};
+        int32_t  builtIn {-1};
+        uint32_t initializer {0};
+    };
+
+    struct Instruction
+    {
+        uint16_t op;
+        uint16_t words;
+        uint32_t start;
+    };
+
+    struct Function
+    {
+        uint32_t              first {0};
+        std::vector<uint32_t> params {};
+    };
+
+    void            Parse(const uint32_t* code, size_t words);
+    void            AddType(const uint32_t* operands, uint16_t op, int count);
+    void            AddConstant(const uint32_t* operands, uint16_t op, int count);
+    uint32_t        AllocateValue(uint32_t id, uint32_t type);
+    uint32_t        ScalarOffset(uint32_t type, uint32_t index, uint32_t& subType) const;
+    const uint32_t* Operands(const Instruction& instruction) const
+    {
+        return &m_code[instruction.start + 1];
+    }
+
+    std::vector<uint32_t>       m_code;
+    std::vector<Instruction>    m_instructions;
+    std::vector<Type>           m_types;
+    std::vector<Id>             m_ids;
+    std::vector<Function>       m_functions;
+    std::vector<uint32_t>       m_labels;
+    std::vector<bool>           m_merges;
+    std::vector<SoftwareScalar> m_constants;
+    std::vector<uint32_t>       m_variables;
+    uint32_t                    m_entry;
+    uint32_t                    m_glsl;
+    uint32_t                    m_valueScalars;
+    uint32_t                    m_memoryScalars;
+    uint32_t                    m_pointerCount;
+};
@@ -0,0 +1,142 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "SoftwareTexture.h"
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOFTWARE_SSE2
+#endif
+
+SoftwareTexture SoftwareTexture::FromRGBA8(const uint8_t* data, int width, int height)
+{
+    SoftwareTexture texture(width, height);
+    for(size_t i = 0; i < texture.m_texels.size(); i++)
+    {
+        texture.m_texels[i] = data[i] / 255.0f;
+    }
+    return texture;
+}
+
+void SoftwareTexture::ToRGBA8(std::vector<uint8_t>& data) const
+{
+    data.resize(m_texels.size());
+    for(size_t i = 0; i < m_texels.size(); i++)
+    {
+        auto value = m_texels[i] * 255.0f + 0.5f;
+        data[i]    = static_cast<uint8_t>(value < 0.0f ? 0.0f : (value > 255.0f ? 255.0f : value));
+    }
+}
+
+bool SoftwareTexture::Address(int& x, int& y, SoftwareWrap wrap) const
+{
+    switch(wrap)
+    {
+    case SoftwareWrap::Border:
+        return x >= 0 && y >= 0 && x < m_width && y < m_height;
+    case SoftwareWrap::Clamp:
+        x = x < 0 ? 0 : (x >= m_width ? m_width - 1 : x);
+        y = y < 0 ? 0 : (y >= m_height ? m_height - 1 : y);
+        return true;
+    case SoftwareWrap::Repeat:
+        x %= m_width;
+        y %= m_height;
+        if(x < 0)
+            x += m_width;
+        if(y < 0)
+            y += m_height;
+        return true;
+    case SoftwareWrap::Mirror: {
+        auto mirror = [](int c, int size) {
+            c %= 2 * size;
+            if(c < 0)
+                c += 2 * size;
+            return c < size ? c : 2 * size - 1 - c;
+        };
+        x = mirror(x, m_width);
+        y = mirror(y, m_height);
+        return true;
+    }
+    }
+    return false;
+}
+
+void SoftwareTexture::Fetch(int x, int y, float* rgba) const
+{
+    if(x < 0 || y < 0 || x >= m_width || y >= m_height)
+    {
+        rgba[0] = rgba[1] = rgba[2] = rgba[3] = 0.0f;
+        return;
+    }
+    const auto* texel = Texel(x, y);
+    rgba[0]           = texel[0];
+    rgba[1]           = texel[1];
+    rgba[2]           = texel[2];
+    rgba[3]           = texel[3];
+}
+
+void SoftwareTexture::Sample(const SoftwareSampler& sampler, float u, float v, int offsetX, int offsetY, float* rgba) const
+{
+    rgba[0] = rgba[1] = rgba[2] = rgba[3] = 0.0f;
+    if(m_texels.empty() || !std::isfinite(u) || !std::isfinite(v))
+        return;
+
+    if(!sampler.linear)
+    {
+        int x = static_cast<int>(std::floor(u * m_width)) + offsetX;
+        int y = static_cast<int>(std::floor(v * m_height)) + offsetY;
+        if(Address(x, y, sampler.wrap))
+        {
+            const auto* texel = Texel(x, y);
+            rgba[0]           = texel[0];
+            rgba[1]           = texel[1];
+            rgba[2]           = texel[2];
+            rgba[3]           = texel[3];
+        }
+        return;
+    }
+
+    // bilinear between four nearest texel centres
+    auto fx = u * m_width - 0.5f;
+    auto fy = v * m_height - 0.5f;
+    auto x0 = std::floor(fx);
+    auto y0 = std::floor(fy);
+    auto ax = fx - x0;
+    auto ay = fy - y0;
+#ifdef SOFTWARE_SSE2
+    // a texel is one vector
+    auto sum = _mm_setzero_ps();
+    for(int t = 0; t < 4; t++)
+    {
+        int  x      = static_cast<int>(x0) + (t & 1) + offsetX;
+        int  y      = static_cast<int>(y0) + (t >> 1) + offsetY;
+        auto weight = ((t & 1) ? ax : 1.0f - ax) * ((t >> 1) ? ay : 1.0f - ay);
+        if(weight != 0.0f && Address(x, y, sampler.wrap))
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(Texel(x, y)), _mm_set1_ps(weight)));
+    }
+    _mm_storeu_ps(rgba, sum);
+#else
+    for(int t = 0; t < 4; t++)
+    {
+        int  x      = static_cast<int>(x0) + (t & 1) + offsetX;
+        int  y      = static_cast<int>(y0) + (t >> 1) + offsetY;
+        auto weight = ((t & 1) ? ax : 1.0f - ax) * ((t >> 1) ? ay : 1.0f - ay);
+        if(weight != 0.0f && Address(x, y, sampler.wrap))
+        {
+            const auto* texel = Texel(x, y);
+            rgba[0] += texel[0] * weight;
+            rgba[1] += texel[1] * weight;
+            rgba[2] += texel[2] * weight;
+            rgba[3] += texel[3] * weight;
+        }
+    }
+#endif
+}
@@ -0,0 +1,64 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+enum class SoftwareWrap
+{
+    Border,
+    Clamp,
+    Repeat,
+    Mirror
+};
+
+struct SoftwareSampler
+{
+    bool         linear {false};
+    SoftwareWrap wrap {SoftwareWrap::Border};
+};
+
+// RGBA float image, top row first
+class SoftwareTexture
+{
+public:
+    SoftwareTexture() : m_width {0}, m_height {0}, m_texels {} { }
+    SoftwareTexture(int width, int height) : m_width {width}, m_height {height}, m_texels(static_cast<size_t>(width) * height * 4) { }
+
+    // from 8-bit RGBA rows
+    static SoftwareTexture FromRGBA8(const uint8_t* data, int width, int height);
+
+    void   ToRGBA8(std::vector<uint8_t>& data) const;
+    void   Sample(const SoftwareSampler& sampler, float u, float v, int offsetX, int offsetY, float* rgba) const;
+    void   Fetch(int x, int y, float* rgba) const;
+    float* Texel(int x, int y)
+    {
+        return &m_texels[(static_cast<size_t>(y) * m_width + x) * 4];
+    }
+    const float* Texel(int x, int y) const
+    {
+        return &m_texels[(static_cast<size_t>(y) * m_width + x) * 4];
+    }
+    int Width() const
+    {
+        return m_width;
+    }
+    int Height() const
+    {
+        return m_height;
+    }
+    bool Empty() const
+    {
+        return m_texels.empty();
+    }
+
+private:
+    bool Address(int& x, int& y, SoftwareWrap wrap) const;
+
+    int                m_width;
+    int                m_height;
+    std::vector<float> m_texels;
+};
@@ -28,7 +28,7 @@ static inline std::string trim(std::string s)
 
 struct SourceShaderParam
 {
-    SourceShaderParam(std::string s, int size, int buffer) : i {-1}, buffer {buffer}, size {size}, offset {}, name {}, desc {}, min {}, max {}, def {}, step {}
+    SourceShaderParam(std::string s, int size, int buffer) : buffer {buffer}, i {-1}, size {size}, offset {}, name {}, desc {}, min {}, max {}, def {}, step {}
     {
         std::istringstream iss(s);
 
@@ -103,6 +103,12 @@ struct SourceShaderDef
     std::string                        fragmentMetadata;
     std::string                        vertexHash;
     std::string                        fragmentHash;
+    std::string                        vertexSPIRV;
+    std::string                        fragmentSPIRV;
+    std::string                        vertexSPIRVHash;
+    std::string                        fragmentSPIRVHash;
+    std::string                        vertexReflection;
+    std::string                        fragmentReflection;
     std::vector<SourceShaderParam>     params;
     SourceShaderInfo                   info;
     std::string                        format;
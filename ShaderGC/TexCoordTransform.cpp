@@ -0,0 +1,49 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "TexCoordTransform.h"
+
+#include <cmath>
+
+static bool IsWhole(float value, float epsilon)
+{
+    return std::fabs(value - std::round(value)) <= epsilon;
+}
+
+TexCoordTransform TexCoordTransform::FromPreprocess(float sx, float sy, float tx, float ty)
+{
+    // quad corner (-1, -1) carries texcoord (0, 1) and clip y points up while v points down
+    return TexCoordTransform(1.0f / sx, 1.0f / sy, (sx - 1.0f - tx) / (2.0f * sx), (sy - 1.0f + ty) / (2.0f * sy));
+}
+
+bool TexCoordTransform::IsIdentity(float epsilon) const
+{
+    return std::fabs(m_scaleU - 1.0f) <= epsilon && std::fabs(m_scaleV - 1.0f) <= epsilon && std::fabs(m_offsetU) <= epsilon && std::fabs(m_offsetV) <= epsilon;
+}
+
+bool TexCoordTransform::IsTexelAligned(int width, int height, int sourceWidth, int sourceHeight, float epsilon) const
+{
+    if(width <= 0 || height <= 0 || sourceWidth <= 0 || sourceHeight <= 0)
+        return false;
+
+    // one texel of the frame spans one texel of the source, epsilon is in texels across the whole frame
+    if(std::fabs(std::fabs(m_scaleU) * sourceWidth - width) > epsilon || std::fabs(std::fabs(m_scaleV) * sourceHeight - height) > epsilon)
+        return false;
+
+    // texel edges meet, flipped frames start from the other edge
+    if(!IsWhole(m_offsetU * sourceWidth, epsilon) || !IsWhole(m_offsetV * sourceHeight, epsilon))
+        return false;
+
+    // nothing outside of the source, it would sample the border instead of blanks
+    float u0, v0, u1, v1;
+    Apply(0.0f, 0.0f, u0, v0);
+    Apply(1.0f, 1.0f, u1, v1);
+    auto inside = [epsilon](float c, int size) { return c >= -epsilon / size && c <= 1.0f + epsilon / size; };
+    return inside(u0, sourceWidth) && inside(u1, sourceWidth) && inside(v0, sourceHeight) && inside(v1, sourceHeight);
+}
@@ -0,0 +1,37 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+// maps texture coordinates of the preprocessed frame to the captured one: u' = u * scale + offset
+class TexCoordTransform
+{
+public:
+    TexCoordTransform() : m_scaleU {1.0f}, m_scaleV {1.0f}, m_offsetU {0.0f}, m_offsetV {0.0f} { }
+    TexCoordTransform(float scaleU, float scaleV, float offsetU, float offsetV) : m_scaleU {scaleU}, m_scaleV {scaleV}, m_offsetU {offsetU}, m_offsetV {offsetV} { }
+
+    // inverse of the preprocess MVP, which scales and translates the captured frame in clip space
+    static TexCoordTransform FromPreprocess(float sx, float sy, float tx, float ty);
+
+    void Apply(float u, float v, float& outU, float& outV) const
+    {
+        outU = u * m_scaleU + m_offsetU;
+        outV = v * m_scaleV + m_offsetV;
+    }
+
+    bool IsIdentity(float epsilon) const;
+
+    // each texel of a width x height frame lands on one source texel and the frame lies within the source,
+    // so sampling the source directly gives the same texels as sampling the frame; epsilon is in source texels
+    bool IsTexelAligned(int width, int height, int sourceWidth, int sourceHeight, float epsilon) const;
+
+private:
+    float m_scaleU;
+    float m_scaleV;
+    float m_offsetU;
+    float m_offsetV;
+};
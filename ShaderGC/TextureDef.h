@@ -10,7 +10,7 @@ GNU General Public License v3.0
 class TextureDef
 {
 public:
-    TextureDef() : Data {}, DataLength {}, PresetParams {}, Dynamic {false} { }
+    TextureDef() : Data {}, DataLength {}, Dynamic {false}, PresetParams {} { }
 
     std::string                        Name;
     const uint8_t*                     Data;
@@ -0,0 +1,246 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "Tracer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+
+// fields are atomic so WriteJson can copy them while the owning thread overwrites the oldest
+struct TraceEvent
+{
+    std::atomic<const char*> category {nullptr};
+    std::atomic<const char*> name {nullptr};
+    std::atomic<const char*> argName {nullptr};
+    std::atomic<int>         arg {0};
+    std::atomic<uint64_t>    start {0};
+    std::atomic<uint64_t>    end {0};
+};
+
+struct TraceRing
+{
+    int                           id {0};
+    std::atomic<const char*>      threadName {nullptr};
+    std::atomic<uint64_t>         head {0};  // spans written so far
+    std::atomic<uint64_t>         first {0};   // spans before this were cleared
+    std::atomic<uint64_t>         written {0}; // spans before this were written out after the thread exited
+    std::atomic<bool>             inUse {true};
+    std::unique_ptr<TraceEvent[]> events {new TraceEvent[Tracer::RingSize]};
+};
+
+// rings are never freed, once their thread exits and its spans were written out or cleared the next new thread takes
+// them over
+struct ThreadRing
+{
+    TraceRing*  ring {nullptr};
+    const char* name {nullptr};
+
+    ~ThreadRing()
+    {
+        if(ring)
+            ring->inUse = false;
+    }
+};
+
+static std::atomic<bool>                       sEnabled {false};
+static std::mutex                              sRingsMutex;
+static std::vector<std::unique_ptr<TraceRing>> sRings;
+static int                                     sNextId = 1;
+static thread_local ThreadRing                 sThreadRing;
+
+static TraceRing* AcquireRing()
+{
+    std::lock_guard lock(sRingsMutex);
+    TraceRing*      ring = nullptr;
+    for(auto& r : sRings)
+    {
+        if(!r->inUse && std::max(r->first.load(), r->written.load()) == r->head.load())
+        {
+            ring        = r.get();
+            ring->first = ring->head.load();
+            ring->inUse = true;
+            break;
+        }
+    }
+    if(!ring)
+    {
+        sRings.push_back(std::make_unique<TraceRing>());
+        ring = sRings.back().get();
+    }
+    ring->id         = sNextId++;
+    ring->threadName = sThreadRing.name;
+    sThreadRing.ring = ring;
+    return ring;
+}
+
+static void WriteString(std::ostream& out, const char* value)
+{
+    out << '"';
+    for(auto c = value ? value : ""; *c; c++)
+    {
+        if(*c == '"' || *c == '\\')
+            out << '\\';
+        out << *c;
+    }
+    out << '"';
+}
+
+// microseconds with the nanoseconds as fraction
+static void WriteMicroseconds(std::ostream& out, uint64_t nanoseconds)
+{
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%llu.%03llu", (unsigned long long)(nanoseconds / 1000), (unsigned long long)(nanoseconds % 1000));
+    out << buffer;
+}
+
+void Tracer::Enable(bool enable)
+{
+    sEnabled.store(enable, std::memory_order_relaxed);
+}
+
+bool Tracer::IsEnabled()
+{
+    return sEnabled.load(std::memory_order_relaxed);
+}
+
+void Tracer::NameThread(const char* name)
+{
+    sThreadRing.name = name;
+    if(sThreadRing.ring)
+        sThreadRing.ring->threadName = name;
+}
+
+uint64_t Tracer::Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Tracer::Record(const char* category, const char* name, uint64_t start, uint64_t end, const char* argName, int arg)
+{
+    auto ring = sThreadRing.ring ? sThreadRing.ring : AcquireRing();
+    auto head = ring->head.load(std::memory_order_relaxed);
+
+    // a reader which sees any of the new fields also sees the head from before, so it knows the slot is being reused
+    std::atomic_thread_fence(std::memory_order_release);
+    auto& event = ring->events[head % RingSize];
+    event.category.store(category, std::memory_order_relaxed);
+    event.name.store(name, std::memory_order_relaxed);
+    event.argName.store(argName, std::memory_order_relaxed);
+    event.arg.store(arg, std::memory_order_relaxed);
+    event.start.store(start, std::memory_order_relaxed);
+    event.end.store(end, std::memory_order_relaxed);
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+void Tracer::WriteJson(std::ostream& out)
+{
+    struct Copy
+    {
+        const char* category;
+        const char* name;
+        const char* argName;
+        int         arg;
+        uint64_t    start;
+        uint64_t    end;
+    };
+
+    struct Thread
+    {
+        int               id;
+        const char*       name;
+        std::vector<Copy> spans;
+    };
+
+    std::vector<Thread> threads;
+    {
+        std::lock_guard lock(sRingsMutex);
+        for(const auto& ring : sRings)
+        {
+            Thread thread {ring->id, ring->threadName.load(), {}};
+            auto   exited = !ring->inUse.load();
+            auto   head   = ring->head.load(std::memory_order_acquire);
+            // the oldest slot is the one its thread writes next
+            auto first = std::max(ring->first.load(), head >= RingSize ? head - RingSize + 1 : 0);
+            for(auto i = first; i < head; i++)
+            {
+                const auto& event = ring->events[i % RingSize];
+                thread.spans.push_back({event.category.load(std::memory_order_relaxed),
+                                        event.name.load(std::memory_order_relaxed),
+                                        event.argName.load(std::memory_order_relaxed),
+                                        event.arg.load(std::memory_order_relaxed),
+                                        event.start.load(std::memory_order_relaxed),
+                                        event.end.load(std::memory_order_relaxed)});
+            }
+
+            // drop the oldest spans if the thread went round the ring while they were copied
+            std::atomic_thread_fence(std::memory_order_acquire);
+            auto newHead = ring->head.load(std::memory_order_relaxed);
+            if(newHead >= RingSize && newHead - RingSize + 1 > first)
+            {
+                auto overwritten = std::min<uint64_t>(newHead - RingSize + 1 - first, thread.spans.size());
+                thread.spans.erase(thread.spans.begin(), thread.spans.begin() + overwritten);
+            }
+            if(exited)
+                ring->written = head;
+            threads.push_back(std::move(thread));
+        }
+    }
+
+    // timestamps from the earliest span
+    uint64_t origin = UINT64_MAX;
+    for(const auto& t : threads)
+    {
+        for(const auto& s : t.spans)
+            origin = std::min(origin, s.start);
+    }
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    auto separator = "\n";
+    for(const auto& t : threads)
+    {
+        if(t.spans.empty())
+            continue;
+
+        out << separator << "{\"ph\":\"M\",\"pid\":1,\"tid\":" << t.id << ",\"name\":\"thread_name\",\"args\":{\"name\":";
+        WriteString(out, t.name ? t.name : "thread");
+        out << "}}";
+        separator = ",\n";
+
+        for(const auto& s : t.spans)
+        {
+            out << separator << "{\"ph\":\"X\",\"pid\":1,\"tid\":" << t.id << ",\"cat\":";
+            WriteString(out, s.category);
+            out << ",\"name\":";
+            WriteString(out, s.name);
+            out << ",\"ts\":";
+            WriteMicroseconds(out, s.start - origin);
+            out << ",\"dur\":";
+            WriteMicroseconds(out, s.end - s.start);
+            if(s.argName)
+            {
+                out << ",\"args\":{";
+                WriteString(out, s.argName);
+                out << ":" << s.arg << "}";
+            }
+            out << "}";
+        }
+    }
+    out << "\n]}\n";
+}
+
+void Tracer::Clear()
+{
+    std::lock_guard lock(sRingsMutex);
+    for(auto& ring : sRings)
+        ring->first = ring->head.load();
+}
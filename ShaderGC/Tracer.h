@@ -0,0 +1,61 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+
+// timeline of named spans from all threads, each thread records into its own ring keeping the latest RingSize - 1 spans
+// without locking; written out as Chrome trace events for chrome://tracing or ui.perfetto.dev
+// names are only kept as pointers so they must be string literals
+class Tracer
+{
+public:
+    static constexpr uint64_t RingSize = 1 << 16;
+
+    static void Enable(bool enable);
+    static bool IsEnabled();
+
+    // shown instead of the thread id, set once from the thread itself
+    static void NameThread(const char* name);
+
+    // steady clock in nanoseconds
+    static uint64_t Now();
+
+    // argName and arg are shown with the span if argName is set
+    static void Record(const char* category, const char* name, uint64_t start, uint64_t end, const char* argName = nullptr, int arg = 0);
+
+    // spans still in the rings, can be called while others keep recording; spans of threads which exited stay
+    // until they are written out here or cleared
+    static void WriteJson(std::ostream& out);
+
+    // forgets recorded spans, only while not enabled
+    static void Clear();
+
+    // records the enclosing scope if tracing was enabled when it started
+    class Span
+    {
+    public:
+        Span(const char* category, const char* name, const char* argName = nullptr, int arg = 0) :
+            m_category {category}, m_name {name}, m_argName {argName}, m_arg {arg}, m_start {IsEnabled() ? Now() : 0}
+        { }
+
+        ~Span()
+        {
+            if(m_start)
+                Record(m_category, m_name, m_start, Now(), m_argName, m_arg);
+        }
+
+    private:
+        const char* m_category;
+        const char* m_name;
+        const char* m_argName;
+        int         m_arg;
+        uint64_t    m_start;
+    };
+};
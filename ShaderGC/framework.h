@@ -10,3 +10,19 @@
 #include <fstream>
 #include <unordered_set>
 #include <iostream>
+#include <algorithm>
+
+#ifndef _WIN32
+// Windows names used across ShaderGC, for the Linux build
+#include <cstdio>
+#include <strings.h>
+
+typedef unsigned char BYTE;
+
+#define _stricmp strcasecmp
+
+inline int strcpy_s(char* dest, size_t size, const char* source)
+{
+    return snprintf(dest, size, "%s", source) < static_cast<int>(size) ? 0 : 1;
+}
+#endif
@@ -12,6 +12,14 @@ GNU General Public License v3.0
 #include "SPIRV.h"
 #include "HLSL.h"
 #include "ShaderCache.h"
+#include "ShaderReflection.h"
+#include "CompileStats.h"
+#include "PresetCost.h"
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <thread>
 
 filesystem::path startupPath;
 filesystem::path templatePath;
@@ -21,6 +29,79 @@ filesystem::path reportPath;
 filesystem::path listPath;
 vector<string>   shaderList;
 
+// shared by -j workers
+mutex                   listMutex;
+mutex                   outputMutex;
+mutex                   reportMutex;
+unordered_set<string>   claimedOutputs;
+vector<SourcePresetDef> pendingPresets;
+
+// pixel shader bytecode compiled in this run by output path, for preset costs
+map<string, vector<uint8_t>> fragmentByteCodes;
+
+// -bench counts allocations of everything linked in, compilers loaded from DLLs are not seen; CountAllocation does
+// nothing outside of a CompileStats::Scope, which only -bench opens. Every replaceable form but the aligned ones, which
+// keep their own pair, goes through malloc and free so none is freed by another allocator
+static void* countedAlloc(size_t size) noexcept
+{
+    CompileStats::CountAllocation(size);
+    return malloc(size ? size : 1);
+}
+
+void* operator new(size_t size)
+{
+    if(auto p = countedAlloc(size))
+        return p;
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    if(auto p = countedAlloc(size))
+        return p;
+    throw bad_alloc();
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept
+{
+    return countedAlloc(size);
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept
+{
+    return countedAlloc(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, const nothrow_t&) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void* p, const nothrow_t&) noexcept
+{
+    free(p);
+}
+
 std::string exec(const char* cmd, ofstream& log)
 {
     std::array<char, 128> buffer;
@@ -91,6 +172,22 @@ filesystem::path glsl(const filesystem::path& shaderPath, const string& stage, c
     return output;
 }
 
+vector<uint32_t> readSPIRV(const filesystem::path& input)
+{
+    ifstream inf(input, ios::binary | ios::ate);
+    auto     size = inf.tellg();
+    inf.seekg(0, ios::beg);
+    vector<uint32_t> buffer;
+    buffer.resize(size / sizeof(uint32_t));
+    inf.read((char*)buffer.data(), size);
+    inf.close();
+
+    if(buffer.size() < 5 || buffer[0] != 0x07230203)
+        throw std::runtime_error("Invalid SPIR-V " + input.string());
+    return buffer;
+}
+
+// metadata of both stages goes into reflection records
 pair<string, string> spirv(const filesystem::path& input, const std::string& stage, ofstream& log, bool& warn)
 {
     if(_tools)
@@ -99,24 +196,13 @@ pair<string, string> spirv(const filesystem::path& input, const std::string& sta
         cmd1 << "\"" << toolsPath.string() << _spirvExe << "\" "
              << " --hlsl --shader-model 50 " << input.string() << "";
         const auto& code = exec(cmd1.str().c_str(), log);
-        std::string metadata;
-        if(stage == "frag")
-        {
-            cmd2 << "\"" << toolsPath.string() << _spirvExe << "\" " << input.string() << " --reflect";
-            metadata = exec(cmd2.str().c_str(), log);
-        }
+        cmd2 << "\"" << toolsPath.string() << _spirvExe << "\" " << input.string() << " --reflect";
+        const auto& metadata = exec(cmd2.str().c_str(), log);
         return make_pair(code, metadata);
     }
     else
     {
-        ifstream inf(input, ios::binary | ios::ate);
-        auto     size = inf.tellg();
-        inf.seekg(0, ios::beg);
-        vector<uint32_t> buffer;
-        buffer.resize(size / sizeof(uint32_t));
-        inf.read((char*)buffer.data(), size);
-        inf.close();
-        return SPIRV::GenerateHLSL(buffer, stage == "frag", log, warn);
+        return SPIRV::GenerateHLSL(readSPIRV(input), true, log, warn);
     }
 }
 
@@ -162,7 +248,7 @@ static string intArrayToString(uint32_t* data, size_t size)
     return sbuf.str();
 }
 
-pair<string, string> fxc(const filesystem::path& shaderPath, const string& profile, const string& source, ofstream& log, bool& warn)
+pair<string, string> fxc(const filesystem::path& shaderPath, const string& profile, const string& source, vector<uint8_t>& byteCode, ofstream& log, bool& warn)
 {
     filesystem::path input = tempPath / shaderPath;
     input.replace_extension("." + profile + ".hlsl");
@@ -174,7 +260,8 @@ pair<string, string> fxc(const filesystem::path& shaderPath, const string& profi
     // 3571 - pow with negative
     // 4000 - use of potentially uninitialized variable
     // 4008 - floating point division by zero
-    auto fullSource = std::string("#pragma warning (disable : 3557)\r\n#pragma warning (disable : 3570)\r\n#pragma warning (disable : 3571)\r\n#pragma warning (disable : "
+    auto fxcSource  = _tools || string(HLSL::CompilerName()) == "fxc";
+    auto fullSource = !fxcSource ? source : std::string("#pragma warning (disable : 3557)\r\n#pragma warning (disable : 3570)\r\n#pragma warning (disable : 3571)\r\n#pragma warning (disable : "
                                   "4000)\r\n#pragma warning (disable : 4008)\r\n#pragma warning (disable : 3556)\r\n" +
                                   source);
     saveSource(input, fullSource);
@@ -210,6 +297,20 @@ pair<string, string> fxc(const filesystem::path& shaderPath, const string& profi
                     break;
                 }
                 outs << line << endl;
+
+                for(auto c = line.c_str(); *c;)
+                {
+                    if(isdigit(static_cast<unsigned char>(*c)))
+                    {
+                        char* end;
+                        byteCode.push_back(static_cast<uint8_t>(strtoul(c, &end, 10)));
+                        c = end;
+                    }
+                    else
+                    {
+                        c++;
+                    }
+                }
             }
         }
 
@@ -227,6 +328,7 @@ pair<string, string> fxc(const filesystem::path& shaderPath, const string& profi
         outf << str;
         outf.close();
 
+        byteCode = std::move(bin);
         return make_pair(str, hashStr);
     }
 }
@@ -250,10 +352,26 @@ string splitCode(const string& input)
     return split.str();
 }
 
+// generated lists keep Windows separators whichever host wrote them
+string includePath(const filesystem::path& relativePath)
+{
+    auto path = relativePath.generic_string();
+    std::replace(path.begin(), path.end(), '/', '\\');
+    return path;
+}
+
+// whether this worker should generate given output, each is generated once per run
+bool claimOutput(const filesystem::path& output)
+{
+    lock_guard<mutex> lock(outputMutex);
+    return claimedOutputs.insert(output.string()).second;
+}
+
 void updateShaderList(const SourceShaderInfo& shaderInfo)
 {
-    ostringstream oss;
-    oss << "#include \"" << shaderInfo.relativePath.string() << "\"";
+    lock_guard<mutex> lock(listMutex);
+    ostringstream     oss;
+    oss << "#include \"" << includePath(shaderInfo.relativePath) << "\"";
     const auto& shaderInclude = oss.str();
     if(find(shaderList.begin(), shaderList.end(), shaderInclude) == shaderList.end())
     {
@@ -265,7 +383,8 @@ void updateShaderList(const SourceShaderInfo& shaderInfo)
 
 void updateCacheList(const SourceShaderInfo& shaderInfo)
 {
-    ostringstream oss;
+    lock_guard<mutex> lock(listMutex);
+    ostringstream     oss;
     oss << " cached.emplace_back(";
     oss << _libName << shaderInfo.className << "ShaderDefs::sVertexHash, ";
     oss << _libName << shaderInfo.className << "ShaderDefs::sVertexByteCode, ";
@@ -286,8 +405,9 @@ void updateCacheList(const SourceShaderInfo& shaderInfo)
 
 void updateTextureList(const SourceShaderInfo& textureInfo)
 {
-    ostringstream oss;
-    oss << "#include \"" << textureInfo.relativePath.string() << "\"";
+    lock_guard<mutex> lock(listMutex);
+    ostringstream     oss;
+    oss << "#include \"" << includePath(textureInfo.relativePath) << "\"";
     const auto& textureInclude = oss.str();
     if(find(shaderList.begin(), shaderList.end(), textureInclude) == shaderList.end())
     {
@@ -299,8 +419,9 @@ void updateTextureList(const SourceShaderInfo& textureInfo)
 
 void updatePresetList(const SourceShaderInfo& shaderInfo)
 {
-    ostringstream oss;
-    oss << "#include \"" << shaderInfo.relativePath.string() << "\"";
+    lock_guard<mutex> lock(listMutex);
+    ostringstream     oss;
+    oss << "#include \"" << includePath(shaderInfo.relativePath) << "\"";
     const auto& presetInclude = oss.str();
 
     ostringstream oss2;
@@ -346,14 +467,24 @@ void populateShaderTemplate(SourceShaderDef def, ofstream& log)
     replace(bufferString, "%FRAGMENT_BYTECODE%", def.fragmentByteCode);
     replace(bufferString, "%VERTEX_HASH%", def.vertexHash);
     replace(bufferString, "%FRAGMENT_HASH%", def.fragmentHash);
+    replace(bufferString, "%VERTEX_SPIRV%", def.vertexSPIRV);
+    replace(bufferString, "%FRAGMENT_SPIRV%", def.fragmentSPIRV);
+    replace(bufferString, "%VERTEX_SPIRV_HASH%", def.vertexSPIRVHash);
+    replace(bufferString, "%FRAGMENT_SPIRV_HASH%", def.fragmentSPIRVHash);
 
-    if(def.fragmentByteCode.empty() || def.vertexByteCode.empty())
+    if(def.fragmentByteCode.empty() || def.vertexByteCode.empty() || def.fragmentSPIRV.empty() || def.vertexSPIRV.empty())
     {
         throw std::runtime_error("Shader compilation failed");
     }
 
+    std::vector<SourceShaderSampler> vertexTextures;
+    auto                             vertexReflection = ShaderReflection::Encode(ShaderGC::LookupParams(def.params, vertexTextures, def.vertexMetadata), vertexTextures);
+    replace(bufferString, "%VERTEX_REFLECTION%", byteArrayToString(vertexReflection.data(), vertexReflection.size()));
+
     std::vector<SourceShaderSampler> textures;
     def.params = ShaderGC::LookupParams(def.params, textures, def.fragmentMetadata);
+    auto fragmentReflection = ShaderReflection::Encode(def.params, textures);
+    replace(bufferString, "%FRAGMENT_REFLECTION%", byteArrayToString(fragmentReflection.data(), fragmentReflection.size()));
 
     ofstream          outfile(info.outputPath);
     std::stringstream iss(bufferString);
@@ -477,8 +608,12 @@ void populateTextureTemplate(SourceTextureDef def, ofstream& log)
     log << "Generated TextureDef " << info.outputPath << endl;
 }
 
-void populatePresetTemplate(
-    const filesystem::path& input, const vector<SourceShaderDef>& shaders, const vector<SourceTextureDef>& textures, const vector<SourceShaderParam>& overrides, ofstream& log)
+void populatePresetTemplate(const filesystem::path&          input,
+                            const vector<SourceShaderDef>&   shaders,
+                            const vector<SourceTextureDef>&  textures,
+                            const vector<SourceShaderParam>& overrides,
+                            float                            cost,
+                            ofstream&                        log)
 {
     const auto& info = getShaderInfo(input, "PresetDef");
 
@@ -490,6 +625,7 @@ void populatePresetTemplate(
     replace(bufferString, "%CLASS_NAME%", info.className);
     replace(bufferString, "%PRESET_NAME%", info.shaderName);
     replace(bufferString, "%PRESET_CATEGORY%", info.category);
+    replace(bufferString, "%PRESET_COST%", std::format("{:.3f}", cost));
 
     ofstream          outfile(info.outputPath);
     std::stringstream iss(bufferString);
@@ -582,14 +718,17 @@ void populatePresetTemplate(
     log << "Generated PresetDef " << info.outputPath << endl;
 }
 
-void processShader(SourceShaderDef def, ofstream& log, bool& warn)
+// fills in def for the ShaderDef template, returns pixel shader bytecode
+vector<uint8_t> compileShader(SourceShaderDef& def, ofstream& log, bool& warn)
 {
     try
     {
         ShaderGC::ProcessSourceShader(def, log, warn);
 
-        const auto& vertexOutput   = spirv(glsl(def.input, "vert", def.vertexSource, log, warn), "vert", log, warn);
-        const auto& fragmentOutput = spirv(glsl(def.input, "frag", def.fragmentSource, log, warn), "frag", log, warn);
+        const auto& vertexSPIRVPath   = glsl(def.input, "vert", def.vertexSource, log, warn);
+        const auto& fragmentSPIRVPath = glsl(def.input, "frag", def.fragmentSource, log, warn);
+        const auto& vertexOutput      = spirv(vertexSPIRVPath, "vert", log, warn);
+        const auto& fragmentOutput    = spirv(fragmentSPIRVPath, "frag", log, warn);
         def.vertexSource           = vertexOutput.first;
         def.vertexMetadata         = vertexOutput.second;
         def.fragmentSource         = fragmentOutput.first;
@@ -599,19 +738,30 @@ void processShader(SourceShaderDef def, ofstream& log, bool& warn)
         metaOutput.replace_extension(".meta");
         saveSource(metaOutput, fragmentOutput.second);
 
-        auto vertexCode      = fxc(def.input, "vs_5_0", vertexOutput.first, log, warn);
-        auto fragmentCode    = fxc(def.input, "ps_5_0", fragmentOutput.first, log, warn);
+        vector<uint8_t> vertexBin, fragmentBin;
+        auto            vertexCode   = fxc(def.input, "vs_5_0", vertexOutput.first, vertexBin, log, warn);
+        auto            fragmentCode = fxc(def.input, "ps_5_0", fragmentOutput.first, fragmentBin, log, warn);
         def.vertexByteCode   = vertexCode.first;
         def.vertexHash       = vertexCode.second;
         def.fragmentByteCode = fragmentCode.first;
         def.fragmentHash     = fragmentCode.second;
 
+        // SPIR-V is kept for other backends, hashed by content
+        auto vertexSPIRV       = readSPIRV(vertexSPIRVPath);
+        auto fragmentSPIRV     = readSPIRV(fragmentSPIRVPath);
+        auto vertexSPIRVHash   = ShaderCache::CalculateHash(vertexSPIRV.data(), vertexSPIRV.size() * sizeof(uint32_t));
+        auto fragmentSPIRVHash = ShaderCache::CalculateHash(fragmentSPIRV.data(), fragmentSPIRV.size() * sizeof(uint32_t));
+        def.vertexSPIRV        = intArrayToString(vertexSPIRV.data(), vertexSPIRV.size());
+        def.fragmentSPIRV      = intArrayToString(fragmentSPIRV.data(), fragmentSPIRV.size());
+        def.vertexSPIRVHash    = intArrayToString(vertexSPIRVHash.data(), vertexSPIRVHash.size());
+        def.fragmentSPIRVHash  = intArrayToString(fragmentSPIRVHash.data(), fragmentSPIRVHash.size());
+
         replace(def.vertexByteCode, " ", "");
         replace(def.vertexHash, " ", "");
         replace(def.fragmentByteCode, " ", "");
         replace(def.fragmentHash, " ", "");
 
-        populateShaderTemplate(def, log);
+        return fragmentBin;
     }
     catch(std::runtime_error& ex)
     {
@@ -620,6 +770,15 @@ void processShader(SourceShaderDef def, ofstream& log, bool& warn)
     }
 }
 
+void processShader(SourceShaderDef def, ofstream& log, bool& warn)
+{
+    auto fragmentBin = compileShader(def, log, warn);
+    populateShaderTemplate(def, log);
+
+    lock_guard<mutex> lock(outputMutex);
+    fragmentByteCodes[def.info.outputPath.string()] = std::move(fragmentBin);
+}
+
 string bin2string(filesystem::path input)
 {
     ostringstream oss;
@@ -659,6 +818,37 @@ void processTexture(SourceTextureDef def, ofstream& log)
     populateTextureTemplate(def, log);
 }
 
+// see PresetCost, from passes compiled in this run or compiled again here if they were already generated;
+// called once all workers are done, 0 if any pass fails
+float presetCost(const vector<SourceShaderDef>& shaders, ofstream& log)
+{
+    vector<ShaderDef>        shaderDefs(shaders.size());
+    vector<const ShaderDef*> passes;
+    for(size_t i = 0; i < shaders.size(); i++)
+    {
+        auto& byteCode = fragmentByteCodes[shaders[i].info.outputPath.string()];
+        if(byteCode.empty())
+        {
+            try
+            {
+                auto def  = shaders[i];
+                bool warn = false;
+                byteCode  = compileShader(def, log, warn);
+            }
+            catch(std::runtime_error&)
+            {
+                return 0.0f;
+            }
+        }
+
+        shaderDefs[i].FragmentByteCode = byteCode.data();
+        shaderDefs[i].FragmentLength   = byteCode.size();
+        shaderDefs[i].PresetParams     = shaders[i].presetParams;
+        passes.push_back(&shaderDefs[i]);
+    }
+    return PresetCost::Estimate(passes);
+}
+
 void processPreset(SourcePresetDef& def, ofstream& log, bool& warn)
 {
     ShaderGC::ProcessSourcePreset(def, log, warn);
@@ -666,7 +856,7 @@ void processPreset(SourcePresetDef& def, ofstream& log, bool& warn)
     for(auto& s : def.shaders)
     {
         s.info = getShaderInfo(s.input, "ShaderDef");
-        if(_force || !filesystem::exists(s.info.outputPath))
+        if((_force || !filesystem::exists(s.info.outputPath)) && claimOutput(s.info.outputPath))
         {
             processShader(s, log, warn);
         }
@@ -677,7 +867,7 @@ void processPreset(SourcePresetDef& def, ofstream& log, bool& warn)
     for(auto& t : def.textures)
     {
         t.info = getShaderInfo(t.input, "TextureDef");
-        if(_force || !filesystem::exists(t.info.outputPath))
+        if((_force || !filesystem::exists(t.info.outputPath)) && claimOutput(t.info.outputPath))
         {
             processTexture(t, log);
         }
@@ -685,9 +875,11 @@ void processPreset(SourcePresetDef& def, ofstream& log, bool& warn)
     }
 
     def.info = getShaderInfo(def.input, "PresetDef");
-    if(_force || !filesystem::exists(def.info.outputPath))
+    if((_force || !filesystem::exists(def.info.outputPath)) && claimOutput(def.info.outputPath))
     {
-        populatePresetTemplate(def.input, def.shaders, def.textures, def.overrides, log);
+        // written once all workers are done, passes shared with other presets may still be generating
+        lock_guard<mutex> lock(outputMutex);
+        pendingPresets.push_back(def);
     }
     updatePresetList(def.info);
 }
@@ -702,21 +894,26 @@ void processFile(const filesystem::path& input, ofstream& reportStream)
 
     if(!filesystem::exists(input))
     {
+        lock_guard<mutex> lock(reportMutex);
         cout << "Cannot find file " << input << endl;
         return;
     }
 
     auto inputString = input.string();
     std::replace(inputString.begin(), inputString.end(), '\\', '!');
+    std::replace(inputString.begin(), inputString.end(), '/', '!');
     std::filesystem::path logPath(tempPath / "logs" / (inputString + ".log"));
-    std::filesystem::create_directory(tempPath / "logs");
+    std::filesystem::create_directories(tempPath / "logs");
     ofstream log(logPath);
     bool     warn = false;
     bool     err  = false;
 
+    // printed in one go so parallel workers don't interleave
+    ostringstream status;
+    status << input << " ...";
+
     try
     {
-        std::cout << input << " ...";
         if(input.extension() == ".slang")
         {
             SourceShaderDef sd(input, getShaderInfo(input, "ShaderDef"));
@@ -732,34 +929,167 @@ void processFile(const filesystem::path& input, ofstream& reportStream)
     }
     catch(std::exception& e)
     {
-        cout << e.what() << endl;
+        status << e.what() << endl;
         err = true;
 
         log << "ERROR:" << e.what() << endl;
     }
     log.close();
 
+    lock_guard<mutex> lock(reportMutex);
     if(err)
     {
         auto orgPath(logPath);
         std::filesystem::rename(orgPath, logPath.replace_extension(".ERROR.log"));
-        std::cout << "ERROR" << endl;
+        std::cout << status.str() << "ERROR" << endl;
         reportStream << "ERROR: " << input << endl;
     }
     else if(warn)
     {
         auto orgPath(logPath);
         std::filesystem::rename(orgPath, logPath.replace_extension(".WARN.log"));
-        std::cout << "WARN" << endl;
+        std::cout << status.str() << "WARN" << endl;
         reportStream << "WARN: " << input << endl;
     }
     else
     {
-        std::cout << "OK" << endl;
+        std::cout << status.str() << "OK" << endl;
         reportStream << "OK: " << input << endl;
     }
 }
 
+void processFiles(const vector<filesystem::path>& inputs, ofstream& reportStream)
+{
+    atomic<size_t> next {0};
+    auto           worker = [&]() {
+        for(auto i = next++; i < inputs.size(); i = next++)
+            processFile(inputs[i], reportStream);
+    };
+
+    vector<thread> workers;
+    for(unsigned j = 1; j < _jobs; j++)
+        workers.emplace_back(worker);
+    worker();
+    for(auto& w : workers)
+        w.join();
+
+    if(!pendingPresets.empty())
+    {
+        filesystem::create_directories(tempPath / "logs");
+        ofstream log(tempPath / "logs" / "presets.log");
+        for(const auto& def : pendingPresets)
+        {
+            auto cost = presetCost(def.shaders, log);
+            populatePresetTemplate(def.input, def.shaders, def.textures, def.overrides, cost, log);
+            if(cost == 0.0f)
+                log << "No cost for " << def.input << endl;
+        }
+    }
+}
+
+// same in-memory pipeline as ShaderGC::CompileSourceShader but without building a ShaderDef
+void benchShader(SourceShaderDef def, ostream& log)
+{
+    bool warn = false;
+    ShaderGC::ProcessSourceShader(def, log, warn);
+
+    auto vertexSPIRV   = GLSL::GenerateSPIRV(def.vertexSource.c_str(), false, log, warn);
+    auto fragmentSPIRV = GLSL::GenerateSPIRV(def.fragmentSource.c_str(), true, log, warn);
+    if(vertexSPIRV.empty() || fragmentSPIRV.empty())
+        throw std::runtime_error("SPIR-V conversion error");
+
+    auto vertexHLSL   = SPIRV::GenerateHLSL(vertexSPIRV, false, log, warn);
+    auto fragmentHLSL = SPIRV::GenerateHLSL(fragmentSPIRV, true, log, warn);
+    HLSL::CompileHLSL(vertexHLSL.first.c_str(), vertexHLSL.first.size(), "vs_5_0", log, warn);
+    HLSL::CompileHLSL(fragmentHLSL.first.c_str(), fragmentHLSL.first.size(), "ps_5_0", log, warn);
+
+    vector<SourceShaderSampler> textures;
+    ShaderGC::LookupParams(def.params, textures, fragmentHLSL.second);
+}
+
+void benchFiles(const vector<filesystem::path>& inputs)
+{
+    // shaders shared between presets are measured once
+    map<string, SourceShaderDef> shaders;
+    ofstream                     log(tempPath / "bench.log");
+    bool                         warn = false;
+    for(const auto& input : inputs)
+    {
+        try
+        {
+            if(input.extension() == ".slang")
+            {
+                SourceShaderDef sd(input, SourceShaderInfo());
+                shaders.insert(make_pair(input.lexically_normal().generic_string(), sd));
+            }
+            else if(input.extension() == ".slangp")
+            {
+                SourcePresetDef pd(input, SourceShaderInfo());
+                ShaderGC::ProcessSourcePreset(pd, log, warn);
+                for(const auto& s : pd.shaders)
+                    shaders.insert(make_pair(s.input.lexically_normal().generic_string(), s));
+            }
+        }
+        catch(std::exception& e)
+        {
+            cout << input << " ..." << e.what() << endl;
+        }
+    }
+
+    CompileReport report;
+    report.compiler = HLSL::CompilerName();
+    report.runs     = _runs;
+    report.jobs     = _jobs;
+    auto& results   = report.shaders;
+    for(const auto& s : shaders)
+        results.push_back({s.first, {}, {}});
+
+    atomic<size_t> next {0};
+    auto           worker = [&]() {
+        ostringstream workerLog;
+        for(auto i = next++; i < results.size(); i = next++)
+        {
+            auto&                result = results[i];
+            vector<CompileStats> runs(_runs);
+            try
+            {
+                for(auto& run : runs)
+                {
+                    CompileStats::Scope scope(run);
+                    benchShader(shaders.at(result.path), workerLog);
+                    workerLog.str({});
+                }
+                result.stats = CompileStats::Median(runs);
+            }
+            catch(std::exception& e)
+            {
+                result.error = e.what();
+            }
+
+            lock_guard<mutex> lock(reportMutex);
+            cout << result.path << " ..." << (result.error.empty() ? "OK" : "ERROR") << endl;
+        }
+    };
+
+    vector<thread> workers;
+    for(unsigned j = 1; j < _jobs; j++)
+        workers.emplace_back(worker);
+    worker();
+    for(auto& w : workers)
+        w.join();
+
+    ofstream out(startupPath / _benchPath);
+    if(_benchPath.extension() == ".csv")
+        report.WriteCsv(out);
+    else
+        report.WriteJson(out);
+    out.close();
+
+    cout << endl;
+    report.WriteSummary(cout);
+    cout << "Results saved to " << (startupPath / _benchPath).string() << endl;
+}
+
 void processListTemplate()
 {
     listPath /= filesystem::path(string(_libName) + ".h");
@@ -798,6 +1128,7 @@ int main(int argc, char* argv[])
 
     try
     {
+        vector<filesystem::path> inputs;
         for(int i = 1; i < argc; i++)
         {
             string input(argv[i]);
@@ -818,6 +1149,32 @@ int main(int argc, char* argv[])
                 _tools = true;
                 continue;
             }
+            if(input == "-hlsl" && i + 1 < argc)
+            {
+                string compiler(argv[++i]);
+                if(!HLSL::SelectCompiler(compiler))
+                {
+                    cout << "HLSL compiler " << compiler << " is not available in this build" << endl;
+                    return -1;
+                }
+                continue;
+            }
+            if(input == "-bench" && i + 1 < argc)
+            {
+                _benchPath = argv[++i];
+                continue;
+            }
+            if(input == "-runs" && i + 1 < argc)
+            {
+                _runs = max(stoi(argv[++i]), 1);
+                continue;
+            }
+            if(input.starts_with("-j"))
+            {
+                _jobs = input.size() > 2 ? static_cast<unsigned>(stoul(input.substr(2))) : thread::hardware_concurrency();
+                _jobs = max(_jobs, 1u);
+                continue;
+            }
             if(input == "*")
             {
                 for(auto& p : filesystem::recursive_directory_iterator("."))
@@ -834,7 +1191,7 @@ int main(int argc, char* argv[])
 
                         if(_force || !isExcluded)
                         {
-                            processFile(p.path().lexically_normal(), reportStream);
+                            inputs.push_back(p.path().lexically_normal());
                         }
                     }
                 }
@@ -845,13 +1202,20 @@ int main(int argc, char* argv[])
                 {
                     for(auto& p : filesystem::directory_iterator(input))
                     {
-                        processFile(p.path(), reportStream);
+                        inputs.push_back(p.path());
                     }
                 }
                 else
-                    processFile(input, reportStream);
+                    inputs.push_back(input);
             }
         }
+
+        GLSL::Initialize();
+        if(!_benchPath.empty())
+            benchFiles(inputs);
+        else
+            processFiles(inputs, reportStream);
+        GLSL::Finalize();
     }
     catch(exception& e)
     {
@@ -28,26 +28,39 @@ GNU General Public License v3.0
 
 #include "SourceDefs.h"
 
+#ifndef _WIN32
+#    define _popen popen
+#    define _pclose pclose
+#endif
+
 using namespace std;
 
 // paths relative to starting in Scripts directory
 const char* _libName      = "RetroArch";
 const char* _inputPath    = "slang-shaders";
-const char* _templatePath = "..\\ShaderGen\\";
-const char* _toolsPath    = "..\\Tools\\";
-const char* _outputPath   = "..\\ShaderGlass\\Shaders\\";
+const char* _templatePath = "../ShaderGen/";
+const char* _toolsPath    = "../Tools/";
+const char* _outputPath   = "../ShaderGlass/Shaders/";
 const char* _tempPath     = "temp";
 
 // only needed when using -tools option
 const char* _fxcPath  = "C:\\Program Files (x86)\\Windows Kits\\10\\bin\\10.0.26100.0\\x64\\fxc.exe";
+#ifdef _WIN32
 const char* _glslExe  = "glslangValidator.exe";
 const char* _spirvExe = "spirv-cross.exe";
+#else
+const char* _glslExe  = "glslangValidator";
+const char* _spirvExe = "spirv-cross";
+#endif
 
 const char*      _raUrl = "https://github.com/libretro/slang-shaders/blob/25311dc03332d9ef2dff8d9d06c611d828028fac/";
 const char*      _mbUrl = "https://github.com/libretro/slang-shaders/blob/25311dc03332d9ef2dff8d9d06c611d828028fac/bezel/Mega_Bezel";
 const char*      _rcUrl = "https://github.com/RetroCrisis/Retro-Crisis-GDV-NTSC";
 bool             _force = false;
 bool             _tools = false;
+unsigned         _jobs  = 1;
+int              _runs  = 5;
+filesystem::path _benchPath;
 filesystem::path outputPath;
 
 void replace(string& str, const string& macro, const string& value)
@@ -114,7 +127,7 @@ SourceShaderInfo getShaderInfo(const filesystem::path& slangInput, const string&
     info.className    = className.str();
     info.shaderName   = shaderName.str();
     info.sourcePath   = slangInput;
-    info.relativePath = filesystem::path(string(_libName) + "\\" + info.category + "\\" + info.className + suffix + ".h").lexically_normal();
+    info.relativePath = (filesystem::path(_libName) / info.category / (info.className + suffix + ".h")).lexically_normal();
     info.outputPath   = filesystem::path(outputPath / info.relativePath.string()).lexically_normal();
     filesystem::create_directories(info.outputPath.parent_path());
 
@@ -10,6 +10,8 @@ GNU General Public License v3.0
 #include "resource.h"
 #include "BrowserWindow.h"
 
+#include <cfloat>
+
 constexpr int WINDOW_WIDTH  = 400;
 constexpr int WINDOW_HEIGHT = 680;
 constexpr int CX_BITMAP     = 24;
@@ -19,6 +21,13 @@ constexpr int BUTTON_WIDTH  = 140;
 constexpr int PANEL_HEIGHT  = 40;
 constexpr int MAX_NAME      = 20;
 constexpr int MAX_VALUE     = 200;
+constexpr int SEARCH_HEIGHT = 28;
+constexpr int MAX_RESULTS   = 100;
+constexpr int ID_SEARCH     = 1;
+constexpr int ID_RESULTS    = 2;
+
+// presets under each, by upper bound of PresetCost
+static const std::pair<const char*, float> sCostGroups[] = {{"Light", 250.0f}, {"Moderate", 1000.0f}, {"Heavy", 5000.0f}, {"Very Heavy", FLT_MAX}};
 
 BrowserWindow::BrowserWindow(CaptureManager& captureManager) :
     m_captureManager(captureManager), m_captureOptions(captureManager.m_options), m_title(), m_windowClass(), m_font(0), m_dpiScale(1.0f)
@@ -131,11 +140,17 @@ void BrowserWindow::Resize()
 
         SendMessage(m_addFavButton, WM_SETFONT, (WPARAM)m_font, MAKELPARAM(TRUE, 0));
         SendMessage(m_delFavButton, WM_SETFONT, (WPARAM)m_font, MAKELPARAM(TRUE, 0));
+        SendMessage(m_searchBox, WM_SETFONT, (WPARAM)m_font, MAKELPARAM(TRUE, 0));
+        SendMessage(m_resultsList, WM_SETFONT, (WPARAM)m_font, MAKELPARAM(TRUE, 0));
     }
 
     RECT rcClient;
     GetClientRect(m_mainWindow, &rcClient);
-    SetWindowPos(m_treeControl, NULL, 0, 0, rcClient.right, rcClient.bottom - (LONG)(PANEL_HEIGHT * m_dpiScale), 0);
+    const auto searchHeight = (LONG)(SEARCH_HEIGHT * m_dpiScale);
+    const auto listHeight   = rcClient.bottom - searchHeight - (LONG)(PANEL_HEIGHT * m_dpiScale);
+    SetWindowPos(m_searchBox, NULL, 0, 0, rcClient.right, searchHeight, 0);
+    SetWindowPos(m_treeControl, NULL, 0, searchHeight, rcClient.right, listHeight, 0);
+    SetWindowPos(m_resultsList, NULL, 0, searchHeight, rcClient.right, listHeight, 0);
     SetWindowPos(m_addFavButton, NULL, 0, rcClient.bottom - (LONG)(PANEL_HEIGHT * m_dpiScale), (LONG)(BUTTON_WIDTH * m_dpiScale), (LONG)(PANEL_HEIGHT * m_dpiScale), 0);
     SetWindowPos(m_delFavButton,
                  NULL,
@@ -252,19 +267,49 @@ void BrowserWindow::Build()
 {
     RECT rcClient; // dimensions of client area
     GetClientRect(m_mainWindow, &rcClient);
+    m_searchBox = CreateWindowEx(0,
+                                 L"EDIT",
+                                 L"",
+                                 WS_TABSTOP | WS_VISIBLE | WS_CHILD | WS_BORDER | ES_AUTOHSCROLL,
+                                 0,
+                                 0,
+                                 rcClient.right,
+                                 (LONG)(SEARCH_HEIGHT * m_dpiScale),
+                                 m_mainWindow,
+                                 (HMENU)ID_SEARCH,
+                                 m_instance,
+                                 NULL);
+    SendMessage(m_searchBox, WM_SETFONT, (LPARAM)m_font, true);
+    SendMessage(m_searchBox, EM_SETCUEBANNER, TRUE, (LPARAM)L"Search names, passes and parameters");
+
     m_treeControl = CreateWindowEx(0,
                                    WC_TREEVIEW,
                                    TEXT("Shader Tree"),
                                    WS_VISIBLE | WS_CHILD | WS_BORDER | TVS_HASLINES | TVS_LINESATROOT | TVS_HASBUTTONS | TVS_SHOWSELALWAYS /* | TVS_FULLROWSELECT*/,
                                    0,
-                                   0,
+                                   (LONG)(SEARCH_HEIGHT * m_dpiScale),
                                    rcClient.right,
-                                   rcClient.bottom - (LONG)(PANEL_HEIGHT * m_dpiScale),
+                                   rcClient.bottom - (LONG)((SEARCH_HEIGHT + PANEL_HEIGHT) * m_dpiScale),
                                    m_mainWindow,
                                    NULL,
                                    m_instance,
                                    NULL);
 
+    // shown instead of the tree while there is a query
+    m_resultsList = CreateWindowEx(0,
+                                   L"LISTBOX",
+                                   L"",
+                                   WS_CHILD | WS_BORDER | WS_VSCROLL | LBS_NOTIFY | LBS_NOINTEGRALHEIGHT,
+                                   0,
+                                   (LONG)(SEARCH_HEIGHT * m_dpiScale),
+                                   rcClient.right,
+                                   rcClient.bottom - (LONG)((SEARCH_HEIGHT + PANEL_HEIGHT) * m_dpiScale),
+                                   m_mainWindow,
+                                   (HMENU)ID_RESULTS,
+                                   m_instance,
+                                   NULL);
+    SendMessage(m_resultsList, WM_SETFONT, (LPARAM)m_font, true);
+
     CreateImageList(m_treeControl);
 
     auto categoryComp = [](const std::string& c1, const std::string& c2) {
@@ -286,6 +331,8 @@ void BrowserWindow::Build()
     };
     std::map<std::string, std::map<std::string, UINT, decltype(shaderComp)>, decltype(categoryComp)> categoryMenus;
 
+    std::map<std::string, UINT, decltype(shaderComp)> importedMenu;
+
     HTREEITEM noneItem = nullptr;
 
     int i = 0;
@@ -298,6 +345,12 @@ void BrowserWindow::Build()
             m_items[id] = noneItem;
             continue;
         }
+        if(sp->Category == "Imported")
+        {
+            // loaded from the library index at startup
+            importedMenu.insert(std::make_pair(sp->Name, WM_SHADER(i++)));
+            continue;
+        }
         if(categoryMenus.find(sp->Category) == categoryMenus.end())
         {
             categoryMenus.insert(std::make_pair(sp->Category, std::map<std::string, UINT, decltype(shaderComp)>()));
@@ -311,6 +364,8 @@ void BrowserWindow::Build()
     LoadPersonal();
 
     m_imported = AddItemToTree(m_treeControl, convertCharArrayToLPCWSTR("Imported"), -1, 1);
+    for(auto p : importedMenu)
+        m_items[p.second] = AddItemToTree(m_treeControl, convertCharArrayToLPCWSTR(p.first.c_str()), p.second, 2);
 
     AddItemToTree(m_treeControl, convertCharArrayToLPCWSTR("Community Favorites"), -1, 1);
 
@@ -365,6 +420,14 @@ void BrowserWindow::Build()
         }
     }
 
+    // filled in when first expanded, presets generated without a cost have to be built to estimate one
+    m_costItems = AddItemToTree(m_treeControl, convertCharArrayToLPCWSTR("By Expected Cost"), -1, 1);
+    TVITEM costItem;
+    costItem.mask      = TVIF_CHILDREN;
+    costItem.hItem     = m_costItems;
+    costItem.cChildren = 1;
+    TreeView_SetItem(m_treeControl, &costItem);
+
     TreeView_Expand(m_treeControl, raItem, TVE_EXPAND);
 
     if(m_captureOptions.presetNo)
@@ -416,6 +479,83 @@ void BrowserWindow::Build()
     Resize();
 }
 
+void BrowserWindow::BuildCosts()
+{
+    const auto&                         presets = m_captureManager.Presets();
+    std::vector<std::pair<float, UINT>> costs;
+    for(int p = 0; p < presets.size(); p++)
+    {
+        // written into the catalog by ShaderGen or set on import, presets are built on the render thread so their passes
+        // aren't read here and those without one are left out
+        auto cost = presets.at(p)->Cost;
+        if(cost > 0.0f)
+            costs.emplace_back(cost, WM_SHADER(p));
+    }
+    std::sort(costs.begin(), costs.end());
+
+    TVINSERTSTRUCT is;
+    is.hInsertAfter = TVI_LAST;
+    is.item.mask    = TVIF_TEXT | TVIF_IMAGE | TVIF_SELECTEDIMAGE | TVIF_PARAM;
+
+    size_t c = 0;
+    for(const auto& group : sCostGroups)
+    {
+        is.hParent             = m_costItems;
+        is.item.pszText        = convertCharArrayToLPCWSTR(group.first);
+        is.item.cchTextMax     = sizeof(is.item.pszText) / sizeof(is.item.pszText[0]);
+        is.item.iImage         = g_nClosed;
+        is.item.iSelectedImage = g_nClosed;
+        is.item.lParam         = -1;
+        auto groupItem         = TreeView_InsertItem(m_treeControl, &is);
+
+        for(; c < costs.size() && costs[c].first < group.second; c++)
+        {
+            char name[MAX_VALUE];
+            snprintf(name, MAX_VALUE, "%s (%.0f)", presets.at(costs[c].second - WM_SHADER(0))->Name.c_str(), costs[c].first);
+            is.hParent               = groupItem;
+            is.item.pszText          = convertCharArrayToLPCWSTR(name);
+            is.item.iImage           = g_nDocument;
+            is.item.iSelectedImage   = g_nDocument;
+            is.item.lParam           = costs[c].second;
+            m_costs[costs[c].second] = TreeView_InsertItem(m_treeControl, &is);
+        }
+    }
+}
+
+void BrowserWindow::Search()
+{
+    char query[MAX_VALUE];
+    if(!WideCharToMultiByte(CP_ACP, 0, GetWindowStringText(m_searchBox).c_str(), -1, query, MAX_VALUE, NULL, NULL))
+        query[0] = 0;
+
+    SendMessage(m_resultsList, LB_RESETCONTENT, 0, 0);
+    if(query[0] == 0)
+    {
+        ShowWindow(m_resultsList, SW_HIDE);
+        ShowWindow(m_treeControl, SW_SHOW);
+        return;
+    }
+
+    // indexed when first searched, built-in presets by name and category as they are not built here, see PresetSearch::Document
+    const auto& presets = m_captureManager.Presets();
+    if(m_search.Size() == 0)
+    {
+        for(int p = 0; p < presets.size(); p++)
+            m_search.Add(WM_SHADER(p), PresetSearch::Document(*presets.at(p)));
+    }
+
+    for(const auto& result : m_search.Find(query, MAX_RESULTS))
+    {
+        const auto& preset = presets.at(result.id - WM_SHADER(0));
+        char        name[MAX_VALUE];
+        snprintf(name, MAX_VALUE, "%s (%s)", preset->Name.c_str(), preset->Category.c_str());
+        auto index = SendMessage(m_resultsList, LB_ADDSTRING, 0, (LPARAM)convertCharArrayToLPCWSTR(name));
+        SendMessage(m_resultsList, LB_SETITEMDATA, index, result.id);
+    }
+    ShowWindow(m_treeControl, SW_HIDE);
+    ShowWindow(m_resultsList, SW_SHOW);
+}
+
 void BrowserWindow::LoadPersonal()
 {
     HKEY  hkey;
@@ -552,6 +692,12 @@ LRESULT CALLBACK BrowserWindow::WndProc(HWND hWnd, UINT message, WPARAM wParam,
                 }
             }
         }
+        else if(lpnmh->code == TVN_ITEMEXPANDING)
+        {
+            LPNMTREEVIEW pnmtv = (LPNMTREEVIEW)lParam;
+            if(pnmtv->itemNew.hItem == m_costItems && TreeView_GetChild(m_treeControl, m_costItems) == NULL)
+                BuildCosts();
+        }
         else if(lpnmh->code == TVN_KEYDOWN)
         {
             LPNMTVKEYDOWN ptvkd = (LPNMTVKEYDOWN)lParam;
@@ -609,6 +755,17 @@ LRESULT CALLBACK BrowserWindow::WndProc(HWND hWnd, UINT message, WPARAM wParam,
                     return 0;
                 }
             }
+            auto cost = m_costs.find((UINT)lParam);
+            if(cost != m_costs.end())
+            {
+                // check if already selected
+                auto selected = TreeView_GetSelection(m_treeControl);
+                if(selected == cost->second)
+                {
+                    // selected from costs - do nothing
+                    return 0;
+                }
+            }
             auto item = m_items.find((UINT)lParam);
             if(item != m_items.end())
             {
@@ -620,6 +777,9 @@ LRESULT CALLBACK BrowserWindow::WndProc(HWND hWnd, UINT message, WPARAM wParam,
         case WM_USER + 1: {
             auto id = (UINT)WM_SHADER(lParam);
 
+            if(m_search.Size())
+                m_search.Add(id, PresetSearch::Document(*m_captureManager.Presets().at(lParam)));
+
             if(m_items.contains(id)) // in-place update
                 return 0;
 
@@ -635,6 +795,24 @@ LRESULT CALLBACK BrowserWindow::WndProc(HWND hWnd, UINT message, WPARAM wParam,
             m_items[id]            = TreeView_InsertItem(m_treeControl, &is);
             return 0;
         }
+        case ID_SEARCH: {
+            if(HIWORD(wParam) == EN_CHANGE)
+                Search();
+            return 0;
+        }
+        case ID_RESULTS: {
+            if(HIWORD(wParam) == LBN_SELCHANGE)
+            {
+                auto index = SendMessage(m_resultsList, LB_GETCURSEL, 0, 0);
+                if(index != LB_ERR)
+                {
+                    auto id = (UINT)SendMessage(m_resultsList, LB_GETITEMDATA, index, 0);
+                    if(WM_SHADER(m_captureOptions.presetNo) != id)
+                        PostMessage(m_shaderWindow, WM_COMMAND, id, 0);
+                }
+            }
+            return 0;
+        }
         case BN_CLICKED: {
             if(lParam == (LPARAM)m_addFavButton)
             {
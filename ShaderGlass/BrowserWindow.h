@@ -12,6 +12,7 @@ GNU General Public License v3.0
 #include "Options.h"
 #include "CaptureManager.h"
 #include "Helpers.h"
+#include "PresetSearch.h"
 
 class BrowserWindow
 {
@@ -31,6 +32,8 @@ private:
     HWND                      m_paramsWindow;
     HWND                      m_addFavButton;
     HWND                      m_delFavButton;
+    HWND                      m_searchBox {nullptr};
+    HWND                      m_resultsList {nullptr};
     UINT                      m_dpi {USER_DEFAULT_SCREEN_DPI};
     HFONT                     m_font;
     CaptureManager&           m_captureManager;
@@ -44,11 +47,16 @@ private:
     HTREEITEM                 m_imported;
     HTREEITEM                 m_personalItems;
     std::map<UINT, HTREEITEM> m_personal;
+    HTREEITEM                 m_costItems;
+    std::map<UINT, HTREEITEM> m_costs;
+    PresetSearch              m_search;
 
     void Resize();
     void Build();
     void SavePersonal();
     void LoadPersonal();
+    void BuildCosts();
+    void Search();
 
     static LRESULT CALLBACK WndProcProxy(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
     ATOM                    MyRegisterClass(HINSTANCE hInstance);
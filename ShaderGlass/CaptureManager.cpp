@@ -21,6 +21,9 @@ using namespace std;
 using namespace util;
 using namespace util::uwp;
 
+// frames kept in a recording, about 2 GB at 1080p
+static constexpr uint32_t sRecordedFrames = 240;
+
 CaptureManager::CaptureManager() : m_options(), m_deviceName(L"Default"), m_lastPreset(-1) { }
 
 bool CaptureManager::Initialize()
@@ -55,14 +58,92 @@ const ShaderCache& CaptureManager::Cache()
     return m_shaderCache;
 }
 
-bool CaptureManager::UpdateInput()
+MetricsRegistry& CaptureManager::Metrics()
 {
-    if(IsActive())
+    return m_metrics;
+}
+
+static bool SameRect(const RECT& a, const RECT& b)
+{
+    return a.left == b.left && a.top == b.top && a.right == b.right && a.bottom == b.bottom;
+}
+
+CaptureChanges CaptureChanges::Between(const CaptureOptions& from, const CaptureOptions& to)
+{
+    CaptureChanges changes;
+    changes.output          = from.outputWindow != to.outputWindow || from.flipMode != to.flipMode || from.allowTearing != to.allowTearing;
+    changes.source          = from.monitor != to.monitor || from.captureWindow != to.captureWindow || from.imageFile != to.imageFile || from.clone != to.clone ||
+                     from.maxCaptureRate != to.maxCaptureRate || from.recordFile != to.recordFile || from.replayFile != to.replayFile;
+    changes.pixelSize       = from.pixelWidth != to.pixelWidth || from.pixelHeight != to.pixelHeight || from.dpiScale != to.dpiScale;
+    changes.outputSize      = from.aspectRatio != to.aspectRatio || from.outputScale != to.outputScale || from.freeScale != to.freeScale;
+    changes.outputFlip      = from.flipHorizontal != to.flipHorizontal || from.flipVertical != to.flipVertical;
+    changes.preset          = from.presetNo != to.presetNo;
+    changes.frameSkip       = from.frameSkip != to.frameSkip;
+    changes.cursor          = from.captureCursor != to.captureCursor;
+    changes.lockedArea      = !SameRect(from.inputArea, to.inputArea);
+    changes.croppedArea     = !SameRect(from.croppedArea, to.croppedArea);
+    changes.vertical        = from.vertical != to.vertical;
+    changes.adaptiveQuality = from.adaptiveQuality != to.adaptiveQuality;
+    changes.memoryBudget    = from.memoryBudget != to.memoryBudget;
+    return changes;
+}
+
+ApplyResult CaptureManager::UpdateInput()
+{
+    return ApplyOptions();
+}
+
+void CaptureManager::BeginOptions()
+{
+    // several options change together, Update* only record them and the next ApplyOptions after EndOptions applies
+    // what differs at once
+    m_deferOptions = true;
+}
+
+void CaptureManager::EndOptions()
+{
+    m_deferOptions = false;
+}
+
+ApplyResult CaptureManager::ApplyOptions()
+{
+    if(!IsActive() || m_deferOptions)
+        return ApplyResult::Applied;
+
+    // only what depends on changed options is rebuilt, a new session is needed just for the swap chain
+    auto changes = CaptureChanges::Between(m_sessionOptions, m_options);
+    if(changes.output)
     {
         StopSession();
-        return StartSession();
+        return StartSession() ? ApplyResult::Applied : ApplyResult::Failed;
     }
-    return true;
+    if(changes.source && !SwapSource())
+        return ApplyResult::Failed;
+
+    if(changes.pixelSize)
+        UpdatePixelSize();
+    if(changes.outputSize)
+        UpdateOutputSize();
+    if(changes.outputFlip)
+        UpdateOutputFlip();
+    if(changes.memoryBudget)
+        UpdateMemoryBudget();
+    auto result = ApplyResult::Applied;
+    if((changes.preset || m_queuedParams.size()) && !UpdateShaderPreset())
+        result = ApplyResult::PresetRefused;
+    if(changes.frameSkip)
+        UpdateFrameSkip();
+    if(changes.cursor)
+        UpdateCursor();
+    if(changes.lockedArea)
+        UpdateLockedArea();
+    if(changes.croppedArea)
+        UpdateCroppedArea();
+    if(changes.vertical)
+        UpdateVertical();
+    if(changes.adaptiveQuality)
+        UpdateAdaptiveQuality();
+    return result;
 }
 
 DWORD WINAPI ThreadFuncProxy(LPVOID lpParam)
@@ -77,10 +158,10 @@ bool CaptureManager::StartSession()
     {
         m_d3dDevice = CreateD3DDevice();
         m_d3dDevice->GetImmediateContext(m_context.put());
+        m_deviceCache = std::make_unique<DeviceCache>(m_d3dDevice);
     }
 
     auto dxgiDevice = m_d3dDevice.as<IDXGIDevice>();
-    auto device     = CreateDirect3DDevice(dxgiDevice.get());
 
     // get GPU name
     {
@@ -99,38 +180,101 @@ bool CaptureManager::StartSession()
     m_d3dDevice->QueryInterface(__uuidof(ID3D11Debug), reinterpret_cast<void**>(m_debug.put()));
 #endif
 
-    winrt::Windows::Graphics::Capture::GraphicsCaptureItem captureItem {nullptr};
-    if(!m_options.imageFile.size())
-    {
-        try
-        {
-            captureItem = m_options.captureWindow ? CreateCaptureItemForWindow(m_options.captureWindow) : CreateCaptureItemForMonitor(m_options.monitor);
-        }
-        catch(winrt::hresult_error const& error)
-        {
-            MessageBox(m_options.outputWindow, error.message().c_str(), L"ShaderGlass", MB_OK | MB_ICONERROR);
-            return false;
-        }
-    }
-
     m_shaderGlass = make_unique<ShaderGlass>();
     m_shaderGlass->Initialize(m_options.outputWindow,
                               m_options.captureWindow,
                               m_options.monitor,
                               m_options.clone,
-                              !m_options.imageFile.empty(),
+                              StillInput(),
                               m_options.flipMode,
                               m_options.allowTearing,
-                              m_d3dDevice,
+                              *m_deviceCache,
+                              m_metrics,
                               m_context);
+    m_sessionOptions = m_options;
     UpdatePixelSize();
     UpdateOutputSize();
     UpdateOutputFlip();
+    UpdateMemoryBudget();
     UpdateShaderPreset();
     UpdateFrameSkip();
     UpdateLockedArea();
     UpdateCroppedArea();
     UpdateVertical();
+    UpdateAdaptiveQuality();
+
+    if(!CreateSession())
+    {
+        m_shaderGlass->Stop();
+        m_shaderGlass.reset();
+        return false;
+    }
+
+    StartRenderThread();
+
+    UpdateCursor();
+    return true;
+}
+
+void CaptureManager::StartRenderThread()
+{
+    m_active       = true;
+    m_renderThread = CreateThread(NULL, 0, ThreadFuncProxy, this, 0, NULL);
+}
+
+void CaptureManager::StopRenderThread()
+{
+    m_active = false;
+    SetEvent(m_frameEvent);
+    if(m_renderThread)
+    {
+        WaitForSingleObject(m_renderThread, INFINITE);
+        CloseHandle(m_renderThread);
+        m_renderThread = nullptr;
+    }
+}
+
+bool CaptureManager::StillInput() const
+{
+    // recordings replay as a standalone texture like an image
+    return !m_options.imageFile.empty() || !m_options.replayFile.empty();
+}
+
+bool CaptureManager::CreateSession()
+{
+    auto device = CreateDirect3DDevice(m_d3dDevice.as<IDXGIDevice>().get());
+
+    if(m_options.replayFile.size())
+    {
+        auto         replay = make_unique<CaptureRecording>();
+        CaptureFrame frame;
+        if(!replay->Open(m_options.replayFile) || !replay->Frame(0, frame))
+        {
+            MessageBox(m_options.outputWindow, L"Unable to open recording", L"ShaderGlass", MB_OK | MB_ICONERROR);
+            return false;
+        }
+
+        m_options.imageWidth  = frame.width;
+        m_options.imageHeight = frame.height;
+
+        m_session = make_unique<CaptureSession>(device, std::move(replay), *m_shaderGlass, m_metrics, m_frameEvent);
+        UpdatePixelSize();
+        return true;
+    }
+
+    winrt::Windows::Graphics::Capture::GraphicsCaptureItem captureItem {nullptr};
+    if(!m_options.imageFile.size())
+    {
+        try
+        {
+            captureItem = m_options.captureWindow ? CreateCaptureItemForWindow(m_options.captureWindow) : CreateCaptureItemForMonitor(m_options.monitor);
+        }
+        catch(winrt::hresult_error const& error)
+        {
+            MessageBox(m_options.outputWindow, error.message().c_str(), L"ShaderGlass", MB_OK | MB_ICONERROR);
+            return false;
+        }
+    }
 
     if(m_options.imageFile.size())
     {
@@ -154,18 +298,59 @@ bool CaptureManager::StartSession()
         m_options.imageWidth  = desc.Width;
         m_options.imageHeight = desc.Height;
 
-        m_session = make_unique<CaptureSession>(device, inputTexture, *m_shaderGlass, m_frameEvent);
+        m_session = make_unique<CaptureSession>(device, inputTexture, *m_shaderGlass, m_metrics, m_frameEvent);
         UpdatePixelSize();
     }
     else
     {
-        m_session = make_unique<CaptureSession>(
-            device, captureItem, winrt::Windows::Graphics::DirectX::DirectXPixelFormat::B8G8R8A8UIntNormalized, *m_shaderGlass, m_options.maxCaptureRate, m_frameEvent);
+        // slots fit the source as it is now, frames grown beyond are not recorded
+        m_recording.reset();
+        if(m_options.recordFile.size())
+        {
+            auto size   = captureItem.Size();
+            m_recording = make_unique<CaptureRecording>();
+            if(!m_recording->Create(m_options.recordFile, sRecordedFrames, CaptureRecording::SlotBytes(size.Width, size.Height)))
+            {
+                MessageBox(m_options.outputWindow, L"Unable to create recording", L"ShaderGlass", MB_OK | MB_ICONERROR);
+                m_recording.reset();
+            }
+        }
+
+        m_session = make_unique<CaptureSession>(device,
+                                                captureItem,
+                                                winrt::Windows::Graphics::DirectX::DirectXPixelFormat::B8G8R8A8UIntNormalized,
+                                                *m_shaderGlass,
+                                                m_metrics,
+                                                m_options.maxCaptureRate,
+                                                m_frameEvent,
+                                                m_recording.get());
     }
+    return true;
+}
 
-    m_active = true;
-    CreateThread(NULL, 0, ThreadFuncProxy, this, 0, NULL);
+bool CaptureManager::SwapSource()
+{
+    // shaders, passes and swap chain stay, only the session feeding frames is replaced once the render thread is out of it
+    StopRenderThread();
+    m_session->Stop();
+    m_session.reset();
 
+    m_shaderGlass->SetCaptureSource(m_options.captureWindow, m_options.monitor, m_options.clone, StillInput());
+    auto created = CreateSession();
+    m_sessionOptions.monitor        = m_options.monitor;
+    m_sessionOptions.captureWindow  = m_options.captureWindow;
+    m_sessionOptions.imageFile      = m_options.imageFile;
+    m_sessionOptions.clone          = m_options.clone;
+    m_sessionOptions.maxCaptureRate = m_options.maxCaptureRate;
+    m_sessionOptions.recordFile     = m_options.recordFile;
+    m_sessionOptions.replayFile     = m_options.replayFile;
+
+    if(!created)
+    {
+        Exit();
+        return false;
+    }
+    StartRenderThread();
     UpdateCursor();
     return true;
 }
@@ -178,8 +363,11 @@ void CaptureManager::SetParams(const std::vector<std::tuple<int, std::string, do
 
 void CaptureManager::UpdateCursor()
 {
-    if(m_session)
+    if(m_session && !m_deferOptions)
+    {
         m_session->UpdateCursor(m_options.captureCursor);
+        m_sessionOptions.captureCursor = m_options.captureCursor;
+    }
 }
 
 void CaptureManager::Debug()
@@ -227,6 +415,51 @@ float CaptureManager::OutFPS()
     return 0.f;
 }
 
+int CaptureManager::SkippedFrames()
+{
+    if(m_shaderGlass)
+    {
+        return m_shaderGlass->SkippedFrames();
+    }
+    return 0;
+}
+
+int CaptureManager::PartialFrames()
+{
+    if(m_shaderGlass)
+    {
+        return m_shaderGlass->PartialFrames();
+    }
+    return 0;
+}
+
+int CaptureManager::AdaptiveLevel()
+{
+    if(m_shaderGlass)
+    {
+        return m_shaderGlass->AdaptiveLevel();
+    }
+    return 0;
+}
+
+int CaptureManager::MemoryLevel()
+{
+    if(m_shaderGlass)
+    {
+        return m_shaderGlass->MemoryLevel();
+    }
+    return 0;
+}
+
+std::vector<PassCost> CaptureManager::PassCosts()
+{
+    if(m_shaderGlass)
+    {
+        return m_shaderGlass->PassCosts();
+    }
+    return {};
+}
+
 float CaptureManager::InFPS()
 {
     if(m_session)
@@ -258,13 +491,15 @@ void CaptureManager::StopSession()
 
 void CaptureManager::Exit()
 {
-    if(m_session.get())
+    if(m_shaderGlass.get())
     {
-        m_active = false;
-        SetEvent(m_frameEvent);
-
-        m_session->Stop();
-        delete m_session.release();
+        StopRenderThread();
+        if(m_session.get())
+        {
+            m_session->Stop();
+            delete m_session.release();
+        }
+        m_recording.reset();
 
         m_shaderGlass->Stop();
         delete m_shaderGlass.release();
@@ -279,80 +514,121 @@ void CaptureManager::Exit()
 
 void CaptureManager::UpdatePixelSize()
 {
-    if(m_shaderGlass)
+    if(m_shaderGlass && !m_deferOptions)
     {
         m_shaderGlass->SetInputScale(m_options.pixelWidth * m_options.dpiScale, m_options.pixelHeight * m_options.dpiScale);
+        m_sessionOptions.pixelWidth  = m_options.pixelWidth;
+        m_sessionOptions.pixelHeight = m_options.pixelHeight;
+        m_sessionOptions.dpiScale    = m_options.dpiScale;
     }
 }
 
 void CaptureManager::UpdateOutputSize()
 {
-    if(m_shaderGlass)
+    if(m_shaderGlass && !m_deferOptions)
     {
         if(m_options.vertical)
             m_shaderGlass->SetOutputScale(1.0f / m_options.outputScale, 1.0f / m_options.aspectRatio / m_options.outputScale);
         else
             m_shaderGlass->SetOutputScale(1.0f * m_options.aspectRatio / m_options.outputScale, 1.0f / m_options.outputScale);
         m_shaderGlass->SetFreeScale(m_options.freeScale);
+        m_sessionOptions.aspectRatio = m_options.aspectRatio;
+        m_sessionOptions.outputScale = m_options.outputScale;
+        m_sessionOptions.freeScale   = m_options.freeScale;
     }
 }
 
 void CaptureManager::UpdateOutputFlip()
 {
-    if(m_shaderGlass)
+    if(m_shaderGlass && !m_deferOptions)
     {
         m_shaderGlass->SetOutputFlip(m_options.flipHorizontal, m_options.flipVertical);
+        m_sessionOptions.flipHorizontal = m_options.flipHorizontal;
+        m_sessionOptions.flipVertical   = m_options.flipVertical;
     }
 }
 
-void CaptureManager::UpdateShaderPreset()
+bool CaptureManager::UpdateShaderPreset()
 {
-    if(m_shaderGlass)
+    if(m_shaderGlass && !m_deferOptions)
     {
+        // a preset over budget even at the lowest degradation is refused and the current one stays
+        auto presetDef = m_presetList.at(m_options.presetNo).get();
+        if(m_options.presetNo != m_sessionOptions.presetNo && !m_shaderGlass->FitsMemoryBudget(*presetDef))
+        {
+            m_options.presetNo = m_sessionOptions.presetNo;
+            m_queuedParams.clear();
+            return false;
+        }
+
         // restore params when restarting
         if(m_lastPreset == m_options.presetNo && !m_queuedParams.size() && m_lastParams.size())
         {
             SetParams(m_lastParams);
         }
-        m_shaderGlass->SetShaderPreset(m_presetList.at(m_options.presetNo).get(), m_queuedParams);
+        m_shaderGlass->SetShaderPreset(presetDef, m_queuedParams);
         m_queuedParams.clear();
-        m_lastPreset = m_options.presetNo;
+        m_lastPreset              = m_options.presetNo;
+        m_sessionOptions.presetNo = m_options.presetNo;
     }
+    return true;
 }
 
 void CaptureManager::UpdateFrameSkip()
 {
-    if(m_shaderGlass)
+    if(m_shaderGlass && !m_deferOptions)
     {
         m_shaderGlass->SetFrameSkip(m_options.frameSkip);
+        m_sessionOptions.frameSkip = m_options.frameSkip;
     }
 }
 
 void CaptureManager::UpdateLockedArea()
 {
-    if(m_shaderGlass)
+    if(m_shaderGlass && !m_deferOptions)
     {
         m_shaderGlass->SetLockedArea(m_options.inputArea);
+        m_sessionOptions.inputArea = m_options.inputArea;
     }
 }
 
 void CaptureManager::UpdateCroppedArea()
 {
-    if(m_shaderGlass)
+    if(m_shaderGlass && !m_deferOptions)
     {
         m_shaderGlass->SetCroppedArea(m_options.croppedArea);
+        m_sessionOptions.croppedArea = m_options.croppedArea;
     }
 }
 
 void CaptureManager::UpdateVertical()
 {
-    if(m_shaderGlass)
+    if(m_shaderGlass && !m_deferOptions)
     {
         m_shaderGlass->SetVertical(m_options.vertical);
+        m_sessionOptions.vertical = m_options.vertical;
         UpdateOutputSize();
     }
 }
 
+void CaptureManager::UpdateAdaptiveQuality()
+{
+    if(m_shaderGlass && !m_deferOptions)
+    {
+        m_shaderGlass->SetAdaptiveQuality(m_options.adaptiveQuality);
+        m_sessionOptions.adaptiveQuality = m_options.adaptiveQuality;
+    }
+}
+
+void CaptureManager::UpdateMemoryBudget()
+{
+    if(m_shaderGlass && !m_deferOptions)
+    {
+        m_shaderGlass->SetMemoryBudget(static_cast<uint64_t>(m_options.memoryBudget) << 20);
+        m_sessionOptions.memoryBudget = m_options.memoryBudget;
+    }
+}
+
 void CaptureManager::GrabOutput()
 {
     if(m_shaderGlass)
@@ -388,6 +664,7 @@ void CaptureManager::ResetParams()
 
 void CaptureManager::ThreadFunc()
 {
+    Tracer::NameThread("render");
     while(m_active)
     {
         WaitForSingleObject(m_frameEvent, 1);
@@ -434,3 +711,18 @@ int CaptureManager::FindByName(const char* presetName)
     }
     return -1;
 }
+
+int CaptureManager::FindByImportPath(const std::filesystem::path& path)
+{
+    const auto normalPath = path.lexically_normal();
+    int        p          = 0;
+    while(p < m_presetList.size())
+    {
+        if(m_presetList[p]->Category == "Imported" && m_presetList[p]->ImportPath.lexically_normal() == normalPath)
+        {
+            return p;
+        }
+        p++;
+    }
+    return -1;
+}
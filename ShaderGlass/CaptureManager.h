@@ -38,6 +38,38 @@ struct CaptureOptions
     bool         maxCaptureRate {false};
     RECT         croppedArea {0, 0, 0, 0};
     bool         vertical {false};
+    bool         adaptiveQuality {false};
+    std::wstring recordFile {}; // captured frames are also written here
+    std::wstring replayFile {}; // input comes from this recording instead
+    unsigned     memoryBudget {0}; // MB of device memory a preset may use, 0 for no limit
+};
+
+// parts of a running session which depend on options that differ, each is rebuilt on its own
+struct CaptureChanges
+{
+    bool output {false}; // swap chain, needs a new session
+    bool source {false}; // capture item or image, ShaderGlass can stay
+    bool pixelSize {false};
+    bool outputSize {false};
+    bool outputFlip {false};
+    bool preset {false};
+    bool frameSkip {false};
+    bool cursor {false};
+    bool lockedArea {false};
+    bool croppedArea {false};
+    bool vertical {false};
+    bool adaptiveQuality {false};
+    bool memoryBudget {false};
+
+    static CaptureChanges Between(const CaptureOptions& from, const CaptureOptions& to);
+};
+
+// outcome of applying options to a running session
+enum class ApplyResult
+{
+    Applied,
+    PresetRefused, // over the memory budget, the current preset stays
+    Failed // the session couldn't be restarted and was stopped
 };
 
 class CaptureManager
@@ -51,45 +83,69 @@ public:
     const std::vector<std::unique_ptr<PresetDef>>& Presets();
     std::vector<std::tuple<int, ShaderParam*>>     Params();
     const ShaderCache&                             Cache();
+    MetricsRegistry&                               Metrics();
+    std::vector<PassCost>                          PassCosts();
 
-    bool  Initialize();
-    bool  IsActive();
-    bool  StartSession();
-    void  StopSession();
-    void  Debug();
-    int   AddPreset(PresetDef* preset);
-    void  UpdatePixelSize();
-    void  UpdateOutputSize();
-    void  UpdateOutputFlip();
-    void  UpdateShaderPreset();
-    void  UpdateFrameSkip();
-    bool  UpdateInput();
-    void  UpdateCursor();
-    void  UpdateLockedArea();
-    void  UpdateCroppedArea();
-    void  UpdateVertical();
-    void  GrabOutput();
-    void  UpdateParams();
-    void  ResetParams();
-    void  SetParams(const std::vector<std::tuple<int, std::string, double>>& params);
-    void  RememberLastPreset();
-    void  SetLastPreset(unsigned presetNo);
-    void  ForgetLastPreset();
-    void  SaveOutput(LPWSTR fileName);
-    void  ProcessFrame();
-    void  ThreadFunc();
-    void  Exit();
-    float InFPS();
-    float OutFPS();
-    int   FindByName(const char* presetName);
+    bool        Initialize();
+    bool        IsActive();
+    bool        StartSession();
+    void        StopSession();
+    ApplyResult ApplyOptions();
+    void        BeginOptions();
+    void        EndOptions();
+    void        Debug();
+    int         AddPreset(PresetDef* preset);
+    void        UpdatePixelSize();
+    void        UpdateOutputSize();
+    void        UpdateOutputFlip();
+    bool        UpdateShaderPreset(); // false if refused, see ApplyResult::PresetRefused
+    void        UpdateFrameSkip();
+    ApplyResult UpdateInput();
+    void        UpdateCursor();
+    void        UpdateLockedArea();
+    void        UpdateCroppedArea();
+    void        UpdateVertical();
+    void        UpdateAdaptiveQuality();
+    void        UpdateMemoryBudget();
+    void        GrabOutput();
+    void        UpdateParams();
+    void        ResetParams();
+    void        SetParams(const std::vector<std::tuple<int, std::string, double>>& params);
+    void        RememberLastPreset();
+    void        SetLastPreset(unsigned presetNo);
+    void        ForgetLastPreset();
+    void        SaveOutput(LPWSTR fileName);
+    void        ProcessFrame();
+    void        ThreadFunc();
+    void        Exit();
+    float       InFPS();
+    float       OutFPS();
+    int         SkippedFrames();
+    int         PartialFrames();
+    int         AdaptiveLevel();
+    int         MemoryLevel();
+    int         FindByName(const char* presetName);
+    int         FindByImportPath(const std::filesystem::path& path);
 
 private:
+    bool CreateSession();
+    bool SwapSource();
+    void StartRenderThread();
+    void StopRenderThread();
+    bool StillInput() const;
+
     volatile bool                                     m_active {false};
     winrt::com_ptr<ID3D11Device>                      m_d3dDevice {nullptr};
     winrt::com_ptr<ID3D11DeviceContext>               m_context {nullptr};
+    std::unique_ptr<DeviceCache>                      m_deviceCache {nullptr};
+    MetricsRegistry                                   m_metrics;
     winrt::com_ptr<ID3D11Debug>                       m_debug {nullptr};
     winrt::com_ptr<ID3D11Texture2D>                   m_outputTexture {nullptr};
     std::unique_ptr<CaptureSession>                   m_session {nullptr};
+    std::unique_ptr<CaptureRecording>                 m_recording {nullptr};
+    HANDLE                                            m_renderThread {nullptr};
+    CaptureOptions                                    m_sessionOptions {};
+    bool                                              m_deferOptions {false}; // changes stay in m_options until EndOptions
     std::unique_ptr<ShaderGlass>                      m_shaderGlass {nullptr};
     std::vector<std::unique_ptr<PresetDef>>           m_presetList;
     std::vector<std::tuple<int, std::string, double>> m_queuedParams;
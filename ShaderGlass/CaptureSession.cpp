@@ -11,6 +11,8 @@ GNU General Public License v3.0
 
 #include "Util/direct3d11.interop.h"
 
+#include <d3d11_4.h>
+
 namespace winrt
 {
 using namespace Windows::Foundation;
@@ -28,8 +30,13 @@ CaptureSession::CaptureSession(winrt::IDirect3DDevice const&     device,
                                winrt::GraphicsCaptureItem const& item,
                                winrt::DirectXPixelFormat         pixelFormat,
                                ShaderGlass&                      shaderGlass,
+                               MetricsRegistry&                  metrics,
                                bool                              maxCaptureRate,
-                               HANDLE frameEvent) : m_device {device}, m_item {item}, m_pixelFormat {pixelFormat}, m_shaderGlass {shaderGlass}, m_frameEvent(frameEvent)
+                               HANDLE                            frameEvent,
+                               CaptureRecording*                 recording) :
+    m_device {device}, m_item {item}, m_pixelFormat {pixelFormat}, m_shaderGlass {shaderGlass}, m_frameEvent(frameEvent), m_capturedFrames {metrics.Counter("capture.frames")},
+    m_overwrittenFrames {metrics.Counter("capture.overwritten_frames")}, m_queueDepth {metrics.Gauge("capture.queue_depth")},
+    m_unrecordedFrames {metrics.Counter("capture.unrecorded_frames")}, m_recording {recording}
 {
     m_contentSize = m_item.Size();
     m_framePool   = winrt::Direct3D11CaptureFramePool::CreateFreeThreaded(m_device, pixelFormat, 2, m_contentSize);
@@ -58,6 +65,16 @@ CaptureSession::CaptureSession(winrt::IDirect3DDevice const&     device,
         { }
     }
 
+    if(m_recording)
+    {
+        // frames are copied on pool threads into the immediate context the renderer uses
+        auto                                d3dDevice = GetDXGIInterfaceFromObject<ID3D11Device>(m_device);
+        winrt::com_ptr<ID3D11DeviceContext> context;
+        d3dDevice->GetImmediateContext(context.put());
+        if(auto multithread = context.try_as<ID3D11Multithread>())
+            multithread->SetMultithreadProtected(TRUE);
+    }
+
     m_numInputFrames  = 0;
     m_prevInputFrames = 0;
     m_fps             = 0;
@@ -71,11 +88,25 @@ CaptureSession::CaptureSession(winrt::IDirect3DDevice const&     device,
 CaptureSession::CaptureSession(winrt::Windows::Graphics::DirectX::Direct3D11::IDirect3DDevice const& device,
                                winrt::com_ptr<ID3D11Texture2D>                                       inputImage,
                                ShaderGlass&                                                          shaderGlass,
-                               HANDLE frameEvent) : m_device {device}, m_inputImage {inputImage}, m_shaderGlass {shaderGlass}, m_frameEvent {frameEvent}
+                               MetricsRegistry&                                                      metrics,
+                               HANDLE                                                                frameEvent) :
+    m_device {device}, m_inputImage {inputImage}, m_shaderGlass {shaderGlass}, m_frameEvent {frameEvent}, m_capturedFrames {metrics.Counter("capture.frames")},
+    m_overwrittenFrames {metrics.Counter("capture.overwritten_frames")}, m_queueDepth {metrics.Gauge("capture.queue_depth")},
+    m_unrecordedFrames {metrics.Counter("capture.unrecorded_frames")}
 {
     ProcessInput();
 }
 
+CaptureSession::CaptureSession(winrt::Windows::Graphics::DirectX::Direct3D11::IDirect3DDevice const& device,
+                               std::unique_ptr<CaptureRecording>                                     replay,
+                               ShaderGlass&                                                          shaderGlass,
+                               MetricsRegistry&                                                      metrics,
+                               HANDLE                                                                frameEvent) :
+    m_device {device}, m_shaderGlass {shaderGlass}, m_frameEvent {frameEvent}, m_capturedFrames {metrics.Counter("capture.frames")},
+    m_overwrittenFrames {metrics.Counter("capture.overwritten_frames")}, m_queueDepth {metrics.Gauge("capture.queue_depth")},
+    m_unrecordedFrames {metrics.Counter("capture.unrecorded_frames")}, m_replay {std::move(replay)}
+{ }
+
 void CaptureSession::UpdateCursor(bool captureCursor)
 {
     if(m_session && winrt::Windows::Foundation::Metadata::ApiInformation::IsPropertyPresent(L"Windows.Graphics.Capture.GraphicsCaptureSession", L"IsCursorCaptureEnabled"))
@@ -84,9 +115,19 @@ void CaptureSession::UpdateCursor(bool captureCursor)
 
 void CaptureSession::OnFrameArrived(winrt::Direct3D11CaptureFramePool const& sender, winrt::IInspectable const&)
 {
+    // frames arrive on pool threads
+    Tracer::NameThread("capture");
+    Tracer::Span span("capture", "OnFrameArrived");
+
     auto frame   = sender.TryGetNextFrame();
     m_inputFrame = GetDXGIInterfaceFromObject<ID3D11Texture2D>(frame.Surface());
-    m_frameTicks = GetTickCount64();
+    // keep ticks unique per frame, they identify new input for the renderer
+    m_frameTicks  = max(GetTickCount64(), m_frameTicks + 1);
+    m_captureTime = MetricsRegistry::Now();
+
+    // every captured frame, also those the renderer never takes
+    if(m_recording)
+        RecordFrame(m_inputFrame.get());
 
     auto contentSize = frame.ContentSize();
     if(contentSize.Width != m_contentSize.Width || contentSize.Height != m_contentSize.Height)
@@ -97,6 +138,12 @@ void CaptureSession::OnFrameArrived(winrt::Direct3D11CaptureFramePool const& sen
     }
 
     SetEvent(m_frameEvent);
+    m_capturedFrames.Add();
+    auto pending = ++m_pendingFrames;
+    if(pending > 1)
+        m_overwrittenFrames.Add();
+    m_queueDepth.Set(pending);
+
     m_numInputFrames++;
     if(m_frameTicks - m_prevTicks > 1000)
     {
@@ -112,22 +159,175 @@ void CaptureSession::ProcessInput()
 {
     if(m_inputImage.get())
     {
-        m_shaderGlass.Process(m_inputImage, 0);
+        m_shaderGlass.Process(m_inputImage, 0, 0);
+    }
+    else if(m_replay)
+    {
+        // the next frame only once the renderer took this one, so the clock moves one frame per rendered input
+        if(m_replayTaken)
+            ReplayFrame();
+        m_replayTaken = m_shaderGlass.Process(m_inputFrame, m_frameTicks, m_captureTime);
     }
     else
     {
-        m_shaderGlass.Process(m_inputFrame, m_frameTicks);
+        if(m_pendingFrames.exchange(0))
+            m_queueDepth.Set(0);
+        m_shaderGlass.Process(m_inputFrame, m_frameTicks, m_captureTime);
     }
 }
 
+void CaptureSession::RecordFrame(ID3D11Texture2D* frame)
+{
+    Tracer::Span span("capture", "RecordFrame");
+
+    std::lock_guard<std::mutex>         lock(m_recordMutex);
+    winrt::com_ptr<ID3D11Device>        d3dDevice;
+    winrt::com_ptr<ID3D11DeviceContext> context;
+    frame->GetDevice(d3dDevice.put());
+    d3dDevice->GetImmediateContext(context.put());
+
+    // write out, oldest first, the copies the GPU has finished since the last arrival
+    for(size_t i = 0; i < sStagedFrames; i++)
+    {
+        auto& staged = m_stagedFrames[(m_nextStaged + i) % sStagedFrames];
+        if(staged.pending && !WriteFrame(context.get(), staged, false))
+            break;
+    }
+
+    // all are pending only if the GPU is frames behind, then this thread waits for the oldest rather than drop it
+    auto& staged = m_stagedFrames[m_nextStaged];
+    if(staged.pending)
+        WriteFrame(context.get(), staged, true);
+
+    D3D11_TEXTURE2D_DESC desc        = {};
+    D3D11_TEXTURE2D_DESC stagingDesc = {};
+    frame->GetDesc(&desc);
+    if(staged.texture)
+        staged.texture->GetDesc(&stagingDesc);
+    if(!staged.texture || stagingDesc.Width != desc.Width || stagingDesc.Height != desc.Height)
+    {
+        desc.Usage          = D3D11_USAGE_STAGING;
+        desc.BindFlags      = 0;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        desc.MiscFlags      = 0;
+        staged.texture      = nullptr;
+        if(FAILED(d3dDevice->CreateTexture2D(&desc, nullptr, staged.texture.put())))
+        {
+            m_unrecordedFrames.Add();
+            return;
+        }
+    }
+
+    context->CopyResource(staged.texture.get(), frame);
+    // pool textures can be larger than the captured content
+    staged.width       = min(desc.Width, (UINT)m_contentSize.Width);
+    staged.height      = min(desc.Height, (UINT)m_contentSize.Height);
+    staged.captureTime = m_captureTime;
+    staged.pending     = true;
+    m_nextStaged       = (m_nextStaged + 1) % sStagedFrames;
+}
+
+// false if the copy isn't done yet and wait wasn't given, the frame then stays pending
+bool CaptureSession::WriteFrame(ID3D11DeviceContext* context, StagedFrame& staged, bool wait)
+{
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    auto                     hr = context->Map(staged.texture.get(), 0, D3D11_MAP_READ, wait ? 0 : D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped);
+    if(hr == DXGI_ERROR_WAS_STILL_DRAWING)
+        return false;
+
+    staged.pending = false;
+    if(FAILED(hr))
+    {
+        m_unrecordedFrames.Add();
+        return true;
+    }
+
+    if(!m_recordStart)
+        m_recordStart = staged.captureTime;
+    if(!m_recording->Write(staged.captureTime - m_recordStart, staged.width, staged.height, mapped.pData, mapped.RowPitch))
+        m_unrecordedFrames.Add();
+    context->Unmap(staged.texture.get(), 0);
+    return true;
+}
+
+// writes the frames still in flight once capture stopped
+void CaptureSession::FlushRecording()
+{
+    std::lock_guard<std::mutex> lock(m_recordMutex);
+    for(size_t i = 0; i < sStagedFrames; i++)
+    {
+        auto& staged = m_stagedFrames[(m_nextStaged + i) % sStagedFrames];
+        if(!staged.pending)
+            continue;
+
+        winrt::com_ptr<ID3D11Device>        d3dDevice;
+        winrt::com_ptr<ID3D11DeviceContext> context;
+        staged.texture->GetDevice(d3dDevice.put());
+        d3dDevice->GetImmediateContext(context.put());
+        WriteFrame(context.get(), staged, true);
+    }
+}
+
+void CaptureSession::ReplayFrame()
+{
+    CaptureFrame frame;
+    if(!m_replay->Frame(m_replayFrame, frame))
+        return; // ticks stay the same so nothing new is rendered
+
+    auto d3dDevice = GetDXGIInterfaceFromObject<ID3D11Device>(m_device);
+
+    D3D11_TEXTURE2D_DESC desc = {};
+    if(m_inputFrame)
+        m_inputFrame->GetDesc(&desc);
+    if(!m_inputFrame || desc.Width != frame.width || desc.Height != frame.height)
+    {
+        desc                  = {};
+        desc.Width            = frame.width;
+        desc.Height           = frame.height;
+        desc.MipLevels        = 1;
+        desc.ArraySize        = 1;
+        desc.Format           = DXGI_FORMAT_B8G8R8A8_UNORM;
+        desc.SampleDesc.Count = 1;
+        desc.Usage            = D3D11_USAGE_DEFAULT;
+        desc.BindFlags        = D3D11_BIND_SHADER_RESOURCE;
+
+        D3D11_SUBRESOURCE_DATA data = {};
+        data.pSysMem                = frame.pixels;
+        data.SysMemPitch            = frame.width * 4;
+        m_inputFrame                = nullptr;
+        if(FAILED(d3dDevice->CreateTexture2D(&desc, &data, m_inputFrame.put())))
+            return;
+    }
+    else
+    {
+        winrt::com_ptr<ID3D11DeviceContext> context;
+        d3dDevice->GetImmediateContext(context.put());
+        context->UpdateSubresource(m_inputFrame.get(), 0, nullptr, frame.pixels, frame.width * 4, 0);
+    }
+
+    // n-th frame shows at logical frame n, as if captured at a steady 60 fps; ticks count from frame 1 as 0 means
+    // the system clock
+    m_replayFrame++;
+    m_frameTicks  = (m_replayFrame * 1000 + 30) / 60;
+    m_captureTime = MetricsRegistry::Now();
+    m_shaderGlass.SetFixedClock(m_frameTicks);
+    m_capturedFrames.Add();
+}
+
 void CaptureSession::Stop()
 {
+    if(m_replay)
+        m_shaderGlass.SetFixedClock(0);
+
     if(m_session)
         m_session.Close();
 
     if(m_framePool)
         m_framePool.Close();
 
+    if(m_recording)
+        FlushRecording();
+
     m_framePool = nullptr;
     m_session   = nullptr;
     m_item      = nullptr;
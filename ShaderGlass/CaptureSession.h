@@ -8,6 +8,10 @@ GNU General Public License v3.0
 #pragma once
 
 #include "ShaderGlass.h"
+#include "CaptureRecording.h"
+
+#include <array>
+#include <mutex>
 
 class CaptureSession
 {
@@ -16,12 +20,23 @@ public:
                    winrt::Windows::Graphics::Capture::GraphicsCaptureItem const&         item,
                    winrt::Windows::Graphics::DirectX::DirectXPixelFormat                 pixelFormat,
                    ShaderGlass&                                                          shaderGlass,
+                   MetricsRegistry&                                                      metrics,
                    bool                                                                  maxCaptureRate,
-                   HANDLE                                                                frameEvent);
+                   HANDLE                                                                frameEvent,
+                   CaptureRecording*                                                     recording = nullptr);
 
     CaptureSession(winrt::Windows::Graphics::DirectX::Direct3D11::IDirect3DDevice const& device,
                    winrt::com_ptr<ID3D11Texture2D>                                       inputImage,
                    ShaderGlass&                                                          shaderGlass,
+                   MetricsRegistry&                                                      metrics,
+                   HANDLE                                                                frameEvent);
+
+    // feeds frames of a recording at a fixed 60 fps clock, each once the renderer took the previous one; the last frame
+    // stays once it ends
+    CaptureSession(winrt::Windows::Graphics::DirectX::Direct3D11::IDirect3DDevice const& device,
+                   std::unique_ptr<CaptureRecording>                                     replay,
+                   ShaderGlass&                                                          shaderGlass,
+                   MetricsRegistry&                                                      metrics,
                    HANDLE                                                                frameEvent);
 
     void OnFrameArrived(winrt::Windows::Graphics::Capture::Direct3D11CaptureFramePool const& sender, winrt::Windows::Foundation::IInspectable const& args);
@@ -38,6 +53,24 @@ public:
     }
 
 private:
+    // copy of a captured frame on its way to the recording
+    struct StagedFrame
+    {
+        winrt::com_ptr<ID3D11Texture2D> texture {nullptr};
+        uint64_t                        captureTime {0};
+        UINT                            width {0};
+        UINT                            height {0};
+        bool                            pending {false}; // copied but not yet written
+    };
+
+    // frames are read back a few arrivals after they're copied, so neither capture nor rendering waits for the GPU
+    static constexpr size_t sStagedFrames = 3;
+
+    void RecordFrame(ID3D11Texture2D* frame);
+    bool WriteFrame(ID3D11DeviceContext* context, StagedFrame& staged, bool wait);
+    void FlushRecording();
+    void ReplayFrame();
+
     winrt::Windows::Graphics::Capture::GraphicsCaptureItem         m_item {nullptr};
     winrt::Windows::Graphics::Capture::Direct3D11CaptureFramePool  m_framePool {nullptr};
     winrt::Windows::Graphics::Capture::GraphicsCaptureSession      m_session {nullptr};
@@ -47,10 +80,24 @@ private:
     winrt::Windows::Graphics::DirectX::DirectXPixelFormat          m_pixelFormat {0};
     winrt::Windows::Graphics::SizeInt32                            m_contentSize {0, 0};
     ULONGLONG                                                      m_frameTicks {0};
+    std::atomic<uint64_t>                                          m_captureTime {0};
+    std::atomic<int>                                               m_pendingFrames {0};
     float                                                          m_fps {0};
     int                                                            m_numInputFrames {0};
     ULONGLONG                                                      m_prevTicks {0};
     int                                                            m_prevInputFrames {0};
     HANDLE                                                         m_frameEvent {nullptr};
     ShaderGlass&                                                   m_shaderGlass;
+    MetricCounter&                                                 m_capturedFrames;
+    MetricCounter&                                                 m_overwrittenFrames; // replaced before the renderer took them
+    MetricGauge&                                                   m_queueDepth; // captured frames not yet taken by the renderer
+    MetricCounter&                                                 m_unrecordedFrames; // larger than a slot of the recording
+    CaptureRecording*                                              m_recording {nullptr};
+    uint64_t                                                       m_recordStart {0};
+    std::array<StagedFrame, sStagedFrames>                         m_stagedFrames;
+    size_t                                                         m_nextStaged {0}; // oldest once all are pending
+    std::mutex                                                     m_recordMutex; // frames arrive on pool threads
+    std::unique_ptr<CaptureRecording>                              m_replay {nullptr};
+    uint64_t                                                       m_replayFrame {0}; // next to read
+    bool                                                           m_replayTaken {true}; // by the renderer, or none read yet
 };
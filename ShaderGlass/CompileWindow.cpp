@@ -130,6 +130,18 @@ LRESULT CALLBACK CompileWindow::WndProc(HWND hWnd, UINT message, WPARAM wParam,
         Resize();
         break;
     }
+    case WM_COMMAND: {
+        UINT wmId = LOWORD(wParam);
+        switch(wmId)
+        {
+        case WM_USER + 1: {
+            // progress of a library import, nullptr restores the default text
+            SetWindowText(m_textControl, lParam ? (LPCWSTR)lParam : TEXT("Compiling shader...\r\n"));
+            return 0;
+        }
+        }
+        break;
+    }
     case WM_KEYDOWN: {
         if(wParam == VK_ESCAPE)
         {
@@ -0,0 +1,113 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "DeviceCache.h"
+#include "ShaderCache.h"
+
+static HRESULT hr;
+
+// idle objects kept for switching back, a few presets' worth of passes
+static const size_t sShaderCapacity  = 256;
+static const size_t sSamplerCapacity = 64;
+
+DeviceCache::DeviceCache(winrt::com_ptr<ID3D11Device> device) :
+    m_device {device}, m_vertexShaders {sShaderCapacity}, m_pixelShaders {sShaderCapacity}, m_inputLayouts {sShaderCapacity}, m_samplerStates {sSamplerCapacity},
+    m_buffers {sSamplerCapacity}
+{ }
+
+std::string DeviceCache::Key(const void* byteCode, size_t length) const
+{
+    auto hash = ShaderCache::CalculateHash(byteCode, length);
+    return std::string((const char*)hash.data(), hash.size() * sizeof(uint32_t));
+}
+
+DeviceObject<ID3D11VertexShader> DeviceCache::VertexShader(const void* byteCode, size_t length)
+{
+    auto create = [&]() {
+        winrt::com_ptr<ID3D11VertexShader> vertexShader;
+        hr = m_device->CreateVertexShader(byteCode, length, NULL, vertexShader.put());
+        assert(SUCCEEDED(hr));
+        return vertexShader;
+    };
+    return m_vertexShaders.Acquire(Key(byteCode, length), create, length);
+}
+
+DeviceObject<ID3D11PixelShader> DeviceCache::PixelShader(const void* byteCode, size_t length)
+{
+    auto create = [&]() {
+        winrt::com_ptr<ID3D11PixelShader> pixelShader;
+        hr = m_device->CreatePixelShader(byteCode, length, NULL, pixelShader.put());
+        assert(SUCCEEDED(hr));
+        return pixelShader;
+    };
+    return m_pixelShaders.Acquire(Key(byteCode, length), create, length);
+}
+
+DeviceObject<ID3D11InputLayout> DeviceCache::InputLayout(const void* vertexByteCode, size_t length)
+{
+    // all passes use the same elements, only the input signature of the vertex shader differs
+    return m_inputLayouts.Acquire(Key(vertexByteCode, length), [&]() {
+        D3D11_INPUT_ELEMENT_DESC inputElementDesc[] = {{"TEXCOORD", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
+                                                       {"TEXCOORD", 1, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0}};
+
+        winrt::com_ptr<ID3D11InputLayout> inputLayout;
+        hr = m_device->CreateInputLayout(inputElementDesc, ARRAYSIZE(inputElementDesc), vertexByteCode, length, inputLayout.put());
+        assert(SUCCEEDED(hr));
+        return inputLayout;
+    });
+}
+
+DeviceObject<ID3D11SamplerState> DeviceCache::SamplerState(const D3D11_SAMPLER_DESC& desc)
+{
+    return m_samplerStates.Acquire(std::string((const char*)&desc, sizeof(desc)), [&]() {
+        winrt::com_ptr<ID3D11SamplerState> samplerState;
+        hr = m_device->CreateSamplerState(&desc, samplerState.put());
+        assert(SUCCEEDED(hr));
+        return samplerState;
+    });
+}
+
+DeviceObject<ID3D11Buffer> DeviceCache::VertexBuffer(const void* data, size_t size)
+{
+    return m_buffers.Acquire(std::string((const char*)data, size), [&]() {
+        D3D11_BUFFER_DESC vertex_buff_descr = {};
+        vertex_buff_descr.ByteWidth         = static_cast<UINT>(size);
+        vertex_buff_descr.Usage             = D3D11_USAGE_IMMUTABLE;
+        vertex_buff_descr.BindFlags         = D3D11_BIND_VERTEX_BUFFER;
+        D3D11_SUBRESOURCE_DATA sr_data      = {0};
+        sr_data.pSysMem                     = data;
+
+        winrt::com_ptr<ID3D11Buffer> vertexBuffer;
+        hr = m_device->CreateBuffer(&vertex_buff_descr, &sr_data, vertexBuffer.put());
+        assert(SUCCEEDED(hr));
+        return vertexBuffer;
+    });
+}
+
+void DeviceCache::Trim()
+{
+    m_vertexShaders.Trim();
+    m_pixelShaders.Trim();
+    m_inputLayouts.Trim();
+    m_samplerStates.Trim();
+    m_buffers.Trim();
+
+    // drivers don't report shader sizes, bytecode is the closest measure; shared by all presets, so pass -1
+    m_shaderMemory.Release();
+    m_shaderMemory = m_memory.Allocate(MemoryKind::Shader, -1, m_vertexShaders.Bytes() + m_pixelShaders.Bytes());
+
+    char message[100];
+    snprintf(message,
+             100,
+             "Device cache: %zu vertex, %zu pixel shaders, %llu reused\n",
+             m_vertexShaders.Size(),
+             m_pixelShaders.Size(),
+             static_cast<unsigned long long>(m_vertexShaders.Hits() + m_pixelShaders.Hits()));
+    OutputDebugStringA(message);
+}
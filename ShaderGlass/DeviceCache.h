@@ -0,0 +1,54 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include "ObjectCache.h"
+#include "MemoryBudget.h"
+
+template<typename T> using DeviceObject = std::shared_ptr<const winrt::com_ptr<T>>;
+
+// immutable objects of one device shared between passes and presets, shaders and layouts are keyed by bytecode hash
+class DeviceCache
+{
+public:
+    DeviceCache(winrt::com_ptr<ID3D11Device> device);
+
+    winrt::com_ptr<ID3D11Device> Device() const
+    {
+        return m_device;
+    }
+
+    // device memory of everything created for presets, not only what this cache holds
+    MemoryLedger& Memory()
+    {
+        return m_memory;
+    }
+
+    DeviceObject<ID3D11VertexShader> VertexShader(const void* byteCode, size_t length);
+    DeviceObject<ID3D11PixelShader>  PixelShader(const void* byteCode, size_t length);
+    DeviceObject<ID3D11InputLayout>  InputLayout(const void* vertexByteCode, size_t length);
+    DeviceObject<ID3D11SamplerState> SamplerState(const D3D11_SAMPLER_DESC& desc);
+
+    // immutable vertex buffer with given contents
+    DeviceObject<ID3D11Buffer> VertexBuffer(const void* data, size_t size);
+
+    // once the previous preset is released
+    void Trim();
+
+private:
+    std::string Key(const void* byteCode, size_t length) const;
+
+    winrt::com_ptr<ID3D11Device>                    m_device;
+    MemoryLedger                                    m_memory;
+    MemoryLedger::Allocation                        m_shaderMemory;
+    ObjectCache<winrt::com_ptr<ID3D11VertexShader>> m_vertexShaders;
+    ObjectCache<winrt::com_ptr<ID3D11PixelShader>>  m_pixelShaders;
+    ObjectCache<winrt::com_ptr<ID3D11InputLayout>>  m_inputLayouts;
+    ObjectCache<winrt::com_ptr<ID3D11SamplerState>> m_samplerStates;
+    ObjectCache<winrt::com_ptr<ID3D11Buffer>>       m_buffers;
+};
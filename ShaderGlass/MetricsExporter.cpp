@@ -0,0 +1,90 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "MetricsExporter.h"
+
+static const wchar_t* sPipePrefix = L"\\\\.\\pipe\\";
+
+DWORD WINAPI PipeThreadFuncProxy(LPVOID lpParam)
+{
+    ((MetricsExporter*)lpParam)->PipeThreadFunc();
+    return 0;
+}
+
+MetricsExporter::MetricsExporter(const MetricsRegistry& registry, const std::wstring& target) : m_registry {registry}, m_target {target}
+{
+    if(IsPipe(m_target))
+    {
+        m_running    = true;
+        m_pipeThread = CreateThread(NULL, 0, PipeThreadFuncProxy, this, 0, NULL);
+    }
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    if(m_pipeThread)
+    {
+        // connect as a client so the thread stops waiting for one
+        m_running   = false;
+        auto client = CreateFileW(m_target.c_str(), GENERIC_READ, 0, NULL, OPEN_EXISTING, 0, NULL);
+        if(client != INVALID_HANDLE_VALUE)
+            CloseHandle(client);
+
+        WaitForSingleObject(m_pipeThread, 1000);
+        CloseHandle(m_pipeThread);
+    }
+}
+
+bool MetricsExporter::IsPipe(const std::wstring& target)
+{
+    return _wcsnicmp(target.c_str(), sPipePrefix, wcslen(sPipePrefix)) == 0;
+}
+
+void MetricsExporter::Publish()
+{
+    if(m_pipeThread || m_target.empty())
+        return;
+
+    // write aside and swap so readers never see half a snapshot
+    auto tempTarget = m_target + L".tmp";
+    {
+        std::ofstream out(tempTarget, std::ios::trunc);
+        if(!out)
+            return;
+        m_registry.Snapshot().WriteJson(out);
+    }
+    MoveFileExW(tempTarget.c_str(), m_target.c_str(), MOVEFILE_REPLACE_EXISTING);
+}
+
+void MetricsExporter::PipeThreadFunc()
+{
+    while(m_running)
+    {
+        auto pipe = CreateNamedPipeW(
+            m_target.c_str(), PIPE_ACCESS_OUTBOUND, PIPE_TYPE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS, PIPE_UNLIMITED_INSTANCES, 64 * 1024, 0, 0, NULL);
+        if(pipe == INVALID_HANDLE_VALUE)
+        {
+            OutputDebugStringW((L"Unable to create metrics pipe " + m_target + L"\n").c_str());
+            return;
+        }
+
+        auto connected = ConnectNamedPipe(pipe, NULL) || GetLastError() == ERROR_PIPE_CONNECTED;
+        if(connected && m_running)
+        {
+            std::ostringstream json;
+            m_registry.Snapshot().WriteJson(json);
+            const auto text = json.str();
+            DWORD      written;
+            WriteFile(pipe, text.data(), static_cast<DWORD>(text.size()), &written, NULL);
+            FlushFileBuffers(pipe);
+        }
+        DisconnectNamedPipe(pipe);
+        CloseHandle(pipe);
+    }
+}
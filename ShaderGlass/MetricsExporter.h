@@ -0,0 +1,30 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include "Metrics.h"
+
+// publishes JSON snapshots of the metrics for monitoring: a named pipe (\\.\pipe\...) serves a fresh one to
+// every client which connects, any other target is a file rewritten on each Publish()
+class MetricsExporter
+{
+public:
+    MetricsExporter(const MetricsRegistry& registry, const std::wstring& target);
+    ~MetricsExporter();
+
+    void Publish();
+    void PipeThreadFunc();
+
+    static bool IsPipe(const std::wstring& target);
+
+private:
+    const MetricsRegistry& m_registry;
+    std::wstring           m_target;
+    HANDLE                 m_pipeThread {nullptr};
+    volatile bool          m_running {false};
+};
@@ -9,7 +9,7 @@ GNU General Public License v3.0
 
 #define MAX_PIXEL_SIZES 20U
 #define MAX_ASPECT_RATIOS 20U
-#define MAX_SHADERS 1500U
+#define MAX_SHADERS 10000U
 #define MAX_FRAME_SKIPS 20U
 #define MAX_OUTPUT_SCALES 20U
 #define MAX_CAPTURE_WINDOWS 100U
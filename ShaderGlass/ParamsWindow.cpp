@@ -21,6 +21,8 @@ constexpr int WINDOW_WIDTH  = 600;
 constexpr int WINDOW_HEIGHT = 600;
 constexpr int TRACK_WIDTH   = 200;
 constexpr int TRACK_HEIGHT  = 30;
+constexpr int COST_HEIGHT   = 18;
+constexpr int COSTS_TIMER   = 1;
 
 ParamsWindow::ParamsWindow(CaptureManager& captureManager) :
     m_captureManager(captureManager), m_captureOptions(captureManager.m_options), m_title(), m_windowClass(), m_resetButtonWnd(0), m_closeButtonWnd(0), m_font(0), m_dpiScale(1.0f),
@@ -174,7 +176,7 @@ void ParamsWindow::Resize()
 
     // calculate
     auto actualSize   = rect.bottom - rect.top;
-    auto requiredSize = m_dpiScale * ((m_trackbars.size() + 0) * PARAM_HEIGHT + PARAMS_TOP);
+    auto requiredSize = m_dpiScale * ((m_trackbars.size() + 0) * PARAM_HEIGHT + PARAMS_TOP + (m_costPasses + 1) * COST_HEIGHT);
 
     if(requiredSize < actualSize)
     {
@@ -208,6 +210,10 @@ void ParamsWindow::RebuildControls(bool doResize)
     {
         DestroyWindow(m_hwndTip);
     }
+    if(m_costsWnd)
+    {
+        DestroyWindow(m_costsWnd);
+    }
     m_trackbars.clear();
 
     SCROLLINFO si;
@@ -255,6 +261,23 @@ void ParamsWindow::RebuildControls(bool doResize)
         }
     }
 
+    // GPU time of each pass below the parameters
+    m_costPasses = m_captureManager.PassCosts().size();
+    m_costsWnd   = CreateWindowEx(0,
+                                  L"STATIC",
+                                  L"",
+                                  SS_LEFT | SS_NOPREFIX | WS_CHILD | WS_VISIBLE,
+                                  (LONG)(m_dpiScale * 20),
+                                  (LONG)(m_dpiScale * (m_trackbars.size() * PARAM_HEIGHT + PARAMS_TOP)),
+                                  (LONG)(m_dpiScale * (WINDOW_WIDTH - 40)),
+                                  (LONG)(m_dpiScale * (m_costPasses + 1) * COST_HEIGHT),
+                                  m_mainWindow,
+                                  NULL,
+                                  m_instance,
+                                  NULL);
+    SendMessage(m_costsWnd, WM_SETFONT, (LPARAM)m_font, true);
+    UpdateCosts();
+
     if(m_trackbars.size())
         SetWindowPos(m_resetButtonWnd,
                      m_mainWindow,
@@ -282,6 +305,19 @@ LRESULT CALLBACK ParamsWindow::WndProc(HWND hWnd, UINT message, WPARAM wParam, L
         {
             // showing
             RebuildControls(true);
+            SetTimer(hWnd, COSTS_TIMER, 1000, NULL);
+        }
+        else
+        {
+            KillTimer(hWnd, COSTS_TIMER);
+        }
+        break;
+    }
+    case WM_TIMER: {
+        if(wParam == COSTS_TIMER)
+        {
+            UpdateCosts();
+            return 0;
         }
         break;
     }
@@ -500,6 +536,30 @@ void ParamsWindow::AddTrackbar(UINT iMin, UINT iMax, UINT iStart, UINT iSteps, c
     m_trackbars.emplace_back(pt);
 }
 
+void ParamsWindow::UpdateCosts()
+{
+    auto        costs = m_captureManager.PassCosts();
+    std::string text  = "GPU time per pass in ms (min / avg / p95)";
+    char        line[200];
+    for(const auto& c : costs)
+    {
+        if(c.samples)
+            snprintf(line, 200, "\r\n%d. %s: %.3f / %.3f / %.3f", c.pass, c.name.c_str(), c.min, c.avg, c.p95);
+        else
+            snprintf(line, 200, "\r\n%d. %s: not rendered", c.pass, c.name.c_str());
+        text += line;
+    }
+    SetWindowTextA(m_costsWnd, text.c_str());
+
+    // preset changed since the controls were built
+    if(costs.size() != m_costPasses)
+    {
+        m_costPasses = costs.size();
+        SetWindowPos(m_costsWnd, 0, 0, 0, (LONG)(m_dpiScale * (WINDOW_WIDTH - 40)), (LONG)(m_dpiScale * (m_costPasses + 1) * COST_HEIGHT), SWP_NOMOVE | SWP_NOZORDER);
+        Resize();
+    }
+}
+
 bool ParamsWindow::Create(_In_ HINSTANCE hInstance, _In_ int nCmdShow, _In_ HWND shaderWindow)
 {
     m_shaderWindow = shaderWindow;
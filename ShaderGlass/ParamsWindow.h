@@ -47,6 +47,8 @@ private:
     HWND            m_resetButtonWnd;
     HWND            m_closeButtonWnd;
     HWND            m_hwndTip;
+    HWND            m_costsWnd {nullptr};
+    size_t          m_costPasses {0};
     HWND            m_shaderWindow;
     HFONT           m_font;
     UINT            m_dpi {USER_DEFAULT_SCREEN_DPI};
@@ -59,6 +61,7 @@ private:
     void AddTrackbar(UINT iMin, UINT iMax, UINT iStart, UINT iStep, const char* name, ShaderParam* p);
     void Resize();
     void RebuildControls(bool doResize);
+    void UpdateCosts();
 
     static LRESULT CALLBACK WndProcProxy(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
     ATOM                    MyRegisterClass(HINSTANCE hInstance);
@@ -15,24 +15,24 @@ Preset::Preset(PresetDef& presetDef) : m_presetDef(presetDef), m_shaders {}
         presetDef.Build();
 }
 
-void Preset::Create(winrt::com_ptr<ID3D11Device> d3dDevice)
+void Preset::Create(DeviceCache& deviceCache)
 {
-    m_shaders.reserve(m_presetDef.ShaderDefs.size());
-    for(auto& sd : m_presetDef.ShaderDefs)
+    // created again when only the orientation changes, Shader can't be moved
+    if(m_shaders.empty())
     {
-        m_shaders.emplace_back(sd);
-    }
-    for(auto& td : m_presetDef.TextureDefs)
-    {
-        m_textures.emplace(td.PresetParams["name"], td);
+        m_shaders.reserve(m_presetDef.ShaderDefs.size());
+        for(auto& sd : m_presetDef.ShaderDefs)
+        {
+            m_shaders.emplace_back(sd);
+        }
+        for(auto& td : m_presetDef.TextureDefs)
+        {
+            m_textures.emplace(td.PresetParams["name"], td);
+        }
     }
     for(auto& s : m_shaders)
     {
-        s.Create(d3dDevice);
-    }
-    for(auto& t : m_textures)
-    {
-        t.second.Create(d3dDevice);
+        s.Create(deviceCache);
     }
 }
 
@@ -15,7 +15,8 @@ class Preset
 {
 public:
     Preset(PresetDef& presetDef);
-    void Create(winrt::com_ptr<ID3D11Device> d3dDevice);
+    // textures are created by the caller once it knows which ones are sampled
+    void Create(DeviceCache& deviceCache);
 
     PresetDef&                     m_presetDef;
     std::vector<Shader>            m_shaders;
@@ -8,6 +8,7 @@ GNU General Public License v3.0
 #include "pch.h"
 
 #include "Shader.h"
+#include "PassChain.h"
 
 static HRESULT hr;
 
@@ -43,95 +44,48 @@ const static std::unordered_map<std::string, DXGI_FORMAT> sFormats = {{"R8_UNORM
                                                                       {"R32G32B32A32_SFLOAT", DXGI_FORMAT_R32G32B32A32_FLOAT}};
 
 Shader::Shader(ShaderDef& shaderDef) :
-    m_shaderDef(shaderDef), m_vertexShader {}, m_pixelShader {}, m_alias {}, m_scaleAbsoluteX {}, m_scaleAbsoluteY {}, m_scaleViewportX {}, m_scaleViewportY {}
+    ShaderParams(shaderDef), m_vertexShader {}, m_pixelShader {}, m_alias {}, m_scaleAbsoluteX {}, m_scaleAbsoluteY {}, m_scaleViewportX {}, m_scaleViewportY {}
 {
-    m_pushBuffer = std::make_unique<int[]>(BufferSize(PUSH_BUFFER));
-    m_uboBuffer  = std::make_unique<int[]>(BufferSize(UBO_BUFFER));
-    for(auto& p : shaderDef.Params)
-    {
-        SetParam(p.name, &p.defaultValue);
-    }
-
-    m_filterLinear = IsTrue("filter_linear");
-    if(IsTrue("srgb_framebuffer"))
-        m_format = DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
-    if(IsTrue("float_framebuffer"))
-        m_format = DXGI_FORMAT_R16G16B16A16_FLOAT;
+    // same options the software renderer and memory planning see
+    const auto options = PassChain::Options(shaderDef);
+    m_filterLinear     = options.linear;
     if(shaderDef.Format != NULL && strlen(shaderDef.Format) > 0)
     {
-        auto format = sFormats.find(shaderDef.Format);
+        auto format = sFormats.find(options.format);
         if(format != sFormats.end())
             m_format = format->second;
 #ifdef _DEBUG
         else
-            throw std::runtime_error("Unknown format " + std::string(shaderDef.Format));
+            throw std::runtime_error("Unknown format " + options.format);
 #endif
     }
-
-    std::string value;
-
-    if(Get("scale_x", value))
-        m_scaleX = stof(value);
-    if(Get("scale_y", value))
-        m_scaleY = stof(value);
-    if(Get("scale", value))
-    {
-        m_scaleX = stof(value);
-        m_scaleY = m_scaleX;
-    }
-
-    if(Get("scale_type_x", value))
-    {
-        if(value == "viewport")
-            m_scaleViewportX = true;
-        else if(value == "absolute")
-            m_scaleAbsoluteX = true;
-    }
-    if(Get("scale_type_y", value))
-    {
-        if(value == "viewport")
-            m_scaleViewportY = true;
-        else if(value == "absolute")
-            m_scaleAbsoluteY = true;
-    }
-    if(Get("scale_type", value))
+    else if(options.format == "R16G16B16A16_SFLOAT")
     {
-        if(value == "viewport")
-        {
-            m_scaleViewportX = true;
-            m_scaleViewportY = true;
-        }
-        else if(value == "absolute")
-        {
-            m_scaleAbsoluteX = true;
-            m_scaleAbsoluteY = true;
-        }
-    }
-    if(Get("alias", value))
-    {
-        m_alias = value;
-    }
-    if(Get("framecount_mod", value))
-    {
-        m_frameCountMod = static_cast<int>(atof(value.c_str()));
+        m_format = DXGI_FORMAT_R16G16B16A16_FLOAT;
     }
-    if(Get("wrap_mode", value))
+    else if(options.format == "R8G8B8A8_SRGB")
     {
-        if(value == "clamp_to_edge")
-            m_clamp = true;
+        m_format = DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
     }
+    m_scaleX         = options.scaleX;
+    m_scaleY         = options.scaleY;
+    m_scaleViewportX = options.viewportX;
+    m_scaleViewportY = options.viewportY;
+    m_scaleAbsoluteX = options.absoluteX;
+    m_scaleAbsoluteY = options.absoluteY;
+    m_alias          = options.alias;
+    m_frameCountMod  = options.frameCountMod;
+    m_clamp          = options.clamp;
 }
 
-void Shader::Create(winrt::com_ptr<ID3D11Device> d3dDevice)
+void Shader::Create(DeviceCache& deviceCache)
 {
     if(m_shaderDef.VertexLength == 0)
         Compile();
 
-    hr = d3dDevice->CreateVertexShader(m_shaderDef.VertexByteCode, m_shaderDef.VertexLength, NULL, m_vertexShader.put());
-    assert(SUCCEEDED(hr));
-
-    hr = d3dDevice->CreatePixelShader(m_shaderDef.FragmentByteCode, m_shaderDef.FragmentLength, NULL, m_pixelShader.put());
-    assert(SUCCEEDED(hr));
+    // passes shared between presets get the same shader objects
+    m_vertexShader = deviceCache.VertexShader(m_shaderDef.VertexByteCode, m_shaderDef.VertexLength);
+    m_pixelShader  = deviceCache.PixelShader(m_shaderDef.FragmentByteCode, m_shaderDef.FragmentLength);
 }
 
 void Shader::Compile()
@@ -185,68 +139,7 @@ void Shader::Compile()
     m_shaderDef.FragmentLength   = m_pixelBlob->GetBufferSize();
 }
 
-void Shader::FillParams(int buffer, void* data)
-{
-    if(buffer == PUSH_BUFFER)
-        memcpy(data, m_pushBuffer.get(), BufferSize(buffer));
-    else
-        memcpy(data, m_uboBuffer.get(), BufferSize(buffer));
-}
-
-std::vector<ShaderParam*> Shader::Params()
-{
-    std::vector<ShaderParam*> params;
-    for(auto& p : m_shaderDef.Params)
-        params.push_back(&p);
-    return params;
-}
-
-void Shader::SetParam(ShaderParam* p, void* v)
-{
-    char* buf = (char*)(p->buffer == PUSH_BUFFER ? m_pushBuffer.get() : m_uboBuffer.get());
-
-    // if it's float remember value (user parameter)
-    if(p->size == 4)
-        p->currentValue = *((float*)v);
-
-    memcpy(buf + p->offset, v, p->size);
-}
-
-void Shader::SetParam(std::string name, void* v)
-{
-    for(auto& p : m_shaderDef.Params)
-    {
-        if(p.name == name)
-        {
-            SetParam(&p, v);
-            // return; // same param can be in both bufs
-        }
-    }
-}
-
-size_t Shader::BufferSize(int buffer)
-{
-    return m_shaderDef.ParamsSize(buffer);
-}
-
-bool Shader::IsTrue(const std::string& presetParam)
-{
-    auto it = m_shaderDef.PresetParams.find(presetParam);
-    return it != m_shaderDef.PresetParams.end() && (it->second == "true" || it->second == "1");
-}
-
-bool Shader::Get(const std::string& presetParam, std::string& value)
-{
-    auto it = m_shaderDef.PresetParams.find(presetParam);
-    if(it != m_shaderDef.PresetParams.end())
-    {
-        value = it->second;
-        return true;
-    }
-    return false;
-}
-
-Shader::Shader(Shader&& shader) : m_shaderDef(shader.m_shaderDef)
+Shader::Shader(Shader&& shader) : ShaderParams(shader.m_shaderDef)
 {
     throw std::runtime_error("This shouldn't happen");
 }
@@ -13,6 +13,55 @@ GNU General Public License v3.0
 static HRESULT     hr;
 static const float background_colour[4] = {0, 0, 0, 1.0f};
 
+// bytes per pixel of formats inputs and passes render to
+static UINT FormatBytes(DXGI_FORMAT format)
+{
+    switch(format)
+    {
+    case DXGI_FORMAT_R8_UNORM:
+    case DXGI_FORMAT_R8_UINT:
+        return 1;
+    case DXGI_FORMAT_R8G8_UNORM:
+    case DXGI_FORMAT_R8G8_UINT:
+    case DXGI_FORMAT_R8G8_SINT:
+    case DXGI_FORMAT_R16_UINT:
+    case DXGI_FORMAT_R16_SINT:
+    case DXGI_FORMAT_R16_FLOAT:
+        return 2;
+    case DXGI_FORMAT_R16G16B16A16_UINT:
+    case DXGI_FORMAT_R16G16B16A16_SINT:
+    case DXGI_FORMAT_R16G16B16A16_FLOAT:
+    case DXGI_FORMAT_R32G32_UINT:
+    case DXGI_FORMAT_R32G32_SINT:
+    case DXGI_FORMAT_R32G32_FLOAT:
+        return 8;
+    case DXGI_FORMAT_R32G32B32A32_UINT:
+    case DXGI_FORMAT_R32G32B32A32_SINT:
+    case DXGI_FORMAT_R32G32B32A32_FLOAT:
+        return 16;
+    default:
+        return 4;
+    }
+}
+
+static uint64_t TextureBytes(const D3D11_TEXTURE2D_DESC& desc)
+{
+    return static_cast<uint64_t>(desc.Width) * desc.Height * desc.ArraySize * FormatBytes(desc.Format);
+}
+
+static float RefreshRate(HMONITOR monitor)
+{
+    MONITORINFOEX monitorInfo;
+    monitorInfo.cbSize = sizeof(MONITORINFOEX);
+    DEVMODE devMode {};
+    devMode.dmSize = sizeof(DEVMODE);
+
+    // 0 and 1 stand for the hardware default
+    if(GetMonitorInfo(monitor, &monitorInfo) && EnumDisplaySettings(monitorInfo.szDevice, ENUM_CURRENT_SETTINGS, &devMode) && devMode.dmDisplayFrequency > 1)
+        return static_cast<float>(devMode.dmDisplayFrequency);
+    return 60.0f;
+}
+
 ShaderGlass::ShaderGlass() :
     m_lastSize {}, m_lastPos {}, m_lastCaptureWindowPos {}, m_lastCaptureWindowSize {}, m_passthroughDef(), m_shaderPreset(new Preset(m_passthroughDef)),
     m_preprocessShader(m_preprocessShaderDef), m_preprocessPreset(m_preprocessPresetDef), m_preprocessPass(m_preprocessShader, m_preprocessPreset, true)
@@ -22,8 +71,8 @@ ShaderGlass::~ShaderGlass()
 {
     std::unique_lock lock(m_mutex);
 
-    DestroyShaders();
-    DestroyPasses();
+    DestroyShaders(0);
+    DestroyPasses(0);
     DestroyTargets();
 
     m_context->Flush();
@@ -36,7 +85,8 @@ void ShaderGlass::Initialize(HWND                                outputWindow,
                              bool                                image,
                              bool                                flipMode,
                              bool                                allowTearing,
-                             winrt::com_ptr<ID3D11Device>        device,
+                             DeviceCache&                        deviceCache,
+                             MetricsRegistry&                    metrics,
                              winrt::com_ptr<ID3D11DeviceContext> context)
 {
     m_outputWindow  = outputWindow;
@@ -45,28 +95,12 @@ void ShaderGlass::Initialize(HWND                                outputWindow,
     m_image         = image;
     m_flipMode      = flipMode;
     m_allowTearing  = allowTearing;
-    m_device        = device;
+    m_deviceCache   = &deviceCache;
+    m_device        = deviceCache.Device();
     m_context       = context;
+    m_metrics       = std::make_unique<RenderMetrics>(metrics);
 
-    if(captureMonitor && !clone)
-    {
-        MONITORINFO monitorInfo;
-        monitorInfo.cbSize = sizeof(MONITORINFO);
-        GetMonitorInfo(captureMonitor, &monitorInfo);
-        m_monitorOffset.x = monitorInfo.rcMonitor.left;
-        m_monitorOffset.y = monitorInfo.rcMonitor.top;
-    }
-    else if(!captureWindow && !captureMonitor && !clone)
-    {
-        // All Desktops glass
-        m_monitorOffset.x = GetSystemMetrics(SM_XVIRTUALSCREEN);
-        m_monitorOffset.y = GetSystemMetrics(SM_YVIRTUALSCREEN);
-    }
-    else
-    {
-        m_monitorOffset.x = 0;
-        m_monitorOffset.y = 0;
-    }
+    UpdateMonitorOffset(captureMonitor);
 
     // remember initial size
     m_lastPos.x = 0;
@@ -152,33 +186,113 @@ void ShaderGlass::Initialize(HWND                                outputWindow,
 
     m_context->RSSetState(m_rasterizerState.get());
 
-    m_preprocessShader.Create(m_device);
-    m_preprocessPass.Initialize(m_device, m_context);
-    RebuildShaders();
+    m_preprocessShader.Create(*m_deviceCache);
+    m_preprocessPass.Initialize(*m_deviceCache, m_context);
+    RebuildShaders(nullptr);
 
     m_running = true;
 }
 
-void ShaderGlass::RebuildShaders()
+void ShaderGlass::UpdateMonitorOffset(HMONITOR captureMonitor)
 {
-    m_shaderPreset->Create(m_device);
+    if(captureMonitor && !m_clone)
+    {
+        MONITORINFO monitorInfo;
+        monitorInfo.cbSize = sizeof(MONITORINFO);
+        GetMonitorInfo(captureMonitor, &monitorInfo);
+        m_monitorOffset.x = monitorInfo.rcMonitor.left;
+        m_monitorOffset.y = monitorInfo.rcMonitor.top;
+    }
+    else if(!m_captureWindow && !captureMonitor && !m_clone)
+    {
+        // All Desktops glass
+        m_monitorOffset.x = GetSystemMetrics(SM_XVIRTUALSCREEN);
+        m_monitorOffset.y = GetSystemMetrics(SM_YVIRTUALSCREEN);
+    }
+    else
+    {
+        m_monitorOffset.x = 0;
+        m_monitorOffset.y = 0;
+    }
+}
+
+void ShaderGlass::RebuildShaders(const Preset* previousPreset)
+{
+    Tracer::Span span("render", "RebuildShaders");
+    auto&        memory = m_deviceCache->Memory();
+    memory.SetPreset(m_shaderPreset->m_presetDef.Name);
+    m_shaderPreset->Create(*m_deviceCache);
     m_shaderPasses.reserve(m_shaderPreset->m_shaders.size() + (m_vertical ? 1 : 0));
-    for(auto& shader : m_shaderPreset->m_shaders)
+    const auto keptPasses = m_shaderPasses.size();
+    for(size_t p = 0; p < m_shaderPreset->m_shaders.size(); p++)
     {
-        m_shaderPasses.emplace_back(shader, *m_shaderPreset, m_device, m_context);
+        auto& shader = m_shaderPreset->m_shaders[p];
+        if(p < keptPasses)
+        {
+            // pass kept from the previous preset, its params start from where they were so ResetParams sees what changed
+            shader.CopyParams(*m_shaderPasses[p].m_shader);
+            m_shaderPasses[p].Rebind(shader, *m_shaderPreset);
+            continue;
+        }
+        m_shaderPasses.emplace_back(shader, *m_shaderPreset, *m_deviceCache, m_context);
     }
     if(m_vertical)
     {
-        m_shaderPasses.emplace_back(m_preprocessShader, m_preprocessPreset, m_device, m_context);
+        m_shaderPasses.emplace_back(m_preprocessShader, m_preprocessPreset, *m_deviceCache, m_context);
+    }
+    for(int p = 0; p < m_shaderPasses.size(); p++)
+    {
+        // constant and push buffers as ShaderPass rounds them
+        auto& shader = *m_shaderPasses[p].m_shader;
+        m_bufferMemory.push_back(memory.Allocate(MemoryKind::Buffer, p, ((shader.BufferSize(0) + 0xf) & ~0xf) + ((shader.BufferSize(-1) + 0xf) & ~0xf)));
     }
     float vertical = m_vertical ? 1.0f : 0.0f;
     m_preprocessShader.SetParam("SGVertical", &vertical);
 
+    std::vector<const ShaderDef*> shaderDefs;
+    for(const auto& shaderPass : m_shaderPasses)
+    {
+        shaderDefs.push_back(&shaderPass.m_shader->m_shaderDef);
+    }
+    m_passGraph = PassGraph(shaderDefs);
+    m_metrics->deadPasses.Set(m_passGraph.DeadPasses().size());
+    m_metrics->sharedPasses.Set(previousPreset ? m_presetDiff.SharedPasses() : 0);
+
+    // textures only sampled by dead passes are not decoded
+    int unusedTextures = 0;
     m_presetTextures.clear();
+    m_textureMemory.clear();
     for(auto& texture : m_shaderPreset->m_textures)
     {
+        if(!m_passGraph.Samples(texture.second.m_name))
+        {
+            unusedTextures++;
+            continue;
+        }
+        if(previousPreset && m_presetDiff.SharesTexture(texture.second.m_name))
+        {
+            // same image in the previous preset, no need to decode it again
+            auto previous = previousPreset->m_textures.find(texture.first);
+            if(previous != previousPreset->m_textures.end() && previous->second.m_textureView)
+            {
+                texture.second.m_textureResource = previous->second.m_textureResource;
+                texture.second.m_textureView     = previous->second.m_textureView;
+            }
+        }
+        if(!texture.second.m_textureView)
+        {
+            texture.second.Create(m_device);
+        }
+        if(auto resource = texture.second.m_textureResource.try_as<ID3D11Texture2D>())
+        {
+            m_textureMemory.push_back(TrackTexture(MemoryKind::Texture, -1, resource.get()));
+        }
         m_presetTextures.insert(make_pair(texture.second.m_name, texture.second.m_textureView));
     }
+    m_metrics->unusedTextures.Set(unusedTextures);
+
+    // previous preset is gone by now, keep only what might be switched back to
+    m_deviceCache->Trim();
 
     ResetParams();
 }
@@ -206,6 +320,8 @@ void ShaderGlass::SetOutputFlip(bool h, bool v)
 
 void ShaderGlass::SetShaderPreset(PresetDef* p, const std::vector<std::tuple<int, std::string, double>>& params)
 {
+    // taken by the render thread under the same lock
+    std::unique_lock lock(m_mutex);
     m_newShaderPreset = std::make_unique<Preset>(*p);
     m_newParams       = params;
 }
@@ -251,29 +367,127 @@ void ShaderGlass::SetVertical(bool vertical)
     }
 }
 
+void ShaderGlass::SetAdaptiveQuality(bool adaptiveQuality)
+{
+    if(m_adaptiveQuality != adaptiveQuality)
+    {
+        m_adaptiveQuality        = adaptiveQuality;
+        m_adaptiveQualityUpdated = true;
+    }
+}
+
+void ShaderGlass::SetCaptureSource(HWND captureWindow, HMONITOR captureMonitor, bool clone, bool image)
+{
+    // shaders and passes stay, only state derived from the input is reset
+    std::unique_lock lock(m_mutex);
+    m_captureWindow         = captureWindow;
+    m_clone                 = clone;
+    m_image                 = image;
+    m_lastCaptureWindowPos  = {};
+    m_lastCaptureWindowSize = {};
+    UpdateMonitorOffset(captureMonitor);
+
+    // new input has its own size and position
+    m_inputRescaled     = true;
+    m_lockedAreaUpdated = true;
+}
+
+void ShaderGlass::SetFixedClock(ULONGLONG ticks)
+{
+    // logical frame numbers restart when switching between clocks
+    if((ticks != 0) != (m_fixedTicks != 0))
+        m_startTicks = ticks ? ticks : GetTickCount64();
+    m_fixedTicks = ticks;
+}
+
+ULONGLONG ShaderGlass::Ticks() const
+{
+    return m_fixedTicks ? m_fixedTicks : GetTickCount64();
+}
+
+void ShaderGlass::SetMemoryBudget(uint64_t bytes)
+{
+    if(m_deviceCache->Memory().Budget() != bytes)
+    {
+        m_deviceCache->Memory().SetBudget(bytes);
+        m_memoryBudgetUpdated = true;
+    }
+}
+
+bool ShaderGlass::FitsMemoryBudget(const PresetDef& presetDef)
+{
+    // anything fits before the first frame is sized
+    std::unique_lock lock(m_mutex);
+    if(!m_chainSize[0] || !m_chainSize[2])
+        return true;
+    return MemoryBudget::Plan(presetDef, m_chainSize[0], m_chainSize[1], m_chainSize[2], m_chainSize[3], 1.0f, m_deviceCache->Memory().Budget()).fits;
+}
+
+MemoryLedger::Allocation ShaderGlass::TrackTexture(MemoryKind kind, int pass, ID3D11Texture2D* texture)
+{
+    D3D11_TEXTURE2D_DESC desc = {};
+    texture->GetDesc(&desc);
+    return m_deviceCache->Memory().Allocate(kind, pass, TextureBytes(desc));
+}
+
 void ShaderGlass::DestroyTargets()
 {
-    if(m_preprocessedRenderTarget != nullptr)
+    m_preprocessedRenderTarget = nullptr;
+    m_originalView             = nullptr;
+    m_preprocessedTexture      = nullptr;
+    m_inputView                = nullptr;
+    m_originalDesc             = {};
+    m_originalMemory.Release();
+}
+
+void ShaderGlass::CreatePreprocessedTarget()
+{
+    if(m_preprocessedTexture != nullptr)
+        return;
+
+    auto hr = m_device->CreateTexture2D(&m_originalDesc, nullptr, m_preprocessedTexture.put());
+    assert(SUCCEEDED(hr));
+    m_originalMemory = TrackTexture(MemoryKind::Original, -1, m_preprocessedTexture.get());
+
+    hr = m_device->CreateShaderResourceView(m_preprocessedTexture.get(), nullptr, m_originalView.put());
+    assert(SUCCEEDED(hr));
+    hr = m_device->CreateRenderTargetView(m_preprocessedTexture.get(), NULL, m_preprocessedRenderTarget.put());
+    assert(SUCCEEDED(hr));
+
+    // first slot of the history ring
+    if(!m_historyResources.empty())
     {
-        m_preprocessedRenderTarget = nullptr;
-        m_originalView             = nullptr;
-        m_preprocessedTexture      = nullptr;
+        m_historyResources[0] = m_originalView;
+        m_historyTargets[0]   = m_preprocessedRenderTarget;
     }
 }
 
 void ShaderGlass::UpdateParams()
 {
+    // re-render only from the first pass reading a changed param
+    std::vector<std::string> changedParams;
     for(auto& s : m_shaderPreset->m_shaders)
         for(auto& p : s.Params())
         {
             if(p->size == 4 && p->name != "FrameCount")
-                s.SetParam(p, &p->currentValue);
+            {
+                if(s.SetParam(p, &p->currentValue))
+                    changedParams.push_back(p->name);
+            }
         }
+    if(!changedParams.empty())
+    {
+        InvalidatePasses(m_passGraph.FirstAffectedPass(changedParams));
+    }
 }
 
 void ShaderGlass::ResetParams()
 {
-    for(auto& s : m_shaderPreset->m_shaders)
+    // re-render only from the first pass whose values changed, passes kept from the previous preset may have none
+    int firstChanged = INT_MAX;
+    for(int i = 0; i < m_shaderPreset->m_shaders.size(); i++)
+    {
+        auto& s = m_shaderPreset->m_shaders[i];
         for(auto& p : s.Params())
         {
             if(p->size == 4 && p->name != "FrameCount")
@@ -284,17 +498,26 @@ void ShaderGlass::ResetParams()
                 {
                     if(o.name == p->name)
                     {
-                        s.SetParam(p, &o.value);
+                        if(s.SetParam(p, &o.value))
+                            firstChanged = min(firstChanged, i);
                         hasOverride = true;
                         break;
                     }
                 }
-                if(!hasOverride)
+                if(!hasOverride && s.SetParam(p, &p->defaultValue))
                 {
-                    s.SetParam(p, &p->defaultValue);
+                    firstChanged = min(firstChanged, i);
                 }
             }
         }
+    }
+    InvalidatePasses(firstChanged);
+}
+
+void ShaderGlass::InvalidatePasses(int firstPass)
+{
+    auto invalidPass = m_invalidPass.load();
+    while(firstPass < invalidPass && !m_invalidPass.compare_exchange_weak(invalidPass, firstPass)) { }
 }
 
 std::vector<std::tuple<int, ShaderParam*>> ShaderGlass::Params()
@@ -344,12 +567,15 @@ bool ShaderGlass::TryResizeSwapChain(const RECT& clientRect, bool force)
     return false;
 }
 
-void ShaderGlass::DestroyShaders()
+void ShaderGlass::DestroyShaders(int keepPasses)
 {
-    m_shaderPasses.clear();
+    // ShaderPass can't be assigned, so no erase
+    while(static_cast<int>(m_shaderPasses.size()) > keepPasses)
+        m_shaderPasses.pop_back();
+    m_bufferMemory.clear();
 }
 
-void ShaderGlass::DestroyPasses()
+void ShaderGlass::DestroyPasses(int keepPasses)
 {
     for(auto& rs : m_passResources)
     {
@@ -358,15 +584,208 @@ void ShaderGlass::DestroyPasses()
             rs.second = nullptr;
         }
     }
-    m_passTargets.clear();
+
+    // outputs of shared passes are reused if their size and format still match, they now count towards the new preset
+    std::map<int, PassTargets> keptOutputs;
+    for(auto& output : m_passOutputs)
+    {
+        if(output.first < keepPasses)
+        {
+            output.second.memory.Adopt();
+            keptOutputs.insert(std::move(output));
+        }
+    }
+    m_passOutputs.swap(keptOutputs);
     m_passTextures.clear();
+    m_historyMemory.clear();
     m_passResources.clear();
-    m_requiresFeedback = false;
-    m_requiresHistory  = 0;
+    m_historyTargets.clear();
+    m_historyResources.clear();
+    m_historyViews.clear();
+    m_feedbackTargets.clear();
+    m_offscreenOutput = false;
+    m_requiresHistory = 0;
+}
+
+void ShaderGlass::CreateFeedbackTargets(int p, const D3D11_TEXTURE2D_DESC& desc)
+{
+    const auto& pass = m_shaderPasses[p];
+
+    FeedbackTargets feedback;
+    feedback.pass = p;
+    for(int t = 0; t < 2; t++)
+    {
+        hr = m_device->CreateTexture2D(&desc, nullptr, feedback.textures[t].put());
+        assert(SUCCEEDED(hr));
+        hr = m_device->CreateRenderTargetView(feedback.textures[t].get(), nullptr, feedback.targets[t].put());
+        assert(SUCCEEDED(hr));
+        hr = m_device->CreateShaderResourceView(feedback.textures[t].get(), nullptr, feedback.resources[t].put());
+        assert(SUCCEEDED(hr));
+    }
+    feedback.memory = m_deviceCache->Memory().Allocate(MemoryKind::PassFeedback, p, 2 * TextureBytes(desc));
+
+    // map entries are rebound when the targets swap
+    if(p < m_shaderPasses.size() - 1)
+    {
+        feedback.outputBindings.push_back(&m_passResources[std::string("PassOutput") + std::to_string(p)]);
+        if(!pass.m_shader->m_alias.empty())
+        {
+            feedback.outputBindings.push_back(&m_passResources[pass.m_shader->m_alias]);
+        }
+    }
+    feedback.feedbackBindings.push_back(&m_passResources[std::string("PassFeedback") + std::to_string(p)]);
+    if(!pass.m_shader->m_alias.empty())
+    {
+        feedback.feedbackBindings.push_back(&m_passResources[pass.m_shader->m_alias + "Feedback"]);
+    }
+    m_feedbackTargets.push_back(std::move(feedback));
+}
+
+void ShaderGlass::SwapFeedbackTargets(int firstPass)
+{
+    for(auto& feedback : m_feedbackTargets)
+    {
+        // a pass that renders writes to the other target, otherwise its output is also its previous one
+        auto rendered = feedback.pass >= firstPass;
+        if(rendered)
+        {
+            feedback.current = 1 - feedback.current;
+        }
+        const auto& output   = feedback.resources[feedback.current];
+        const auto& previous = rendered ? feedback.resources[1 - feedback.current] : output;
+        for(auto binding : feedback.outputBindings)
+        {
+            *binding = output;
+        }
+        for(auto binding : feedback.feedbackBindings)
+        {
+            *binding = previous;
+        }
+
+        m_shaderPasses[feedback.pass].m_targetView = feedback.targets[feedback.current].get();
+        if(feedback.pass + 1 < m_shaderPasses.size())
+        {
+            m_shaderPasses[feedback.pass + 1].m_sourceView = output.get();
+        }
+    }
+}
+
+int ShaderGlass::BeginFrameTimer()
+{
+    if(m_frameTimers.empty())
+    {
+        m_frameTimers.resize(m_timestampQueue.Slots());
+        for(auto& timer : m_frameTimers)
+        {
+            D3D11_QUERY_DESC queryDesc {D3D11_QUERY_TIMESTAMP_DISJOINT, 0};
+            hr = m_device->CreateQuery(&queryDesc, timer.disjoint.put());
+            assert(SUCCEEDED(hr));
+            queryDesc.Query = D3D11_QUERY_TIMESTAMP;
+            hr              = m_device->CreateQuery(&queryDesc, timer.begin.put());
+            assert(SUCCEEDED(hr));
+            hr = m_device->CreateQuery(&queryDesc, timer.end.put());
+            assert(SUCCEEDED(hr));
+        }
+    }
+
+    // all slots still waiting for the GPU, this frame goes untimed rather than overwrite one
+    auto slot = m_timestampQueue.Begin();
+    if(slot < 0)
+        return slot;
+
+    auto& timer = m_frameTimers[slot];
+    timer.passes.clear();
+    m_context->Begin(timer.disjoint.get());
+    m_context->End(timer.begin.get());
+    return slot;
+}
+
+void ShaderGlass::TimePass(int timer, int pass, bool end)
+{
+    if(timer < 0)
+        return;
+
+    auto& frameTimer = m_frameTimers[timer];
+    auto  query      = pass * 2 + (end ? 1 : 0);
+    if(query >= frameTimer.passQueries.size())
+        frameTimer.passQueries.resize(query + 1);
+    if(!frameTimer.passQueries[query])
+    {
+        D3D11_QUERY_DESC queryDesc {D3D11_QUERY_TIMESTAMP, 0};
+        hr = m_device->CreateQuery(&queryDesc, frameTimer.passQueries[query].put());
+        assert(SUCCEEDED(hr));
+    }
+
+    m_context->End(frameTimer.passQueries[query].get());
+    if(end)
+        frameTimer.passes.push_back(pass);
+}
+
+bool ShaderGlass::EndFrameTimer(int timer, bool complete, float& frameTime)
+{
+    if(timer >= 0)
+    {
+        auto& frameTimer = m_frameTimers[timer];
+        m_context->End(frameTimer.end.get());
+        m_context->End(frameTimer.disjoint.get());
+        frameTimer.complete = complete;
+        m_timestampQueue.End(timer);
+    }
+
+    // read the oldest timer if the GPU is done with it, otherwise try again next frame
+    auto oldestSlot = m_timestampQueue.Oldest();
+    if(oldestSlot < 0)
+        return false;
+
+    auto&                               oldest = m_frameTimers[oldestSlot];
+    D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint;
+    UINT64                              begin, end;
+    if(m_context->GetData(oldest.disjoint.get(), &disjoint, sizeof(disjoint), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK ||
+       m_context->GetData(oldest.begin.get(), &begin, sizeof(begin), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK ||
+       m_context->GetData(oldest.end.get(), &end, sizeof(end), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+        return false;
+
+    std::vector<PassTimestamps> timestamps;
+    for(auto pass : oldest.passes)
+    {
+        PassTimestamps t {pass, 0, 0};
+        if(m_context->GetData(oldest.passQueries[pass * 2].get(), &t.begin, sizeof(t.begin), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK ||
+           m_context->GetData(oldest.passQueries[pass * 2 + 1].get(), &t.end, sizeof(t.end), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+            return false;
+        timestamps.push_back(t);
+    }
+
+    // clock changed frequency meanwhile, timestamps can't be compared
+    m_timestampQueue.Retire(!disjoint.Disjoint);
+    if(disjoint.Disjoint)
+        return false;
+
+    m_passTimings.AddFrame(timestamps, disjoint.Frequency);
+    if(!oldest.complete)
+        return false;
+
+    frameTime = (end - begin) * 1000.0f / disjoint.Frequency;
+    return true;
+}
+
+void ShaderGlass::ResetPassTimings()
+{
+    // results still on the way were measured at the old sizes
+    m_timestampQueue.Reset();
+
+    std::vector<std::string> names;
+    for(const auto& shaderPass : m_shaderPasses)
+    {
+        const auto& shader = *shaderPass.m_shader;
+        names.push_back(shader.m_alias.empty() ? shader.m_shaderDef.Name : shader.m_alias);
+    }
+    m_passTimings.Reset(names);
 }
 
 void ShaderGlass::PresentFrame()
 {
+    Tracer::Span span("render", "PresentFrame");
+
     DXGI_PRESENT_PARAMETERS presentParameters {};
     UINT                    presentFlags = 0;
     if(m_flipMode)
@@ -381,32 +800,81 @@ void ShaderGlass::PresentFrame()
     PostMessage(m_outputWindow, WM_PAINT, 0, 0); // necessary for click-through
 }
 
-void ShaderGlass::Process(winrt::com_ptr<ID3D11Texture2D> texture, ULONGLONG frameTicks)
+bool ShaderGlass::Process(winrt::com_ptr<ID3D11Texture2D> texture, ULONGLONG frameTicks, uint64_t captureTime)
 {
-    auto nowTicks            = GetTickCount64();
+    auto processStart        = MetricsRegistry::Now();
+    auto nowTicks            = Ticks();
     auto timeSinceLastRender = nowTicks - m_prevRenderTicks;
     auto logicalFrameNo      = (int)roundf((nowTicks - m_startTicks) / 16.6666666f); // fix shaders at 60 fps
+    auto newInput            = frameTicks != m_prevFrameTicks;
+
+    // frame time budget follows the refresh rate of the monitor showing the output
+    auto outputMonitor = MonitorFromWindow(m_outputWindow, MONITOR_DEFAULTTONEAREST);
+    if(outputMonitor != m_outputMonitor)
+    {
+        m_outputMonitor = outputMonitor;
+        m_qualityController.SetRefreshRate(RefreshRate(outputMonitor));
+    }
+
+    if(m_adaptiveQualityUpdated)
+    {
+        // start from full quality
+        m_qualityController.Reset();
+        m_timestampQueue.Reset();
+        m_metrics->qualityLevel.Set(0);
+        m_adaptiveQualityUpdated = false;
+        m_inputRescaled          = true;
+    }
+
+    if(m_memoryBudgetUpdated)
+    {
+        // passes are resized to the new plan
+        m_memoryBudgetUpdated = false;
+        m_inputRescaled       = true;
+    }
+
+    // adaptive quality may lower settings further
+    const auto& quality   = m_adaptiveQuality ? m_qualityController.Current() : QualityController::Levels()[0];
+    auto        frameSkip = max((int)m_frameSkip, quality.frameSkip);
 
     // same input
     if(frameTicks == m_prevFrameTicks)
     {
         if(logicalFrameNo == m_prevLogicalFrameNo)
-            return;
+            return false;
 
         auto timeSinceLastInput = nowTicks - frameTicks;
         if(timeSinceLastInput < 20) // 3.3 ms delay allowance for frame timing
-            return;
+            return false;
     }
 
-    if(m_frameSkip > 0)
+    // already rendered or don't need this frame
+    if(frameSkip > 0 && (logicalFrameNo == m_prevLogicalFrameNo || (logicalFrameNo % (frameSkip + 1) != 0)))
     {
-        if(logicalFrameNo == m_prevLogicalFrameNo) // already rendered
-            return;
+        // an input held back is only lost once a newer one replaces it
+        if(newInput && frameTicks != m_skippedInputTicks)
+        {
+            if(m_skippedInputTicks)
+                m_metrics->skippedInputs.Add();
+            m_skippedInputTicks = frameTicks;
+        }
+        return true;
+    }
 
-        if((logicalFrameNo % (m_frameSkip + 1) != 0)) // don't need this frame
-            return;
+    // before the input counts as taken, so it's offered again on the next call
+    std::unique_lock lock(m_mutex, std::try_to_lock);
+    if(!lock.owns_lock())
+    {
+        if(frameTicks != m_busyInputTicks)
+            m_metrics->droppedFrames.Add();
+        m_busyInputTicks = frameTicks;
+        return false;
     }
 
+    if(m_skippedInputTicks && m_skippedInputTicks != frameTicks)
+        m_metrics->skippedInputs.Add();
+    m_skippedInputTicks = 0;
+
     m_frameCounter++;
     m_prevFrameTicks     = frameTicks;
     m_prevLogicalFrameNo = logicalFrameNo;
@@ -415,15 +883,11 @@ void ShaderGlass::Process(winrt::com_ptr<ID3D11Texture2D> texture, ULONGLONG fra
     {
         // skip frame
         PresentFrame();
-        return;
+        return true;
     }
 
-    std::unique_lock lock(m_mutex, std::try_to_lock);
-    if(!lock.owns_lock())
-    {
-        // still rendering, drop frame
-        return;
-    }
+    // the render thread gets here only when a frame is due, it polls far more often
+    Tracer::Span span("render", "Process");
 
     POINT topLeft;
     topLeft.x = 0;
@@ -505,7 +969,7 @@ void ShaderGlass::Process(winrt::com_ptr<ID3D11Texture2D> texture, ULONGLONG fra
     {
         // skip
         PresentFrame();
-        return;
+        return true;
     }
 
     auto clientWidth  = clientRect.right;
@@ -566,8 +1030,10 @@ void ShaderGlass::Process(winrt::com_ptr<ID3D11Texture2D> texture, ULONGLONG fra
     auto destWidth  = static_cast<long>(clientWidth * m_outputScaleW);
     auto destHeight = static_cast<long>(clientHeight * m_outputScaleH);
 
-    if(destWidth <= (int)m_inputScaleW || destHeight <= (int)m_inputScaleH)
-        return;
+    auto inputScaleW = m_inputScaleW * quality.inputScale;
+    auto inputScaleH = m_inputScaleH * quality.inputScale;
+    if(destWidth <= (int)inputScaleW || destHeight <= (int)inputScaleH)
+        return true;
 
     bool inputRescaled = m_inputRescaled;
     m_inputRescaled    = false;
@@ -576,7 +1042,7 @@ void ShaderGlass::Process(winrt::com_ptr<ID3D11Texture2D> texture, ULONGLONG fra
     // force recreate
     if(inputRescaled || inputResized || m_verticalUpdated)
     {
-        if(m_preprocessedRenderTarget != nullptr)
+        if(m_originalDesc.Width != 0)
         {
             DestroyTargets();
             if(m_displayRenderTarget)
@@ -591,19 +1057,34 @@ void ShaderGlass::Process(winrt::com_ptr<ID3D11Texture2D> texture, ULONGLONG fra
         }
     }
 
-    bool rebuildPasses = false;
+    bool     rebuildPasses = false;
+    uint64_t rebuildStart  = 0;
+    int      sharedPasses  = 0;
+    int      keptPasses    = 0;
 
     if(m_newShaderPreset || m_verticalUpdated)
     {
-        m_startTicks = GetTickCount64(); // reset logical frame no
+        m_startTicks = Ticks(); // reset logical frame no
+        rebuildStart = processStart;
 
-        DestroyShaders();
+        std::unique_ptr<Preset> previousPreset;
+        m_presetDiff = PresetDiff();
         if(m_newShaderPreset)
         {
+            // passes and textures the new preset has in common with the current one are reused
+            m_presetDiff = PresetDiff(m_shaderPreset->m_presetDef, m_newShaderPreset->m_presetDef);
+            previousPreset.swap(m_shaderPreset);
             m_shaderPreset.swap(m_newShaderPreset);
-            m_newShaderPreset.reset();
         }
-        RebuildShaders();
+        sharedPasses = m_verticalUpdated ? 0 : m_presetDiff.SharedPasses();
+        DestroyShaders(sharedPasses);
+        RebuildShaders(previousPreset.get());
+        previousPreset.reset();
+
+        // their outputs stay valid unless what they were rendered from changed too, passes resized or with new
+        // param values are dropped from the kept ones further on
+        auto moved = outputMoved || m_lastPos.x != topLeft.x || m_lastPos.y != topLeft.y || m_lockedAreaUpdated;
+        keptPasses = newInput || inputRescaled || inputResized || outputResized || moved ? 0 : sharedPasses;
         if(m_newParams.size())
         {
             const auto& shaderParams = Params();
@@ -629,44 +1110,30 @@ void ShaderGlass::Process(winrt::com_ptr<ID3D11Texture2D> texture, ULONGLONG fra
     }
 
     // size of preprocessed input, which is 'original' for the shader chain
-    UINT originalWidth  = static_cast<UINT>(destWidth / m_inputScaleW);
-    UINT originalHeight = static_cast<UINT>(destHeight / m_inputScaleH);
+    UINT originalWidth  = static_cast<UINT>(destWidth / inputScaleW);
+    UINT originalHeight = static_cast<UINT>(destHeight / inputScaleH);
 
     if(m_captureWindow || m_image)
     {
         const auto captureW = captureClient.right;
         const auto captureH = captureClient.bottom;
-        originalWidth       = static_cast<UINT>(captureW / m_inputScaleW);
-        originalHeight      = static_cast<UINT>(captureH / m_inputScaleH);
+        originalWidth       = static_cast<UINT>(captureW / inputScaleW);
+        originalHeight      = static_cast<UINT>(captureH / inputScaleH);
     }
 
-    // create preprocessed output texture, scaled down size, inverted etc.
-    if(m_preprocessedTexture == nullptr)
+    // describe preprocessed output texture, scaled down size, inverted etc.; it isn't created while the first pass
+    // samples the captured frame instead
+    if(m_originalDesc.Width == 0)
     {
-        D3D11_TEXTURE2D_DESC desc2 = {};
-        texture->GetDesc(&desc2);
-        desc2.Usage          = D3D11_USAGE_DEFAULT;
-        desc2.BindFlags      = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
-        desc2.CPUAccessFlags = 0;
-        desc2.MiscFlags      = 0;
-        desc2.Width          = m_vertical ? originalHeight : originalWidth;
-        desc2.Height         = m_vertical ? originalWidth : originalHeight;
-
-        hr = m_device->CreateTexture2D(&desc2, nullptr, m_preprocessedTexture.put());
-        assert(SUCCEEDED(hr));
-        outputResized = true;
-        rebuildPasses = true;
-
-        hr = m_device->CreateShaderResourceView(m_preprocessedTexture.get(), nullptr, m_originalView.put());
-        assert(SUCCEEDED(hr));
-    }
-
-    // create texture render target
-    if(m_preprocessedRenderTarget == nullptr)
-    {
-        hr = m_device->CreateRenderTargetView(m_preprocessedTexture.get(), NULL, m_preprocessedRenderTarget.put());
-        assert(SUCCEEDED(hr));
-        rebuildPasses = true;
+        texture->GetDesc(&m_originalDesc);
+        m_originalDesc.Usage          = D3D11_USAGE_DEFAULT;
+        m_originalDesc.BindFlags      = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+        m_originalDesc.CPUAccessFlags = 0;
+        m_originalDesc.MiscFlags      = 0;
+        m_originalDesc.Width          = m_vertical ? originalHeight : originalWidth;
+        m_originalDesc.Height         = m_vertical ? originalWidth : originalHeight;
+        outputResized                 = true;
+        rebuildPasses                 = true;
     }
 
     if(inputRescaled || outputResized || inputResized)
@@ -677,6 +1144,17 @@ void ShaderGlass::Process(winrt::com_ptr<ID3D11Texture2D> texture, ULONGLONG fra
             std::swap(viewportWidth, viewportHeight);
         }
 
+        // over budget the preset is degraded, predicted from its definition before anything is created at the new size
+        m_chainSize[0] = originalWidth;
+        m_chainSize[1] = originalHeight;
+        m_chainSize[2] = viewportWidth;
+        m_chainSize[3] = viewportHeight;
+
+        const auto memoryBudget = m_deviceCache->Memory().Budget();
+        m_memoryPlan            = MemoryBudget::Plan(m_shaderPreset->m_presetDef, originalWidth, originalHeight, viewportWidth, viewportHeight, quality.passScale, memoryBudget);
+        const auto passScale    = quality.passScale * m_memoryPlan.passScale;
+        m_metrics->memoryLevel.Set(m_memoryPlan.level);
+
         m_textureSizes.clear();
         m_textureSizes.insert(std::make_pair("Original", float4 {(float)originalWidth, (float)originalHeight, 1.0f / originalWidth, 1.0f / originalHeight}));
         m_textureSizes.insert(std::make_pair("FinalViewport", float4 {(float)viewportWidth, (float)viewportHeight, 1.0f / viewportWidth, 1.0f / viewportHeight}));
@@ -703,22 +1181,22 @@ void ShaderGlass::Process(winrt::com_ptr<ID3D11Texture2D> texture, ULONGLONG fra
             {
                 UINT outputWidth  = sourceWidth;
                 UINT outputHeight = sourceHeight;
-                if(shaderPass.m_shader.m_scaleViewportX)
-                    outputWidth = static_cast<UINT>(viewportWidth * shaderPass.m_shader.m_scaleX);
-                else if(shaderPass.m_shader.m_scaleAbsoluteX)
-                    outputWidth = static_cast<UINT>(shaderPass.m_shader.m_scaleX);
+                if(shaderPass.m_shader->m_scaleViewportX)
+                    outputWidth = static_cast<UINT>(viewportWidth * shaderPass.m_shader->m_scaleX * passScale);
+                else if(shaderPass.m_shader->m_scaleAbsoluteX)
+                    outputWidth = static_cast<UINT>(shaderPass.m_shader->m_scaleX);
                 else
-                    outputWidth = static_cast<UINT>(sourceWidth * shaderPass.m_shader.m_scaleX);
-                if(shaderPass.m_shader.m_scaleViewportY)
-                    outputHeight = static_cast<UINT>(viewportHeight * shaderPass.m_shader.m_scaleY);
-                else if(shaderPass.m_shader.m_scaleAbsoluteY)
-                    outputHeight = static_cast<UINT>(shaderPass.m_shader.m_scaleY);
+                    outputWidth = static_cast<UINT>(sourceWidth * shaderPass.m_shader->m_scaleX);
+                if(shaderPass.m_shader->m_scaleViewportY)
+                    outputHeight = static_cast<UINT>(viewportHeight * shaderPass.m_shader->m_scaleY * passScale);
+                else if(shaderPass.m_shader->m_scaleAbsoluteY)
+                    outputHeight = static_cast<UINT>(shaderPass.m_shader->m_scaleY);
                 else
-                    outputHeight = static_cast<UINT>(sourceHeight * shaderPass.m_shader.m_scaleY);
+                    outputHeight = static_cast<UINT>(sourceHeight * shaderPass.m_shader->m_scaleY);
                 passSizes.push_back({sourceWidth, sourceHeight, outputWidth, outputHeight});
-                if(!shaderPass.m_shader.m_alias.empty())
+                if(!shaderPass.m_shader->m_alias.empty())
                 {
-                    m_textureSizes.insert(std::make_pair(shaderPass.m_shader.m_alias, float4 {(float)outputWidth, (float)outputHeight, 1.0f / outputWidth, 1.0f / outputHeight}));
+                    m_textureSizes.insert(std::make_pair(shaderPass.m_shader->m_alias, float4 {(float)outputWidth, (float)outputHeight, 1.0f / outputWidth, 1.0f / outputHeight}));
                 }
                 sourceWidth  = outputWidth;
                 sourceHeight = outputHeight;
@@ -729,13 +1207,15 @@ void ShaderGlass::Process(winrt::com_ptr<ID3D11Texture2D> texture, ULONGLONG fra
         for(int p = 0; p < m_shaderPasses.size(); p++)
         {
             auto& shaderPass = m_shaderPasses[p];
-            shaderPass.Resize(passSizes[p][0], passSizes[p][1], passSizes[p][2], passSizes[p][3], m_textureSizes, passSizes);
+            if(shaderPass.Resize(passSizes[p][0], passSizes[p][1], passSizes[p][2], passSizes[p][3], m_textureSizes, passSizes))
+                keptPasses = min(keptPasses, p);
         }
+        ResetPassTimings();
     }
 
     if(rebuildPasses)
     {
-        DestroyPasses();
+        DestroyPasses(sharedPasses);
 
         for(auto& pt : m_presetTextures)
         {
@@ -743,9 +1223,6 @@ void ShaderGlass::Process(winrt::com_ptr<ID3D11Texture2D> texture, ULONGLONG fra
             m_passResources.insert(pt);
         }
 
-        m_passResources.insert(std::make_pair("Original", m_originalView));
-
-        m_preprocessPass.m_targetView = m_preprocessedRenderTarget.get();
         if(m_shaderPasses.size() > 1)
         {
             D3D11_TEXTURE2D_DESC desc2 = {};
@@ -755,63 +1232,58 @@ void ShaderGlass::Process(winrt::com_ptr<ID3D11Texture2D> texture, ULONGLONG fra
             desc2.CPUAccessFlags = 0;
             desc2.MiscFlags      = 0;
 
-            for(const auto& pass : m_shaderPasses)
+            for(int p = 0; p < m_shaderPasses.size(); p++)
             {
-                m_requiresFeedback |= pass.RequiresFeedback();
-                m_requiresHistory = max(m_requiresHistory, pass.RequiresHistory());
+                if(m_passGraph.Nodes()[p].live)
+                    m_requiresHistory = max(m_requiresHistory, m_shaderPasses[p].RequiresHistory());
             }
 
             for(size_t p = 1; p < m_shaderPasses.size(); p++)
             {
                 const auto& pass = m_shaderPasses[p - 1];
+                if(!m_passGraph.Nodes()[p - 1].live)
+                    continue;
 
-                desc2.Format = pass.m_shader.m_format;
+                desc2.Format = pass.m_shader->m_format;
 
                 // use shader output size
                 desc2.Width     = pass.m_destWidth;
                 desc2.Height    = pass.m_destHeight;
                 desc2.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
 
-                winrt::com_ptr<ID3D11Texture2D> passTexture;
-                hr = m_device->CreateTexture2D(&desc2, nullptr, passTexture.put());
-                assert(SUCCEEDED(hr));
-                m_passTextures.push_back(passTexture);
-
-                winrt::com_ptr<ID3D11RenderTargetView> passTarget;
-                hr = m_device->CreateRenderTargetView(passTexture.get(), nullptr, passTarget.put());
-                assert(SUCCEEDED(hr));
-                m_passTargets.push_back(passTarget);
-
-                winrt::com_ptr<ID3D11ShaderResourceView> passResource;
-                hr = m_device->CreateShaderResourceView(passTexture.get(), nullptr, passResource.put());
-                assert(SUCCEEDED(hr));
-                m_passResources.insert(std::make_pair(std::string("PassOutput") + std::to_string(p - 1), passResource));
-                if(!pass.m_shader.m_alias.empty())
+                if(m_passGraph.Nodes()[p - 1].fedBack)
                 {
-                    m_passResources.insert(std::make_pair(pass.m_shader.m_alias, passResource));
+                    // targets are assigned when swapped
+                    CreateFeedbackTargets(static_cast<int>(p - 1), desc2);
+                    keptPasses = min(keptPasses, static_cast<int>(p - 1));
+                    continue;
                 }
 
-                // create feedback textures if needed
-                if(m_requiresFeedback)
+                auto&                output = m_passOutputs[static_cast<int>(p - 1)];
+                D3D11_TEXTURE2D_DESC outputDesc {};
+                if(output.texture)
+                    output.texture->GetDesc(&outputDesc);
+                if(!output.texture || outputDesc.Width != desc2.Width || outputDesc.Height != desc2.Height || outputDesc.Format != desc2.Format)
                 {
-                    desc2.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-
-                    winrt::com_ptr<ID3D11Texture2D> feedbackTexture;
-                    hr = m_device->CreateTexture2D(&desc2, nullptr, feedbackTexture.put());
+                    keptPasses = min(keptPasses, static_cast<int>(p - 1));
+                    output     = {};
+                    hr         = m_device->CreateTexture2D(&desc2, nullptr, output.texture.put());
                     assert(SUCCEEDED(hr));
-                    m_passTextures.push_back(feedbackTexture);
-                    winrt::com_ptr<ID3D11ShaderResourceView> feedbackResource;
-                    hr = m_device->CreateShaderResourceView(feedbackTexture.get(), nullptr, feedbackResource.put());
+                    output.memory = TrackTexture(MemoryKind::PassOutput, static_cast<int>(p - 1), output.texture.get());
+                    hr            = m_device->CreateRenderTargetView(output.texture.get(), nullptr, output.target.put());
                     assert(SUCCEEDED(hr));
-                    m_passResources.insert(std::make_pair(std::string("PassFeedback") + std::to_string(p - 1), feedbackResource));
-                    if(!pass.m_shader.m_alias.empty())
-                    {
-                        m_passResources.insert(std::make_pair(pass.m_shader.m_alias + "Feedback", feedbackResource));
-                    }
+                    hr = m_device->CreateShaderResourceView(output.texture.get(), nullptr, output.resource.put());
+                    assert(SUCCEEDED(hr));
+                }
+
+                m_passResources.insert(std::make_pair(std::string("PassOutput") + std::to_string(p - 1), output.resource));
+                if(!pass.m_shader->m_alias.empty())
+                {
+                    m_passResources.insert(std::make_pair(pass.m_shader->m_alias, output.resource));
                 }
 
-                m_shaderPasses[p - 1].m_targetView = passTarget.get();
-                m_shaderPasses[p].m_sourceView     = passResource.get();
+                m_shaderPasses[p - 1].m_targetView = output.target.get();
+                m_shaderPasses[p].m_sourceView     = output.resource.get();
             }
         }
         else
@@ -819,63 +1291,75 @@ void ShaderGlass::Process(winrt::com_ptr<ID3D11Texture2D> texture, ULONGLONG fra
             m_requiresHistory = m_shaderPasses.begin()->RequiresHistory();
         }
 
-        if(m_requiresHistory)
+        // without history OriginalHistory reads the current input
+        if(!m_memoryPlan.history)
         {
-            D3D11_TEXTURE2D_DESC desc2 = {};
-            texture->GetDesc(&desc2);
-            desc2.Usage          = D3D11_USAGE_DEFAULT;
-            desc2.BindFlags      = D3D11_BIND_SHADER_RESOURCE;
-            desc2.CPUAccessFlags = 0;
-            desc2.MiscFlags      = 0;
-            desc2.Width          = m_vertical ? originalHeight : originalWidth;
-            desc2.Height         = m_vertical ? originalWidth : originalHeight;
+            m_requiresHistory = 0;
+        }
 
+        // ring of Original textures for history, preprocessed texture is the first slot
+        if(m_requiresHistory)
+            CreatePreprocessedTarget();
+        m_historyResources.push_back(m_originalView);
+        m_historyTargets.push_back(m_preprocessedRenderTarget);
+        if(m_requiresHistory)
+        {
             for(int h = 0; h < m_requiresHistory; h++)
             {
                 winrt::com_ptr<ID3D11Texture2D> historyTexture;
-                hr = m_device->CreateTexture2D(&desc2, nullptr, historyTexture.put());
+                hr = m_device->CreateTexture2D(&m_originalDesc, nullptr, historyTexture.put());
                 assert(SUCCEEDED(hr));
                 m_passTextures.push_back(historyTexture);
+                m_historyMemory.push_back(TrackTexture(MemoryKind::History, -1, historyTexture.get()));
+
+                winrt::com_ptr<ID3D11RenderTargetView> historyTarget;
+                hr = m_device->CreateRenderTargetView(historyTexture.get(), nullptr, historyTarget.put());
+                assert(SUCCEEDED(hr));
+                m_historyTargets.push_back(historyTarget);
+
                 winrt::com_ptr<ID3D11ShaderResourceView> historyResource;
                 hr = m_device->CreateShaderResourceView(historyTexture.get(), nullptr, historyResource.put());
                 assert(SUCCEEDED(hr));
-                m_passResources.insert(std::make_pair(std::string("OriginalHistory") + std::to_string(h + 1), historyResource));
+                m_historyResources.push_back(historyResource);
             }
         }
+        m_historyRing.Resize(m_requiresHistory);
+        m_historyViews.resize(m_historyRing.Size());
 
-        m_shaderPasses[m_shaderPasses.size() - 1].m_targetView = m_displayRenderTarget.get();
+        const auto last = static_cast<int>(m_shaderPasses.size() - 1);
+        m_shaderPasses[last].m_targetView = m_displayRenderTarget.get();
+        keptPasses                        = min(keptPasses, last);
 
-        if(m_requiresFeedback)
+        if(m_passGraph.Nodes()[m_shaderPasses.size() - 1].fedBack)
         {
-            // add feedback for last pass
-            int         p        = (int)m_shaderPasses.size() - 1;
-            const auto& lastPass = m_shaderPasses[p];
+            // last pass output is fed back, render it offscreen and copy to display
+            const auto& lastPass = m_shaderPasses[m_shaderPasses.size() - 1];
 
             D3D11_TEXTURE2D_DESC desc2 = {};
-            texture->GetDesc(&desc2);
-            desc2.Usage          = D3D11_USAGE_DEFAULT;
-            desc2.BindFlags      = D3D11_BIND_SHADER_RESOURCE;
-            desc2.CPUAccessFlags = 0;
-            desc2.MiscFlags      = 0;
-            desc2.Width          = lastPass.m_destWidth;
-            desc2.Height         = lastPass.m_destHeight;
-
-            winrt::com_ptr<ID3D11Texture2D> feedbackTexture;
-            hr = m_device->CreateTexture2D(&desc2, nullptr, feedbackTexture.put());
-            assert(SUCCEEDED(hr));
-            m_passTextures.push_back(feedbackTexture);
-            winrt::com_ptr<ID3D11ShaderResourceView> feedbackResource;
-            hr = m_device->CreateShaderResourceView(feedbackTexture.get(), nullptr, feedbackResource.put());
-            assert(SUCCEEDED(hr));
-            m_passResources.insert(std::make_pair(std::string("PassFeedback") + std::to_string(p), feedbackResource));
-            if(!lastPass.m_shader.m_alias.empty())
-            {
-                m_passResources.insert(std::make_pair(lastPass.m_shader.m_alias + "Feedback", feedbackResource));
-            }
+            desc2.Format           = DXGI_FORMAT_B8G8R8A8_UNORM;
+            desc2.Width            = lastPass.m_destWidth;
+            desc2.Height           = lastPass.m_destHeight;
+            desc2.MipLevels        = 1;
+            desc2.ArraySize        = 1;
+            desc2.SampleDesc.Count = 1;
+            desc2.Usage            = D3D11_USAGE_DEFAULT;
+            desc2.BindFlags        = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+
+            CreateFeedbackTargets(static_cast<int>(m_shaderPasses.size() - 1), desc2);
+            m_offscreenOutput = true;
         }
+
+        m_metrics->memoryLive.Set(m_deviceCache->Memory().Live());
+        m_metrics->memoryPeak.Set(m_deviceCache->Memory().Peak());
     }
 
-    if(outputMoved || outputResized || inputResized || (m_lastPos.x != topLeft.x || m_lastPos.y != topLeft.y) || m_lockedAreaUpdated)
+    if(rebuildStart)
+    {
+        m_metrics->presetRebuild.Record(MetricsRegistry::Now() - rebuildStart);
+    }
+
+    auto updateMVP = outputMoved || outputResized || inputResized || (m_lastPos.x != topLeft.x || m_lastPos.y != topLeft.y) || m_lockedAreaUpdated;
+    if(updateMVP)
     {
         // preprocess captured frame to a texture: crop (via scale & translation), reduce resolution, and whatnot (invert y?)
         float sx = 1.0f, sy = 1.0f, tx = 0.0f, ty = 0.0f;
@@ -955,107 +1439,140 @@ void ShaderGlass::Process(winrt::com_ptr<ID3D11Texture2D> texture, ULONGLONG fra
         m_preprocessPass.UpdateMVP(sx, sy, tx, ty);
         m_lastPos.x = topLeft.x;
         m_lastPos.y = topLeft.y;
+
+        // first pass can sample the captured frame itself if that gives the same texels as the preprocessed one,
+        // any transform is fine for passthrough as it only samples at its texcoords, other shaders may offset them
+        auto& firstPass   = m_shaderPasses.front();
+        auto  transform   = TexCoordTransform::FromPreprocess(sx, sy, tx, ty);
+        auto  direct      = !m_vertical && !m_requiresHistory && m_passGraph.OriginalOnlyInFirstPass();
+        auto  aligned     = transform.IsTexelAligned(originalWidth, originalHeight, capturedTextureDesc.Width, capturedTextureDesc.Height, 0.25f);
+        auto  passthrough = firstPass.m_shader->m_shaderDef.Name == "passthrough" && !firstPass.m_shader->m_filterLinear;
+        m_foldPreprocess  = direct && aligned && (passthrough || transform.IsIdentity(0.001f));
+        firstPass.UpdateTexCoords(m_foldPreprocess ? transform : TexCoordTransform());
     }
 
-    if(m_captureWindow && !m_clone)
+    // if input didn't change only passes depending on time or changed params need rendering, after a preset switch
+    // neither do passes kept from the previous one
+    auto invalidated = newInput || rebuildPasses || inputRescaled || inputResized || outputResized || updateMVP;
+    auto invalidPass = m_invalidPass.exchange(INT_MAX);
+    auto firstPass   = min(min(invalidated ? keptPasses : INT_MAX, m_passGraph.FirstVariantPass()), invalidPass);
+    const auto last  = static_cast<int>(m_shaderPasses.size() - 1);
+    if(firstPass > last)
+    {
+        // output would be identical, but swap chain contents don't survive Present so the last pass is drawn again
+        m_skippedCounter++;
+        m_metrics->unchangedFrames.Add();
+        firstPass = last;
+    }
+    else if(firstPass > 0)
     {
-        // clear any blanks around captured window
-        m_context->ClearRenderTargetView(m_preprocessedRenderTarget.get(), background_colour);
+        m_partialCounter++;
+        m_metrics->partialFrames.Add();
     }
 
-    winrt::com_ptr<ID3D11ShaderResourceView> textureView;
-    hr = m_device->CreateShaderResourceView(texture.get(), nullptr, textureView.put());
+    // passes are timed on every frame, but only complete ones count for adaptive quality,
+    // partial ones would make it look cheaper than it is
+    auto timer = BeginFrameTimer();
+
+    m_inputView = nullptr;
+    hr          = m_device->CreateShaderResourceView(texture.get(), nullptr, m_inputView.put());
     assert(SUCCEEDED(hr));
-    m_preprocessPass.Render(textureView.get(), m_passResources, logicalFrameNo, 0, 0);
 
-    int p = 0;
-    for(auto& shaderPass : m_shaderPasses)
+    // history moves on every rendered frame, even if input is the same
+    if(m_foldPreprocess)
     {
-        auto passBoxX = p == m_shaderPasses.size() - 1 ? m_boxX : 0;
-        auto passBoxY = p == m_shaderPasses.size() - 1 ? m_boxY : 0;
-
-        if(p == 0)
+        // first pass reads the captured frame, which is Original
+        m_historyViews[0] = m_inputView.get();
+    }
+    else if(invalidated || m_requiresHistory)
+    {
+        CreatePreprocessedTarget();
+        m_historyRing.Advance();
+        for(int h = 0; h < m_historyViews.size(); h++)
         {
-            shaderPass.Render(m_originalView.get(), m_passResources, logicalFrameNo, passBoxX, passBoxY);
+            m_historyViews[h] = m_historyResources[m_historyRing.Slot(h)].get();
         }
-        else
+
+        auto originalTarget           = m_historyTargets[m_historyRing.Slot(0)].get();
+        m_preprocessPass.m_targetView = originalTarget;
+        if(m_captureWindow && !m_clone)
         {
-            shaderPass.Render(m_passResources, logicalFrameNo, passBoxX, passBoxY);
+            // clear any blanks around captured window
+            m_context->ClearRenderTargetView(originalTarget, background_colour);
         }
-        p++;
+
+        Tracer::Span preprocessSpan("render", "Preprocess");
+        m_preprocessPass.Render(m_inputView.get(), m_passResources, m_historyViews, logicalFrameNo, 0, 0);
     }
 
-    if(m_requiresFeedback)
+    SwapFeedbackTargets(firstPass);
+
+    int p = 0;
+    for(auto& shaderPass : m_shaderPasses)
     {
-        // copy output to feedback
-        for(size_t q = 0; q < m_shaderPasses.size() - 1; q++)
+        if(p < firstPass || !m_passGraph.Nodes()[p].live)
         {
-            auto                           passOutput   = m_passResources.find(std::string("PassOutput") + std::to_string(q));
-            auto                           passFeedback = m_passResources.find(std::string("PassFeedback") + std::to_string(q));
-            winrt::com_ptr<ID3D11Resource> outputResource;
-            winrt::com_ptr<ID3D11Resource> feedbackResource;
-            passOutput->second->GetResource(outputResource.put());
-            passFeedback->second->GetResource(feedbackResource.put());
-            m_context->CopyResource(feedbackResource.get(), outputResource.get());
+            p++;
+            continue;
         }
 
-        // copy display texture as last pass feedback
-        auto displayTexture = m_displayTexture;
-        if(displayTexture)
+        Tracer::Span passSpan("render", "Pass", "pass", p);
+
+        auto passBoxX = p == m_shaderPasses.size() - 1 && !m_offscreenOutput ? m_boxX : 0;
+        auto passBoxY = p == m_shaderPasses.size() - 1 && !m_offscreenOutput ? m_boxY : 0;
+
+        TimePass(timer, p, false);
+        if(p == 0)
         {
-            int                            p                = (int)m_shaderPasses.size() - 1;
-            const auto&                    lastPass         = m_shaderPasses[p];
-            auto                           lastPassFeedback = m_passResources.find(std::string("PassFeedback") + std::to_string(p));
-            winrt::com_ptr<ID3D11Resource> lastPassFeedbackResource;
-            lastPassFeedback->second->GetResource(lastPassFeedbackResource.put());
-            D3D11_TEXTURE2D_DESC desc3 = {};
-            displayTexture->GetDesc(&desc3);
-            if(m_boxX != 0 || m_boxY != 0 || lastPass.m_destWidth != desc3.Width || lastPass.m_destHeight != desc3.Height)
-            {
-                D3D11_BOX srcBox;
-                srcBox.left   = m_boxX;
-                srcBox.right  = srcBox.left + lastPass.m_destWidth;
-                srcBox.top    = m_boxY;
-                srcBox.bottom = srcBox.top + lastPass.m_destHeight;
-                srcBox.back   = 1;
-                srcBox.front  = 0;
-                m_context->CopySubresourceRegion(lastPassFeedbackResource.get(), 0, 0, 0, 0, displayTexture.get(), 0, &srcBox);
-            }
-            else
-            {
-                m_context->CopyResource(lastPassFeedbackResource.get(), displayTexture.get());
-            }
+            shaderPass.Render(m_historyViews[0], m_passResources, m_historyViews, logicalFrameNo, passBoxX, passBoxY);
+        }
+        else
+        {
+            shaderPass.Render(m_passResources, m_historyViews, logicalFrameNo, passBoxX, passBoxY);
         }
+        TimePass(timer, p, true);
+        p++;
     }
 
-    if(m_requiresHistory)
+    auto displayTexture = m_displayTexture;
+    if(m_offscreenOutput && displayTexture)
     {
-        // lookup oldest History for reuse
-        const auto&                    lastHistory     = m_passResources.find(std::string("OriginalHistory" + std::to_string(m_requiresHistory)));
-        auto                           lastHistoryView = lastHistory->second;
-        winrt::com_ptr<ID3D11Resource> lastHistoryResource;
-        lastHistoryView->GetResource(lastHistoryResource.put());
-
-        for(int h = m_requiresHistory; h > 1; h--)
+        // place offscreen output in the display box
+        const auto&          output = m_feedbackTargets.back();
+        D3D11_TEXTURE2D_DESC outputDesc {};
+        D3D11_TEXTURE2D_DESC displayDesc {};
+        output.textures[output.current]->GetDesc(&outputDesc);
+        displayTexture->GetDesc(&displayDesc);
+        if(m_boxX < (int)displayDesc.Width && m_boxY < (int)displayDesc.Height)
         {
-            // remap middle Histories one frame back
-            m_passResources[std::string("OriginalHistory" + std::to_string(h))] = m_passResources[std::string("OriginalHistory" + std::to_string(h - 1))];
+            D3D11_BOX srcBox;
+            srcBox.left   = 0;
+            srcBox.right  = min(outputDesc.Width, displayDesc.Width - m_boxX);
+            srcBox.top    = 0;
+            srcBox.bottom = min(outputDesc.Height, displayDesc.Height - m_boxY);
+            srcBox.back   = 1;
+            srcBox.front  = 0;
+            m_context->CopySubresourceRegion(displayTexture.get(), 0, m_boxX, m_boxY, 0, output.textures[output.current].get(), 0, &srcBox);
         }
+    }
 
-        // copy current Original to History1 for next pass
-        const auto&                    original = m_passResources.find("Original");
-        winrt::com_ptr<ID3D11Resource> originalResource;
-        original->second->GetResource(originalResource.put());
-
-        m_context->CopyResource(lastHistoryResource.get(), originalResource.get());
-        if(m_requiresHistory > 1)
-        {
-            m_passResources["OriginalHistory1"] = lastHistoryView;
-        }
+    float frameTime;
+    if(EndFrameTimer(timer, firstPass == 0, frameTime) && m_adaptiveQuality && m_qualityController.AddFrame(frameTime / (frameSkip + 1)))
+    {
+        m_metrics->qualityLevel.Set(m_qualityController.LastChange().toLevel);
+        m_metrics->qualityChanges.Add();
+        m_inputRescaled = true;
     }
 
+    m_metrics->frameTime.Record(MetricsRegistry::Now() - processStart);
     PresentFrame();
 
+    // only the first presentation of an input counts, later ones just animate
+    if(newInput && captureTime)
+    {
+        m_metrics->latency.Record(MetricsRegistry::Now() - captureTime);
+    }
+    m_metrics->frames.Add();
     m_renderCounter++;
     m_prevRenderTicks = GetTickCount64();
     if(m_prevRenderTicks - m_prevTicks > 1000)
@@ -1066,6 +1583,7 @@ void ShaderGlass::Process(winrt::com_ptr<ID3D11Texture2D> texture, ULONGLONG fra
         m_prevRenderCounter = m_renderCounter;
         m_prevTicks         = m_prevRenderTicks;
     }
+    return true;
 }
 
 winrt::com_ptr<ID3D11Texture2D> ShaderGlass::GrabOutput()
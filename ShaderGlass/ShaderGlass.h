@@ -9,10 +9,81 @@ GNU General Public License v3.0
 
 #include "Preset.h"
 #include "ShaderPass.h"
+#include "PassGraph.h"
+#include "PresetDiff.h"
+#include "HistoryRing.h"
+#include "QualityController.h"
+#include "PassTimings.h"
+#include "Metrics.h"
+#include "Tracer.h"
 #include "Shaders\PreprocessShaderDef.h"
 #include "Shaders\PassthroughShaderDef.h"
 #include "Shaders\PassthroughPresetDef.h"
 #include <mutex>
+#include <atomic>
+
+// pair of targets for a pass whose previous output is sampled, roles swap every rendered frame
+struct FeedbackTargets
+{
+    int                                                    pass {0};
+    int                                                    current {0};
+    winrt::com_ptr<ID3D11Texture2D>                        textures[2];
+    winrt::com_ptr<ID3D11RenderTargetView>                 targets[2];
+    winrt::com_ptr<ID3D11ShaderResourceView>               resources[2];
+    std::vector<winrt::com_ptr<ID3D11ShaderResourceView>*> outputBindings;
+    std::vector<winrt::com_ptr<ID3D11ShaderResourceView>*> feedbackBindings;
+    MemoryLedger::Allocation                               memory; // both textures
+};
+
+// target a pass renders its output to, outputs of passes shared with the next preset are kept
+struct PassTargets
+{
+    winrt::com_ptr<ID3D11Texture2D>          texture;
+    winrt::com_ptr<ID3D11RenderTargetView>   target;
+    winrt::com_ptr<ID3D11ShaderResourceView> resource;
+    MemoryLedger::Allocation                 memory;
+};
+
+// GPU timestamps around a frame and each of its passes, read back a few frames later
+struct FrameTimer
+{
+    winrt::com_ptr<ID3D11Query>              disjoint;
+    winrt::com_ptr<ID3D11Query>              begin;
+    winrt::com_ptr<ID3D11Query>              end;
+    std::vector<winrt::com_ptr<ID3D11Query>> passQueries; // begin and end of each pass
+    std::vector<int>                         passes;      // rendered in the frame
+    bool                                     complete {false};
+};
+
+// metrics the render loop records, looked up once per session
+struct RenderMetrics
+{
+    explicit RenderMetrics(MetricsRegistry& registry) :
+        frames {registry.Counter("render.frames")}, droppedFrames {registry.Counter("render.dropped_frames")}, skippedInputs {registry.Counter("render.skipped_inputs")},
+        unchangedFrames {registry.Counter("render.unchanged_frames")}, partialFrames {registry.Counter("render.partial_frames")},
+        frameTime {registry.Histogram("render.frame_us")}, latency {registry.Histogram("render.latency_us")}, presetRebuild {registry.Histogram("render.preset_rebuild_us")},
+        memoryLive {registry.Gauge("memory.live_bytes")}, memoryPeak {registry.Gauge("memory.peak_bytes")}, memoryLevel {registry.Gauge("memory.budget_level")},
+        deadPasses {registry.Gauge("render.dead_passes")}, unusedTextures {registry.Gauge("render.unused_textures")}, sharedPasses {registry.Gauge("render.shared_passes")},
+        qualityLevel {registry.Gauge("render.quality_level")}, qualityChanges {registry.Counter("render.quality_changes")}
+    { }
+
+    MetricCounter&   frames;
+    MetricCounter&   droppedFrames; // inputs which came while the renderer was busy, each counted once
+    MetricCounter&   skippedInputs; // not needed due to frame skip
+    MetricCounter&   unchangedFrames; // output would be identical
+    MetricCounter&   partialFrames;
+    MetricHistogram& frameTime; // CPU time to submit a rendered frame
+    MetricHistogram& latency; // from capture of a new input to its presentation
+    MetricHistogram& presetRebuild; // from switching preset to having all passes ready
+    MetricGauge&     memoryLive; // device memory of textures, buffers and shaders
+    MetricGauge&     memoryPeak;
+    MetricGauge&     memoryLevel; // degradation needed to stay within budget
+    MetricGauge&     deadPasses; // of the current preset, not rendered as nothing reads them
+    MetricGauge&     unusedTextures; // of the current preset, not decoded
+    MetricGauge&     sharedPasses; // kept from the previous preset
+    MetricGauge&     qualityLevel; // set by adaptive quality
+    MetricCounter&   qualityChanges;
+};
 
 class ShaderGlass
 {
@@ -25,9 +96,11 @@ public:
                      bool                                image,
                      bool                                flipMode,
                      bool                                allowTearing,
-                     winrt::com_ptr<ID3D11Device>        device,
+                     DeviceCache&                        deviceCache,
+                     MetricsRegistry&                    metrics,
                      winrt::com_ptr<ID3D11DeviceContext> context);
-    void  Process(winrt::com_ptr<ID3D11Texture2D> texture, ULONGLONG frameTicks);
+    // false if it didn't take the input, which was the same as before or came while the renderer was busy
+    bool  Process(winrt::com_ptr<ID3D11Texture2D> texture, ULONGLONG frameTicks, uint64_t captureTime);
     void  SetInputScale(float w, float h);
     void  SetOutputScale(float w, float h);
     void  SetOutputFlip(bool h, bool v);
@@ -37,10 +110,35 @@ public:
     void  SetCroppedArea(RECT area);
     void  SetFreeScale(bool freeScale);
     void  SetVertical(bool vertical);
+    void  SetAdaptiveQuality(bool adaptiveQuality);
+    void  SetCaptureSource(HWND captureWindow, HMONITOR captureMonitor, bool clone, bool image);
+    void  SetFixedClock(ULONGLONG ticks);
+    void  SetMemoryBudget(uint64_t bytes);
+    bool  FitsMemoryBudget(const PresetDef& presetDef);
     float FPS()
     {
         return m_fps;
     }
+    int SkippedFrames()
+    {
+        return m_skippedCounter;
+    }
+    int PartialFrames()
+    {
+        return m_partialCounter;
+    }
+    int AdaptiveLevel()
+    {
+        return m_qualityController.Level();
+    }
+    int MemoryLevel()
+    {
+        return m_memoryPlan.level;
+    }
+    std::vector<PassCost> PassCosts()
+    {
+        return m_passTimings.Costs();
+    }
     winrt::com_ptr<ID3D11Texture2D>            GrabOutput();
     std::vector<std::tuple<int, ShaderParam*>> Params();
     void                                       UpdateParams();
@@ -49,12 +147,24 @@ public:
     ~ShaderGlass();
 
 private:
-    bool TryResizeSwapChain(const RECT& clientRect, bool force);
-    void DestroyShaders();
-    void DestroyPasses();
-    void DestroyTargets();
-    void RebuildShaders();
-    void PresentFrame();
+    bool      TryResizeSwapChain(const RECT& clientRect, bool force);
+    void      DestroyShaders(int keepPasses);
+    void      DestroyPasses(int keepPasses);
+    void      DestroyTargets();
+    void      CreatePreprocessedTarget();
+    void      UpdateMonitorOffset(HMONITOR captureMonitor);
+    void      RebuildShaders(const Preset* previousPreset);
+    void      PresentFrame();
+    void      InvalidatePasses(int firstPass);
+    void      CreateFeedbackTargets(int p, const D3D11_TEXTURE2D_DESC& desc);
+    void      SwapFeedbackTargets(int firstPass);
+    int       BeginFrameTimer();
+    void      TimePass(int timer, int pass, bool end);
+    bool      EndFrameTimer(int timer, bool complete, float& frameTime);
+    void      ResetPassTimings();
+    ULONGLONG Ticks() const;
+
+    MemoryLedger::Allocation TrackTexture(MemoryKind kind, int pass, ID3D11Texture2D* texture);
 
     POINT                                    m_lastSize;
     POINT                                    m_lastPos;
@@ -69,17 +179,39 @@ private:
     winrt::com_ptr<ID3D11RenderTargetView>   m_displayRenderTarget {nullptr};
     winrt::com_ptr<ID3D11Texture2D>          m_preprocessedTexture {nullptr};
     winrt::com_ptr<ID3D11RenderTargetView>   m_preprocessedRenderTarget {nullptr};
+    winrt::com_ptr<ID3D11ShaderResourceView> m_inputView {nullptr}; // captured frame, Original while preprocess is folded
+    D3D11_TEXTURE2D_DESC                     m_originalDesc {};      // of the preprocessed texture, created when first needed
 
     std::vector<winrt::com_ptr<ID3D11Texture2D>>                    m_passTextures;
-    std::vector<winrt::com_ptr<ID3D11RenderTargetView>>             m_passTargets;
+    std::map<int, PassTargets>                                      m_passOutputs;
     std::map<std::string, winrt::com_ptr<ID3D11ShaderResourceView>> m_passResources;
     std::map<std::string, winrt::com_ptr<ID3D11ShaderResourceView>> m_presetTextures;
     std::map<std::string, float4>                                   m_textureSizes;
+    std::vector<winrt::com_ptr<ID3D11RenderTargetView>>             m_historyTargets;
+    std::vector<winrt::com_ptr<ID3D11ShaderResourceView>>           m_historyResources;
+    std::vector<ID3D11ShaderResourceView*>                          m_historyViews;
+    HistoryRing                                                     m_historyRing;
+    std::vector<FeedbackTargets>                                    m_feedbackTargets;
+    std::vector<FrameTimer>                                         m_frameTimers;
+    TimestampQueue                                                  m_timestampQueue {8};
+    PassTimings                                                     m_passTimings;
+    QualityController                                               m_qualityController;
     std::vector<ShaderPass>                                         m_shaderPasses;
+    PassGraph                                                       m_passGraph;
+    PresetDiff                                                      m_presetDiff;
+    std::atomic<int>                                                m_invalidPass {0};
+    DeviceCache*                                                    m_deviceCache {nullptr};
+    MemoryLedger::Allocation                                        m_originalMemory;
+    std::vector<MemoryLedger::Allocation>                           m_historyMemory;
+    std::vector<MemoryLedger::Allocation>                           m_textureMemory;
+    std::vector<MemoryLedger::Allocation>                           m_bufferMemory;
+    MemoryPlan                                                      m_memoryPlan;
+    std::unique_ptr<RenderMetrics>                                  m_metrics {nullptr};
 
     POINT      m_monitorOffset {0, 0};
     HWND       m_outputWindow {0};
     HWND       m_captureWindow {0};
+    HMONITOR   m_outputMonitor {0};
     bool       m_clone {false};
     bool       m_image {false};
     bool       m_flipMode {false};
@@ -88,17 +220,23 @@ private:
     int        m_logicalFrameCounter {0};
     ULONGLONG  m_startTicks {0};
     int        m_renderCounter {0};
+    int        m_skippedCounter {0};
+    int        m_partialCounter {0};
     int        m_prevRenderCounter {0};
     ULONGLONG  m_prevRenderTicks {0};
     ULONGLONG  m_prevTicks {0};
     ULONGLONG  m_prevFrameTicks {0};
+    ULONGLONG  m_skippedInputTicks {0};
+    ULONGLONG  m_busyInputTicks {0}; // last input which came while busy, it's offered again
+    ULONGLONG  m_fixedTicks {0}; // replay clock, 0 when following the system one
     int        m_prevLogicalFrameNo {0};
     float      m_fps {0};
-    bool       m_requiresFeedback {false};
+    bool       m_offscreenOutput {false};
     int        m_requiresHistory {0};
     std::mutex m_mutex {};
     int        m_boxX {0};
     int        m_boxY {0};
+    bool       m_foldPreprocess {false};
 
     PassthroughPresetDef                              m_passthroughDef;
     PreprocessShaderDef                               m_preprocessShaderDef;
@@ -127,4 +265,8 @@ private:
     volatile bool  m_croppedAreaUpdated {false};
     volatile bool  m_vertical {false};
     volatile bool  m_verticalUpdated {false};
+    volatile bool  m_adaptiveQuality {false};
+    volatile bool  m_adaptiveQualityUpdated {false};
+    volatile bool  m_memoryBudgetUpdated {false};
+    volatile int   m_chainSize[4] {0, 0, 0, 0}; // original and viewport size of the last resize, for budget checks
 };
@@ -12,11 +12,11 @@ GNU General Public License v3.0
 
 static HRESULT hr;
 
-ShaderPass::ShaderPass(Shader& shader, Preset& preset, bool preprocess) : m_shader {shader}, m_preset {preset}, m_preprocess {preprocess} { }
+ShaderPass::ShaderPass(Shader& shader, Preset& preset, bool preprocess) : m_shader {&shader}, m_preset {&preset}, m_preprocess {preprocess} { }
 
-ShaderPass::ShaderPass(Shader& shader, Preset& preset, winrt::com_ptr<ID3D11Device> device, winrt::com_ptr<ID3D11DeviceContext> context) : ShaderPass(shader, preset, false)
+ShaderPass::ShaderPass(Shader& shader, Preset& preset, DeviceCache& deviceCache, winrt::com_ptr<ID3D11DeviceContext> context) : ShaderPass(shader, preset, false)
 {
-    Initialize(device, context);
+    Initialize(deviceCache, context);
 }
 
 // clang-format off
@@ -35,31 +35,17 @@ static float sVertexBuffer[] =
 };
 // clang-format on
 
-void ShaderPass::Initialize(winrt::com_ptr<ID3D11Device> device, winrt::com_ptr<ID3D11DeviceContext> context)
+void ShaderPass::Initialize(DeviceCache& deviceCache, winrt::com_ptr<ID3D11DeviceContext> context)
 {
-    m_device  = device;
+    m_device  = deviceCache.Device();
     m_context = context;
 
-    D3D11_INPUT_ELEMENT_DESC inputElementDesc[] = {{"TEXCOORD", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
-                                                   {"TEXCOORD", 1, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0}};
+    m_inputLayout  = deviceCache.InputLayout(m_shader->m_shaderDef.VertexByteCode, m_shader->m_shaderDef.VertexLength);
+    m_vertexBuffer = deviceCache.VertexBuffer(sVertexBuffer, sizeof(sVertexBuffer));
 
-    hr = m_device->CreateInputLayout(inputElementDesc, ARRAYSIZE(inputElementDesc), m_shader.m_shaderDef.VertexByteCode, m_shader.m_shaderDef.VertexLength, m_inputLayout.put());
-    assert(SUCCEEDED(hr));
+    for(const auto& texture : m_shader->m_shaderDef.Samplers)
     {
-        D3D11_BUFFER_DESC vertex_buff_descr = {};
-        vertex_buff_descr.ByteWidth         = sizeof(sVertexBuffer);
-        vertex_buff_descr.Usage             = D3D11_USAGE_DEFAULT;
-        vertex_buff_descr.BindFlags         = D3D11_BIND_VERTEX_BUFFER;
-        D3D11_SUBRESOURCE_DATA sr_data      = {0};
-        sr_data.pSysMem                     = sVertexBuffer;
-        hr                                  = m_device->CreateBuffer(&vertex_buff_descr, &sr_data, m_vertexBuffer.put());
-        assert(SUCCEEDED(hr));
-    }
-
-    for(const auto& texture : m_shader.m_shaderDef.Samplers)
-    {
-        winrt::com_ptr<ID3D11SamplerState> samplerState;
-        D3D11_SAMPLER_DESC                 samplerDesc = {};
+        D3D11_SAMPLER_DESC samplerDesc = {};
 
         samplerDesc.Filter         = D3D11_FILTER_MIN_MAG_MIP_POINT;
         samplerDesc.AddressU       = D3D11_TEXTURE_ADDRESS_BORDER;
@@ -74,8 +60,8 @@ void ShaderPass::Initialize(winrt::com_ptr<ID3D11Device> device, winrt::com_ptr<
         // is it a static texture?
         //if(m_preset)
         {
-            auto ti = m_preset.m_textures.find(texture.name);
-            if(ti != m_preset.m_textures.end())
+            auto ti = m_preset->m_textures.find(texture.name);
+            if(ti != m_preset->m_textures.end())
             {
                 if(ti->second.m_linear)
                     samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
@@ -100,9 +86,9 @@ void ShaderPass::Initialize(winrt::com_ptr<ID3D11Device> device, winrt::com_ptr<
             }
             else
             {
-                if(m_shader.m_filterLinear)
+                if(m_shader->m_filterLinear)
                     samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
-                if(m_shader.m_clamp)
+                if(m_shader->m_clamp)
                 {
                     samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
                     samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
@@ -111,14 +97,14 @@ void ShaderPass::Initialize(winrt::com_ptr<ID3D11Device> device, winrt::com_ptr<
             }
         }
 
-        m_device->CreateSamplerState(&samplerDesc, samplerState.put());
-        m_samplers.insert(std::make_pair(texture.binding, samplerState));
+        m_frame.m_samplers.insert(std::make_pair(texture.binding, deviceCache.SamplerState(samplerDesc)));
     }
+    m_frame.Initialize(m_shader->m_shaderDef, m_shader->m_frameCountMod);
 
-    if(m_shader.BufferSize(0) > 0)
+    if(m_shader->BufferSize(0) > 0)
     {
         D3D11_BUFFER_DESC constantBufferDesc = {};
-        constantBufferDesc.ByteWidth         = (m_shader.BufferSize(0) + 0xf) & 0xfffffff0;
+        constantBufferDesc.ByteWidth         = (m_shader->BufferSize(0) + 0xf) & 0xfffffff0;
         constantBufferDesc.Usage             = D3D11_USAGE_DYNAMIC;
         constantBufferDesc.BindFlags         = D3D11_BIND_CONSTANT_BUFFER;
         constantBufferDesc.CPUAccessFlags    = D3D11_CPU_ACCESS_WRITE;
@@ -131,10 +117,10 @@ void ShaderPass::Initialize(winrt::com_ptr<ID3D11Device> device, winrt::com_ptr<
         m_constantBuffer = nullptr;
     }
 
-    if(m_shader.BufferSize(-1) > 0)
+    if(m_shader->BufferSize(-1) > 0)
     {
         D3D11_BUFFER_DESC pushBufferDesc = {};
-        pushBufferDesc.ByteWidth         = (m_shader.BufferSize(-1) + 0xf) & 0xfffffff0;
+        pushBufferDesc.ByteWidth         = (m_shader->BufferSize(-1) + 0xf) & 0xfffffff0;
         pushBufferDesc.Usage             = D3D11_USAGE_DYNAMIC;
         pushBufferDesc.BindFlags         = D3D11_BIND_CONSTANT_BUFFER;
         pushBufferDesc.CPUAccessFlags    = D3D11_CPU_ACCESS_WRITE;
@@ -146,101 +132,102 @@ void ShaderPass::Initialize(winrt::com_ptr<ID3D11Device> device, winrt::com_ptr<
     {
         m_pushBuffer = nullptr;
     }
-
-    // create MVP
-    memset(&m_modelViewProj, 0, 16 * sizeof(float));
-    m_modelViewProj.m[0][0] = 2.0f;
-    m_modelViewProj.m[1][1] = 2.0f;
-    m_modelViewProj.m[3][0] = -1.0f;
-    m_modelViewProj.m[3][1] = -1.0f;
-    m_modelViewProj.m[3][3] = 1.0f;
 }
 
 void ShaderPass::UpdateMVP(float sx, float sy, float tx, float ty)
 {
-    // has effect only on preprocess pass
-    m_modelViewProj.m[0][0] = sx;
-    m_modelViewProj.m[1][1] = sy;
-    m_modelViewProj.m[3][0] = tx;
-    m_modelViewProj.m[3][1] = ty;
+    m_frame.UpdateMVP(sx, sy, tx, ty);
+}
+
+void ShaderPass::UpdateTexCoords(const TexCoordTransform& transform)
+{
+    // used when the preprocess pass is folded into this one, the shared quad can't change
+    if(transform.IsIdentity(0.0f))
+    {
+        m_texCoordBuffer = nullptr;
+        return;
+    }
+
+    float vertices[8 * 6];
+    memcpy(vertices, sVertexBuffer, sizeof(vertices));
+    for(int v = 4; v < 8; v++)
+        transform.Apply(vertices[v * 6 + 4], vertices[v * 6 + 5], vertices[v * 6 + 4], vertices[v * 6 + 5]);
+
+    if(m_texCoordBuffer == nullptr)
+    {
+        D3D11_BUFFER_DESC vertex_buff_descr = {};
+        vertex_buff_descr.ByteWidth         = sizeof(vertices);
+        vertex_buff_descr.Usage             = D3D11_USAGE_DEFAULT;
+        vertex_buff_descr.BindFlags         = D3D11_BIND_VERTEX_BUFFER;
+        D3D11_SUBRESOURCE_DATA sr_data      = {0};
+        sr_data.pSysMem                     = vertices;
+        hr                                  = m_device->CreateBuffer(&vertex_buff_descr, &sr_data, m_texCoordBuffer.put());
+        assert(SUCCEEDED(hr));
+    }
+    else
+    {
+        m_context->UpdateSubresource(m_texCoordBuffer.get(), 0, nullptr, vertices, 0, 0);
+    }
 }
 
 ShaderPass::~ShaderPass()
 {
     m_inputLayout    = nullptr;
     m_vertexBuffer   = nullptr;
+    m_texCoordBuffer = nullptr;
     m_constantBuffer = nullptr;
     m_pushBuffer     = nullptr;
-    m_samplers.clear();
+    m_frame.m_samplers.clear();
 }
 
-void ShaderPass::Resize(
+bool ShaderPass::Resize(
     int sourceWidth, int sourceHeight, int destWidth, int destHeight, const std::map<std::string, float4>& textureSizes, const std::vector<std::array<UINT, 4>>& passSizes)
 {
+    auto changed = destWidth != m_destWidth || destHeight != m_destHeight;
     m_destWidth  = destWidth;
     m_destHeight = destHeight;
-
-    params_SourceSize[0] = static_cast<float>(sourceWidth);
-    params_SourceSize[1] = static_cast<float>(sourceHeight);
-    params_SourceSize[2] = 1.0f / sourceWidth;
-    params_SourceSize[3] = 1.0f / sourceHeight;
-    params_OutputSize[0] = static_cast<float>(destWidth);
-    params_OutputSize[1] = static_cast<float>(destHeight);
-    params_OutputSize[2] = 1.0f / destWidth;
-    params_OutputSize[3] = 1.0f / destHeight;
-    m_shader.SetParam("SourceSize", params_SourceSize);
-    m_shader.SetParam("OutputSize", params_OutputSize);
-
-    for(const auto& tx : textureSizes)
-    {
-        auto sizeParam = tx.first + "Size";
-        m_shader.SetParam(sizeParam, (void*)&tx.second);
-    }
-    for(auto p = 0; p < passSizes.size(); p++)
-    {
-        const auto& passSize = passSizes.at(p);
-        if(passSize[2] != 0 && passSize[3] != 0)
-        {
-            auto  sizeParam    = "PassOutputSize" + std::to_string(p);
-            float passSizeF[4] = {(float)passSize[2], (float)passSize[3], 1.0f / passSize[2], 1.0f / passSize[3]};
-            m_shader.SetParam(sizeParam, passSizeF);
-        }
-    }
+    changed |= m_frame.Resize(*m_shader, sourceWidth, sourceHeight, destWidth, destHeight, textureSizes, passSizes);
+    return changed;
 }
 
-void ShaderPass::Render(std::map<std::string, winrt::com_ptr<ID3D11ShaderResourceView>>& resources, int frameNo, int boxX, int boxY)
+void ShaderPass::Render(std::map<std::string, winrt::com_ptr<ID3D11ShaderResourceView>>& resources,
+                        const std::vector<ID3D11ShaderResourceView*>&                     history,
+                        int                                                               frameNo,
+                        int                                                               boxX,
+                        int                                                               boxY)
 {
-    Render(m_sourceView, resources, frameNo, boxX, boxY);
+    Render(m_sourceView, resources, history, frameNo, boxX, boxY);
 }
 
-void ShaderPass::Render(ID3D11ShaderResourceView* sourceView, std::map<std::string, winrt::com_ptr<ID3D11ShaderResourceView>>& resources, int frameNo, int boxX, int boxY)
+void ShaderPass::Render(ID3D11ShaderResourceView*                                         sourceView,
+                        std::map<std::string, winrt::com_ptr<ID3D11ShaderResourceView>>& resources,
+                        const std::vector<ID3D11ShaderResourceView*>&                     history,
+                        int                                                               frameNo,
+                        int                                                               boxX,
+                        int                                                               boxY)
 {
-    params_FrameCount = frameNo;
-    if(m_shader.m_frameCountMod > 0)
-    {
-        while(params_FrameCount >= m_shader.m_frameCountMod)
-            params_FrameCount -= m_shader.m_frameCountMod;
-    }
-
-    m_shader.SetParam("FrameCount", &params_FrameCount);
-    m_shader.SetParam("MVP", &m_modelViewProj);
+    m_frame.Render(*this, *m_shader, sourceView, resources, history, frameNo, boxX, boxY);
+}
 
-    if(m_constantBuffer != nullptr)
-    {
-        D3D11_MAPPED_SUBRESOURCE mappedSubresource;
-        m_context->Map(m_constantBuffer.get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedSubresource);
-        m_shader.FillParams(0, (char*)mappedSubresource.pData);
-        m_context->Unmap(m_constantBuffer.get(), 0);
-    }
+bool ShaderPass::Map(int buffer, void*& data)
+{
+    auto* constantBuffer = buffer == UBO_BUFFER ? m_constantBuffer.get() : m_pushBuffer.get();
+    if(constantBuffer == nullptr)
+        return false;
+
+    D3D11_MAPPED_SUBRESOURCE mappedSubresource;
+    m_context->Map(constantBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedSubresource);
+    data = mappedSubresource.pData;
+    return true;
+}
 
-    if(m_pushBuffer != nullptr)
-    {
-        D3D11_MAPPED_SUBRESOURCE mappedSubresource;
-        m_context->Map(m_pushBuffer.get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedSubresource);
-        m_shader.FillParams(-1, (char*)mappedSubresource.pData);
-        m_context->Unmap(m_pushBuffer.get(), 0);
-    }
+void ShaderPass::Unmap(int buffer)
+{
+    m_context->Unmap(buffer == UBO_BUFFER ? m_constantBuffer.get() : m_pushBuffer.get(), 0);
+}
 
+void ShaderPass::SetTarget(int boxX, int boxY)
+{
     D3D11_VIEWPORT viewport = {static_cast<float>(boxX), static_cast<float>(boxY), static_cast<float>(m_destWidth), static_cast<float>(m_destHeight), 0.0f, 1.0f};
     m_context->RSSetViewports(1, &viewport);
 
@@ -248,48 +235,33 @@ void ShaderPass::Render(ID3D11ShaderResourceView* sourceView, std::map<std::stri
     m_context->OMSetRenderTargets(1, targets, NULL);
 
     m_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
-    m_context->IASetInputLayout(m_inputLayout.get());
-    ID3D11Buffer* vertexBuffer[1] = {m_vertexBuffer.get()};
+    m_context->IASetInputLayout(m_inputLayout->get());
+    ID3D11Buffer* vertexBuffer[1] = {m_texCoordBuffer ? m_texCoordBuffer.get() : m_vertexBuffer->get()};
     m_context->IASetVertexBuffers(0, 1, vertexBuffer, &s_vertexStride, &s_vertexOffset);
 
-    m_context->VSSetShader(m_shader.m_vertexShader.get(), NULL, 0);
-    m_context->PSSetShader(m_shader.m_pixelShader.get(), NULL, 0);
+    m_context->VSSetShader(m_shader->m_vertexShader->get(), NULL, 0);
+    m_context->PSSetShader(m_shader->m_pixelShader->get(), NULL, 0);
+}
 
-    std::vector<int> bindings;
-    for(const auto& texture : m_shader.m_shaderDef.Samplers)
-    {
-        auto& sampler = m_samplers.at(texture.binding);
-        if(texture.name == "Source")
-        {
-            ID3D11ShaderResourceView* localResources[1] = {sourceView};
-            m_context->PSSetShaderResources(texture.binding, 1, localResources);
-            bindings.push_back(texture.binding);
-        }
-        else
-        {
-            auto it = resources.find(texture.name);
-            if(it == resources.end() && texture.name.starts_with("OriginalHistory"))
-            {
-                it = resources.find("Original"); // should only map 0 to Original
-            }
-            if(it != resources.end())
-            {
-                ID3D11ShaderResourceView* localResources[1] = {it->second.get()};
-                m_context->PSSetShaderResources(texture.binding, 1, localResources);
-                bindings.push_back(texture.binding);
-            }
-            else
-            {
-#ifdef _DEBUG
-                OutputDebugStringW(convertCharArrayToLPCWSTR(texture.name.c_str()));
-                OutputDebugStringW(L"\n");
-#endif
-            }
-        }
-        ID3D11SamplerState* samplers[1] = {sampler.get()};
-        m_context->PSSetSamplers(texture.binding, 1, samplers);
-    }
+void ShaderPass::SetResource(int binding, ID3D11ShaderResourceView* view)
+{
+    ID3D11ShaderResourceView* localResources[1] = {view};
+    m_context->PSSetShaderResources(binding, 1, localResources);
+}
+
+ID3D11ShaderResourceView* ShaderPass::ResourceView(const winrt::com_ptr<ID3D11ShaderResourceView>& resource)
+{
+    return resource.get();
+}
 
+void ShaderPass::SetSampler(int binding, const DeviceObject<ID3D11SamplerState>& sampler)
+{
+    ID3D11SamplerState* samplers[1] = {sampler->get()};
+    m_context->PSSetSamplers(binding, 1, samplers);
+}
+
+void ShaderPass::SetConstantBuffers()
+{
     if(m_constantBuffer != nullptr)
     {
         ID3D11Buffer* buffer[1] = {m_constantBuffer.get()};
@@ -302,7 +274,10 @@ void ShaderPass::Render(ID3D11ShaderResourceView* sourceView, std::map<std::stri
         m_context->VSSetConstantBuffers(1, 1, buffer);
         m_context->PSSetConstantBuffers(1, 1, buffer);
     }
+}
 
+void ShaderPass::Draw()
+{
     if(m_preprocess)
     {
         m_context->Draw(s_vertexCount, 0);
@@ -311,8 +286,10 @@ void ShaderPass::Render(ID3D11ShaderResourceView* sourceView, std::map<std::stri
     {
         m_context->Draw(s_vertexCount, 4);
     }
+}
 
-    // unbind to allow rebinding as input/output
+void ShaderPass::Unbind(const std::vector<int>& bindings)
+{
     for(auto& b : bindings)
     {
         ID3D11ShaderResourceView* null[] = {nullptr};
@@ -322,22 +299,25 @@ void ShaderPass::Render(ID3D11ShaderResourceView* sourceView, std::map<std::stri
     m_context->OMSetRenderTargets(1, null, NULL);
 }
 
-bool ShaderPass::RequiresFeedback() const
+void ShaderPass::Unresolved(const std::string& name)
 {
-    for(const auto& texture : m_shader.m_shaderDef.Samplers)
-    {
-        if(texture.name.ends_with("Feedback") || texture.name.starts_with("PassFeedback"))
-        {
-            return true;
-        }
-    }
-    return false;
+#ifdef _DEBUG
+    OutputDebugStringW(convertCharArrayToLPCWSTR(name.c_str()));
+    OutputDebugStringW(L"\n");
+#endif
+}
+
+void ShaderPass::Rebind(Shader& shader, Preset& preset)
+{
+    m_shader                = &shader;
+    m_preset                = &preset;
+    m_frame.m_frameCountMod = shader.m_frameCountMod;
 }
 
 int ShaderPass::RequiresHistory() const
 {
     int maxHistory = 0;
-    for(const auto& texture : m_shader.m_shaderDef.Samplers)
+    for(const auto& texture : m_shader->m_shaderDef.Samplers)
     {
         if(texture.name.starts_with("OriginalHistory"))
         {
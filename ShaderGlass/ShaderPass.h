@@ -9,6 +9,8 @@ GNU General Public License v3.0
 
 #include "Shader.h"
 #include "Preset.h"
+#include "PassFrame.h"
+#include "TexCoordTransform.h"
 
 #pragma once
 
@@ -16,39 +18,62 @@ class ShaderPass
 {
 public:
     ShaderPass(Shader& shader, Preset& preset, bool preprocess);
-    ShaderPass(Shader& shader, Preset& preset, winrt::com_ptr<ID3D11Device> device, winrt::com_ptr<ID3D11DeviceContext> context);
+    ShaderPass(Shader& shader, Preset& preset, DeviceCache& deviceCache, winrt::com_ptr<ID3D11DeviceContext> context);
     ~ShaderPass();
 
-    void Initialize(winrt::com_ptr<ID3D11Device> device, winrt::com_ptr<ID3D11DeviceContext> context);
-    void Render(std::map<std::string, winrt::com_ptr<ID3D11ShaderResourceView>>& resources, int frameCount, int boxX, int boxY);
-    void Render(ID3D11ShaderResourceView* sourceView, std::map<std::string, winrt::com_ptr<ID3D11ShaderResourceView>>& resources, int frameCount, int boxX, int boxY);
-    void
+    void Initialize(DeviceCache& deviceCache, winrt::com_ptr<ID3D11DeviceContext> context);
+    void Render(std::map<std::string, winrt::com_ptr<ID3D11ShaderResourceView>>& resources,
+                const std::vector<ID3D11ShaderResourceView*>&                     history,
+                int                                                               frameCount,
+                int                                                               boxX,
+                int                                                               boxY);
+    void Render(ID3D11ShaderResourceView*                                         sourceView,
+                std::map<std::string, winrt::com_ptr<ID3D11ShaderResourceView>>& resources,
+                const std::vector<ID3D11ShaderResourceView*>&                     history,
+                int                                                               frameCount,
+                int                                                               boxX,
+                int                                                               boxY);
+    // whether the output size or any param changed
+    bool
     Resize(int sourceWidth, int sourceHeight, int destWidth, int destHeight, const std::map<std::string, float4>& textureSizes, const std::vector<std::array<UINT, 4>>& passSizes);
     void UpdateMVP(float sx, float sy, float tx, float ty);
-    bool RequiresFeedback() const;
+    void UpdateTexCoords(const TexCoordTransform& transform);
     int  RequiresHistory() const;
+    // moves a pass kept across a preset switch to the same shader of the new preset, device objects are the same
+    void Rebind(Shader& shader, Preset& preset);
 
-    Shader&                   m_shader;
-    Preset&                   m_preset;
+    Shader*                   m_shader;
+    Preset*                   m_preset;
     ID3D11ShaderResourceView* m_sourceView {nullptr};
     ID3D11RenderTargetView*   m_targetView {nullptr};
     int                       m_destWidth {0};
     int                       m_destHeight {0};
 
 private:
-    float4x4                                          m_modelViewProj {};
-    winrt::com_ptr<ID3D11Device>                      m_device {nullptr};
-    winrt::com_ptr<ID3D11DeviceContext>               m_context {nullptr};
-    winrt::com_ptr<ID3D11InputLayout>                 m_inputLayout {nullptr};
-    winrt::com_ptr<ID3D11Buffer>                      m_vertexBuffer {nullptr};
-    winrt::com_ptr<ID3D11Buffer>                      m_constantBuffer {nullptr};
-    winrt::com_ptr<ID3D11Buffer>                      m_pushBuffer {nullptr};
-    std::map<int, winrt::com_ptr<ID3D11SamplerState>> m_samplers;
-    bool                                              m_preprocess {false};
-    const UINT                                        s_vertexStride {6 * sizeof(float)};
-    const UINT                                        s_vertexOffset {0};
-    const UINT                                        s_vertexCount {4};
-    float                                             params_SourceSize[4] {0, 0, 0, 0};
-    float                                             params_OutputSize[4] {0, 0, 0, 0};
-    int                                               params_FrameCount {0};
-};
+    template<typename> friend class PassFrame;
+
+    // device side of PassFrame::Render
+    bool                      Map(int buffer, void*& data);
+    void                      Unmap(int buffer);
+    void                      SetTarget(int boxX, int boxY);
+    void                      SetResource(int binding, ID3D11ShaderResourceView* view);
+    ID3D11ShaderResourceView* ResourceView(const winrt::com_ptr<ID3D11ShaderResourceView>& resource);
+    void                      SetSampler(int binding, const DeviceObject<ID3D11SamplerState>& sampler);
+    void                      SetConstantBuffers();
+    void                      Draw();
+    void                      Unbind(const std::vector<int>& bindings);
+    void                      Unresolved(const std::string& name);
+
+    PassFrame<DeviceObject<ID3D11SamplerState>> m_frame;
+    winrt::com_ptr<ID3D11Device>                m_device {nullptr};
+    winrt::com_ptr<ID3D11DeviceContext>         m_context {nullptr};
+    DeviceObject<ID3D11InputLayout>             m_inputLayout {nullptr};
+    DeviceObject<ID3D11Buffer>                  m_vertexBuffer {nullptr};
+    winrt::com_ptr<ID3D11Buffer>                m_texCoordBuffer {nullptr};
+    winrt::com_ptr<ID3D11Buffer>                m_constantBuffer {nullptr};
+    winrt::com_ptr<ID3D11Buffer>                m_pushBuffer {nullptr};
+    bool                                        m_preprocess {false};
+    const UINT                                  s_vertexStride {6 * sizeof(float)};
+    const UINT                                  s_vertexOffset {0};
+    const UINT                                  s_vertexCount {4};
+};
\ No newline at end of file
@@ -10,9 +10,12 @@ GNU General Public License v3.0
 #include "resource.h"
 #include "ShaderWindow.h"
 #include "ShaderGC.h"
+#include "GLSL.h"
 
 #include "Shlobj.h"
 
+#include <thread>
+
 #define TIMER_TITLE 0
 
 ShaderWindow::ShaderWindow(CaptureManager& captureManager) :
@@ -23,10 +26,6 @@ bool ShaderWindow::LoadProfile(const std::wstring& fileName)
 {
     try
     {
-        bool paused = m_captureManager.IsActive();
-        if(paused)
-            Stop();
-
         m_captureManager.ForgetLastPreset();
 
         std::ifstream infile(fileName);
@@ -38,6 +37,9 @@ bool ShaderWindow::LoadProfile(const std::wstring& fileName)
             return false;
         }
 
+        // every key only sets m_captureOptions, a running session applies what differs once the profile is read
+        m_captureManager.BeginOptions();
+
         std::string                                       shaderCategory;
         std::string                                       shaderName;
         std::optional<std::wstring>                       shaderPath;
@@ -55,7 +57,10 @@ bool ShaderWindow::LoadProfile(const std::wstring& fileName)
             if(key == "ProfileVersion")
             {
                 if(!value.starts_with("1."))
+                {
+                    m_captureManager.EndOptions();
                     return true;
+                }
             }
             else if(key == "CaptureWindow")
             {
@@ -322,13 +327,16 @@ bool ShaderWindow::LoadProfile(const std::wstring& fileName)
             m_captureManager.SetParams(params);
         }
 
-        if(paused)
-            SendMessage(m_mainWindow, WM_COMMAND, IDM_START, 0);
+        // a new capture source swaps the session, anything else is set on the running one
+        m_captureManager.EndOptions();
+        TryUpdateInput();
+        UpdateWindowState();
 
         AddRecentProfile(fileName);
     }
     catch(std::exception& e)
     {
+        m_captureManager.EndOptions();
         MessageBox(NULL, convertCharArrayToLPCWSTR((std::string("Error loading profile: ") + std::string(e.what())).c_str()), L"ShaderGlass", MB_OK | MB_ICONERROR);
     }
 
@@ -376,6 +384,32 @@ void ShaderWindow::ImportShader()
     }
 }
 
+void ShaderWindow::ImportFolder()
+{
+    BROWSEINFOW bi;
+    wchar_t     szFolderName[MAX_PATH] = L"";
+    ZeroMemory(&bi, sizeof(bi));
+    bi.hwndOwner      = m_mainWindow;
+    bi.pszDisplayName = szFolderName;
+    bi.lpszTitle      = L"Folder with Slang Profiles (*.slangp) to import, subfolders included";
+    bi.ulFlags        = BIF_RETURNONLYFSDIRS | BIF_NEWDIALOGSTYLE;
+
+    // folder dialog needs COM on this thread
+    const auto comInitialized = SUCCEEDED(CoInitializeEx(NULL, COINIT_APARTMENTTHREADED));
+    auto       idList         = SHBrowseForFolderW(&bi);
+    if(idList)
+    {
+        if(SHGetPathFromIDListW(idList, szFolderName))
+        {
+            std::wstring ws(szFolderName);
+            ImportFolder(ws);
+        }
+        CoTaskMemFree(idList);
+    }
+    if(comInitialized)
+        CoUninitialize();
+}
+
 void ShaderWindow::SetFreeScale()
 {
     if(!ScaleLocked())
@@ -406,6 +440,7 @@ void ShaderWindow::LoadImage()
         m_captureOptions.imageFile     = ws;
         m_captureOptions.captureWindow = NULL;
         m_captureOptions.monitor       = NULL;
+        m_captureOptions.replayFile.clear();
 
         // update input checkboxes
         CheckMenuRadioItem(m_windowMenu, WM_CAPTURE_WINDOW(0), WM_CAPTURE_WINDOW(static_cast<UINT>(m_captureWindows.size())), 0, MF_BYCOMMAND);
@@ -545,13 +580,25 @@ DWORD WINAPI CompileThreadFuncProxy(LPVOID lpParam)
 // shader compiler needs to reuse thread
 void ShaderWindow::CompileThreadFunc()
 {
-    const ShaderCache& cache = m_captureManager.Cache();
+    const ShaderCache& cache         = m_captureManager.Cache();
+    auto&              compileTime   = m_captureManager.Metrics().Histogram("compile.preset_us");
+    auto&              compileErrors = m_captureManager.Metrics().Counter("compile.errors");
+    Tracer::NameThread("compile");
+
+    // folder imports compile on worker threads of their own
+    GLSL::Initialize();
 
     while(true)
     {
         WaitForSingleObject(m_compileEvent, INFINITE);
         ResetEvent(m_compileEvent);
 
+        if(!m_importFolder.empty())
+        {
+            CompileFolder(cache);
+            continue;
+        }
+
         if(m_importPath.empty())
             continue;
 
@@ -560,9 +607,12 @@ void ShaderWindow::CompileThreadFunc()
         {
             std::ofstream log;
             bool          warn;
-            auto          preset = ShaderGC::CompilePreset(m_importPath, log, warn, cache);
-            if(preset == nullptr)
-                throw std::runtime_error("Internal error");
+            PresetDef*    preset;
+            {
+                MetricsRegistry::Timer timer(compileTime);
+                Tracer::Span           span("compile", "CompilePreset");
+                preset = m_library.Import(m_importPath, log, warn, cache);
+            }
             auto id      = m_captureManager.AddPreset(preset);
             m_numPresets = (unsigned int)m_captureManager.Presets().size();
             SendMessage(m_browserWindow, WM_COMMAND, WM_USER + 1, id);
@@ -571,7 +621,9 @@ void ShaderWindow::CompileThreadFunc()
         catch(std::exception& ex)
         {
             errorMsg = std::string(ex.what());
+            compileErrors.Add();
         }
+        m_library.Save(GetLibraryPath());
         EnableWindow(m_mainWindow, true);
         ShowWindow(m_compileWindow, SW_HIDE);
         m_importPath = std::filesystem::path();
@@ -583,6 +635,100 @@ void ShaderWindow::CompileThreadFunc()
     }
 }
 
+// compiles a folder on a pool leaving a core to capture and rendering, only files changed since the last import
+void ShaderWindow::CompileFolder(const ShaderCache& cache)
+{
+    const auto    jobs = max(std::thread::hardware_concurrency(), 2u) - 1;
+    LibraryImport imported;
+    size_t        skipped = 0;
+    std::string   message;
+    try
+    {
+        {
+            Tracer::Span span("compile", "ImportFolder");
+            imported = m_library.ImportDirectory(m_importFolder, jobs, cache, [this](size_t done, size_t total) {
+                wchar_t progress[MAX_LOADSTRING];
+                _snwprintf_s(progress, MAX_LOADSTRING, L"Compiling shaders... %zu of %zu\r\n", done, total);
+                SendMessage(m_compileWindow, WM_COMMAND, WM_USER + 1, (LPARAM)progress);
+            });
+        }
+        for(const auto& path : imported.changed)
+        {
+            if(m_captureManager.Presets().size() >= MAX_SHADERS)
+            {
+                skipped++;
+                continue;
+            }
+            auto preset = m_library.Preset(path);
+            if(preset == nullptr)
+                continue;
+            auto id = m_captureManager.AddPreset(preset);
+            SendMessage(m_browserWindow, WM_COMMAND, WM_USER + 1, id);
+        }
+        m_numPresets = (unsigned int)m_captureManager.Presets().size();
+        m_library.Save(GetLibraryPath());
+
+        std::ostringstream summary;
+        summary << "Imported " << imported.compiled << " of " << imported.scanned << " presets, " << imported.unchanged << " unchanged";
+        if(imported.removed)
+            summary << ", " << imported.removed << " removed";
+        if(skipped)
+            summary << ", " << skipped << " over the limit of " << MAX_SHADERS << " shaders";
+        if(imported.failed)
+        {
+            // the first failure says why, the others show theirs when imported one by one
+            const auto& first = imported.errors.front();
+            summary << ", " << imported.failed << " failed to compile" << std::endl << std::endl << first.string() << ":" << std::endl << m_library.Error(first);
+        }
+        message = summary.str();
+    }
+    catch(std::exception& ex)
+    {
+        message = std::string(ex.what());
+    }
+    m_captureManager.Metrics().Counter("compile.errors").Add(imported.failed);
+
+    SendMessage(m_compileWindow, WM_COMMAND, WM_USER + 1, 0);
+    EnableWindow(m_mainWindow, true);
+    ShowWindow(m_compileWindow, SW_HIDE);
+    m_importFolder = std::filesystem::path();
+
+    MessageBox(m_mainWindow, convertCharArrayToLPCWSTR(message.c_str()), L"ShaderGlass", MB_OK);
+}
+
+void ShaderWindow::ShowCompileWindow()
+{
+    RECT rc, rcDlg, rcOwner;
+    GetWindowRect(m_mainWindow, &rcOwner);
+    GetWindowRect(m_compileWindow, &rcDlg);
+    CopyRect(&rc, &rcOwner);
+    OffsetRect(&rcDlg, -rcDlg.left, -rcDlg.top);
+    OffsetRect(&rc, -rc.left, -rc.top);
+    OffsetRect(&rc, -rcDlg.right, -rcDlg.bottom);
+    SetWindowPos(m_compileWindow,
+                 HWND_TOP,
+                 rcOwner.left + (rc.right / 2),
+                 rcOwner.top + max(0, (rc.bottom / 2)),
+                 0,
+                 0, // Ignores size arguments.
+                 SWP_NOSIZE);
+
+    ShowWindow(m_compileWindow, SW_SHOW);
+    EnableWindow(m_mainWindow, false);
+    if(!m_compileEvent)
+    {
+        m_compileEvent = CreateEvent(NULL, TRUE, FALSE, TEXT("CompileEvent"));
+    }
+    if(!m_compileThread)
+    {
+        m_compileThread = CreateThread(NULL, 0, CompileThreadFuncProxy, this, 0, NULL);
+    }
+    if(m_compileEvent)
+    {
+        SetEvent(m_compileEvent);
+    }
+}
+
 bool ShaderWindow::ImportShader(const std::wstring& fileName)
 {
     try
@@ -594,35 +740,38 @@ bool ShaderWindow::ImportShader(const std::wstring& fileName)
 
         AddRecentImport(m_importPath);
 
-        RECT rc, rcDlg, rcOwner;
-        GetWindowRect(m_mainWindow, &rcOwner);
-        GetWindowRect(m_compileWindow, &rcDlg);
-        CopyRect(&rc, &rcOwner);
-        OffsetRect(&rcDlg, -rcDlg.left, -rcDlg.top);
-        OffsetRect(&rc, -rc.left, -rc.top);
-        OffsetRect(&rc, -rcDlg.right, -rcDlg.bottom);
-        SetWindowPos(m_compileWindow,
-                     HWND_TOP,
-                     rcOwner.left + (rc.right / 2),
-                     rcOwner.top + max(0, (rc.bottom / 2)),
-                     0,
-                     0, // Ignores size arguments.
-                     SWP_NOSIZE);
-
-        ShowWindow(m_compileWindow, SW_SHOW);
-        EnableWindow(m_mainWindow, false);
-        if(!m_compileEvent)
-        {
-            m_compileEvent = CreateEvent(NULL, TRUE, FALSE, TEXT("CompileEvent"));
-        }
-        if(!m_compileThread)
-        {
-            m_compileThread = CreateThread(NULL, 0, CompileThreadFuncProxy, this, 0, NULL);
-        }
-        if(m_compileEvent)
+        // unchanged since it was imported, already loaded from the library
+        if(m_library.Current(m_importPath))
         {
-            SetEvent(m_compileEvent);
+            auto existing = m_captureManager.FindByImportPath(m_importPath);
+            if(existing != -1)
+            {
+                m_importPath = std::filesystem::path();
+                SendMessage(m_mainWindow, WM_COMMAND, WM_SHADER(existing), 0);
+                return true;
+            }
         }
+
+        ShowCompileWindow();
+        return true;
+    }
+    catch(std::exception& ex)
+    {
+        MessageBox(m_mainWindow, convertCharArrayToLPCWSTR(ex.what()), L"ShaderGlass", MB_OK);
+        return false;
+    }
+}
+
+bool ShaderWindow::ImportFolder(const std::wstring& folder)
+{
+    try
+    {
+        m_importFolder = folder;
+
+        if(m_importFolder.empty())
+            return false;
+
+        ShowCompileWindow();
         return true;
     }
     catch(std::exception& ex)
@@ -819,7 +968,7 @@ void ShaderWindow::BuildShaderMenu()
         throw std::runtime_error("Too many shaders!");
 
     m_importsMenu = CreatePopupMenu();
-    InsertMenu(m_shaderMenu, 7, MF_BYPOSITION | MF_STRING | MF_POPUP, (UINT_PTR)m_importsMenu, L"Recent imports");
+    InsertMenu(m_shaderMenu, 8, MF_BYPOSITION | MF_STRING | MF_POPUP, (UINT_PTR)m_importsMenu, L"Recent imports");
     LoadRecentImports();
 }
 
@@ -972,7 +1121,8 @@ void ShaderWindow::AdjustWindowSize(HWND hWnd)
         return;
 
     // resize client area to captured window/file x scale
-    if(m_captureManager.IsActive() && !m_captureOptions.freeScale && ((m_captureOptions.captureWindow && m_captureOptions.clone) || !m_captureOptions.imageFile.empty()))
+    if(m_captureManager.IsActive() && !m_captureOptions.freeScale && ((m_captureOptions.captureWindow && m_captureOptions.clone) || !m_captureOptions.imageFile.empty() ||
+                                                                       !m_captureOptions.replayFile.empty()))
     {
         LONG inputWidth = 0, inputHeight = 0;
 
@@ -1144,6 +1294,16 @@ void ShaderWindow::UpdateTitle()
         }
         if(m_captureOptions.maxCaptureRate)
             advancedFlags[a++] = 'M';
+        if(m_captureOptions.adaptiveQuality)
+        {
+            advancedFlags[a++] = 'A';
+            advancedFlags[a++] = static_cast<char>('0' + m_captureManager.AdaptiveLevel());
+        }
+        if(m_captureOptions.memoryBudget && m_captureManager.MemoryLevel())
+        {
+            advancedFlags[a++] = 'B';
+            advancedFlags[a++] = static_cast<char>('0' + m_captureManager.MemoryLevel());
+        }
         advancedFlags[a] = 0;
         if(a == 1)
             advancedFlags[0] = 0;
@@ -1287,6 +1447,23 @@ LRESULT CALLBACK ShaderWindow::WndProc(HWND hWnd, UINT message, WPARAM wParam, L
                 CheckMenuItem(m_programMenu, ID_PROCESSING_REMEMBERPOSITION, MF_CHECKED);
             }
             break;
+        case ID_PROCESSING_RECORDTRACE:
+            if(Tracer::IsEnabled())
+            {
+                Tracer::Enable(false);
+                CheckMenuItem(m_programMenu, ID_PROCESSING_RECORDTRACE, MF_UNCHECKED);
+                SaveTrace();
+            }
+            else
+            {
+                Tracer::Clear();
+                Tracer::Enable(true);
+                CheckMenuItem(m_programMenu, ID_PROCESSING_RECORDTRACE, MF_CHECKED);
+            }
+            break;
+        case ID_PROCESSING_SAVEPASSCOSTS:
+            SavePassCosts();
+            break;
         case ID_PRESENTATION_USEFLIPMODE:
             if(GetMenuState(m_advancedMenu, ID_PRESENTATION_USEFLIPMODE, MF_BYCOMMAND) & MF_CHECKED)
             {
@@ -1522,6 +1699,9 @@ LRESULT CALLBACK ShaderWindow::WndProc(HWND hWnd, UINT message, WPARAM wParam, L
         case ID_SHADER_IMPORT:
             ImportShader();
             break;
+        case ID_SHADER_IMPORTFOLDER:
+            ImportFolder();
+            break;
         case IDM_PROCESSING_SAVEPROFILEAS:
             SaveProfile();
             break;
@@ -1566,6 +1746,12 @@ LRESULT CALLBACK ShaderWindow::WndProc(HWND hWnd, UINT message, WPARAM wParam, L
                 SaveRememberFPS(m_captureOptions.frameSkip);
             }
             break;
+        case ID_FPS_ADAPTIVEQUALITY:
+            m_captureOptions.adaptiveQuality = !m_captureOptions.adaptiveQuality;
+            CheckMenuItem(m_frameSkipMenu, ID_FPS_ADAPTIVEQUALITY, m_captureOptions.adaptiveQuality ? MF_CHECKED : MF_UNCHECKED);
+            SaveAdaptiveQualityState(m_captureOptions.adaptiveQuality);
+            m_captureManager.UpdateAdaptiveQuality();
+            break;
         case IDM_ABOUT1:
         case IDM_ABOUT2:
         case IDM_ABOUT3:
@@ -1588,7 +1774,8 @@ LRESULT CALLBACK ShaderWindow::WndProc(HWND hWnd, UINT message, WPARAM wParam, L
                 {
                     PostMessage(m_browserWindow, WM_COMMAND, WM_USER, wmId + (lParam << 16));
                     m_captureOptions.presetNo = wmId - WM_SHADER(0);
-                    m_captureManager.UpdateShaderPreset();
+                    if(!m_captureManager.UpdateShaderPreset())
+                        PresetRefused();
                     UpdateWindowState();
                     if(wmId != WM_SHADER(0) && m_toggledNone)
                     {
@@ -1612,6 +1799,7 @@ LRESULT CALLBACK ShaderWindow::WndProc(HWND hWnd, UINT message, WPARAM wParam, L
                     CheckMenuItem(m_inputMenu, ID_INPUT_FILE, MF_UNCHECKED | MF_BYCOMMAND);
                     EnableMenuItem(m_outputScaleMenu, IDM_OUTPUT_FREESCALE, MF_BYCOMMAND | MF_ENABLED);
                     m_captureOptions.imageFile.clear();
+                    m_captureOptions.replayFile.clear();
                     TryUpdateInput();
                     UpdateWindowState();
                     SetFreeScale();
@@ -1643,6 +1831,7 @@ LRESULT CALLBACK ShaderWindow::WndProc(HWND hWnd, UINT message, WPARAM wParam, L
                     CheckMenuItem(m_inputMenu, ID_INPUT_FILE, MF_UNCHECKED | MF_BYCOMMAND);
                     EnableMenuItem(m_outputScaleMenu, IDM_OUTPUT_FREESCALE, MF_BYCOMMAND | MF_DISABLED);
                     m_captureOptions.imageFile.clear();
+                    m_captureOptions.replayFile.clear();
                     TryUpdateInput();
                     UpdateWindowState();
                     break;
@@ -1701,7 +1890,7 @@ LRESULT CALLBACK ShaderWindow::WndProc(HWND hWnd, UINT message, WPARAM wParam, L
                 if(frameSkip != frameSkips.end())
                 {
                     m_selectedFrameSkip = wmId - WM_FRAME_SKIP(0);
-                    CheckMenuRadioItem(m_frameSkipMenu, 1, static_cast<UINT>(frameSkips.size() + 1), wmId - WM_FRAME_SKIP(0) + 1, MF_BYPOSITION);
+                    CheckMenuRadioItem(m_frameSkipMenu, 2, static_cast<UINT>(frameSkips.size() + 2), wmId - WM_FRAME_SKIP(0) + 2, MF_BYPOSITION);
                     m_captureOptions.frameSkip = frameSkip->second.s;
                     m_captureManager.UpdateFrameSkip();
                     if(RememberFPS())
@@ -1868,10 +2057,13 @@ LRESULT CALLBACK ShaderWindow::WndProc(HWND hWnd, UINT message, WPARAM wParam, L
             return 0;
         case TIMER_TITLE:
             UpdateTitle();
+            if(m_metricsExporter)
+                m_metricsExporter->Publish();
             return 0;
         }
         break;
     case WM_DESTROY:
+        m_metricsExporter.reset();
         m_captureManager.Exit();
         SaveStartingPosition();
         PostQuitMessage(0);
@@ -1920,11 +2112,23 @@ void ShaderWindow::Stop()
 
 void ShaderWindow::TryUpdateInput()
 {
-    if(!m_captureManager.UpdateInput())
+    auto result = m_captureManager.UpdateInput();
+    if(result == ApplyResult::Failed)
     {
         EnableMenuItem(m_programMenu, IDM_START, MF_BYCOMMAND | MF_ENABLED);
         EnableMenuItem(m_programMenu, IDM_STOP, MF_BYCOMMAND | MF_DISABLED);
     }
+    else if(result == ApplyResult::PresetRefused)
+    {
+        PresetRefused();
+    }
+}
+
+// the preset chosen didn't fit the memory budget, the browser goes back to the one still running
+void ShaderWindow::PresetRefused()
+{
+    MessageBox(m_mainWindow, L"Shader exceeds the memory budget", L"ShaderGlass", MB_OK | MB_ICONWARNING);
+    PostMessage(m_browserWindow, WM_COMMAND, WM_USER, WM_SHADER(m_captureOptions.presetNo));
 }
 
 void ShaderWindow::Screenshot()
@@ -1953,6 +2157,59 @@ void ShaderWindow::Screenshot()
     }
 }
 
+void ShaderWindow::SaveTrace()
+{
+    OPENFILENAME ofn;
+    wchar_t      szFile[MAX_PATH] = L"";
+
+    ZeroMemory(&ofn, sizeof(ofn));
+    ofn.lStructSize     = sizeof(ofn);
+    ofn.hwndOwner       = m_mainWindow;
+    ofn.lpstrFile       = szFile;
+    ofn.nMaxFile        = MAX_PATH;
+    ofn.lpstrFilter     = _T("Chrome Trace\0*.json\0");
+    ofn.lpstrDefExt     = _T("json");
+    ofn.nFilterIndex    = 1;
+    ofn.lpstrFileTitle  = NULL;
+    ofn.nMaxFileTitle   = 0;
+    ofn.lpstrInitialDir = NULL;
+    ofn.Flags           = OFN_PATHMUSTEXIST;
+
+    if(GetSaveFileName(&ofn) == TRUE)
+    {
+        std::ofstream out(ofn.lpstrFile, std::ios::trunc);
+        Tracer::WriteJson(out);
+    }
+}
+
+void ShaderWindow::SavePassCosts()
+{
+    // taken now, while the dialog is open they would change
+    auto costs = m_captureManager.PassCosts();
+
+    OPENFILENAME ofn;
+    wchar_t      szFile[MAX_PATH] = L"";
+
+    ZeroMemory(&ofn, sizeof(ofn));
+    ofn.lStructSize     = sizeof(ofn);
+    ofn.hwndOwner       = m_mainWindow;
+    ofn.lpstrFile       = szFile;
+    ofn.nMaxFile        = MAX_PATH;
+    ofn.lpstrFilter     = _T("CSV\0*.csv\0");
+    ofn.lpstrDefExt     = _T("csv");
+    ofn.nFilterIndex    = 1;
+    ofn.lpstrFileTitle  = NULL;
+    ofn.nMaxFileTitle   = 0;
+    ofn.lpstrInitialDir = NULL;
+    ofn.Flags           = OFN_PATHMUSTEXIST;
+
+    if(GetSaveFileName(&ofn) == TRUE)
+    {
+        std::ofstream out(ofn.lpstrFile, std::ios::trunc);
+        PassTimings::WriteCsv(out, costs);
+    }
+}
+
 void ShaderWindow::ToggleBorderless(HWND hWnd)
 {
     LONG cur_style = GetWindowLong(m_mainWindow, GWL_STYLE);
@@ -2009,6 +2266,7 @@ bool ShaderWindow::Create(_In_ HINSTANCE hInstance, _In_ int nCmdShow)
     }
 
     m_captureManager.Initialize();
+    LoadLibraryIndex();
 
     m_mainMenu = LoadMenu(hInstance, MAKEINTRESOURCEW(IDC_SHADERGLASS));
 
@@ -2066,6 +2324,11 @@ bool ShaderWindow::Create(_In_ HINSTANCE hInstance, _In_ int nCmdShow)
     {
         CheckMenuItem(m_frameSkipMenu, ID_FPS_REMEMBERFPS, MF_BYCOMMAND | MF_CHECKED);
     }
+    if(GetAdaptiveQualityState())
+    {
+        CheckMenuItem(m_frameSkipMenu, ID_FPS_ADAPTIVEQUALITY, MF_BYCOMMAND | MF_CHECKED);
+        m_captureOptions.adaptiveQuality = true;
+    }
     if(CanSetCaptureRate())
     {
         if(GetMaxCaptureRateState())
@@ -2218,6 +2481,16 @@ int ShaderWindow::GetRememberFPS()
     return GetRegistryInt(TEXT("Remember FPS"), -1);
 }
 
+void ShaderWindow::SaveAdaptiveQualityState(bool state)
+{
+    SaveRegistryOption(TEXT("Adaptive Quality"), state);
+}
+
+bool ShaderWindow::GetAdaptiveQualityState()
+{
+    return GetRegistryOption(TEXT("Adaptive Quality"), false);
+}
+
 void ShaderWindow::LoadRecentProfiles()
 {
     m_recentProfiles.clear();
@@ -2423,6 +2696,32 @@ std::wstring ShaderWindow::GetDefaultPath() const
     return L"ShaderGlassDefault.sgp";
 }
 
+std::wstring ShaderWindow::GetLibraryPath() const
+{
+    wchar_t* path;
+    if(SUCCEEDED(SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, NULL, &path)))
+    {
+        return std::wstring(path) + L"\\ShaderGlassLibrary.sgl";
+    }
+    return L"ShaderGlassLibrary.sgl";
+}
+
+// imported presets come back without compiling, files changed since are compiled again when next imported
+void ShaderWindow::LoadLibraryIndex()
+{
+    if(!m_library.Load(GetLibraryPath()))
+        return;
+
+    for(const auto& path : m_library.Paths())
+    {
+        if(m_captureManager.Presets().size() >= MAX_SHADERS)
+            break;
+        auto preset = m_library.Preset(path);
+        if(preset != nullptr)
+            m_captureManager.AddPreset(preset);
+    }
+}
+
 void ShaderWindow::SaveDefault()
 {
     SaveProfile(GetDefaultPath());
@@ -2493,6 +2792,14 @@ void ShaderWindow::Start(_In_ LPWSTR lpCmdLine, HWND paramsWindow, HWND browserW
                 autoStart = false;
             else if(wcscmp(args[a], L"-fullscreen") == 0 || wcscmp(args[a], L"-f") == 0)
                 fullScreen = true;
+            else if(wcscmp(args[a], L"-metrics") == 0 && a + 1 < numArgs)
+                m_metricsExporter = std::make_unique<MetricsExporter>(m_captureManager.Metrics(), args[++a]);
+            else if(wcscmp(args[a], L"-record") == 0 && a + 1 < numArgs)
+                m_captureOptions.recordFile = args[++a];
+            else if(wcscmp(args[a], L"-replay") == 0 && a + 1 < numArgs)
+                m_captureOptions.replayFile = args[++a];
+            else if(wcscmp(args[a], L"-budget") == 0 && a + 1 < numArgs)
+                m_captureOptions.memoryBudget = static_cast<unsigned>(max(_wtoi(args[++a]), 0));
             else if(a == numArgs - 1)
             {
                 std::wstring ws(args[a]);
@@ -2500,6 +2807,14 @@ void ShaderWindow::Start(_In_ LPWSTR lpCmdLine, HWND paramsWindow, HWND browserW
                     LoadProfile(ws);
             }
         }
+
+        // a recording replaces whatever the profile captures
+        if(!m_captureOptions.replayFile.empty())
+        {
+            m_captureOptions.captureWindow = NULL;
+            m_captureOptions.monitor       = NULL;
+            m_captureOptions.imageFile.clear();
+        }
     }
 
     m_paramsWindow  = paramsWindow;
@@ -12,6 +12,7 @@ GNU General Public License v3.0
 #pragma comment(lib, "dxguid.lib")
 
 #include "Texture.h"
+#include "Tracer.h"
 #include "WIC\WICTextureLoader11.h"
 
 Texture::Texture(TextureDef& textureDef) : m_linear(false), m_mipmap(false), m_repeat(false), m_clamp(false), m_mirror(false), m_textureDef(textureDef)
@@ -35,6 +36,8 @@ Texture::Texture(TextureDef& textureDef) : m_linear(false), m_mipmap(false), m_r
 
 void Texture::Create(winrt::com_ptr<ID3D11Device> d3dDevice)
 {
+    Tracer::Span span("render", "Texture::Create");
+
     auto hr = DirectX::CreateWICTextureFromMemoryEx(d3dDevice.get(),
                                                     nullptr,
                                                     m_textureDef.Data,
@@ -177,6 +177,10 @@
 #define ID_FPS_REMEMBERFPS              32918
 #define ID_PROCESSING_SETASDEFAULT      32919
 #define ID_PROCESSING_REMOVEDEFAULT     32920
+#define ID_FPS_ADAPTIVEQUALITY          32921
+#define ID_PROCESSING_RECORDTRACE       32922
+#define ID_PROCESSING_SAVEPASSCOSTS     32923
+#define ID_SHADER_IMPORTFOLDER          32924
 #define IDC_STATIC                      -1
 #define IDC_STATIC_LABEL                -1
 
@@ -186,7 +190,7 @@
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NO_MFC                     1
 #define _APS_NEXT_RESOURCE_VALUE        138
-#define _APS_NEXT_COMMAND_VALUE         32921
+#define _APS_NEXT_COMMAND_VALUE         32925
 #define _APS_NEXT_CONTROL_VALUE         1002
 #define _APS_NEXT_SYMED_VALUE           116
 #endif
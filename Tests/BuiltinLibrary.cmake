@@ -0,0 +1,145 @@
+# Generates the sources of BuiltinLibrary, every preset of the embedded library (ShaderGlass/Shaders/RetroArch.h)
+# built on Linux. RetroArch.h includes with backslashes and its byte code doesn't fit in memory as one translation
+# unit, nor can each preset include the shaders it uses as Mega Bezel presets share most of them, so:
+# - BuiltinShaders<N>.cpp include about BUILTIN_LIBRARY_UNIT_SIZE bytes of shader headers each, inside a namespace,
+#   and copy every shader out through BuiltinShader_<class>()
+# - BuiltinPresets<N>.cpp include preset headers, with each ShaderDef class they use standing in for the copy and
+#   each TextureDef an empty stub (some textures aren't in the tree, and nothing built from this draws them)
+
+set(BUILTIN_LIBRARY_SHADERS ${CMAKE_CURRENT_SOURCE_DIR}/../ShaderGlass/Shaders)
+set(BUILTIN_LIBRARY_DIR ${CMAKE_CURRENT_BINARY_DIR}/BuiltinLibrary)
+set(BUILTIN_LIBRARY_UNIT_SIZE 6000000)
+set(BUILTIN_LIBRARY_HEADER "// generated by BuiltinLibrary.cmake from RetroArch.h, do not modify\n\n#include \"BuiltinLibrary.h\"\n\n")
+
+set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${BUILTIN_LIBRARY_SHADERS}/RetroArch.h)
+
+file(STRINGS ${BUILTIN_LIBRARY_SHADERS}/RetroArch.h library_lines REGEX "^#include \"|^new [A-Za-z0-9_]+\\(\\),")
+set(library_presets)
+foreach(line IN LISTS library_lines)
+    if(line MATCHES "^#include \"(.*)\"$")
+        string(REPLACE "\\" "/" header "${CMAKE_MATCH_1}")
+        get_filename_component(class "${header}" NAME_WE)
+        set(library_header_${class} "${header}")
+    elseif(line MATCHES "^new ([A-Za-z0-9_]+)\\(\\),")
+        list(APPEND library_presets ${CMAKE_MATCH_1})
+    endif()
+endforeach()
+
+set(BUILTIN_LIBRARY_SOURCES)
+set(library_units)
+
+# file(CONFIGURE) leaves a unit alone when unchanged so reconfiguring doesn't rebuild it
+macro(write_library_unit unit content)
+    file(CONFIGURE OUTPUT ${BUILTIN_LIBRARY_DIR}/${unit}.cpp CONTENT "${content}" @ONLY)
+    list(APPEND BUILTIN_LIBRARY_SOURCES ${BUILTIN_LIBRARY_DIR}/${unit}.cpp)
+    list(APPEND library_units ${unit})
+endmacro()
+
+macro(write_shader_unit)
+    list(LENGTH library_units index)
+    math(EXPR index "${index} - ${preset_units}")
+    set(content "${BUILTIN_LIBRARY_HEADER}namespace BuiltinShaders\n{\n")
+    foreach(shader IN LISTS unit_shaders)
+        string(APPEND content "#include \"${library_header_${shader}}\"\n")
+    endforeach()
+    string(APPEND content "}\n")
+    foreach(shader IN LISTS unit_shaders)
+        string(APPEND content "\nShaderDef BuiltinShader_${shader}()\n{\n    return BuiltinShaders::RetroArch::${shader}();\n}\n")
+    endforeach()
+    write_library_unit(BuiltinShaders${index} "${content}")
+endmacro()
+
+macro(write_preset_unit)
+    list(LENGTH library_units index)
+    list(REMOVE_DUPLICATES unit_shaders)
+    list(REMOVE_DUPLICATES unit_textures)
+    set(content "${BUILTIN_LIBRARY_HEADER}")
+    foreach(shader IN LISTS unit_shaders)
+        string(APPEND content "ShaderDef BuiltinShader_${shader}();\n")
+    endforeach()
+    string(APPEND content "\nnamespace RetroArch\n{\n")
+    foreach(shader IN LISTS unit_shaders)
+        string(APPEND content "class ${shader} : public ShaderDef\n{\npublic:\n    ${shader}() : ShaderDef {BuiltinShader_${shader}()} { }\n};\n\n")
+    endforeach()
+    foreach(texture IN LISTS unit_textures)
+        string(APPEND content "class ${texture} : public TextureDef\n{\npublic:\n    ${texture}() : TextureDef {} { }\n};\n\n")
+    endforeach()
+    string(APPEND content "}\n\n")
+    foreach(preset IN LISTS unit_presets)
+        string(APPEND content "#include \"${library_header_${preset}}\"\n")
+    endforeach()
+    string(APPEND content "\nvoid BuiltinPresets${index}(std::vector<PresetDef*>& presets)\n{\n")
+    foreach(preset IN LISTS unit_presets)
+        string(APPEND content "    presets.push_back(new RetroArch::${preset}());\n")
+    endforeach()
+    string(APPEND content "}\n")
+    write_library_unit(BuiltinPresets${index} "${content}")
+endmacro()
+
+# preset headers are mostly params and overrides, which take about ten times longer to compile than byte code
+set(library_shaders)
+set(unit_size 0)
+set(unit_shaders)
+set(unit_textures)
+set(unit_presets)
+foreach(preset IN LISTS library_presets)
+    set(header "${BUILTIN_LIBRARY_SHADERS}/${library_header_${preset}}")
+    file(READ "${header}" source)
+    string(REGEX MATCHALL "[A-Za-z0-9_]+ShaderDef\\(\\)" shaders "${source}")
+    string(REGEX MATCHALL "[A-Za-z0-9_]+TextureDef\\(\\)" textures "${source}")
+    list(TRANSFORM shaders REPLACE "\\(\\)$" "")
+    list(TRANSFORM textures REPLACE "\\(\\)$" "")
+    foreach(shader IN LISTS shaders)
+        if(NOT library_header_${shader})
+            message(FATAL_ERROR "${header} uses ${shader} which RetroArch.h doesn't include")
+        endif()
+    endforeach()
+
+    file(SIZE "${header}" size)
+    math(EXPR unit_size "${unit_size} + ${size} * 10")
+    list(APPEND library_shaders ${shaders})
+    list(APPEND unit_shaders ${shaders})
+    list(APPEND unit_textures ${textures})
+    list(APPEND unit_presets ${preset})
+    if(unit_size GREATER BUILTIN_LIBRARY_UNIT_SIZE)
+        write_preset_unit()
+        set(unit_size 0)
+        set(unit_shaders)
+        set(unit_textures)
+        set(unit_presets)
+    endif()
+endforeach()
+if(unit_presets)
+    write_preset_unit()
+endif()
+list(LENGTH library_units preset_units)
+
+# every shader any preset uses, once
+list(REMOVE_DUPLICATES library_shaders)
+set(unit_size 0)
+set(unit_shaders)
+foreach(shader IN LISTS library_shaders)
+    file(SIZE "${BUILTIN_LIBRARY_SHADERS}/${library_header_${shader}}" size)
+    math(EXPR unit_size "${unit_size} + ${size}")
+    list(APPEND unit_shaders ${shader})
+    if(unit_size GREATER BUILTIN_LIBRARY_UNIT_SIZE)
+        write_shader_unit()
+        set(unit_size 0)
+        set(unit_shaders)
+    endif()
+endforeach()
+if(unit_shaders)
+    write_shader_unit()
+endif()
+
+set(content "${BUILTIN_LIBRARY_HEADER}")
+math(EXPR last "${preset_units} - 1")
+foreach(index RANGE ${last})
+    string(APPEND content "void BuiltinPresets${index}(std::vector<PresetDef*>& presets);\n")
+endforeach()
+string(APPEND content "\nconst std::vector<PresetDef*>& BuiltinLibrary()\n{\n    static const auto presets = [] {\n        std::vector<PresetDef*> presets;\n")
+foreach(index RANGE ${last})
+    string(APPEND content "        BuiltinPresets${index}(presets);\n")
+endforeach()
+string(APPEND content "        return presets;\n    }();\n    return presets;\n}\n")
+write_library_unit(BuiltinLibrary "${content}")
@@ -0,0 +1,31 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include "PresetDef.h"
+
+// every preset of RetroArch::PresetList, unbuilt and in its order, from sources BuiltinLibrary.cmake generates;
+// their TextureDefs have no data
+const std::vector<PresetDef*>& BuiltinLibrary();
+
+// builds each preset in turn for f(presetDef, shaderDefs) and clears it after, Mega Bezel presets alone take
+// hundreds of MB built
+template<typename F> void ForEachBuiltinPreset(F f)
+{
+    for(auto* presetDef : BuiltinLibrary())
+    {
+        presetDef->Build();
+        std::vector<const ShaderDef*> shaderDefs;
+        for(const auto& shaderDef : presetDef->ShaderDefs)
+            shaderDefs.push_back(&shaderDef);
+        f(*presetDef, shaderDefs);
+        presetDef->ShaderDefs.clear();
+        presetDef->TextureDefs.clear();
+        presetDef->Overrides.clear();
+    }
+}
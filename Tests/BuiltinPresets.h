@@ -0,0 +1,53 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include "PresetDef.h"
+
+// a few presets of the generated library covering the kinds of pass graphs it has, for tests which name them: static
+// chains, FrameCount, history, self, alias and forward feedback; BuiltinLibrary.h has all of them
+#include "RetroArch/anamorphic/shaders/AnamorphicShadersAnamorphicShaderDef.h"
+#include "RetroArch/anamorphic/AnamorphicAnamorphicPresetDef.h"
+#include "RetroArch/anti-aliasing/shaders/AntiAliasingShadersAdvancedAaShaderDef.h"
+#include "RetroArch/interpolation/shaders/InterpolationShadersBicubicXShaderDef.h"
+#include "RetroArch/interpolation/shaders/InterpolationShadersBicubicYShaderDef.h"
+#include "RetroArch/anti-aliasing/AntiAliasingAdvancedAaPresetDef.h"
+#include "RetroArch/auto-box/AutoBoxBoxCenterShaderDef.h"
+#include "RetroArch/border/gameboy-player/BorderGameboyPlayerGameboyPlayerTextureDef.h"
+#include "RetroArch/border/shaders/BorderShadersImgborderGbpShaderDef.h"
+#include "RetroArch/crt/shaders/CrtShadersTvoutTweaksShaderDef.h"
+#include "RetroArch/misc/shaders/MiscShadersImageAdjustmentShaderDef.h"
+#include "RetroArch/border/gameboy-player/BorderGameboyPlayerGameboyPlayerTvoutPresetDef.h"
+#include "RetroArch/motionblur/shaders/MotionblurShadersMix_framesShaderDef.h"
+#include "RetroArch/motionblur/MotionblurMix_framesPresetDef.h"
+#include "RetroArch/motionblur/shaders/MotionblurShadersFeedbackShaderDef.h"
+#include "RetroArch/motionblur/MotionblurFeedbackPresetDef.h"
+#include "RetroArch/border/shaders/autocrop-koko/BorderShadersAutocropKokoAutocrop0_precutShaderDef.h"
+#include "RetroArch/border/shaders/autocrop-koko/BorderShadersAutocropKokoAutocrop1_computeShaderDef.h"
+#include "RetroArch/border/shaders/autocrop-koko/BorderShadersAutocropKokoAutocrop2_displayShaderDef.h"
+#include "RetroArch/border/BorderAutocropKokoPresetDef.h"
+#include "RetroArch/crt/shaders/newpixie/CrtShadersNewpixieAccumulateShaderDef.h"
+#include "RetroArch/crt/shaders/newpixie/CrtShadersNewpixieBlur_horizShaderDef.h"
+#include "RetroArch/crt/shaders/newpixie/CrtShadersNewpixieBlur_vertShaderDef.h"
+#include "RetroArch/crt/shaders/newpixie/CrtShadersNewpixieCrtframeTextureDef.h"
+#include "RetroArch/crt/shaders/newpixie/CrtShadersNewpixieNewpixieCrtShaderDef.h"
+#include "RetroArch/crt/CrtNewpixieCrtPresetDef.h"
+
+// built preset with its pass pointers, as PassChain and the renderer take them
+template<typename T> struct BuiltinPreset
+{
+    BuiltinPreset()
+    {
+        preset.Build();
+        for(const auto& shaderDef : preset.ShaderDefs)
+            shaderDefs.push_back(&shaderDef);
+    }
+
+    T                             preset;
+    std::vector<const ShaderDef*> shaderDefs;
+};
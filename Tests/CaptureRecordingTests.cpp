@@ -0,0 +1,220 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "CaptureRecording.h"
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+
+// recording file named after the running test, removed when done
+struct RecordingFile
+{
+    RecordingFile() :
+        path {std::filesystem::temp_directory_path() / (std::string("ShaderGCTests_") + ::testing::UnitTest::GetInstance()->current_test_info()->name() + ".sgcr")}
+    { }
+
+    ~RecordingFile()
+    {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+
+    std::vector<char> Read() const
+    {
+        std::ifstream file(path, std::ios::binary);
+        return std::vector<char>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    }
+
+    void Write(const std::vector<char>& data) const
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(data.data(), data.size());
+    }
+
+    std::filesystem::path path;
+};
+
+// BGRA8 frame whose every byte depends on the frame and position, rows padded to pitch
+static std::vector<uint8_t> Pixels(uint32_t width, uint32_t height, uint32_t pitch, int frame)
+{
+    std::vector<uint8_t> pixels(static_cast<size_t>(pitch) * height, 0xEE);
+    for(uint32_t y = 0; y < height; y++)
+    {
+        for(uint32_t x = 0; x < width * 4; x++)
+            pixels[y * pitch + x] = static_cast<uint8_t>(frame * 31 + y * 7 + x);
+    }
+    return pixels;
+}
+
+static void ExpectFrame(const CaptureRecording& recording, uint64_t n, uint32_t width, uint32_t height, int frame)
+{
+    CaptureFrame captured;
+    ASSERT_TRUE(recording.Frame(n, captured)) << n;
+    EXPECT_EQ(captured.index, static_cast<uint64_t>(frame));
+    EXPECT_EQ(captured.timestamp, 1000u + frame * 16667u);
+    EXPECT_EQ(captured.width, width);
+    EXPECT_EQ(captured.height, height);
+    const auto expected = Pixels(width, height, width * 4, frame);
+    EXPECT_EQ(std::vector<uint8_t>(captured.pixels, captured.pixels + expected.size()), expected) << n;
+}
+
+static bool Write(CaptureRecording& recording, uint32_t width, uint32_t height, uint32_t pitch, int frame)
+{
+    const auto pixels = Pixels(width, height, pitch, frame);
+    return recording.Write(1000u + frame * 16667u, width, height, pixels.data(), pitch);
+}
+
+TEST(CaptureRecording, SlotBytes)
+{
+    EXPECT_EQ(CaptureRecording::SlotBytes(1, 1), 4096u);
+    EXPECT_EQ(CaptureRecording::SlotBytes(32, 31), 4096u);
+    EXPECT_EQ(CaptureRecording::SlotBytes(32, 32), 8192u);
+    EXPECT_EQ(CaptureRecording::SlotBytes(1920, 1080) % 4096, 0u);
+    EXPECT_GE(CaptureRecording::SlotBytes(1920, 1080), sizeof(CaptureRecording::SlotHeader) + 1920u * 1080u * 4u);
+}
+
+TEST(CaptureRecording, WriteAndReopen)
+{
+    RecordingFile file;
+    {
+        CaptureRecording recording;
+        ASSERT_TRUE(recording.Create(file.path, 4, CaptureRecording::SlotBytes(20, 10)));
+        EXPECT_EQ(recording.Slots(), 4u);
+        EXPECT_EQ(recording.Frames(), 0u);
+
+        // rows are packed whatever the pitch they came with
+        EXPECT_TRUE(Write(recording, 20, 10, 96, 0));
+        EXPECT_TRUE(Write(recording, 16, 8, 64, 1));
+        EXPECT_EQ(recording.Frames(), 2u);
+        ExpectFrame(recording, 0, 20, 10, 0);
+        ExpectFrame(recording, 1, 16, 8, 1);
+    }
+
+    CaptureRecording recording;
+    ASSERT_TRUE(recording.Open(file.path));
+    EXPECT_EQ(recording.Slots(), 4u);
+    ASSERT_EQ(recording.Frames(), 2u);
+    ExpectFrame(recording, 0, 20, 10, 0);
+    ExpectFrame(recording, 1, 16, 8, 1);
+
+    CaptureFrame frame;
+    EXPECT_FALSE(recording.Frame(2, frame));
+
+    // read only
+    EXPECT_FALSE(Write(recording, 16, 8, 64, 2));
+}
+
+TEST(CaptureRecording, RingKeepsLatestFrames)
+{
+    RecordingFile    file;
+    CaptureRecording recording;
+    ASSERT_TRUE(recording.Create(file.path, 3, CaptureRecording::SlotBytes(8, 8)));
+    for(int f = 0; f < 7; f++)
+        ASSERT_TRUE(Write(recording, 8, 8, 32, f));
+
+    ASSERT_EQ(recording.Frames(), 3u);
+    for(int n = 0; n < 3; n++)
+        ExpectFrame(recording, n, 8, 8, 4 + n);
+
+    recording.Close();
+    ASSERT_TRUE(recording.Open(file.path));
+    ASSERT_EQ(recording.Frames(), 3u);
+    ExpectFrame(recording, 0, 8, 8, 4);
+}
+
+TEST(CaptureRecording, OversizedFrameIsSkipped)
+{
+    RecordingFile    file;
+    CaptureRecording recording;
+    ASSERT_TRUE(recording.Create(file.path, 2, CaptureRecording::SlotBytes(8, 8)));
+    ASSERT_TRUE(Write(recording, 8, 8, 32, 0));
+    EXPECT_FALSE(Write(recording, 64, 64, 256, 1));
+    EXPECT_EQ(recording.Frames(), 1u);
+    ExpectFrame(recording, 0, 8, 8, 0);
+}
+
+TEST(CaptureRecording, ReaderSeesFramesWrittenBeforeOpening)
+{
+    RecordingFile    file;
+    CaptureRecording writer;
+    ASSERT_TRUE(writer.Create(file.path, 3, CaptureRecording::SlotBytes(8, 8)));
+    ASSERT_TRUE(Write(writer, 8, 8, 32, 0));
+    ASSERT_TRUE(Write(writer, 8, 8, 32, 1));
+
+    CaptureRecording reader;
+    ASSERT_TRUE(reader.Open(file.path));
+    ASSERT_TRUE(Write(writer, 8, 8, 32, 2));
+    EXPECT_EQ(reader.Frames(), 2u);
+    ExpectFrame(reader, 1, 8, 8, 1);
+
+    // once the writer reuses the slot of a frame the reader knows, that frame reads as damaged
+    ASSERT_TRUE(Write(writer, 8, 8, 32, 3));
+    CaptureFrame frame;
+    EXPECT_FALSE(reader.Frame(0, frame));
+    ExpectFrame(reader, 1, 8, 8, 1);
+}
+
+TEST(CaptureRecording, RejectsDamagedFiles)
+{
+    RecordingFile    file;
+    CaptureRecording recording;
+    EXPECT_FALSE(recording.Open(file.path));
+    EXPECT_FALSE(recording.Create(file.path, 0, CaptureRecording::SlotBytes(8, 8)));
+    EXPECT_FALSE(recording.Create(file.path, 2, sizeof(CaptureRecording::SlotHeader)));
+
+    ASSERT_TRUE(recording.Create(file.path, 2, CaptureRecording::SlotBytes(8, 8)));
+    ASSERT_TRUE(Write(recording, 8, 8, 32, 0));
+    recording.Close();
+    const auto good = file.Read();
+
+    auto damaged = [&](const std::vector<char>& data) {
+        file.Write(data);
+        CaptureRecording opened;
+        return !opened.Open(file.path) && opened.Frames() == 0;
+    };
+
+    EXPECT_TRUE(damaged({}));
+    EXPECT_TRUE(damaged(std::vector<char>(good.begin(), good.begin() + sizeof(CaptureRecording::FileHeader) - 1)));
+    EXPECT_TRUE(damaged(std::vector<char>(good.begin(), good.end() - 1)));
+
+    auto magic = good;
+    magic[0]   = 'X';
+    EXPECT_TRUE(damaged(magic));
+
+    auto version = good;
+    version[4]++;
+    EXPECT_TRUE(damaged(version));
+
+    // more slots than the file holds
+    auto slots = good;
+    slots[8]++;
+    EXPECT_TRUE(damaged(slots));
+
+    // a slot header which doesn't match its frame
+    auto size = good;
+    size[4096 + offsetof(CaptureRecording::SlotHeader, bytes)]++;
+    file.Write(size);
+    ASSERT_TRUE(recording.Open(file.path));
+    ASSERT_EQ(recording.Frames(), 1u);
+    CaptureFrame frame;
+    EXPECT_FALSE(recording.Frame(0, frame));
+    recording.Close();
+
+    auto index = good;
+    index[4096 + offsetof(CaptureRecording::SlotHeader, index)]++;
+    file.Write(index);
+    ASSERT_TRUE(recording.Open(file.path));
+    EXPECT_FALSE(recording.Frame(0, frame));
+    recording.Close();
+
+    file.Write(good);
+    ASSERT_TRUE(recording.Open(file.path));
+    ExpectFrame(recording, 0, 8, 8, 0);
+}
@@ -0,0 +1,155 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "CompileStats.h"
+#include "json.hpp"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+static CompileStats Stats(double glsl, double hlsl)
+{
+    CompileStats stats;
+    stats[CompileStage::GLSL].milliseconds = glsl;
+    stats[CompileStage::HLSL].milliseconds = hlsl;
+    return stats;
+}
+
+TEST(CompileStats, NestedTimers)
+{
+    CompileStats stats;
+    {
+        CompileStats::Scope scope(stats);
+        CompileStats::Timer outer(CompileStage::Preprocess);
+        CompileStats::CountAllocation(10);
+        {
+            CompileStats::Timer inner(CompileStage::GLSL);
+            CompileStats::CountAllocation(100);
+            CompileStats::CountAllocation(200);
+        }
+        // back to the outer stage once the inner one ends
+        CompileStats::CountAllocation(20);
+    }
+
+    EXPECT_EQ(stats[CompileStage::Preprocess].calls, 1);
+    EXPECT_EQ(stats[CompileStage::Preprocess].allocations, 2u);
+    EXPECT_EQ(stats[CompileStage::Preprocess].allocatedBytes, 30u);
+    EXPECT_EQ(stats[CompileStage::GLSL].calls, 1);
+    EXPECT_EQ(stats[CompileStage::GLSL].allocations, 2u);
+    EXPECT_EQ(stats[CompileStage::GLSL].allocatedBytes, 300u);
+    EXPECT_GE(stats[CompileStage::Preprocess].milliseconds, stats[CompileStage::GLSL].milliseconds);
+    EXPECT_EQ(stats[CompileStage::SPIRV].calls, 0);
+    EXPECT_DOUBLE_EQ(stats.TotalMilliseconds(), stats[CompileStage::Preprocess].milliseconds + stats[CompileStage::GLSL].milliseconds);
+}
+
+TEST(CompileStats, ScopesRestore)
+{
+    CompileStats outer;
+    CompileStats inner;
+    {
+        CompileStats::Scope outerScope(outer);
+        {
+            CompileStats::Scope innerScope(inner);
+            CompileStats::Timer timer(CompileStage::HLSL);
+            CompileStats::CountAllocation(5);
+        }
+        CompileStats::Timer timer(CompileStage::HLSL);
+        CompileStats::CountAllocation(7);
+    }
+
+    EXPECT_EQ(inner[CompileStage::HLSL].calls, 1);
+    EXPECT_EQ(inner[CompileStage::HLSL].allocatedBytes, 5u);
+    EXPECT_EQ(outer[CompileStage::HLSL].calls, 1);
+    EXPECT_EQ(outer[CompileStage::HLSL].allocatedBytes, 7u);
+
+    // nothing is collected outside of a Scope, nor outside of a Timer
+    {
+        CompileStats::Timer timer(CompileStage::HLSL);
+        CompileStats::CountAllocation(9);
+    }
+    {
+        CompileStats::Scope scope(outer);
+        CompileStats::CountAllocation(9);
+    }
+    EXPECT_EQ(outer[CompileStage::HLSL].calls, 1);
+    EXPECT_EQ(outer[CompileStage::HLSL].allocatedBytes, 7u);
+    EXPECT_EQ(inner[CompileStage::HLSL].allocatedBytes, 5u);
+}
+
+TEST(CompileStats, Median)
+{
+    // per stage, so the median of each can come from a different run
+    const auto median = CompileStats::Median({Stats(3, 10), Stats(1, 30), Stats(2, 20), Stats(100, 5), Stats(4, 1000)});
+    EXPECT_DOUBLE_EQ(median[CompileStage::GLSL].milliseconds, 3.0);
+    EXPECT_DOUBLE_EQ(median[CompileStage::HLSL].milliseconds, 20.0);
+    EXPECT_DOUBLE_EQ(CompileStats::Median({}).TotalMilliseconds(), 0.0);
+}
+
+TEST(CompileStats, Percentiles)
+{
+    std::vector<double> values;
+    for(int i = 100; i > 0; i--)
+        values.push_back(i);
+    EXPECT_DOUBLE_EQ(CompileReport::Percentile(values, 0.5), 51.0);
+    EXPECT_DOUBLE_EQ(CompileReport::Percentile(values, 0.9), 91.0);
+    EXPECT_DOUBLE_EQ(CompileReport::Percentile(values, 0.99), 100.0);
+    EXPECT_DOUBLE_EQ(CompileReport::Percentile(values, 1.0), 100.0);
+    EXPECT_DOUBLE_EQ(CompileReport::Percentile({7.0}, 0.5), 7.0);
+    EXPECT_DOUBLE_EQ(CompileReport::Percentile({}, 0.5), 0.0);
+}
+
+TEST(CompileStats, Report)
+{
+    CompileReport report;
+    report.compiler = "test";
+    report.runs     = 3;
+    report.jobs     = 1;
+    report.shaders.push_back({"a.slang", {}, Stats(1, 2)});
+    report.shaders.push_back({"b.slang", "SPIR-V conversion error", Stats(1000, 1000)});
+    report.shaders.push_back({"c.slang", {}, Stats(3, 4)});
+    report.shaders[2].stats[CompileStage::HLSL].allocations    = 12;
+    report.shaders[2].stats[CompileStage::HLSL].allocatedBytes = 345;
+
+    std::ostringstream out;
+    report.WriteJson(out);
+    const auto json = nlohmann::json::parse(out.str());
+    EXPECT_EQ(json["compiler"], "test");
+    EXPECT_EQ(json["runs"], 3);
+    EXPECT_NE(json["allocations"].get<std::string>().find("partial"), std::string::npos);
+
+    // shaders which failed are listed but left out of the summary
+    EXPECT_DOUBLE_EQ(json["summary"]["glsl"]["p50"].get<double>(), 3.0);
+    EXPECT_DOUBLE_EQ(json["summary"]["glsl"]["max"].get<double>(), 3.0);
+    EXPECT_DOUBLE_EQ(json["summary"]["glsl"]["sum"].get<double>(), 4.0);
+    EXPECT_DOUBLE_EQ(json["summary"]["total"]["sum"].get<double>(), 10.0);
+    EXPECT_DOUBLE_EQ(json["summary"]["spirv"]["max"].get<double>(), 0.0);
+    ASSERT_EQ(json["shaders"].size(), 3u);
+    EXPECT_FALSE(json["shaders"][0].contains("error"));
+    EXPECT_EQ(json["shaders"][1]["error"], "SPIR-V conversion error");
+    EXPECT_EQ(json["shaders"][2]["path"], "c.slang");
+    EXPECT_EQ(json["shaders"][2]["hlsl"]["allocations"], 12);
+    EXPECT_EQ(json["shaders"][2]["hlsl"]["bytes"], 345);
+    EXPECT_DOUBLE_EQ(json["shaders"][2]["total_ms"].get<double>(), 7.0);
+
+    std::stringstream csv;
+    report.WriteCsv(csv);
+    std::vector<std::string> lines;
+    for(std::string line; std::getline(csv, line);)
+        lines.push_back(line);
+    ASSERT_EQ(lines.size(), 4u);
+    EXPECT_EQ(lines[0].substr(0, 34), "shader,preprocess_ms,preprocess_al");
+    EXPECT_EQ(lines[2].substr(lines[2].size() - 2), ",1");
+    EXPECT_EQ(lines[3], "c.slang,0,0,0,3,0,0,0,0,0,4,12,345,0,0,0,7,");
+
+    std::ostringstream summary;
+    report.WriteSummary(summary);
+    EXPECT_NE(summary.str().find("total"), std::string::npos);
+    EXPECT_NE(summary.str().find("allocations are partial"), std::string::npos);
+}
@@ -0,0 +1,54 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "FrontEndStub.h"
+#include "GLSL.h"
+#include "SPIRV.h"
+
+#include <atomic>
+#include <cstring>
+
+static std::atomic<size_t> sCompiles {0};
+
+std::vector<uint32_t> GLSL::GenerateSPIRV(const char* source, bool, std::ostream&, bool&)
+{
+    if(strstr(source, "BROKEN"))
+        throw std::runtime_error("GLSL error: BROKEN");
+    sCompiles++;
+
+    const auto            length = strlen(source);
+    std::vector<uint32_t> words((length + 3) / 4);
+    memcpy(words.data(), source, length);
+    return words;
+}
+
+std::pair<std::string, std::string> SPIRV::GenerateHLSL(const std::vector<uint32_t>&, bool reflect, std::ostream&, bool&)
+{
+    return std::make_pair(std::string(reflect ? FrontEndStub::FragmentHLSL : FrontEndStub::VertexHLSL), std::string("{}"));
+}
+
+size_t FrontEndStub::Compiles()
+{
+    return sCompiles;
+}
+
+const ShaderCache& FrontEndStub::Cache()
+{
+    static const std::vector<uint32_t> vertexHash   = ShaderCache::CalculateHash(VertexHLSL);
+    static const std::vector<uint32_t> fragmentHash = ShaderCache::CalculateHash(FragmentHLSL);
+    static const std::vector<uint8_t>  vertexDXBC {'D', 'X', 'B', 'C', 'v'};
+    static const std::vector<uint8_t>  fragmentDXBC {'D', 'X', 'B', 'C', 'f'};
+    static const ShaderCache           cache = [] {
+        ShaderCache c;
+        c.m_cachedShaders.emplace_back(vertexHash.data(), vertexDXBC.data(), vertexDXBC.size());
+        c.m_cachedShaders.emplace_back(fragmentHash.data(), fragmentDXBC.data(), fragmentDXBC.size());
+        return c;
+    }();
+    return cache;
+}
@@ -0,0 +1,25 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include "ShaderCache.h"
+
+// stands in for glslang and SPIRV-Cross, which are prebuilt for Windows only: GLSL::GenerateSPIRV throws for
+// sources containing BROKEN and otherwise packs them into words, SPIRV::GenerateHLSL gives the same HLSL for
+// every shader of a stage with nothing reflected; DXBC of that HLSL is in Cache so HLSL is never compiled
+class FrontEndStub
+{
+public:
+    // GLSL sources compiled so far, two per pass
+    static size_t Compiles();
+
+    static const ShaderCache& Cache();
+
+    static constexpr const char* VertexHLSL   = "float4 main() : SV_Position { return 0; }";
+    static constexpr const char* FragmentHLSL = "float4 main() : SV_Target { return 1; }";
+};
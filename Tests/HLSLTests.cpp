@@ -0,0 +1,42 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "HLSL.h"
+
+#include <gtest/gtest.h>
+
+TEST(HLSL, SelectsOnlyBuiltCompilers)
+{
+    EXPECT_FALSE(HLSL::SelectCompiler("dxc"));
+    EXPECT_FALSE(HLSL::SelectCompiler(""));
+#ifdef _WIN32
+    EXPECT_STREQ(HLSL::CompilerName(), "fxc");
+    EXPECT_TRUE(HLSL::SelectCompiler("fxc"));
+#else
+    EXPECT_FALSE(HLSL::SelectCompiler("fxc"));
+#endif
+#ifdef SHADERGC_VKD3D
+    EXPECT_TRUE(HLSL::SelectCompiler("vkd3d"));
+    EXPECT_STREQ(HLSL::CompilerName(), "vkd3d");
+#endif
+}
+
+#if !defined(_WIN32) && !defined(SHADERGC_VKD3D)
+TEST(HLSL, ThrowsWithoutCompiler)
+{
+    // a failed selection keeps the current compiler, here none
+    EXPECT_FALSE(HLSL::SelectCompiler("vkd3d"));
+    EXPECT_STREQ(HLSL::CompilerName(), "none");
+
+    std::ostringstream log;
+    bool               warn     = false;
+    const char         source[] = "float4 main() : SV_Target { return 0; }";
+    EXPECT_THROW(HLSL::CompileHLSL(source, sizeof(source) - 1, "ps_5_0", log, warn), std::runtime_error);
+}
+#endif
@@ -0,0 +1,83 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "HistoryRing.h"
+
+#include <gtest/gtest.h>
+
+TEST(HistoryRing, WithoutHistoryAlwaysFirstSlot)
+{
+    HistoryRing ring;
+    EXPECT_EQ(ring.Size(), 1);
+    for(int f = 0; f < 3; f++)
+    {
+        ring.Advance();
+        EXPECT_EQ(ring.Slot(0), 0);
+        EXPECT_EQ(ring.Slot(5), 0);
+    }
+}
+
+TEST(HistoryRing, SlotsFollowFrames)
+{
+    // slot a frame is rendered to is the one OriginalHistoryN reads N frames later
+    HistoryRing ring;
+    ring.Resize(3);
+    ASSERT_EQ(ring.Size(), 4);
+
+    std::vector<int> rendered;
+    for(int f = 0; f < 10; f++)
+    {
+        ring.Advance();
+        rendered.push_back(ring.Slot(0));
+        for(int age = 0; age < ring.Size() && age <= f; age++)
+            EXPECT_EQ(ring.Slot(age), rendered[f - age]) << "frame " << f << " age " << age;
+    }
+}
+
+TEST(HistoryRing, SlotsAreDistinct)
+{
+    HistoryRing ring;
+    ring.Resize(5);
+    for(int f = 0; f < 7; f++)
+    {
+        ring.Advance();
+        std::vector<bool> used(ring.Size());
+        for(int age = 0; age < ring.Size(); age++)
+        {
+            const auto slot = ring.Slot(age);
+            ASSERT_GE(slot, 0);
+            ASSERT_LT(slot, ring.Size());
+            EXPECT_FALSE(used[slot]);
+            used[slot] = true;
+        }
+    }
+}
+
+TEST(HistoryRing, DeeperThanRingClamps)
+{
+    // a shader sampling deeper history than the ring was sized for gets the oldest frame kept
+    HistoryRing ring;
+    ring.Resize(2);
+    ring.Advance();
+    ring.Advance();
+    EXPECT_EQ(ring.Slot(7), ring.Slot(2));
+}
+
+TEST(HistoryRing, ResizeRestarts)
+{
+    HistoryRing ring;
+    ring.Resize(2);
+    ring.Advance();
+    ring.Resize(4);
+    EXPECT_EQ(ring.Size(), 5);
+    EXPECT_EQ(ring.Slot(0), 0);
+    ring.Advance();
+    EXPECT_EQ(ring.Slot(0), 1);
+    EXPECT_EQ(ring.Slot(1), 0);
+}
@@ -0,0 +1,380 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "LibraryIndex.h"
+#include "FrontEndStub.h"
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+
+static const char* sPreset = "shaders = 1\nshader0 = shaders/crt.slang\nscale_type0 = viewport\ntextures = \"mask\"\nmask = mask.png\nGAMMA = 2.4\n";
+
+static std::string Shader(const char* body)
+{
+    return std::string("#version 450\n#include \"inc.h\"\n#pragma parameter GAMMA \"Gamma\" 2.2 1.0 3.0 0.1\n#pragma stage vertex\nvoid main() {}\n"
+                       "#pragma stage fragment\nvoid main() { ") +
+           body + " }\n";
+}
+
+// folder of presets named after the running test, removed when done: a/crt compiles, b/crt references it with
+// another GAMMA, c/broken doesn't compile and d/missing names a shader which isn't there
+struct LibraryFolder
+{
+    LibraryFolder() :
+        root {std::filesystem::temp_directory_path() / (std::string("ShaderGCTests_") + ::testing::UnitTest::GetInstance()->current_test_info()->name())}
+    {
+        std::filesystem::remove_all(root);
+        Write("a/crt.slangp", sPreset);
+        Write("a/shaders/crt.slang", Shader("a"));
+        Write("a/shaders/inc.h", "// include v1\n");
+        Write("a/mask.png", std::string("\x89PNG\r\n\x1a\n", 8) + "pixels");
+        Write("b/crt.slangp", "#reference \"../a/crt.slangp\"\nGAMMA = 2.0\n");
+        Write("c/broken.slangp", "shaders = 1\nshader0 = broken.slang\n");
+        Write("c/broken.slang", Shader("BROKEN"));
+        Write("c/inc.h", "\n");
+        Write("d/missing.slangp", "shaders = 1\nshader0 = nothere.slang\n");
+        Write("d/readme.txt", "not a preset");
+    }
+
+    ~LibraryFolder()
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(root, ec);
+    }
+
+    void Write(const char* file, const std::string& contents) const
+    {
+        std::filesystem::create_directories((root / file).parent_path());
+        std::ofstream(root / file, std::ios::binary | std::ios::trunc) << contents;
+    }
+
+    // rewritten with the same contents a second later
+    void Touch(const char* file) const
+    {
+        const auto mtime = std::filesystem::last_write_time(root / file);
+        std::filesystem::last_write_time(root / file, mtime + std::chrono::seconds(1));
+    }
+
+    std::filesystem::path Path(const char* file) const
+    {
+        return (root / file).lexically_normal();
+    }
+
+    std::vector<char> Read(const char* file) const
+    {
+        std::ifstream infile(root / file, std::ios::binary);
+        return std::vector<char>((std::istreambuf_iterator<char>(infile)), std::istreambuf_iterator<char>());
+    }
+
+    void Write(const char* file, const std::vector<char>& data) const
+    {
+        std::ofstream(root / file, std::ios::binary | std::ios::trunc).write(data.data(), data.size());
+    }
+
+    std::filesystem::path root;
+};
+
+static LibraryImport Import(LibraryIndex& index, const LibraryFolder& folder, unsigned jobs = 4)
+{
+    return index.ImportDirectory(folder.root, jobs, FrontEndStub::Cache());
+}
+
+static std::vector<uint8_t> Serialized(const LibraryIndex& index, const std::filesystem::path& path)
+{
+    std::unique_ptr<PresetDef> presetDef(index.Preset(path));
+    return presetDef ? LibraryIndex::Serialize(*presetDef) : std::vector<uint8_t>();
+}
+
+static std::vector<std::filesystem::path> Relative(const std::vector<LibraryDependency>& dependencies, const LibraryFolder& folder)
+{
+    std::vector<std::filesystem::path> paths;
+    for(const auto& dependency : dependencies)
+        paths.push_back(dependency.path.lexically_relative(folder.root));
+    return paths;
+}
+
+TEST(LibraryIndex, ImportDirectory)
+{
+    LibraryFolder folder;
+    LibraryIndex  index;
+    size_t        calls = 0;
+    const auto    result = index.ImportDirectory(folder.root, 4, FrontEndStub::Cache(), [&](size_t done, size_t total) {
+        calls++;
+        EXPECT_EQ(done, calls);
+        EXPECT_EQ(total, 4u);
+    });
+    EXPECT_EQ(calls, 4u);
+    EXPECT_EQ(result.scanned, 4u);
+    EXPECT_EQ(result.unchanged, 0u);
+    EXPECT_EQ(result.compiled, 2u);
+    EXPECT_EQ(result.failed, 2u);
+    EXPECT_EQ(result.removed, 0u);
+    EXPECT_EQ(result.changed, (std::vector<std::filesystem::path> {folder.Path("a/crt.slangp"), folder.Path("b/crt.slangp")}));
+    EXPECT_EQ(result.errors, (std::vector<std::filesystem::path> {folder.Path("c/broken.slangp"), folder.Path("d/missing.slangp")}));
+    EXPECT_EQ(index.Size(), 4u);
+
+    // bulk imported presets are named after their folder
+    std::unique_ptr<PresetDef> a(index.Preset(folder.Path("a/crt.slangp")));
+    ASSERT_NE(a, nullptr);
+    EXPECT_EQ(a->Name, "a/crt.slangp");
+    ASSERT_EQ(a->ShaderDefs.size(), 1u);
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(a->ShaderDefs[0].FragmentByteCode), a->ShaderDefs[0].FragmentLength), "DXBCf");
+    EXPECT_EQ(a->ShaderDefs[0].PresetParams["scale_type"], "viewport");
+    ASSERT_EQ(a->TextureDefs.size(), 1u);
+    EXPECT_EQ(a->TextureDefs[0].PresetParams["name"], "mask");
+    EXPECT_EQ(a->TextureDefs[0].DataLength, 14);
+    EXPECT_TRUE(a->ShaderDefs[0].Dynamic && a->TextureDefs[0].Dynamic);
+
+    std::unique_ptr<PresetDef> b(index.Preset(folder.Path("b/crt.slangp")));
+    ASSERT_NE(b, nullptr);
+    ASSERT_EQ(b->Overrides.size(), 1u);
+    EXPECT_EQ(b->Overrides[0].name, "GAMMA");
+    EXPECT_EQ(b->Overrides[0].value, 2.0f);
+
+    EXPECT_EQ(index.Preset(folder.Path("c/broken.slangp")), nullptr);
+    EXPECT_NE(index.Error(folder.Path("c/broken.slangp")).find("BROKEN"), std::string::npos);
+    EXPECT_FALSE(index.Error(folder.Path("d/missing.slangp")).empty());
+    EXPECT_TRUE(index.Error(folder.Path("a/crt.slangp")).empty());
+}
+
+TEST(LibraryIndex, Dependencies)
+{
+    LibraryFolder folder;
+    const auto    dependencies = LibraryIndex::Dependencies(folder.Path("b/crt.slangp"));
+    EXPECT_EQ(Relative(dependencies, folder),
+              (std::vector<std::filesystem::path> {"b/crt.slangp", "a/crt.slangp", "a/shaders/crt.slang", "a/shaders/inc.h", "a/mask.png"}));
+    for(const auto& dependency : dependencies)
+    {
+        EXPECT_NE(dependency.mtime, 0) << dependency.path;
+        EXPECT_EQ(dependency.size, std::filesystem::file_size(dependency.path)) << dependency.path;
+    }
+
+    // a missing file is recorded so that creating it counts as a change
+    const auto missing = LibraryIndex::Dependencies(folder.Path("d/missing.slangp"));
+    EXPECT_EQ(Relative(missing, folder), (std::vector<std::filesystem::path> {"d/missing.slangp", "d/nothere.slang"}));
+    EXPECT_EQ(missing.back().mtime, 0);
+    EXPECT_EQ(missing.back().size, 0u);
+
+    // hashes contents only, and tells a missing file from an empty one
+    auto touched = dependencies;
+    touched[0].mtime++;
+    EXPECT_EQ(LibraryIndex::Hash(touched), LibraryIndex::Hash(dependencies));
+    const auto hash = LibraryIndex::Hash(missing);
+    folder.Write("d/nothere.slang", "");
+    EXPECT_NE(LibraryIndex::Hash(missing), hash);
+}
+
+TEST(LibraryIndex, SerializeRoundTrip)
+{
+    LibraryFolder folder;
+    LibraryIndex  index;
+    Import(index, folder);
+    const auto serialized = Serialized(index, folder.Path("b/crt.slangp"));
+    ASSERT_FALSE(serialized.empty());
+
+    std::unique_ptr<PresetDef> presetDef(LibraryIndex::Deserialize(serialized.data(), serialized.size()));
+    ASSERT_NE(presetDef, nullptr);
+    EXPECT_EQ(LibraryIndex::Serialize(*presetDef), serialized);
+
+    // cut anywhere it's rejected rather than read past its end
+    for(size_t length = 0; length < serialized.size(); length++)
+        EXPECT_EQ(std::unique_ptr<PresetDef>(LibraryIndex::Deserialize(serialized.data(), length)), nullptr) << length;
+}
+
+TEST(LibraryIndex, SaveAndLoad)
+{
+    LibraryFolder folder;
+    LibraryIndex  index;
+    Import(index, folder);
+    ASSERT_TRUE(index.Save(folder.root / "index.sgl"));
+    EXPECT_FALSE(std::filesystem::exists(folder.root / "index.sgl.tmp"));
+
+    LibraryIndex loaded;
+    ASSERT_TRUE(loaded.Load(folder.root / "index.sgl"));
+    ASSERT_EQ(loaded.Paths(), index.Paths());
+    for(const auto& path : index.Paths())
+    {
+        EXPECT_EQ(loaded.Error(path), index.Error(path)) << path;
+        EXPECT_EQ(Serialized(loaded, path), Serialized(index, path)) << path;
+    }
+
+    // nothing compiles again, including what failed
+    const auto compiles = FrontEndStub::Compiles();
+    const auto result   = Import(loaded, folder);
+    EXPECT_EQ(result.unchanged, 4u);
+    EXPECT_EQ(result.compiled + result.failed + result.removed, 0u);
+    EXPECT_EQ(FrontEndStub::Compiles(), compiles);
+
+    EXPECT_FALSE(loaded.Load(folder.root / "nothing.sgl"));
+    EXPECT_EQ(loaded.Size(), 0u);
+}
+
+// where damage to a saved index is most likely to slip through: each field of the header, both ends of every entry
+// (found by the path it starts with), the hash at the end and the last byte, rather than every byte of the index
+static std::vector<size_t> Offsets(const std::vector<char>& data, const LibraryIndex& index)
+{
+    std::vector<size_t> offsets {0, 3, 4, 7, 8, 11};
+    for(const auto& path : index.Paths())
+    {
+        const auto utf8  = path.u8string();
+        const auto found = std::search(data.begin(), data.end(), utf8.begin(), utf8.end(), [](char a, char8_t b) { return a == static_cast<char>(b); });
+        if(found == data.end())
+        {
+            ADD_FAILURE() << path;
+            continue;
+        }
+        const auto start = static_cast<size_t>(found - data.begin());
+        offsets.insert(offsets.end(), {start - 5, start - 4, start, start + utf8.size() - 1});
+    }
+    const auto hash = data.size() - HASH_LEN * sizeof(uint32_t);
+    offsets.insert(offsets.end(), {hash - 1, hash, data.size() - 1});
+    std::sort(offsets.begin(), offsets.end());
+    offsets.erase(std::unique(offsets.begin(), offsets.end()), offsets.end());
+    return offsets;
+}
+
+TEST(LibraryIndex, RejectsTruncatedIndex)
+{
+    LibraryFolder folder;
+    LibraryIndex  index;
+    Import(index, folder);
+    ASSERT_TRUE(index.Save(folder.root / "index.sgl"));
+    const auto good = folder.Read("index.sgl");
+
+    for(auto length : Offsets(good, index))
+    {
+        folder.Write("cut.sgl", std::vector<char>(good.begin(), good.begin() + length));
+        LibraryIndex loaded;
+        Import(loaded, folder);
+        EXPECT_FALSE(loaded.Load(folder.root / "cut.sgl")) << length;
+        EXPECT_EQ(loaded.Size(), 0u) << length;
+    }
+}
+
+TEST(LibraryIndex, RejectsBitFlips)
+{
+    LibraryFolder folder;
+    LibraryIndex  index;
+    Import(index, folder);
+    ASSERT_TRUE(index.Save(folder.root / "index.sgl"));
+    const auto good = folder.Read("index.sgl");
+
+    // a flip in mtimes, hashes or byte code would still parse, the hash at the end catches those too
+    for(auto offset : Offsets(good, index))
+    {
+        auto flipped = good;
+        flipped[offset] ^= static_cast<char>(1 << (offset % 8));
+        folder.Write("flipped.sgl", flipped);
+        LibraryIndex loaded;
+        EXPECT_FALSE(loaded.Load(folder.root / "flipped.sgl")) << offset;
+        EXPECT_EQ(loaded.Size(), 0u) << offset;
+    }
+
+    folder.Write("flipped.sgl", good);
+    LibraryIndex loaded;
+    EXPECT_TRUE(loaded.Load(folder.root / "flipped.sgl"));
+}
+
+TEST(LibraryIndex, RescanTouchedFiles)
+{
+    LibraryFolder folder;
+    LibraryIndex  index;
+    Import(index, folder);
+
+    // new mtime, same contents: settled from the hash and not looked at again
+    folder.Touch("a/crt.slangp");
+    folder.Touch("a/shaders/inc.h");
+    EXPECT_TRUE(index.Current(folder.Path("a/crt.slangp")));
+    const auto compiles = FrontEndStub::Compiles();
+    auto       result   = Import(index, folder);
+    EXPECT_EQ(result.unchanged, 4u);
+    EXPECT_EQ(FrontEndStub::Compiles(), compiles);
+
+    ASSERT_TRUE(index.Save(folder.root / "index.sgl"));
+    LibraryIndex loaded;
+    ASSERT_TRUE(loaded.Load(folder.root / "index.sgl"));
+    EXPECT_TRUE(loaded.Current(folder.Path("b/crt.slangp")));
+    EXPECT_FALSE(loaded.Current(folder.Path("e/new.slangp")));
+}
+
+TEST(LibraryIndex, RescanRecompilesDependents)
+{
+    LibraryFolder folder;
+    LibraryIndex  index;
+    Import(index, folder);
+    const auto before = Serialized(index, folder.Path("a/crt.slangp"));
+
+    // both presets include it, the ones in c and d don't
+    folder.Write("a/shaders/inc.h", "// include v2\n");
+    EXPECT_FALSE(index.Current(folder.Path("a/crt.slangp")));
+    EXPECT_FALSE(index.Current(folder.Path("b/crt.slangp")));
+    EXPECT_TRUE(index.Current(folder.Path("c/broken.slangp")));
+
+    const auto compiles = FrontEndStub::Compiles();
+    const auto result   = Import(index, folder, 1);
+    EXPECT_EQ(result.unchanged, 2u);
+    EXPECT_EQ(result.compiled, 2u);
+    EXPECT_EQ(result.failed, 0u);
+    EXPECT_EQ(result.changed, (std::vector<std::filesystem::path> {folder.Path("a/crt.slangp"), folder.Path("b/crt.slangp")}));
+    EXPECT_EQ(FrontEndStub::Compiles(), compiles + 4);
+    EXPECT_EQ(Serialized(index, folder.Path("a/crt.slangp")), before);
+    EXPECT_TRUE(index.Current(folder.Path("a/crt.slangp")));
+}
+
+TEST(LibraryIndex, RescanFixedAndRemovedFiles)
+{
+    LibraryFolder folder;
+    LibraryIndex  index;
+    Import(index, folder);
+
+    folder.Write("c/broken.slang", Shader("fixed"));
+    std::filesystem::remove(folder.root / "d/missing.slangp");
+    folder.Write("e/new.slangp", "#reference \"../a/crt.slangp\"\n");
+
+    const auto result = Import(index, folder);
+    EXPECT_EQ(result.scanned, 4u);
+    EXPECT_EQ(result.unchanged, 2u);
+    EXPECT_EQ(result.compiled, 2u);
+    EXPECT_EQ(result.failed, 0u);
+    EXPECT_EQ(result.removed, 1u);
+    EXPECT_EQ(result.changed, (std::vector<std::filesystem::path> {folder.Path("c/broken.slangp"), folder.Path("e/new.slangp")}));
+    EXPECT_TRUE(index.Error(folder.Path("c/broken.slangp")).empty());
+    EXPECT_NE(std::unique_ptr<PresetDef>(index.Preset(folder.Path("c/broken.slangp"))), nullptr);
+    EXPECT_EQ(index.Size(), 4u);
+
+}
+
+TEST(LibraryIndex, ImportSingleFile)
+{
+    LibraryFolder      folder;
+    LibraryIndex       index;
+    std::ostringstream log;
+    bool               warn = false;
+
+    // imported one by one it's named after the file, unless it's part of a bulk import already
+    std::unique_ptr<PresetDef> single(index.Import(folder.root / "a" / "shaders" / ".." / "crt.slangp", log, warn, FrontEndStub::Cache()));
+    ASSERT_NE(single, nullptr);
+    EXPECT_EQ(single->Name, "crt.slangp");
+    EXPECT_TRUE(index.Current(folder.Path("a/crt.slangp")));
+    EXPECT_EQ(index.Paths(), std::vector<std::filesystem::path> {folder.Path("a/crt.slangp")});
+
+    Import(index, folder);
+    single.reset(index.Import(folder.Path("b/crt.slangp"), log, warn, FrontEndStub::Cache()));
+    EXPECT_EQ(single->Name, "b/crt.slangp");
+    EXPECT_EQ(Import(index, folder).unchanged, 4u);
+
+    // a file which no longer compiles leaves the index
+    folder.Write("a/shaders/crt.slang", Shader("BROKEN"));
+    EXPECT_THROW(index.Import(folder.Path("a/crt.slangp"), log, warn, FrontEndStub::Cache()), std::exception);
+    EXPECT_EQ(index.Preset(folder.Path("a/crt.slangp")), nullptr);
+    EXPECT_EQ(index.Size(), 3u);
+    EXPECT_THROW(index.Import(folder.Path("nothing.slangp"), log, warn, FrontEndStub::Cache()), std::exception);
+    EXPECT_EQ(index.Size(), 3u);
+}
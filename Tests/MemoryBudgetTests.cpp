@@ -0,0 +1,227 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "MemoryBudget.h"
+
+#include <gtest/gtest.h>
+
+static const uint64_t sInput    = 640 * 360 * 4;
+static const uint64_t sViewport = 1920 * 1080 * 4;
+
+static ShaderDef Pass(const std::vector<const char*>& samplers)
+{
+    ShaderDef shaderDef;
+    for(auto sampler : samplers)
+        shaderDef.Samplers.push_back(ShaderSampler(sampler, 0));
+    return shaderDef;
+}
+
+// PNG signature and IHDR chunk of an image of given size
+static std::vector<uint8_t> Png(uint32_t width, uint32_t height)
+{
+    std::vector<uint8_t> png {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n', 0, 0, 0, 13, 'I', 'H', 'D', 'R'};
+    for(auto value : {width, height})
+    {
+        for(int shift = 24; shift >= 0; shift -= 8)
+            png.push_back(static_cast<uint8_t>(value >> shift));
+    }
+    png.insert(png.end(), {8, 6, 0, 0, 0});
+    return png;
+}
+
+// a viewport-sized pass reading one frame of history, then the final pass
+static PresetDef HistoryPreset()
+{
+    PresetDef presetDef;
+    presetDef.ShaderDefs.push_back(Pass({"Source", "OriginalHistory1"}));
+    presetDef.ShaderDefs.back().Param("scale_type", "viewport");
+    presetDef.ShaderDefs.push_back(Pass({"Source"}));
+    return presetDef;
+}
+
+static MemoryPlan Plan(const PresetDef& presetDef, uint64_t budget, float passScale = 1.0f)
+{
+    return MemoryBudget::Plan(presetDef, 640, 360, 1920, 1080, passScale, budget);
+}
+
+TEST(MemoryBudget, FormatBytes)
+{
+    EXPECT_EQ(MemoryBudget::FormatBytes("R8G8B8A8_UNORM"), 4);
+    EXPECT_EQ(MemoryBudget::FormatBytes("R8G8B8A8_SRGB"), 4);
+    EXPECT_EQ(MemoryBudget::FormatBytes("R16G16B16A16_SFLOAT"), 8);
+    EXPECT_EQ(MemoryBudget::FormatBytes("R32G32B32A32_SFLOAT"), 16);
+    EXPECT_EQ(MemoryBudget::FormatBytes("A2B10G10R10_UNORM_PACK32"), 4);
+    EXPECT_EQ(MemoryBudget::FormatBytes("R8_UNORM"), 1);
+    EXPECT_EQ(MemoryBudget::FormatBytes(""), 4);
+}
+
+TEST(MemoryBudget, ImageSize)
+{
+    auto png    = Png(320, 200);
+    int  width  = 0;
+    int  height = 0;
+    ASSERT_TRUE(MemoryBudget::ImageSize(png.data(), png.size(), width, height));
+    EXPECT_EQ(width, 320);
+    EXPECT_EQ(height, 200);
+
+    EXPECT_FALSE(MemoryBudget::ImageSize(nullptr, 0, width, height));
+    EXPECT_FALSE(MemoryBudget::ImageSize(png.data(), 23, width, height));
+    auto chunk = png;
+    chunk[12]  = 'X';
+    EXPECT_FALSE(MemoryBudget::ImageSize(chunk.data(), chunk.size(), width, height));
+    auto empty = Png(0, 200);
+    EXPECT_FALSE(MemoryBudget::ImageSize(empty.data(), empty.size(), width, height));
+}
+
+TEST(MemoryBudget, PredictByKind)
+{
+    const auto presetDef = HistoryPreset();
+    const auto footprint = MemoryBudget::Predict(presetDef, 640, 360, 1920, 1080);
+    EXPECT_EQ(footprint.Kind(MemoryKind::Original), sInput);
+    EXPECT_EQ(footprint.Kind(MemoryKind::History), sInput);
+    EXPECT_EQ(footprint.Kind(MemoryKind::PassOutput), sViewport);
+    EXPECT_EQ(footprint.Kind(MemoryKind::PassFeedback), 0u);
+    EXPECT_EQ(footprint.Kind(MemoryKind::Texture), 0u);
+    EXPECT_EQ(footprint.Total(), sInput * 2 + sViewport);
+    ASSERT_EQ(footprint.passes.size(), 2u);
+    EXPECT_EQ(footprint.passes[0], sViewport);
+    EXPECT_EQ(footprint.passes[1], 0u);
+
+    // the final pass renders to the swap chain
+    EXPECT_EQ(MemoryBudget::Predict(presetDef, 640, 360, 1920, 1080, 0.5f, false).Total(), sInput + sViewport / 4);
+    EXPECT_EQ(MemoryBudget::Predict(PresetDef(), 640, 360, 1920, 1080).Total(), 0u);
+}
+
+TEST(MemoryBudget, PredictFeedbackTexturesAndStaticChains)
+{
+    // a float pass feeding back into itself, and a LUT sampled only by a pass nothing reads
+    const auto lut = Png(64, 16);
+    PresetDef  presetDef;
+    presetDef.ShaderDefs.push_back(Pass({"Source", "PassFeedback0"}));
+    presetDef.ShaderDefs.back().Param("float_framebuffer", "true");
+    presetDef.ShaderDefs.push_back(Pass({"Source", "LUT"}));
+    presetDef.ShaderDefs.push_back(Pass({"PassOutput0", "BORDER"}));
+    for(auto name : {"LUT", "BORDER"})
+    {
+        presetDef.TextureDefs.push_back(TextureDef());
+        presetDef.TextureDefs.back().Data       = lut.data();
+        presetDef.TextureDefs.back().DataLength = lut.size();
+        presetDef.TextureDefs.back().Param("name", name);
+    }
+
+    auto footprint = MemoryBudget::Predict(presetDef, 640, 360, 1920, 1080);
+    EXPECT_EQ(footprint.Kind(MemoryKind::PassFeedback), 640u * 360u * 8u * 2u);
+    EXPECT_EQ(footprint.Kind(MemoryKind::PassOutput), 0u);
+    EXPECT_EQ(footprint.Kind(MemoryKind::Texture), 64u * 16u * 4u);
+    EXPECT_EQ(footprint.Kind(MemoryKind::History), 0u);
+
+    // a chain with nothing varying still draws its last pass to the swap chain
+    PresetDef staticDef;
+    staticDef.ShaderDefs.push_back(Pass({"Source"}));
+    staticDef.ShaderDefs.push_back(Pass({"Source"}));
+    footprint = MemoryBudget::Predict(staticDef, 640, 360, 1920, 1080);
+    EXPECT_EQ(footprint.Kind(MemoryKind::PassOutput), sInput);
+}
+
+TEST(MemoryBudget, PlanEachLevel)
+{
+    const auto presetDef = HistoryPreset();
+    ASSERT_EQ(MemoryBudget::Levels(), 5);
+
+    // 0: everything, 1 and 2: smaller passes, 3: no history, 4: quarter size passes
+    const uint64_t totals[] = {sInput * 2 + sViewport, sInput * 2 + sViewport * 9 / 16, sInput * 2 + sViewport / 4, sInput + sViewport / 4, sInput + sViewport / 16};
+    for(int level = 0; level < MemoryBudget::Levels(); level++)
+    {
+        // the footprint of a level is exactly what fits it
+        const auto plan = Plan(presetDef, totals[level]);
+        EXPECT_EQ(plan.level, level);
+        EXPECT_TRUE(plan.fits);
+        EXPECT_EQ(plan.passScale, MemoryBudget::Level(level).passScale);
+        EXPECT_EQ(plan.history, MemoryBudget::Level(level).history);
+        EXPECT_EQ(plan.footprint.Total(), totals[level]) << level;
+        EXPECT_EQ(plan.footprint.Total(), MemoryBudget::Predict(presetDef, 640, 360, 1920, 1080, plan.passScale, plan.history).Total());
+
+        // a byte less goes a level further
+        const auto over = Plan(presetDef, totals[level] - 1);
+        EXPECT_EQ(over.level, std::min(level + 1, MemoryBudget::Levels() - 1));
+        EXPECT_EQ(over.fits, level + 1 < MemoryBudget::Levels());
+    }
+
+    // levels only get cheaper
+    for(int level = 1; level < MemoryBudget::Levels(); level++)
+        EXPECT_LT(totals[level], totals[level - 1]);
+}
+
+TEST(MemoryBudget, PlanWithoutBudget)
+{
+    const auto plan = Plan(HistoryPreset(), 0);
+    EXPECT_EQ(plan.level, 0);
+    EXPECT_TRUE(plan.fits);
+    EXPECT_TRUE(plan.history);
+    EXPECT_EQ(plan.footprint.Total(), sInput * 2 + sViewport);
+}
+
+TEST(MemoryBudget, PlanStartsFromQualityScale)
+{
+    // quality control already halved the passes, so level 0 fits what level 2 would otherwise
+    const auto plan = Plan(HistoryPreset(), sInput * 2 + sViewport / 4, 0.5f);
+    EXPECT_EQ(plan.level, 0);
+    EXPECT_EQ(plan.passScale, 1.0f);
+    EXPECT_EQ(plan.footprint.Kind(MemoryKind::PassOutput), sViewport / 4);
+}
+
+TEST(MemoryLedger, TracksLiveAndPeak)
+{
+    MemoryLedger ledger;
+    ledger.SetPreset("first");
+    {
+        auto texture = ledger.Allocate(MemoryKind::Texture, -1, 1000);
+        auto output  = ledger.Allocate(MemoryKind::PassOutput, 1, 300);
+        EXPECT_EQ(ledger.Live(), 1300u);
+
+        auto moved = std::move(output);
+        output.Release();
+        EXPECT_EQ(ledger.Live(), 1300u);
+        moved.Release();
+        EXPECT_EQ(ledger.Live(), 1000u);
+        EXPECT_EQ(ledger.Peak(), 1300u);
+    }
+    EXPECT_EQ(ledger.Live(), 0u);
+    EXPECT_EQ(ledger.Peak(), 1300u);
+    ledger.ResetPeak();
+    EXPECT_EQ(ledger.Peak(), 0u);
+}
+
+TEST(MemoryLedger, FootprintByPreset)
+{
+    MemoryLedger ledger;
+    ledger.SetPreset("first");
+    auto shared = ledger.Allocate(MemoryKind::Original, -1, 100);
+    auto pass   = ledger.Allocate(MemoryKind::PassOutput, 2, 40);
+
+    // the next preset keeps the input texture
+    ledger.SetPreset("second");
+    shared.Adopt();
+    auto feedback = ledger.Allocate(MemoryKind::PassFeedback, 0, 8);
+
+    const auto first = ledger.Footprint("first");
+    EXPECT_EQ(first.Total(), 40u);
+    ASSERT_EQ(first.passes.size(), 3u);
+    EXPECT_EQ(first.passes[2], 40u);
+
+    const auto second = ledger.Footprint("second");
+    EXPECT_EQ(second.Kind(MemoryKind::Original), 100u);
+    EXPECT_EQ(second.Kind(MemoryKind::PassFeedback), 8u);
+    EXPECT_EQ(ledger.Footprint().Total(), 148u);
+
+    EXPECT_EQ(ledger.Budget(), 0u);
+    ledger.SetBudget(1 << 20);
+    EXPECT_EQ(ledger.Budget(), 1u << 20);
+    EXPECT_STREQ(MemoryLedger::KindName(MemoryKind::PassFeedback), "pass_feedback");
+}
@@ -0,0 +1,143 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "Metrics.h"
+#include "json.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <thread>
+
+template<typename D> static std::vector<uint64_t> Sample(D distribution, size_t samples)
+{
+    std::mt19937_64       random(1);
+    std::vector<uint64_t> values(samples);
+    for(auto& v : values)
+        v = static_cast<uint64_t>(distribution(random));
+    return values;
+}
+
+// percentiles of known distributions are within half a bucket of the exact ones
+static void ExpectPercentiles(std::vector<uint64_t> values)
+{
+    MetricHistogram histogram;
+    for(auto v : values)
+        histogram.Record(v);
+    const auto snapshot = histogram.Snapshot();
+    EXPECT_EQ(snapshot.count, values.size());
+
+    std::sort(values.begin(), values.end());
+    EXPECT_EQ(snapshot.max, values.back());
+    for(auto q : {0.5, 0.9, 0.99, 0.999})
+    {
+        const auto exact = values[static_cast<size_t>(std::ceil(q * values.size())) - 1];
+        const auto value = snapshot.Percentile(q);
+        EXPECT_LE(std::fabs(static_cast<double>(value) - exact), exact / (2.0 * MetricHistogram::SubBuckets) + 0.5) << q;
+    }
+}
+
+TEST(Metrics, CounterAndGauge)
+{
+    MetricsRegistry registry;
+    registry.Counter("frames").Add();
+    registry.Counter("frames").Add(2);
+    registry.Gauge("queue").Set(5);
+    registry.Gauge("queue").Add(-7);
+    EXPECT_EQ(registry.Counter("frames").Value(), 3u);
+    EXPECT_EQ(registry.Gauge("queue").Value(), -2);
+    EXPECT_EQ(&registry.Histogram("latency"), &registry.Histogram("latency"));
+}
+
+TEST(Metrics, Buckets)
+{
+    // exact below SubBuckets, contiguous and at most 1/SubBuckets of their value wide above
+    for(uint64_t v = 0; v < MetricHistogram::SubBuckets; v++)
+        EXPECT_EQ(MetricHistogram::BucketIndex(v), static_cast<int>(v));
+    for(int i = 1; i < MetricHistogram::Buckets; i++)
+    {
+        EXPECT_EQ(MetricHistogram::BucketLow(i), MetricHistogram::BucketHigh(i - 1) + 1) << i;
+        EXPECT_EQ(MetricHistogram::BucketIndex(MetricHistogram::BucketLow(i)), i);
+        EXPECT_EQ(MetricHistogram::BucketIndex(MetricHistogram::BucketHigh(i)), i);
+        EXPECT_LE(MetricHistogram::BucketHigh(i) - MetricHistogram::BucketLow(i), MetricHistogram::BucketLow(i) / MetricHistogram::SubBuckets);
+    }
+    EXPECT_EQ(MetricHistogram::BucketHigh(MetricHistogram::Buckets - 1), MetricHistogram::MaxValue);
+    EXPECT_EQ(MetricHistogram::BucketIndex(~0ull), MetricHistogram::Buckets - 1);
+}
+
+TEST(Metrics, Percentiles)
+{
+    const size_t samples = 200000;
+    ExpectPercentiles(Sample(std::uniform_int_distribution<uint64_t>(0, 20000), samples));
+    ExpectPercentiles(Sample(std::lognormal_distribution<double>(8.5, 0.3), samples));
+    ExpectPercentiles(Sample(std::exponential_distribution<double>(1.0 / 5000), samples));
+    ExpectPercentiles(Sample(std::lognormal_distribution<double>(6.0, 3.0), samples));
+}
+
+TEST(Metrics, EmptyAndOverflow)
+{
+    MetricHistogram histogram;
+    EXPECT_EQ(histogram.Snapshot().Percentile(0.5), 0u);
+    EXPECT_EQ(histogram.Snapshot().Mean(), 0.0);
+
+    histogram.Record(~0ull);
+    histogram.Record(3);
+    const auto snapshot = histogram.Snapshot();
+    EXPECT_EQ(snapshot.max, MetricHistogram::MaxValue);
+    EXPECT_EQ(snapshot.Percentile(0.5), 3u);
+    EXPECT_LE(snapshot.Percentile(1.0), MetricHistogram::MaxValue);
+    EXPECT_GE(snapshot.Percentile(1.0), MetricHistogram::MaxValue - MetricHistogram::MaxValue / (2 * MetricHistogram::SubBuckets));
+}
+
+TEST(Metrics, RecordsFromThreads)
+{
+    MetricsRegistry registry;
+    auto&           counter   = registry.Counter("counter");
+    auto&           histogram = registry.Histogram("histogram");
+
+    const int                threads = 4;
+    const uint64_t           calls   = 100000;
+    std::vector<std::thread> workers;
+    for(int t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&, t]() {
+            for(uint64_t i = 0; i < calls; i++)
+            {
+                counter.Add();
+                histogram.Record(t * calls + i);
+            }
+        });
+    }
+    for(auto& w : workers)
+        w.join();
+
+    const auto snapshot = histogram.Snapshot();
+    EXPECT_EQ(counter.Value(), threads * calls);
+    EXPECT_EQ(snapshot.count, threads * calls);
+    EXPECT_EQ(snapshot.max, threads * calls - 1);
+    EXPECT_EQ(snapshot.sum, threads * calls * (threads * calls - 1) / 2);
+}
+
+TEST(Metrics, WriteJson)
+{
+    MetricsRegistry registry;
+    registry.Counter("capture.frames").Add(10);
+    registry.Gauge("queue \"depth\"").Set(-1);
+    for(uint64_t v = 1; v <= 100; v++)
+        registry.Histogram("latency").Record(v);
+
+    std::ostringstream out;
+    registry.Snapshot().WriteJson(out);
+    const auto json = nlohmann::json::parse(out.str());
+    EXPECT_EQ(json["counters"]["capture.frames"], 10);
+    EXPECT_EQ(json["gauges"]["queue \"depth\""], -1);
+    EXPECT_EQ(json["histograms"]["latency"]["count"], 100);
+    EXPECT_EQ(json["histograms"]["latency"]["max"], 100);
+    EXPECT_EQ(json["histograms"]["latency"]["p50"], 50);
+}
@@ -0,0 +1,172 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "NullRenderer.h"
+#include "BuiltinPresets.h"
+
+#include <gtest/gtest.h>
+
+using namespace RetroArch;
+
+static ShaderDef Pass(const std::vector<const char*>& samplers)
+{
+    ShaderDef shaderDef;
+    for(size_t s = 0; s < samplers.size(); s++)
+        shaderDef.Samplers.push_back(ShaderSampler(samplers[s], static_cast<int>(s) + 1));
+    return shaderDef;
+}
+
+static std::vector<uint64_t> Counts(const NullDevice& device)
+{
+    std::vector<uint64_t> counts;
+    for(int c = 0; c < static_cast<int>(NullCall::Count); c++)
+        counts.push_back(device.Calls(static_cast<NullCall>(c)));
+    return counts;
+}
+
+TEST(NullDevice, MapKeepsContents)
+{
+    NullDevice device;
+    auto       first  = device.CreateBuffer(16);
+    auto       second = device.CreateBuffer(64);
+    EXPECT_NE(first, second);
+    EXPECT_NE(device.CreateTexture(), device.CreateTexture());
+
+    static_cast<uint8_t*>(device.Map(first))[15] = 42;
+    device.Unmap(first);
+    static_cast<uint8_t*>(device.Map(second))[0] = 7;
+    device.Unmap(second);
+    EXPECT_EQ(static_cast<uint8_t*>(device.Map(first))[15], 42);
+    device.Unmap(first);
+
+    EXPECT_EQ(device.Calls(NullCall::Map), 3u);
+    EXPECT_EQ(device.Calls(NullCall::Unmap), 3u);
+    EXPECT_EQ(device.MappedBytes(), 16u + 64u + 16u);
+}
+
+TEST(NullDevice, Counts)
+{
+    NullDevice device;
+    device.Call(NullCall::Draw);
+    device.Call(NullCall::SetShader, 2);
+    EXPECT_EQ(device.Calls(NullCall::Draw), 1u);
+    EXPECT_EQ(device.Calls(NullCall::SetShader), 2u);
+    EXPECT_EQ(device.Calls(NullCall::SetSampler), 0u);
+    EXPECT_EQ(device.TotalCalls(), 3u);
+
+    device.Map(device.CreateBuffer(32));
+    device.ResetCounts();
+    EXPECT_EQ(device.TotalCalls(), 0u);
+    EXPECT_EQ(device.MappedBytes(), 0u);
+
+    EXPECT_STREQ(NullDevice::CallName(NullCall::Map), "Map");
+    EXPECT_STREQ(NullDevice::CallName(NullCall::SetConstantBuffer), "SetConstantBuffer");
+    EXPECT_STREQ(NullDevice::CallName(NullCall::Draw), "Draw");
+}
+
+TEST(ShaderParams, SetByName)
+{
+    // SourceSize is in both buffers
+    ShaderDef shaderDef;
+    shaderDef.Params.push_back(ShaderParam("SourceSize", 0, 0, 16, 0.0f, 0.0f, 0.0f));
+    shaderDef.Params.push_back(ShaderParam("SourceSize", -1, 4, 16, 0.0f, 0.0f, 0.0f));
+    shaderDef.Params.push_back(ShaderParam("strength", -1, 0, 4, 0.0f, 1.0f, 0.5f));
+    ShaderParams params(shaderDef);
+    EXPECT_EQ(params.BufferSize(UBO_BUFFER), 16u);
+    EXPECT_EQ(params.BufferSize(PUSH_BUFFER), 20u);
+
+    float push[5];
+    params.FillParams(PUSH_BUFFER, push);
+    EXPECT_FLOAT_EQ(push[0], 0.5f);
+
+    float size[4] = {640, 360, 1.0f / 640, 1.0f / 360};
+    EXPECT_TRUE(params.SetParam("SourceSize", size));
+    EXPECT_FALSE(params.SetParam("SourceSize", size));
+    float ubo[4];
+    params.FillParams(UBO_BUFFER, ubo);
+    params.FillParams(PUSH_BUFFER, push);
+    EXPECT_FLOAT_EQ(ubo[1], 360.0f);
+    EXPECT_FLOAT_EQ(push[2], 360.0f);
+
+    ShaderParams copy(shaderDef);
+    copy.CopyParams(params);
+    EXPECT_FALSE(copy.SetParam("SourceSize", size));
+}
+
+TEST(NullRenderer, CallsPerPass)
+{
+    // pass 1 is never read, the first pass maps its UBO and push constants, the last has no params
+    PresetDef presetDef;
+    presetDef.ShaderDefs.push_back(Pass({"Source", "LUT", "missing"}));
+    presetDef.ShaderDefs.back().Params.push_back(ShaderParam("MVP", 0, 0, 64, 0.0f, 0.0f, 0.0f));
+    presetDef.ShaderDefs.back().Params.push_back(ShaderParam("FrameCount", -1, 0, 4, 0.0f, 0.0f, 0.0f));
+    presetDef.ShaderDefs.push_back(Pass({"Source"}));
+    presetDef.ShaderDefs.push_back(Pass({"PassOutput0", "Original", "PassFeedback2"}));
+    presetDef.TextureDefs.push_back(TextureDef());
+    presetDef.TextureDefs.back().Param("name", "LUT");
+
+    NullRenderer renderer(presetDef);
+    renderer.Render(640, 360, 1920, 1080);
+    const auto& device = renderer.Device();
+    EXPECT_EQ(device.Calls(NullCall::Draw), 2u);
+    EXPECT_EQ(device.Calls(NullCall::Map), 2u);
+    EXPECT_EQ(device.Calls(NullCall::Unmap), 2u);
+    EXPECT_EQ(device.MappedBytes(), 64u + 16u);
+    EXPECT_EQ(device.Calls(NullCall::SetViewport), 2u);
+    EXPECT_EQ(device.Calls(NullCall::SetRenderTarget), 4u);
+    EXPECT_EQ(device.Calls(NullCall::SetInputAssembler), 6u);
+    EXPECT_EQ(device.Calls(NullCall::SetShader), 4u);
+    EXPECT_EQ(device.Calls(NullCall::SetConstantBuffer), 4u);
+
+    // every sampler is set, resources only for what resolves and unbound again after the draw
+    EXPECT_EQ(device.Calls(NullCall::SetSampler), 6u);
+    EXPECT_EQ(device.Calls(NullCall::SetShaderResource), 2u * (2u + 3u));
+}
+
+TEST(NullRenderer, SameCallsEveryFrame)
+{
+    BuiltinPreset<CrtNewpixieCrtPresetDef> newpixie;
+    NullRenderer                           renderer(newpixie.preset);
+
+    size_t samplers = 0;
+    for(const auto* shaderDef : newpixie.shaderDefs)
+        samplers += shaderDef->Samplers.size();
+
+    renderer.Render(640, 360, 1920, 1080);
+    const auto first       = Counts(renderer.Device());
+    const auto firstMapped = renderer.Device().MappedBytes();
+    EXPECT_EQ(renderer.Device().Calls(NullCall::Draw), newpixie.shaderDefs.size());
+    EXPECT_EQ(renderer.Device().Calls(NullCall::SetSampler), samplers);
+
+    // feedback of blur_horiz and the frame texture resolve too
+    EXPECT_EQ(renderer.Device().Calls(NullCall::SetShaderResource), 2 * samplers);
+
+    for(int f = 0; f < 10; f++)
+    {
+        renderer.Device().ResetCounts();
+        renderer.SetParam("acc_modulate", 0.5f);
+        renderer.Render(640, 360, 1920, 1080);
+        EXPECT_EQ(Counts(renderer.Device()), first);
+        EXPECT_EQ(renderer.Device().MappedBytes(), firstMapped);
+    }
+}
+
+TEST(NullRenderer, HistoryAndResize)
+{
+    BuiltinPreset<MotionblurMix_framesPresetDef> mixFrames;
+    NullRenderer                                 renderer(mixFrames.preset);
+    renderer.Render(640, 360, 1920, 1080);
+    const auto first = Counts(renderer.Device());
+    EXPECT_EQ(renderer.Device().Calls(NullCall::SetShaderResource), 2 * mixFrames.shaderDefs[0]->Samplers.size());
+
+    // a different input or viewport size doesn't change what's bound
+    renderer.Device().ResetCounts();
+    renderer.Render(320, 240, 800, 600);
+    EXPECT_EQ(Counts(renderer.Device()), first);
+}
@@ -0,0 +1,102 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "ObjectCache.h"
+
+#include <gtest/gtest.h>
+
+// stands in for the device, counts what would be created on it
+struct CountingDevice
+{
+    int Create()
+    {
+        return ++created;
+    }
+
+    int created {0};
+};
+
+TEST(ObjectCache, SharesByKey)
+{
+    CountingDevice   device;
+    ObjectCache<int> cache(2);
+    auto             create = [&] { return device.Create(); };
+
+    auto a     = cache.Acquire("a", create, 100);
+    auto sameA = cache.Acquire("a", create, 100);
+    auto b     = cache.Acquire("b", create, 50);
+    EXPECT_EQ(a, sameA);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(device.created, 2);
+    EXPECT_EQ(cache.Hits(), 1u);
+    EXPECT_EQ(cache.Misses(), 2u);
+    EXPECT_EQ(cache.Bytes(), 150u);
+}
+
+TEST(ObjectCache, KeepsReferencedObjects)
+{
+    CountingDevice   device;
+    ObjectCache<int> cache(0);
+    auto             create = [&] { return device.Create(); };
+
+    auto a = cache.Acquire("a", create);
+    cache.Acquire("b", create);
+    cache.Trim();
+    EXPECT_EQ(cache.Size(), 1u);
+
+    // a is still referenced so it isn't created again
+    EXPECT_EQ(cache.Acquire("a", create), a);
+    EXPECT_EQ(device.created, 2);
+
+    a.reset();
+    cache.Trim();
+    EXPECT_EQ(cache.Size(), 0u);
+}
+
+TEST(ObjectCache, EvictsLeastRecentlyUsed)
+{
+    CountingDevice   device;
+    ObjectCache<int> cache(2);
+    auto             create = [&] { return device.Create(); };
+
+    auto referenced = cache.Acquire("a", create, 1);
+    cache.Acquire("b", create, 2);
+    cache.Acquire("c", create, 4);
+    cache.Acquire("d", create, 8);
+    cache.Acquire("b", create, 2);
+
+    // c is the oldest unreferenced one, b was used again after it
+    cache.Trim();
+    EXPECT_EQ(cache.Size(), 3u);
+    EXPECT_EQ(cache.Bytes(), 11u);
+    cache.Acquire("b", create);
+    cache.Acquire("d", create);
+    EXPECT_EQ(device.created, 4);
+    cache.Acquire("c", create, 4);
+    EXPECT_EQ(device.created, 5);
+}
+
+TEST(ObjectCache, TrimWithinCapacityKeepsAll)
+{
+    CountingDevice   device;
+    ObjectCache<int> cache(4);
+    auto             create = [&] { return device.Create(); };
+
+    for(auto key : {"a", "b", "c"})
+        cache.Acquire(key, create, 10);
+    cache.Trim();
+    EXPECT_EQ(cache.Size(), 3u);
+    EXPECT_EQ(cache.Bytes(), 30u);
+
+    cache.Clear();
+    EXPECT_EQ(cache.Size(), 0u);
+    EXPECT_EQ(cache.Bytes(), 0u);
+    cache.Acquire("a", create);
+    EXPECT_EQ(device.created, 4);
+}
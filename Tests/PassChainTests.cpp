@@ -0,0 +1,98 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "PassChain.h"
+
+#include <gtest/gtest.h>
+
+TEST(PassChain, DefaultOptions)
+{
+    ShaderDef  shaderDef;
+    const auto options = PassChain::Options(shaderDef);
+    EXPECT_EQ(options.shaderDef, &shaderDef);
+    EXPECT_EQ(options.format, "R8G8B8A8_UNORM");
+    EXPECT_EQ(options.scaleX, 1.0f);
+    EXPECT_FALSE(options.viewportX || options.viewportY || options.absoluteX || options.absoluteY);
+    EXPECT_FALSE(options.linear);
+    EXPECT_FALSE(options.clamp);
+    EXPECT_TRUE(options.alias.empty());
+}
+
+TEST(PassChain, PresetOptions)
+{
+    ShaderDef shaderDef;
+    shaderDef.Param("filter_linear", "1").Param("srgb_framebuffer", "true").Param("scale_type_x", "absolute").Param("scale_x", "320");
+    shaderDef.Param("scale_type_y", "viewport").Param("scale_y", "0.5").Param("alias", "First").Param("framecount_mod", "60").Param("wrap_mode", "clamp_to_edge");
+    const auto options = PassChain::Options(shaderDef);
+    EXPECT_TRUE(options.linear);
+    EXPECT_EQ(options.format, "R8G8B8A8_SRGB");
+    EXPECT_TRUE(options.absoluteX);
+    EXPECT_FALSE(options.viewportX);
+    EXPECT_TRUE(options.viewportY);
+    EXPECT_EQ(options.scaleX, 320.0f);
+    EXPECT_EQ(options.scaleY, 0.5f);
+    EXPECT_EQ(options.alias, "First");
+    EXPECT_EQ(options.frameCountMod, 60);
+    EXPECT_TRUE(options.clamp);
+}
+
+TEST(PassChain, FormatPrecedence)
+{
+    // float beats srgb and an explicit format beats both
+    ShaderDef shaderDef;
+    shaderDef.Param("srgb_framebuffer", "true").Param("float_framebuffer", "true");
+    EXPECT_EQ(PassChain::Options(shaderDef).format, "R16G16B16A16_SFLOAT");
+
+    char format[] = "R32G32B32A32_SFLOAT";
+    shaderDef.Format = format;
+    EXPECT_EQ(PassChain::Options(shaderDef).format, "R32G32B32A32_SFLOAT");
+}
+
+TEST(PassChain, ScaleTypeAppliesToBoth)
+{
+    ShaderDef shaderDef;
+    shaderDef.Param("scale_type_x", "viewport").Param("scale_type", "absolute").Param("scale", "2");
+    const auto options = PassChain::Options(shaderDef);
+    EXPECT_TRUE(options.absoluteX && options.absoluteY);
+    EXPECT_FALSE(options.viewportX || options.viewportY);
+    EXPECT_EQ(options.scaleX, 2.0f);
+    EXPECT_EQ(options.scaleY, 2.0f);
+}
+
+TEST(PassChain, Sizes)
+{
+    // source scaled, then absolute, the last pass always fills the viewport
+    PresetDef presetDef;
+    presetDef.ShaderDefs.push_back(ShaderDef());
+    presetDef.ShaderDefs.back().Param("scale", "2");
+    presetDef.ShaderDefs.push_back(ShaderDef());
+    presetDef.ShaderDefs.back().Param("scale_type", "absolute").Param("scale_x", "100").Param("scale_y", "50");
+    presetDef.ShaderDefs.push_back(ShaderDef());
+    presetDef.ShaderDefs.back().Param("scale_type", "viewport").Param("scale", "0.5");
+    presetDef.ShaderDefs.push_back(ShaderDef());
+
+    PassChain chain(presetDef);
+    EXPECT_TRUE(chain.Resize(320, 240, 1920, 1080));
+    EXPECT_FALSE(chain.Resize(320, 240, 1920, 1080));
+    const auto& passes = chain.Passes();
+    EXPECT_EQ(passes[0].width, 640);
+    EXPECT_EQ(passes[0].height, 480);
+    EXPECT_EQ(passes[1].width, 100);
+    EXPECT_EQ(passes[1].height, 50);
+    EXPECT_EQ(passes[2].width, 960);
+    EXPECT_EQ(passes[2].height, 540);
+    EXPECT_EQ(passes[3].width, 1920);
+    EXPECT_EQ(passes[3].height, 1080);
+
+    // pass scale only shrinks viewport-scaled intermediate passes
+    EXPECT_TRUE(chain.Resize(320, 240, 1920, 1080, 0.5f));
+    EXPECT_EQ(passes[0].width, 640);
+    EXPECT_EQ(passes[2].width, 480);
+    EXPECT_EQ(passes[3].width, 1920);
+}
@@ -0,0 +1,322 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "PassGraph.h"
+#include "BuiltinPresets.h"
+#include "BuiltinLibrary.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+using namespace RetroArch;
+
+// pass with the given samplers and params, without byte code so all declared params count as used
+static ShaderDef Pass(const std::vector<const char*>& samplers, const std::vector<const char*>& params = {}, const char* alias = nullptr)
+{
+    ShaderDef shaderDef;
+    for(auto sampler : samplers)
+        shaderDef.Samplers.push_back(ShaderSampler(sampler, 0));
+    for(auto param : params)
+        shaderDef.Params.push_back(ShaderParam(param, -1, 0, 4, 0.0f, 1.0f, 0.0f));
+    if(alias)
+        shaderDef.Param("alias", alias);
+    return shaderDef;
+}
+
+static std::vector<const ShaderDef*> Pointers(const std::vector<ShaderDef>& shaderDefs)
+{
+    std::vector<const ShaderDef*> pointers;
+    for(const auto& shaderDef : shaderDefs)
+        pointers.push_back(&shaderDef);
+    return pointers;
+}
+
+TEST(PassGraph, StaticChainIsNeverVariant)
+{
+    BuiltinPreset<AnamorphicAnamorphicPresetDef> anamorphic;
+    PassGraph                                    single(anamorphic.shaderDefs);
+    EXPECT_EQ(single.FirstVariantPass(), 1);
+    EXPECT_TRUE(single.DeadPasses().empty());
+    EXPECT_TRUE(single.OriginalOnlyInFirstPass());
+
+    BuiltinPreset<AntiAliasingAdvancedAaPresetDef> advancedAa;
+    PassGraph                                      chain(advancedAa.shaderDefs);
+    ASSERT_EQ(chain.Nodes().size(), 3u);
+    EXPECT_EQ(chain.FirstVariantPass(), 3);
+    EXPECT_TRUE(chain.DeadPasses().empty());
+    EXPECT_EQ(chain.Nodes()[1].inputs, std::vector<int> {0});
+    EXPECT_EQ(chain.Nodes()[2].inputs, std::vector<int> {1});
+}
+
+TEST(PassGraph, FrameCountMakesPassVariant)
+{
+    // image-adjustment animates film grain
+    BuiltinPreset<BorderGameboyPlayerGameboyPlayerTvoutPresetDef> tvout;
+    PassGraph                                                     graph(tvout.shaderDefs);
+    ASSERT_EQ(graph.Nodes().size(), 4u);
+    EXPECT_FALSE(graph.Nodes()[0].variant);
+    EXPECT_FALSE(graph.Nodes()[1].variant);
+    EXPECT_TRUE(graph.Nodes()[2].frameCount);
+    EXPECT_TRUE(graph.Nodes()[3].variant);
+    EXPECT_EQ(graph.FirstVariantPass(), 2);
+    EXPECT_TRUE(graph.Nodes()[0].original);
+}
+
+TEST(PassGraph, HistoryMakesPassVariant)
+{
+    BuiltinPreset<MotionblurMix_framesPresetDef> mixFrames;
+    PassGraph                                    graph(mixFrames.shaderDefs);
+    ASSERT_EQ(graph.Nodes().size(), 1u);
+    EXPECT_EQ(graph.Nodes()[0].history, 1);
+    EXPECT_EQ(graph.FirstVariantPass(), 0);
+    EXPECT_FALSE(graph.OriginalOnlyInFirstPass());
+}
+
+TEST(PassGraph, SelfFeedback)
+{
+    BuiltinPreset<MotionblurFeedbackPresetDef> feedback;
+    PassGraph                                  graph(feedback.shaderDefs);
+    ASSERT_EQ(graph.Nodes().size(), 1u);
+    EXPECT_TRUE(graph.Nodes()[0].fedBack);
+    EXPECT_EQ(graph.Nodes()[0].feedbacks, std::vector<int> {0});
+    EXPECT_EQ(graph.FirstVariantPass(), 0);
+}
+
+TEST(PassGraph, FeedbackKeepsLaterPassLive)
+{
+    // accumulate samples blur_horiz of the previous frame, which no pass reads otherwise
+    BuiltinPreset<CrtNewpixieCrtPresetDef> newpixie;
+    PassGraph                              graph(newpixie.shaderDefs);
+    ASSERT_EQ(graph.Nodes().size(), 4u);
+    EXPECT_EQ(graph.Nodes()[0].feedbacks, std::vector<int> {1});
+    EXPECT_TRUE(graph.Nodes()[1].fedBack);
+    EXPECT_TRUE(graph.DeadPasses().empty());
+    EXPECT_EQ(graph.FirstVariantPass(), 0);
+}
+
+TEST(PassGraph, AliasedFeedback)
+{
+    BuiltinPreset<BorderAutocropKokoPresetDef> autocrop;
+    PassGraph                                  graph(autocrop.shaderDefs);
+    ASSERT_EQ(graph.Nodes().size(), 3u);
+    auto feedbacks = graph.Nodes()[1].feedbacks;
+    std::sort(feedbacks.begin(), feedbacks.end());
+    EXPECT_EQ(feedbacks, (std::vector<int> {0, 1}));
+    EXPECT_TRUE(graph.Nodes()[0].fedBack);
+    EXPECT_TRUE(graph.Nodes()[1].fedBack);
+    EXPECT_FALSE(graph.Nodes()[2].fedBack);
+    EXPECT_EQ(graph.FirstVariantPass(), 1);
+}
+
+TEST(PassGraph, FindLivePasses)
+{
+    // the final pass reads pass 0 and pass 2 by its alias, passes 1 and 3 are never read
+    std::vector<ShaderDef> shaderDefs {Pass({"Source"}),
+                                       Pass({"Source"}, {"FrameCount"}),
+                                       Pass({"PassOutput0"}, {}, "third"),
+                                       Pass({"PassOutput1"}),
+                                       Pass({"PassOutput0", "third"})};
+    PassGraph              graph(Pointers(shaderDefs));
+    EXPECT_EQ(graph.DeadPasses(), (std::vector<int> {1, 3}));
+    EXPECT_EQ(graph.Nodes()[4].inputs, (std::vector<int> {0, 2}));
+
+    // the only variant pass is dead, so the chain is static
+    EXPECT_EQ(graph.FirstVariantPass(), 5);
+
+    // samplers of dead passes don't count
+    EXPECT_TRUE(graph.Samples("PassOutput0"));
+    EXPECT_FALSE(graph.Samples("PassOutput1"));
+}
+
+TEST(PassGraph, FirstAffectedPass)
+{
+    BuiltinPreset<BorderGameboyPlayerGameboyPlayerTvoutPresetDef> tvout;
+    PassGraph                                                     graph(tvout.shaderDefs);
+    EXPECT_EQ(graph.FirstAffectedPass({"BORDER"}), 0);
+    EXPECT_EQ(graph.FirstAffectedPass({"ia_saturation"}), 2);
+    EXPECT_EQ(graph.FirstAffectedPass({"ia_saturation", "BORDER"}), 0);
+    EXPECT_EQ(graph.FirstAffectedPass({"no_such_param"}), 4);
+    EXPECT_EQ(graph.FirstAffectedPass({}), 4);
+
+    BuiltinPreset<CrtNewpixieCrtPresetDef> newpixie;
+    PassGraph                              crt(newpixie.shaderDefs);
+    EXPECT_EQ(crt.FirstAffectedPass({"blur_y"}), 2);
+    EXPECT_EQ(crt.FirstAffectedPass({"frametexture"}), 3);
+}
+
+TEST(PassGraph, UsedParamsAreDeclared)
+{
+    BuiltinPreset<BorderGameboyPlayerGameboyPlayerTvoutPresetDef> tvout;
+    for(const auto* shaderDef : tvout.shaderDefs)
+    {
+        for(const auto& used : PassGraph::UsedParams(*shaderDef))
+        {
+            EXPECT_TRUE(std::any_of(shaderDef->Params.begin(), shaderDef->Params.end(), [&](const ShaderParam& p) { return p.name == used; })) << used;
+        }
+    }
+}
+
+TEST(PassGraph, UsedParamsReadByteCode)
+{
+    // accumulate declares the usual size and FrameCount members but its compiled shaders don't read them
+    BuiltinPreset<CrtNewpixieCrtPresetDef> newpixie;
+    EXPECT_EQ(PassGraph::UsedParams(*newpixie.shaderDefs[0]), (std::vector<std::string> {"MVP", "acc_modulate"}));
+
+    // box-center declares FrameCount too, which would make the chain variant from its pass on
+    BuiltinPreset<BorderGameboyPlayerGameboyPlayerTvoutPresetDef> tvout;
+    PassGraph                                                     graph(tvout.shaderDefs);
+    EXPECT_FALSE(graph.Nodes()[3].frameCount);
+    EXPECT_TRUE(graph.Nodes()[2].frameCount);
+}
+
+TEST(PassGraph, UsedParamsWithoutByteCode)
+{
+    // imported shaders whose byte code can't be parsed count every declared param
+    auto shaderDef = Pass({"Source"}, {"MVP", "FrameCount", "strength"});
+    EXPECT_EQ(PassGraph::UsedParams(shaderDef), (std::vector<std::string> {"MVP", "FrameCount", "strength"}));
+}
+
+TEST(PassGraph, ParamChangeKeepsEarlierOutputs)
+{
+    // a param of the bicubic passes only re-renders them, one nobody reads nothing
+    BuiltinPreset<AntiAliasingAdvancedAaPresetDef> advancedAa;
+    PassGraph                                      graph(advancedAa.shaderDefs);
+    EXPECT_EQ(graph.FirstAffectedPass({"B_ANTI_RINGING"}), 1);
+    EXPECT_EQ(graph.FirstAffectedPass({"AA_RESOLUTION_X", "B_ANTI_RINGING"}), 0);
+    EXPECT_EQ(graph.FirstAffectedPass({"FrameCount"}), 3);
+    EXPECT_EQ(graph.FirstAffectedPass({"OutputSize"}), 3);
+}
+
+TEST(PassGraph, FeedbackOnlyForSampledPasses)
+{
+    // only passes whose feedback is sampled get a second target, unknown passes and aliases are ignored
+    std::vector<ShaderDef> shaderDefs {Pass({"Source"}, {}, "first"),
+                                       Pass({"Source", "PassFeedback9", "missingFeedback"}),
+                                       Pass({"Source", "firstFeedback", "PassFeedback2"})};
+    PassGraph              graph(Pointers(shaderDefs));
+    EXPECT_TRUE(graph.Nodes()[0].fedBack);
+    EXPECT_FALSE(graph.Nodes()[1].fedBack);
+    EXPECT_TRUE(graph.Nodes()[2].fedBack);
+    EXPECT_TRUE(graph.Nodes()[1].feedbacks.empty());
+    EXPECT_EQ(graph.Nodes()[2].feedbacks, (std::vector<int> {0, 2}));
+
+    // sampling any feedback makes a pass variant even if what it samples isn't known
+    EXPECT_TRUE(graph.Nodes()[1].feedback);
+    EXPECT_EQ(graph.FirstVariantPass(), 1);
+}
+
+TEST(PassGraph, TexturesOfDeadPassesAreUnused)
+{
+    // LUT is only sampled by a pass nothing reads, so its texture doesn't need loading
+    std::vector<ShaderDef> shaderDefs {Pass({"Source", "LUT"}), Pass({"Original", "BORDER"}), Pass({"PassOutput1"})};
+    PassGraph              graph(Pointers(shaderDefs));
+    EXPECT_EQ(graph.DeadPasses(), std::vector<int> {0});
+    EXPECT_FALSE(graph.Samples("LUT"));
+    EXPECT_TRUE(graph.Samples("BORDER"));
+    EXPECT_FALSE(graph.Samples("missing"));
+}
+
+TEST(PassGraph, PresetTexturesAreSampled)
+{
+    BuiltinPreset<BorderGameboyPlayerGameboyPlayerTvoutPresetDef> tvout;
+    PassGraph                                                     graph(tvout.shaderDefs);
+    ASSERT_FALSE(tvout.preset.TextureDefs.empty());
+    for(auto& textureDef : tvout.preset.TextureDefs)
+        EXPECT_TRUE(graph.Samples(textureDef.PresetParams["name"])) << textureDef.PresetParams["name"];
+
+    BuiltinPreset<CrtNewpixieCrtPresetDef> newpixie;
+    EXPECT_TRUE(PassGraph(newpixie.shaderDefs).Samples("frametexture"));
+}
+
+// sorted report lines against Tests/Golden/<name>.txt, SHADERGC_UPDATE_GOLDEN rewrites it
+static void ExpectReport(const std::string& name, std::vector<std::string> lines)
+{
+    std::sort(lines.begin(), lines.end());
+    const auto path = std::string(SHADERGC_TESTS_DIR) + "/Golden/" + name + ".txt";
+    if(std::getenv("SHADERGC_UPDATE_GOLDEN"))
+    {
+        std::ofstream file(path);
+        for(const auto& line : lines)
+            file << line << "\n";
+    }
+
+    std::ifstream            file(path);
+    std::vector<std::string> golden;
+    for(std::string line; std::getline(file, line);)
+        golden.push_back(line);
+    ASSERT_FALSE(golden.empty()) << path;
+
+    int mismatches = 0;
+    for(size_t i = 0; i < std::max(golden.size(), lines.size()); i++)
+    {
+        const auto expected = i < golden.size() ? golden[i] : std::string {};
+        const auto actual   = i < lines.size() ? lines[i] : std::string {};
+        if(expected != actual && mismatches++ < 10)
+            ADD_FAILURE() << name << " line " << i + 1 << " got \"" << actual << "\" expected \"" << expected << "\"";
+    }
+    EXPECT_EQ(mismatches, 0);
+}
+
+TEST(PassGraph, PrunesBuiltinLibrary)
+{
+    // what loading each built-in preset skips: passes nothing reads and textures only those (or no pass) sample
+    std::vector<std::string> lines;
+    ForEachBuiltinPreset([&](const PresetDef& presetDef, const std::vector<const ShaderDef*>& shaderDefs) {
+        PassGraph          graph(shaderDefs);
+        std::ostringstream line;
+        line << presetDef.Category << "/" << presetDef.Name << ": passes " << shaderDefs.size() << ", dead";
+        for(auto p : graph.DeadPasses())
+            line << " " << p;
+        line << ", unused textures";
+        for(const auto& textureDef : presetDef.TextureDefs)
+        {
+            auto name = textureDef.PresetParams.find("name");
+            if(name != textureDef.PresetParams.end() && !graph.Samples(name->second))
+                line << " " << name->second;
+        }
+        lines.push_back(line.str());
+    });
+    EXPECT_EQ(lines.size(), BuiltinLibrary().size());
+    ExpectReport("pruning", lines);
+}
+
+TEST(PassGraph, ClassifiesBuiltinLibrary)
+{
+    // the static prefix of each built-in preset, which static-content idle mode keeps between frames
+    std::vector<std::string> lines;
+    ForEachBuiltinPreset([&](const PresetDef& presetDef, const std::vector<const ShaderDef*>& shaderDefs) {
+        const auto name  = presetDef.Category + "/" + presetDef.Name;
+        PassGraph  graph(shaderDefs);
+        const auto first = graph.FirstVariantPass();
+        ASSERT_LE(first, static_cast<int>(shaderDefs.size())) << name;
+        for(int p = 0; p < first; p++)
+        {
+            const auto& node = graph.Nodes()[p];
+            EXPECT_FALSE(node.live && node.variant) << name << " pass " << p;
+        }
+        if(first < static_cast<int>(shaderDefs.size()))
+        {
+            EXPECT_TRUE(graph.Nodes()[first].live) << name;
+            EXPECT_TRUE(graph.Nodes()[first].variant) << name;
+        }
+        EXPECT_EQ(PassGraph(shaderDefs).FirstVariantPass(), first) << name;
+
+        std::ostringstream line;
+        line << name << ": passes " << shaderDefs.size() << ", first variant " << first << ", variant";
+        for(int p = 0; p < static_cast<int>(shaderDefs.size()); p++)
+        {
+            if(graph.Nodes()[p].variant)
+                line << " " << p;
+        }
+        lines.push_back(line.str());
+    });
+    EXPECT_EQ(lines.size(), BuiltinLibrary().size());
+    ExpectReport("variant", lines);
+}
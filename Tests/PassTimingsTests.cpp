@@ -0,0 +1,176 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "PassTimings.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+
+TEST(TimestampQueue, SlotsInOrder)
+{
+    TimestampQueue queue(3);
+    EXPECT_EQ(queue.Oldest(), -1);
+
+    // three frames in flight fill all slots, the fourth goes untimed
+    for(int f = 0; f < 3; f++)
+    {
+        auto slot = queue.Begin();
+        EXPECT_EQ(slot, f);
+        queue.End(slot);
+    }
+    EXPECT_EQ(queue.Begin(), -1);
+    EXPECT_EQ(queue.Untimed(), 1u);
+
+    // read back oldest first, a slot is free again once retired
+    EXPECT_EQ(queue.Oldest(), 0);
+    queue.Retire(true);
+    EXPECT_EQ(queue.Oldest(), 1);
+    queue.Retire(false);
+    EXPECT_EQ(queue.Timed(), 1u);
+    EXPECT_EQ(queue.Dropped(), 1u);
+    EXPECT_EQ(queue.MaxLatency(), 3u);
+
+    auto slot = queue.Begin();
+    EXPECT_EQ(slot, 0);
+    queue.End(slot);
+    EXPECT_EQ(queue.Oldest(), 2);
+
+    queue.Reset();
+    EXPECT_EQ(queue.Oldest(), -1);
+    queue.Retire(true);
+    EXPECT_EQ(queue.Timed(), 1u);
+}
+
+TEST(PassTimings, IgnoresBadTimestamps)
+{
+    PassTimings timings;
+    timings.Reset({"first", "second"});
+    timings.AddFrame({{0, 100, 200}, {1, 300, 200}, {2, 0, 100}, {-1, 0, 100}}, 1000);
+    timings.AddFrame({{0, 0, 100}}, 0);
+
+    const auto costs = timings.Costs();
+    ASSERT_EQ(costs.size(), 2u);
+    EXPECT_EQ(costs[0].samples, 1);
+    EXPECT_FLOAT_EQ(costs[0].min, 100.0f);
+    EXPECT_EQ(costs[1].samples, 0);
+    EXPECT_EQ(costs[1].name, "second");
+}
+
+TEST(PassTimings, KeepsLatestWindow)
+{
+    PassTimings timings;
+    timings.Reset({"pass"});
+    for(int f = 0; f < PassTimings::Window + 100; f++)
+        timings.AddFrame({{0, 0, static_cast<uint64_t>(f + 1)}}, 1000);
+
+    // samples of 101..340 ms
+    const auto cost = timings.Costs()[0];
+    EXPECT_EQ(cost.samples, PassTimings::Window);
+    EXPECT_FLOAT_EQ(cost.min, 101.0f);
+    EXPECT_FLOAT_EQ(cost.avg, 220.5f);
+    EXPECT_FLOAT_EQ(cost.p95, 328.0f);
+
+    timings.Reset({"pass"});
+    EXPECT_EQ(timings.Costs()[0].samples, 0);
+}
+
+TEST(PassTimings, LateAndDroppedReadbacks)
+{
+    // synthetic timestamps of a 51-pass chain read back 1-6 frames late, with passes left out and frames dropped,
+    // give the same min/avg/p95 as computed directly from what was read back
+    const int       passes    = 51;
+    const int       frames    = 5000;
+    const uint64_t  frequency = 10000000;
+    std::mt19937_64 random(1);
+
+    std::vector<std::string>                         names;
+    std::vector<std::lognormal_distribution<double>> costs;
+    for(int p = 0; p < passes; p++)
+    {
+        names.push_back("pass" + std::to_string(p));
+        costs.emplace_back(std::log(0.02 + 0.01 * (p % 7)), 0.25);
+    }
+
+    TimestampQueue                           queue(8);
+    PassTimings                              timings;
+    std::vector<std::vector<PassTimestamps>> slotTimestamps(queue.Slots());
+    std::vector<int>                         slotReady(queue.Slots());
+    std::vector<int>                         slotFrame(queue.Slots());
+    std::vector<std::vector<float>>          expected(passes);
+    std::uniform_int_distribution<int>       delay(1, 6);
+    std::bernoulli_distribution              skipped(0.1);
+    std::bernoulli_distribution              disjoint(0.01);
+    int                                      lastFrame = -1;
+    timings.Reset(names);
+
+    for(int frame = 0; frame < frames; frame++)
+    {
+        auto slot = queue.Begin();
+        if(slot >= 0)
+        {
+            uint64_t time = static_cast<uint64_t>(frame) * frequency / 60;
+            slotTimestamps[slot].clear();
+            for(int p = 0; p < passes; p++)
+            {
+                auto duration = static_cast<uint64_t>(costs[p](random) * frequency / 1000);
+                if(!skipped(random))
+                    slotTimestamps[slot].push_back({p, time, time + duration});
+                time += duration;
+            }
+            slotReady[slot] = frame + delay(random);
+            slotFrame[slot] = frame;
+            queue.End(slot);
+        }
+
+        // the renderer polls once per frame and never waits
+        auto oldest = queue.Oldest();
+        if(oldest >= 0 && frame >= slotReady[oldest])
+        {
+            EXPECT_GT(slotFrame[oldest], lastFrame);
+            lastFrame  = slotFrame[oldest];
+            auto valid = !disjoint(random);
+            queue.Retire(valid);
+            if(valid)
+            {
+                timings.AddFrame(slotTimestamps[oldest], frequency);
+                for(const auto& t : slotTimestamps[oldest])
+                    expected[t.pass].push_back(static_cast<float>((t.end - t.begin) * 1000.0 / frequency));
+            }
+        }
+    }
+
+    EXPECT_GT(queue.Timed(), frames / 2u);
+    EXPECT_GT(queue.Dropped(), 0u);
+    EXPECT_LE(queue.MaxLatency(), 8u);
+
+    for(const auto& cost : timings.Costs())
+    {
+        auto& samples = expected[cost.pass];
+        if(samples.size() > PassTimings::Window)
+            samples.erase(samples.begin(), samples.end() - PassTimings::Window);
+        std::sort(samples.begin(), samples.end());
+
+        double sum = 0.0;
+        for(auto s : samples)
+            sum += s;
+        EXPECT_EQ(cost.samples, static_cast<int>(samples.size()));
+        EXPECT_FLOAT_EQ(cost.min, samples.front());
+        EXPECT_NEAR(cost.avg, sum / samples.size(), 1e-5);
+        EXPECT_FLOAT_EQ(cost.p95, samples[static_cast<size_t>(std::ceil(0.95 * samples.size())) - 1]);
+    }
+}
+
+TEST(PassTimings, WriteCsv)
+{
+    std::ostringstream out;
+    PassTimings::WriteCsv(out, {{0, "crt, \"royale\"", 2, 0.5f, 0.75f, 1.0f}});
+    EXPECT_EQ(out.str(), "pass,name,samples,min_ms,avg_ms,p95_ms\n0,\"crt, \"\"royale\"\"\",2,0.5,0.75,1\n");
+}
@@ -0,0 +1,132 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "PresetCost.h"
+#include "DXBC.h"
+#include "BuiltinPresets.h"
+
+#include <gtest/gtest.h>
+
+using namespace RetroArch;
+
+static float Weighted(const ShaderDef& shaderDef)
+{
+    ShaderCost cost;
+    EXPECT_TRUE(DXBC::Cost(shaderDef.FragmentByteCode, shaderDef.FragmentLength, cost));
+    return cost.weighted;
+}
+
+// catalog cost written by ShaderGen is what the built passes estimate to, rounded as it writes it; headers generated
+// before ShaderGen wrote costs carry none and are estimated from their passes once built
+template<typename T> static void ExpectCatalogCost()
+{
+    BuiltinPreset<T> builtin;
+    const auto       estimate = PresetCost::Estimate(builtin.shaderDefs);
+    EXPECT_GT(estimate, 0.0f) << builtin.preset.Name;
+    if(builtin.preset.Cost > 0.0f)
+    {
+        EXPECT_NEAR(builtin.preset.Cost, estimate, 0.001f) << builtin.preset.Name;
+        EXPECT_EQ(PresetCost::Of(builtin.preset), builtin.preset.Cost);
+    }
+    else
+    {
+        EXPECT_EQ(PresetCost::Of(builtin.preset), estimate);
+    }
+}
+
+TEST(DXBC, Cost)
+{
+    BuiltinPreset<CrtNewpixieCrtPresetDef> newpixie;
+    for(const auto* shaderDef : newpixie.shaderDefs)
+    {
+        ShaderCost cost;
+        ASSERT_TRUE(DXBC::Cost(shaderDef->FragmentByteCode, shaderDef->FragmentLength, cost));
+        EXPECT_GT(cost.instructions, 0);
+        EXPECT_GT(cost.samples, 0);
+        EXPECT_GE(cost.weighted, static_cast<float>(cost.instructions));
+    }
+
+    // autocrop compute scans the frame in nested loops, which count as their iterations in the weight
+    BuiltinPreset<BorderAutocropKokoPresetDef> autocrop;
+    ShaderCost                                 scan;
+    ASSERT_TRUE(DXBC::Cost(autocrop.shaderDefs[1]->FragmentByteCode, autocrop.shaderDefs[1]->FragmentLength, scan));
+    EXPECT_GT(scan.loops, 1);
+    EXPECT_EQ(scan.loopDepth, 2);
+    EXPECT_GT(scan.weighted, static_cast<float>(scan.instructions * DXBC::LoopIterations));
+
+    ShaderCost           none;
+    std::vector<uint8_t> garbage(64, 0xAB);
+    EXPECT_FALSE(DXBC::Cost(nullptr, 0, none));
+    EXPECT_FALSE(DXBC::Cost(garbage.data(), garbage.size(), none));
+    EXPECT_FALSE(DXBC::Cost(newpixie.shaderDefs[0]->FragmentByteCode, 16, none));
+}
+
+TEST(PresetCost, CatalogMatchesEstimate)
+{
+    ExpectCatalogCost<AnamorphicAnamorphicPresetDef>();
+    ExpectCatalogCost<AntiAliasingAdvancedAaPresetDef>();
+    ExpectCatalogCost<BorderGameboyPlayerGameboyPlayerTvoutPresetDef>();
+    ExpectCatalogCost<MotionblurMix_framesPresetDef>();
+    ExpectCatalogCost<MotionblurFeedbackPresetDef>();
+    ExpectCatalogCost<BorderAutocropKokoPresetDef>();
+    ExpectCatalogCost<CrtNewpixieCrtPresetDef>();
+}
+
+TEST(PresetCost, PassSizes)
+{
+    // first pass of a two pass chain, the second renders to the 1920x1080 viewport from 640x360 input
+    BuiltinPreset<AntiAliasingAdvancedAaPresetDef> advancedAa;
+    const auto                                     first  = Weighted(*advancedAa.shaderDefs[0]);
+    const auto                                     second = Weighted(*advancedAa.shaderDefs[1]);
+    auto                                           cost   = [&](std::initializer_list<std::pair<const char*, const char*>> params) {
+        auto pass = *advancedAa.shaderDefs[0];
+        pass.PresetParams.clear();
+        for(const auto& param : params)
+            pass.Param(param.first, param.second);
+        return PresetCost::Estimate({&pass, advancedAa.shaderDefs[1]});
+    };
+
+    EXPECT_NEAR(cost({}), first / 9.0f + second, 0.01f);
+    EXPECT_NEAR(cost({{"scale_type", "source"}, {"scale", "2.0"}}), first * 4.0f / 9.0f + second, 0.01f);
+    EXPECT_NEAR(cost({{"scale_type", "viewport"}}), first + second, 0.01f);
+    EXPECT_NEAR(cost({{"scale_type_x", "viewport"}, {"scale_y", "3"}}), first + second, 0.01f);
+    EXPECT_NEAR(cost({{"scale_type", "absolute"}, {"scale_x", "192"}, {"scale_y", "108"}}), first / 100.0f + second, 0.01f);
+
+    // scale applies to both axes over per-axis ones, unparsable scales are 1
+    EXPECT_NEAR(cost({{"scale_x", "4"}, {"scale", "0.5"}}), first / 36.0f + second, 0.01f);
+    EXPECT_NEAR(cost({{"scale", "wide"}}), first / 9.0f + second, 0.01f);
+
+    // size of the last pass is always the viewport
+    auto last = *advancedAa.shaderDefs[1];
+    last.Param("scale_type", "absolute");
+    EXPECT_EQ(PresetCost::Estimate({advancedAa.shaderDefs[0], &last}), PresetCost::Estimate({advancedAa.shaderDefs[0], advancedAa.shaderDefs[1]}));
+}
+
+TEST(PresetCost, UnknownWithoutByteCode)
+{
+    BuiltinPreset<CrtNewpixieCrtPresetDef> newpixie;
+    ShaderDef                              imported;
+    EXPECT_EQ(PresetCost::Estimate({newpixie.shaderDefs[0], &imported}), 0.0f);
+    EXPECT_EQ(PresetCost::Estimate({}), 0.0f);
+}
+
+TEST(PresetCost, OfLeavesPresetUnbuilt)
+{
+    // a preset without a catalog cost is estimated from its passes only if it has them, it's never built here
+    CrtNewpixieCrtPresetDef unbuilt;
+    unbuilt.Cost = 0.0f;
+    EXPECT_EQ(PresetCost::Of(unbuilt), 0.0f);
+    EXPECT_TRUE(unbuilt.ShaderDefs.empty());
+    EXPECT_TRUE(unbuilt.TextureDefs.empty());
+
+    BuiltinPreset<CrtNewpixieCrtPresetDef> newpixie;
+    newpixie.preset.Cost = 0.0f;
+    EXPECT_EQ(PresetCost::Of(newpixie.preset), PresetCost::Estimate(newpixie.shaderDefs));
+    EXPECT_EQ(newpixie.preset.Cost, 0.0f);
+}
@@ -0,0 +1,134 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "PresetDiff.h"
+#include "BuiltinPresets.h"
+
+#include <gtest/gtest.h>
+
+using namespace RetroArch;
+
+// uncompiled pass, the source stands for its bytecode
+static ShaderDef Pass(const char* source, const std::vector<const char*>& samplers = {"Source"}, const char* alias = nullptr)
+{
+    ShaderDef shaderDef;
+    shaderDef.VertexSource   = "vertex";
+    shaderDef.FragmentSource = source;
+    for(auto sampler : samplers)
+        shaderDef.Samplers.push_back(ShaderSampler(sampler, 0));
+    if(alias)
+        shaderDef.Param("alias", alias);
+    return shaderDef;
+}
+
+static PresetDef Preset(const std::vector<ShaderDef>& shaderDefs)
+{
+    PresetDef presetDef;
+    presetDef.ShaderDefs = shaderDefs;
+    return presetDef;
+}
+
+static const uint8_t sImage[]      = {1, 2, 3, 4};
+static const uint8_t sOtherImage[] = {1, 2, 3, 5};
+
+static TextureDef Texture(const char* name, const uint8_t* data)
+{
+    TextureDef textureDef;
+    textureDef.Data       = data;
+    textureDef.DataLength = 4;
+    textureDef.Param("name", name);
+    return textureDef;
+}
+
+TEST(PresetDiff, SamePreset)
+{
+    BuiltinPreset<CrtNewpixieCrtPresetDef> newpixie;
+    PresetDiff                             diff(newpixie.preset, newpixie.preset);
+    EXPECT_EQ(diff.SharedPasses(), 4);
+    EXPECT_EQ(diff.SharedTextures(), std::vector<std::string> {"frametexture"});
+}
+
+TEST(PresetDiff, SharesLeadingPasses)
+{
+    auto from = Preset({Pass("a"), Pass("b"), Pass("c"), Pass("d")});
+    auto to   = Preset({Pass("a"), Pass("b"), Pass("x"), Pass("d")});
+    EXPECT_EQ(PresetDiff(from, to).SharedPasses(), 2);
+
+    // param defaults and preset params count, param values don't
+    to = from;
+    to.ShaderDefs[1].Param("scale", "2.0");
+    EXPECT_EQ(PresetDiff(from, to).SharedPasses(), 1);
+    to = from;
+    to.ShaderDefs[0].Params.push_back(ShaderParam("strength", -1, 0, 4, 0.0f, 1.0f, 0.5f));
+    EXPECT_EQ(PresetDiff(from, to).SharedPasses(), 0);
+}
+
+TEST(PresetDiff, LastPassOnlyMatchesLastPass)
+{
+    // the last pass renders at viewport size, the same pass in the middle of a chain doesn't
+    auto from = Preset({Pass("a"), Pass("b")});
+    auto to   = Preset({Pass("a"), Pass("b"), Pass("c")});
+    EXPECT_EQ(PresetDiff(from, to).SharedPasses(), 1);
+    EXPECT_EQ(PresetDiff(to, from).SharedPasses(), 1);
+}
+
+TEST(PresetDiff, ForwardFeedbackEndsSharedPrefix)
+{
+    // pass 0 reads the previous output of pass 2, which differs, so pass 0 renders differently too
+    auto from = Preset({Pass("a", {"Source", "PassFeedback2"}), Pass("b"), Pass("c"), Pass("d")});
+    auto to   = Preset({Pass("a", {"Source", "PassFeedback2"}), Pass("b"), Pass("x"), Pass("d")});
+    EXPECT_EQ(PresetDiff(from, to).SharedPasses(), 0);
+
+    // by alias, and from a pass in the middle of the prefix
+    from = Preset({Pass("a"), Pass("b", {"Source", "laterFeedback"}), Pass("c", {"Source"}, "later"), Pass("d")});
+    to   = Preset({Pass("a"), Pass("b", {"Source", "laterFeedback"}), Pass("x", {"Source"}, "later"), Pass("d")});
+    EXPECT_EQ(PresetDiff(from, to).SharedPasses(), 1);
+
+    // feedback of a shared pass keeps the prefix
+    from = Preset({Pass("a", {"Source", "PassFeedback1"}), Pass("b"), Pass("c"), Pass("d")});
+    to   = Preset({Pass("a", {"Source", "PassFeedback1"}), Pass("b"), Pass("x"), Pass("d")});
+    EXPECT_EQ(PresetDiff(from, to).SharedPasses(), 2);
+}
+
+TEST(PresetDiff, BuiltinForwardFeedback)
+{
+    // newpixie's accumulate pass reads blur_horiz of the previous frame
+    BuiltinPreset<CrtNewpixieCrtPresetDef> newpixie;
+    PresetDef                              changed = newpixie.preset;
+    changed.ShaderDefs[1].PresetParams["mipmap_input"] = "true";
+    EXPECT_EQ(PresetDiff(newpixie.preset, changed).SharedPasses(), 0);
+
+    changed = newpixie.preset;
+    changed.ShaderDefs[2].PresetParams["mipmap_input"] = "true";
+    EXPECT_EQ(PresetDiff(newpixie.preset, changed).SharedPasses(), 2);
+}
+
+TEST(PresetDiff, Textures)
+{
+    auto from = Preset({Pass("a", {"Source", "LUT"}), Pass("b", {"Source", "BORDER"}), Pass("c")});
+    auto to   = from;
+    from.TextureDefs.push_back(Texture("LUT", sImage));
+    from.TextureDefs.push_back(Texture("BORDER", sImage));
+    to.TextureDefs.push_back(Texture("LUT", sImage));
+    to.TextureDefs.push_back(Texture("BORDER", sOtherImage));
+
+    PresetDiff diff(from, to);
+    EXPECT_TRUE(diff.SharesTexture("LUT"));
+    EXPECT_FALSE(diff.SharesTexture("BORDER"));
+    EXPECT_EQ(diff.SharedPasses(), 1);
+
+    // same image sampled differently
+    to.TextureDefs[1] = Texture("BORDER", sImage);
+    to.TextureDefs[1].Param("linear", "true");
+    EXPECT_FALSE(PresetDiff(from, to).SharesTexture("BORDER"));
+
+    // a texture only one preset has differs too
+    to.TextureDefs.pop_back();
+    EXPECT_EQ(PresetDiff(from, to).SharedPasses(), 1);
+}
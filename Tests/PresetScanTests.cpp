@@ -0,0 +1,235 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "PresetScan.h"
+#include "ShaderGC.h"
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+
+static const char* sBlur = R"(#version 450
+#pragma name blur
+#pragma parameter RADIUS "Blur radius" 2.0 0.0 8.0 0.5
+#include "common.inc"
+#pragma stage vertex
+layout(binding = 3) uniform sampler2D VertexOnly;
+void main() {}
+#pragma stage fragment
+layout(set = 0,
+       binding = 2) uniform sampler2D Source;
+/* uniform sampler2D Commented;
+   layout(binding = 9) uniform sampler2D AlsoCommented; */
+uniform sampler2D Unbound; // uniform sampler2D LineComment;
+vec4 blur(sampler2D tex) { return texture(tex, vec2(0.0)); }
+layout(binding = 4) uniform sampler2D Source;
+void main() { FragColor = blur(Source); }
+)";
+
+static const char* sCommon = "#pragma parameter GAMMA \"Gamma\" 2.2 1.0 3.0 0.1\n#pragma parameter RADIUS \"Radius again\" 1.0 0.0 1.0 1.0\n";
+
+static const char* sFinal = "#version 450\n#pragma format R16G16B16A16_SFLOAT\n#pragma parameter GAMMA \"Gamma\" 2.2 1.0 3.0 0.1\n"
+                            "#pragma parameter MASK \"Mask\" 0.5 0.0 1.0 0.1\n#pragma stage fragment\n"
+                            "layout(binding = 1) uniform sampler2D Source;\nlayout(binding = 2) uniform sampler2D mask;\n";
+
+// shader pack named after the running test, removed when done: crt/two.slangp runs blur twice then final with a
+// mask texture, crt/ref.slangp references it, crt/broken.slangp names a shader which isn't there
+struct ScanFolder
+{
+    ScanFolder() :
+        root {std::filesystem::temp_directory_path() / (std::string("ShaderGCTests_") + ::testing::UnitTest::GetInstance()->current_test_info()->name())}
+    {
+        std::filesystem::remove_all(root);
+        Write("shaders/blur.slang", sBlur);
+        Write("shaders/common.inc", sCommon);
+        Write("shaders/final.slang", sFinal);
+        Write("crt/two.slangp",
+              "shaders = 3\nshader0 = ../shaders/blur.slang\nscale_type0 = source\nshader1 = ../shaders/blur.slang\nalias1 = Blurred\n"
+              "shader2 = ../shaders/final.slang\ntextures = \"mask\"\nmask = mask.png\nGAMMA = 2.4\n");
+        Write("crt/ref.slangp", "#reference \"two.slangp\"\nMASK = 0.25\n");
+        Write("crt/broken.slangp", "shaders = 2\nshader0 = ../shaders/blur.slang\nshader1 = nothere.slang\n");
+        Write("crt/notes.txt", "not a preset");
+    }
+
+    ~ScanFolder()
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(root, ec);
+    }
+
+    void Write(const char* file, const char* contents) const
+    {
+        std::filesystem::create_directories((root / file).parent_path());
+        std::ofstream(root / file, std::ios::binary | std::ios::trunc) << contents;
+    }
+
+    std::filesystem::path Path(const char* file) const
+    {
+        return (root / file).lexically_normal();
+    }
+
+    std::filesystem::path root;
+};
+
+static std::vector<std::string> Names(const std::vector<SourceShaderParam>& params)
+{
+    std::vector<std::string> names;
+    for(const auto& param : params)
+        names.push_back(param.name);
+    return names;
+}
+
+static std::vector<std::pair<std::string, int>> Samplers(const ScannedShader& shader)
+{
+    std::vector<std::pair<std::string, int>> samplers;
+    for(const auto& sampler : shader.samplers)
+        samplers.emplace_back(sampler.name, sampler.binding);
+    return samplers;
+}
+
+TEST(PresetScan, ScanSource)
+{
+    ScanFolder    folder;
+    ScannedShader shader;
+    PresetScanner::ScanSource(ShaderGC::LoadSource(folder.Path("shaders/blur.slang"), true), shader);
+    EXPECT_EQ(shader.name, "blur");
+    EXPECT_TRUE(shader.format.empty());
+
+    // the include is read where it is, so the first RADIUS wins
+    EXPECT_EQ(Names(shader.params), (std::vector<std::string> {"RADIUS", "GAMMA"}));
+    EXPECT_EQ(shader.params[0].desc, "Blur radius");
+    EXPECT_EQ(shader.params[0].def, 2.0f);
+    EXPECT_EQ(shader.params[0].max, 8.0f);
+    EXPECT_EQ(shader.params[0].step, 0.5f);
+
+    // fragment stage only, layout on an earlier line, comments and function parameters left out, first declaration kept
+    EXPECT_EQ(Samplers(shader), (std::vector<std::pair<std::string, int>> {{"Source", 2}, {"Unbound", -1}}));
+
+    ScannedShader final;
+    PresetScanner::ScanSource(ShaderGC::LoadSource(folder.Path("shaders/final.slang"), true), final);
+    EXPECT_TRUE(final.name.empty());
+    EXPECT_EQ(final.format, "R16G16B16A16_SFLOAT");
+    EXPECT_EQ(Samplers(final), (std::vector<std::pair<std::string, int>> {{"Source", 1}, {"mask", 2}}));
+}
+
+TEST(PresetScan, MatchesPreprocessing)
+{
+    // params and format are what compiling starts from, which then adds the built-in ones
+    ScanFolder    folder;
+    PresetScanner scanner;
+    for(const auto* file : {"shaders/blur.slang", "shaders/final.slang"})
+    {
+        const auto         scanned = scanner.Shader(folder.Path(file));
+        SourceShaderDef    def(folder.Path(file), SourceShaderInfo());
+        std::ostringstream log;
+        bool               warn = false;
+        ShaderGC::ProcessSourceShader(def, log, warn);
+        EXPECT_EQ(scanned->format, def.format) << file;
+        ASSERT_LE(scanned->params.size(), def.params.size()) << file;
+        for(size_t p = 0; p < scanned->params.size(); p++)
+        {
+            EXPECT_EQ(scanned->params[p].name, def.params[p].name) << file;
+            EXPECT_EQ(scanned->params[p].desc, def.params[p].desc) << file;
+            EXPECT_EQ(scanned->params[p].def, def.params[p].def) << file;
+        }
+    }
+}
+
+TEST(PresetScan, ScanPreset)
+{
+    ScanFolder    folder;
+    PresetScanner scanner;
+    const auto    preset = scanner.Scan(folder.root / "crt" / ".." / "crt" / "two.slangp");
+    EXPECT_EQ(preset.path, folder.Path("crt/two.slangp"));
+    EXPECT_TRUE(preset.error.empty()) << preset.error;
+    ASSERT_EQ(preset.passes.size(), 3u);
+    EXPECT_EQ(preset.passes[0].shader->path, folder.Path("shaders/blur.slang"));
+    EXPECT_EQ(preset.passes[0].presetParams.at("scale_type"), "source");
+    EXPECT_EQ(preset.passes[1].presetParams.at("alias"), "Blurred");
+    EXPECT_EQ(preset.passes[2].shader->path, folder.Path("shaders/final.slang"));
+
+    // a shader used twice is read once
+    EXPECT_EQ(preset.passes[0].shader, preset.passes[1].shader);
+    EXPECT_EQ(scanner.Shaders(), 2u);
+
+    ASSERT_EQ(preset.textures.size(), 1u);
+    EXPECT_EQ(preset.textures[0].presetParams.at("name"), "mask");
+    EXPECT_EQ(preset.textures[0].input.filename(), "mask.png");
+    EXPECT_TRUE(preset.textures[0].data.empty());
+
+    // params of all passes once each, preset values applied
+    const auto params = preset.Params();
+    EXPECT_EQ(Names(params), (std::vector<std::string> {"RADIUS", "GAMMA", "MASK"}));
+    EXPECT_EQ(params[1].def, 2.4f);
+    EXPECT_EQ(params[2].def, 0.5f);
+
+    const auto reference = scanner.Scan(folder.Path("crt/ref.slangp"));
+    EXPECT_TRUE(reference.error.empty()) << reference.error;
+    EXPECT_EQ(reference.passes.size(), 3u);
+    EXPECT_EQ(reference.Params()[2].def, 0.25f);
+    EXPECT_EQ(reference.passes[2].shader, preset.passes[2].shader);
+    EXPECT_EQ(scanner.Shaders(), 2u);
+}
+
+TEST(PresetScan, ScanShader)
+{
+    ScanFolder    folder;
+    PresetScanner scanner;
+    const auto    preset = scanner.Scan(folder.Path("shaders/final.slang"));
+    EXPECT_TRUE(preset.error.empty());
+    ASSERT_EQ(preset.passes.size(), 1u);
+    EXPECT_TRUE(preset.passes[0].presetParams.empty());
+    EXPECT_EQ(preset.passes[0].shader, scanner.Shader(folder.Path("shaders/final.slang")));
+    EXPECT_EQ(Names(preset.Params()), (std::vector<std::string> {"GAMMA", "MASK"}));
+}
+
+TEST(PresetScan, Errors)
+{
+    ScanFolder    folder;
+    PresetScanner scanner;
+
+    // what could be read is kept
+    const auto broken = scanner.Scan(folder.Path("crt/broken.slangp"));
+    EXPECT_NE(broken.error.find("nothere.slang"), std::string::npos) << broken.error;
+    ASSERT_EQ(broken.passes.size(), 2u);
+    EXPECT_TRUE(broken.passes[0].shader->error.empty());
+    EXPECT_FALSE(broken.passes[1].shader->error.empty());
+
+    EXPECT_FALSE(scanner.Scan(folder.Path("crt/nothing.slangp")).error.empty());
+    EXPECT_FALSE(scanner.Scan(folder.Path("crt/nothing.slang")).error.empty());
+}
+
+TEST(PresetScan, ScanDirectory)
+{
+    ScanFolder    folder;
+    PresetScanner scanner;
+    size_t        calls   = 0;
+    const auto    presets = scanner.ScanDirectory(folder.root, 4, [&](size_t done, size_t total) {
+        calls++;
+        EXPECT_EQ(done, calls);
+        EXPECT_EQ(total, 3u);
+    });
+    EXPECT_EQ(calls, 3u);
+
+    // sorted by path, only presets
+    ASSERT_EQ(presets.size(), 3u);
+    EXPECT_EQ(presets[0].path, folder.Path("crt/broken.slangp"));
+    EXPECT_EQ(presets[1].path, folder.Path("crt/ref.slangp"));
+    EXPECT_EQ(presets[2].path, folder.Path("crt/two.slangp"));
+    EXPECT_FALSE(presets[0].error.empty());
+    EXPECT_TRUE(presets[1].error.empty());
+    EXPECT_EQ(presets[2].passes.size(), 3u);
+    EXPECT_EQ(scanner.Shaders(), 3u);
+
+    // each shader is shared whichever thread read it first
+    EXPECT_EQ(presets[1].passes[0].shader, presets[2].passes[0].shader);
+    EXPECT_EQ(presets[0].passes[0].shader, presets[2].passes[0].shader);
+
+    EXPECT_TRUE(scanner.ScanDirectory(folder.Path("nothing"), 4).empty());
+}
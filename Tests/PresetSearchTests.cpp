@@ -0,0 +1,203 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "PresetSearch.h"
+#include "BuiltinPresets.h"
+
+#include <gtest/gtest.h>
+
+using namespace RetroArch;
+
+static SearchDocument Document(const char*                     name,
+                               const char*                     category,
+                               const std::vector<std::string>& passes       = {},
+                               const std::vector<std::string>& params       = {},
+                               const std::vector<std::string>& descriptions = {})
+{
+    return SearchDocument {name, category, passes, params, descriptions};
+}
+
+// ids of results, best first
+static std::vector<uint32_t> Find(const PresetSearch& search, const std::string& query, size_t limit = 10)
+{
+    std::vector<uint32_t> ids;
+    for(const auto& result : search.Find(query, limit))
+        ids.push_back(result.id);
+    return ids;
+}
+
+// a few presets the way the catalog has them
+static PresetSearch Catalog()
+{
+    PresetSearch search;
+    search.Add(1, Document("crt-geom", "crt", {"crt-geom"}, {"CRTgamma", "R"}, {"CRTGeom Target Gamma", "CRTGeom Curvature Radius"}));
+    search.Add(2, Document("crt-geom-deluxe", "crt", {"phosphor_apply", "crt-geom-deluxe"}, {"aperture_strength"}, {"Shadow mask strength"}));
+    search.Add(3, Document("crt-guest-advanced-ntsc", "crt", {"ntsc-pass1", "crt-guest-advanced"}, {"cust_artifacting"}, {"NTSC Custom Artifacting Value"}));
+    search.Add(4, Document("crt-royale", "crt", {"crt-royale-first-pass"}, {"crt_gamma"}, {"Simulated CRT Gamma"}));
+    search.Add(5, Document("scanline", "scanlines", {"scanline"}, {"SCANLINE_BASE_BRIGHTNESS"}, {"Scanline Base Brightness"}));
+    search.Add(6, Document("newpixie-crt", "crt", {"accumulate", "newpixie-crt"}, {"curvature"}, {"Curvature"}));
+    search.Add(7, Document("bloom", "presets", {"bloom_pass"}, {"BLOOM_STRENGTH"}, {"Bloom Strength"}));
+    return search;
+}
+
+TEST(PresetSearch, Words)
+{
+    EXPECT_EQ(PresetSearch::Words("CRT-Guest_Advanced  NTSC2"), (std::vector<std::string> {"crt", "guest", "advanced", "ntsc2"}));
+    EXPECT_EQ(PresetSearch::Words(" -- "), std::vector<std::string> {});
+    EXPECT_EQ(PresetSearch::Words("\xC3\x89" "cran crt"), (std::vector<std::string> {"\xC3\x89" "cran", "crt"}));
+}
+
+TEST(PresetSearch, RanksByField)
+{
+    // the same word in each field of a different preset
+    PresetSearch search;
+    search.Add(5, Document("other", "misc", {}, {}, {"glow"}));
+    search.Add(4, Document("other", "misc", {}, {"glow"}));
+    search.Add(3, Document("other", "misc", {"glow"}));
+    search.Add(2, Document("other", "glow"));
+    search.Add(1, Document("soft glow", "misc"));
+    EXPECT_EQ(Find(search, "glow"), (std::vector<uint32_t> {1, 2, 3, 4, 5}));
+
+    // a word in several fields counts its best one
+    search.Add(6, Document("other", "glow", {"glow"}, {"glow"}, {"glow"}));
+    const auto results = search.Find("glow", 3);
+    ASSERT_EQ(results.size(), 3u);
+    EXPECT_EQ(results[0].id, 1u);
+    EXPECT_EQ(results[1].score, results[2].score);
+}
+
+TEST(PresetSearch, RanksByMatch)
+{
+    // exact above prefix above inside, and a longer share of a term above a shorter one
+    PresetSearch search;
+    search.Add(1, Document("hiscan", "misc"));
+    search.Add(2, Document("scanlines", "misc"));
+    search.Add(3, Document("scanline", "misc"));
+    search.Add(4, Document("scan", "misc"));
+    EXPECT_EQ(Find(search, "scan"), (std::vector<uint32_t> {4, 3, 2, 1}));
+
+    // inside matches need three letters
+    EXPECT_EQ(Find(search, "ca"), std::vector<uint32_t> {});
+    EXPECT_EQ(Find(search, "sc"), (std::vector<uint32_t> {4, 3, 2}));
+}
+
+TEST(PresetSearch, NamesStartingWithQueryFirst)
+{
+    const auto search = Catalog();
+
+    // all crt presets match crt in their name, the one named after the query wins, then the shorter names
+    const auto crt = Find(search, "crt geom");
+    ASSERT_EQ(crt.size(), 2u);
+    EXPECT_EQ(crt, (std::vector<uint32_t> {1, 2}));
+    EXPECT_EQ(Find(search, "crt-geom-deluxe")[0], 2u);
+    EXPECT_EQ(Find(search, "crt")[0], 1u);
+
+    // the full name finds its preset first, and so do the letters typed on the way once they tell it apart
+    const std::vector<std::pair<const char*, uint32_t>> queries {{"crt-geom", 1}, {"crt-geom-d", 2}, {"crt-geom-deluxe", 2}, {"crt-gu", 3}, {"crt-guest-advanced-ntsc", 3},
+                                                                 {"crt-r", 4},    {"crt-royale", 4},  {"sca", 5},             {"scanline", 5}, {"newp", 6},
+                                                                 {"newpixie-crt", 6}, {"bl", 7},      {"bloom", 7}};
+    for(const auto& [query, id] : queries)
+        EXPECT_EQ(Find(search, query, 1), std::vector<uint32_t> {id}) << query;
+}
+
+TEST(PresetSearch, EveryWordMustMatch)
+{
+    const auto search = Catalog();
+    EXPECT_EQ(Find(search, "guest ntsc"), std::vector<uint32_t> {3});
+    EXPECT_EQ(Find(search, "ntsc guest"), std::vector<uint32_t> {3});
+    EXPECT_EQ(Find(search, "guest royale"), std::vector<uint32_t> {});
+
+    // the name joined into one word, and words found in passes and params
+    EXPECT_EQ(Find(search, "crtguest"), std::vector<uint32_t> {3});
+    EXPECT_EQ(Find(search, "accumulate")[0], 6u);
+    EXPECT_EQ(Find(search, "gamma"), (std::vector<uint32_t> {4, 1}));
+    EXPECT_EQ(Find(search, "shadow mask"), std::vector<uint32_t> {2});
+}
+
+TEST(PresetSearch, TypoFallback)
+{
+    const auto search = Catalog();
+
+    // a word contained in no term takes those sharing most of its trigrams
+    EXPECT_EQ(Find(search, "curvture"), (std::vector<uint32_t> {6, 1}));
+    EXPECT_EQ(Find(search, "scanlnie"), std::vector<uint32_t> {});
+    EXPECT_EQ(Find(search, "bloomm"), std::vector<uint32_t> {7});
+    EXPECT_EQ(Find(search, "guest artifacing"), std::vector<uint32_t> {3});
+
+    // ranked below what matches for real, and only for words of four letters or more
+    PresetSearch both = Catalog();
+    both.Add(8, Document("curvtures", "misc"));
+    EXPECT_EQ(Find(both, "curvture"), std::vector<uint32_t> {8});
+    EXPECT_EQ(Find(search, "blom"), std::vector<uint32_t> {});
+    EXPECT_EQ(Find(search, "crx"), std::vector<uint32_t> {});
+    EXPECT_EQ(Find(search, "zzzzzz"), std::vector<uint32_t> {});
+
+    // fallback matches score less than exact ones of the same field
+    const auto typo  = search.Find("bloomm", 1);
+    const auto exact = search.Find("bloom", 1);
+    ASSERT_EQ(typo.size(), 1u);
+    EXPECT_LT(typo[0].score, exact[0].score);
+}
+
+TEST(PresetSearch, AddReplaceRemove)
+{
+    auto search = Catalog();
+    EXPECT_EQ(search.Size(), 7u);
+    EXPECT_EQ(Find(search, "bloom"), std::vector<uint32_t> {7});
+
+    // an id added again only matches its new document
+    search.Add(7, Document("glow", "presets"));
+    EXPECT_EQ(search.Size(), 7u);
+    EXPECT_EQ(Find(search, "bloom"), std::vector<uint32_t> {});
+    EXPECT_EQ(Find(search, "glow"), std::vector<uint32_t> {7});
+
+    search.Remove(7);
+    search.Remove(42);
+    EXPECT_EQ(search.Size(), 6u);
+    EXPECT_EQ(Find(search, "glow"), std::vector<uint32_t> {});
+
+    EXPECT_EQ(Find(search, "crt", 2).size(), 2u);
+    EXPECT_EQ(Find(search, "crt", 0).size(), 0u);
+    EXPECT_EQ(Find(search, "").size(), 0u);
+    EXPECT_EQ(Find(search, "- ").size(), 0u);
+}
+
+TEST(PresetSearch, DocumentOfBuiltinPreset)
+{
+    // by name and category, never built for searching
+    CrtNewpixieCrtPresetDef newpixie;
+    const auto              document = PresetSearch::Document(newpixie);
+    EXPECT_TRUE(newpixie.ShaderDefs.empty());
+    EXPECT_TRUE(newpixie.TextureDefs.empty());
+    EXPECT_TRUE(newpixie.Overrides.empty());
+    EXPECT_EQ(document.name, "newpixie-crt");
+    EXPECT_EQ(document.category, "crt");
+    EXPECT_TRUE(document.passes.empty());
+    EXPECT_TRUE(document.params.empty());
+
+    // nor are the passes of one the render thread built read
+    BuiltinPreset<CrtNewpixieCrtPresetDef> built;
+    EXPECT_TRUE(PresetSearch::Document(built.preset).passes.empty());
+}
+
+TEST(PresetSearch, DocumentOfImportedPreset)
+{
+    BuiltinPreset<CrtNewpixieCrtPresetDef> imported;
+    imported.preset.ImportPath = "crt/newpixie-crt.slangp";
+    const auto document        = PresetSearch::Document(imported.preset);
+    EXPECT_EQ(document.name, "newpixie-crt");
+    EXPECT_EQ(document.passes, (std::vector<std::string> {"accumulate", "blur_horiz", "blur_vert", "newpixie-crt"}));
+
+    // params with a description, once each
+    EXPECT_EQ(document.params.size(), document.descriptions.size());
+    EXPECT_NE(std::find(document.params.begin(), document.params.end(), "curvature"), document.params.end());
+    EXPECT_EQ(std::find(document.params.begin(), document.params.end(), "MVP"), document.params.end());
+    for(const auto& param : document.params)
+        EXPECT_EQ(std::count(document.params.begin(), document.params.end(), param), 1) << param;
+}
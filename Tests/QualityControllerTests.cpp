@@ -0,0 +1,152 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "QualityController.h"
+
+#include <gtest/gtest.h>
+
+// frame time of a preset whose cost scales with pass size and is spread over skipped frames
+static float FrameTime(const QualityLevel& level, float fullCost)
+{
+    return fullCost * level.passScale * level.passScale / (level.frameSkip + 1);
+}
+
+TEST(QualityController, BudgetFollowsRefreshRate)
+{
+    QualityController controller;
+    EXPECT_FLOAT_EQ(controller.Budget(), 12.5f);
+    controller.SetRefreshRate(144.0f);
+    EXPECT_FLOAT_EQ(controller.Budget(), 0.75f * 1000.0f / 144.0f);
+    controller.SetRefreshRate(0.0f);
+    EXPECT_FLOAT_EQ(controller.Budget(), 0.75f * 1000.0f / 144.0f);
+}
+
+TEST(QualityController, StaysWithinBudget)
+{
+    QualityController controller;
+    for(int f = 0; f < 1000; f++)
+        EXPECT_FALSE(controller.AddFrame(8.0f));
+    EXPECT_EQ(controller.Level(), 0);
+    EXPECT_TRUE(controller.Changes().empty());
+}
+
+TEST(QualityController, DegradesAfterSustainedOverBudget)
+{
+    QualitySettings   settings;
+    QualityController controller(settings);
+
+    // a single spike is smoothed away
+    EXPECT_FALSE(controller.AddFrame(8.0f));
+    EXPECT_FALSE(controller.AddFrame(100.0f));
+    for(int f = 0; f < 100; f++)
+        controller.AddFrame(8.0f);
+    EXPECT_EQ(controller.Level(), 0);
+
+    int frames = 0;
+    while(!controller.AddFrame(20.0f))
+        frames++;
+    EXPECT_GE(frames, settings.degradeFrames - 1);
+    EXPECT_EQ(controller.Level(), 1);
+    EXPECT_EQ(controller.LastChange().fromLevel, 0);
+    EXPECT_EQ(controller.LastChange().toLevel, 1);
+    EXPECT_GT(controller.LastChange().frameTime, controller.Budget() * settings.degradeRatio);
+}
+
+TEST(QualityController, SameBudgetAtHigherRefreshRateDegrades)
+{
+    // 10 ms is fine at 60 Hz but not at 144 Hz
+    QualityController at60, at144;
+    at144.SetRefreshRate(144.0f);
+    for(int f = 0; f < 200; f++)
+    {
+        at60.AddFrame(10.0f);
+        at144.AddFrame(10.0f);
+    }
+    EXPECT_EQ(at60.Level(), 0);
+    EXPECT_GT(at144.Level(), 0);
+}
+
+TEST(QualityController, SettlesOnCheapestSufficientLevel)
+{
+    // at 14 ms the first level under budget is 0.75 pass scale, with enough headroom to retry the full one
+    QualityController controller;
+    for(int f = 0; f < 20000; f++)
+        controller.AddFrame(FrameTime(controller.Current(), 14.0f));
+    EXPECT_EQ(controller.Level(), 1);
+
+    // retrying the full level fails each time, so retries get further apart
+    const auto changes = controller.Changes();
+    ASSERT_GE(changes.size(), 5u);
+    std::vector<int> upgrades;
+    for(const auto& change : changes)
+    {
+        if(change.toLevel < change.fromLevel)
+            upgrades.push_back(change.frame);
+    }
+    ASSERT_GE(upgrades.size(), 3u);
+    for(size_t u = 2; u < upgrades.size(); u++)
+        EXPECT_GE(upgrades[u] - upgrades[u - 1], upgrades[u - 1] - upgrades[u - 2]);
+}
+
+TEST(QualityController, ClimbsBackWhenLoadDrops)
+{
+    QualityController controller;
+    for(int f = 0; f < 2000; f++)
+        controller.AddFrame(FrameTime(controller.Current(), 40.0f));
+    const auto degraded = controller.Level();
+    EXPECT_GT(degraded, 1);
+
+    for(int f = 0; f < 20000; f++)
+        controller.AddFrame(FrameTime(controller.Current(), 4.0f));
+    EXPECT_EQ(controller.Level(), 0);
+}
+
+TEST(QualityController, LowestLevelIsFloor)
+{
+    QualityController controller;
+    for(int f = 0; f < 10000; f++)
+        controller.AddFrame(100.0f);
+    EXPECT_EQ(controller.Level(), static_cast<int>(QualityController::Levels().size()) - 1);
+}
+
+TEST(QualityController, ChangesAreCapped)
+{
+    // a load too heavy for the full level and light for all others keeps only the latest changes, oldest first
+    QualitySettings settings;
+    settings.upgradeFrames = 1;
+    settings.degradeFrames = 1;
+    settings.settleFrames  = 0;
+    settings.smoothing     = 1.0f;
+    QualityController controller(settings);
+    int               changes = 0;
+    for(int f = 0; f < 100000; f++)
+    {
+        if(controller.AddFrame(controller.Level() ? 1.0f : 20.0f))
+            changes++;
+    }
+    EXPECT_GT(changes, 1000);
+
+    const auto kept = controller.Changes();
+    EXPECT_LT(kept.size(), 100u);
+    ASSERT_FALSE(kept.empty());
+    EXPECT_EQ(kept.back().frame, controller.LastChange().frame);
+    for(size_t c = 1; c < kept.size(); c++)
+        EXPECT_LT(kept[c - 1].frame, kept[c].frame);
+}
+
+TEST(QualityController, ResetClearsChanges)
+{
+    QualityController controller;
+    for(int f = 0; f < 1000; f++)
+        controller.AddFrame(30.0f);
+    ASSERT_GT(controller.Level(), 0);
+    controller.Reset();
+    EXPECT_EQ(controller.Level(), 0);
+    EXPECT_TRUE(controller.Changes().empty());
+}
@@ -0,0 +1,137 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "ShaderReflection.h"
+#include "BuiltinPresets.h"
+
+#include <gtest/gtest.h>
+
+using namespace RetroArch;
+
+// param as ShaderGen has it after reflection, i of -1 means the stage doesn't bind it
+static SourceShaderParam Param(const std::string& name, int buffer, int offset, int size, int i)
+{
+    SourceShaderParam param("#pragma parameter " + name, size, buffer);
+    param.offset = offset;
+    param.i      = i;
+    return param;
+}
+
+static bool Decode(const std::vector<uint8_t>& record, std::vector<ShaderParam>& params, std::vector<ShaderSampler>& samplers)
+{
+    params.clear();
+    samplers.clear();
+    return ShaderReflection::Decode(record.data(), record.size(), params, samplers);
+}
+
+TEST(ShaderReflection, RoundTrip)
+{
+    const auto record = ShaderReflection::Encode({Param("MVP", 0, 0, 64, 0), Param("SourceSize", -1, 0, 16, 1), Param("strength", -1, 16, 4, 2)},
+                                                 {SourceShaderSampler("Source", 2), SourceShaderSampler("PassFeedback0", 3)});
+
+    std::vector<ShaderParam>   params;
+    std::vector<ShaderSampler> samplers;
+    ASSERT_TRUE(Decode(record, params, samplers));
+    ASSERT_EQ(params.size(), 3u);
+    EXPECT_EQ(params[0].name, "MVP");
+    EXPECT_EQ(params[0].buffer, 0);
+    EXPECT_EQ(params[0].size, 64);
+    EXPECT_EQ(params[1].name, "SourceSize");
+    EXPECT_EQ(params[1].buffer, -1);
+    EXPECT_EQ(params[2].offset, 16);
+    EXPECT_EQ(params[2].size, 4);
+    ASSERT_EQ(samplers.size(), 2u);
+    EXPECT_EQ(samplers[0].name, "Source");
+    EXPECT_EQ(samplers[0].binding, 2);
+    EXPECT_EQ(samplers[1].name, "PassFeedback0");
+    EXPECT_EQ(samplers[1].binding, 3);
+}
+
+TEST(ShaderReflection, SkipsUnboundParams)
+{
+    const auto record = ShaderReflection::Encode({Param("MVP", 0, 0, 64, 0), Param("unused", -1, 0, 4, -1), Param("FrameCount", -1, 0, 4, 1)}, {});
+
+    std::vector<ShaderParam>   params;
+    std::vector<ShaderSampler> samplers;
+    ASSERT_TRUE(Decode(record, params, samplers));
+    ASSERT_EQ(params.size(), 2u);
+    EXPECT_EQ(params[0].name, "MVP");
+    EXPECT_EQ(params[1].name, "FrameCount");
+    EXPECT_TRUE(samplers.empty());
+}
+
+TEST(ShaderReflection, RejectsDamagedRecords)
+{
+    const auto record = ShaderReflection::Encode({Param("MVP", 0, 0, 64, 0)}, {SourceShaderSampler("Source", 2)});
+
+    std::vector<ShaderParam>   params;
+    std::vector<ShaderSampler> samplers;
+    EXPECT_FALSE(ShaderReflection::Decode(nullptr, 0, params, samplers));
+
+    // every truncation, including one ending inside a name
+    for(size_t size = 0; size < record.size(); size++)
+    {
+        params.clear();
+        samplers.clear();
+        EXPECT_FALSE(ShaderReflection::Decode(record.data(), size, params, samplers)) << size;
+    }
+
+    auto trailing = record;
+    trailing.push_back(0);
+    EXPECT_FALSE(Decode(trailing, params, samplers));
+
+    auto magic = record;
+    magic[0]   = 'X';
+    EXPECT_FALSE(Decode(magic, params, samplers));
+
+    auto version = record;
+    version[4]++;
+    EXPECT_FALSE(Decode(version, params, samplers));
+
+    // a count larger than what follows
+    auto count = record;
+    count[5]++;
+    EXPECT_FALSE(Decode(count, params, samplers));
+}
+
+TEST(ShaderReflection, MatchesHeaderLayout)
+{
+    // the fragment record of a generated pass describes the params and samplers its header lists
+    BuiltinPreset<CrtNewpixieCrtPresetDef> newpixie;
+    for(const auto* shaderDef : newpixie.shaderDefs)
+    {
+        std::vector<SourceShaderParam>   sourceParams;
+        std::vector<SourceShaderSampler> sourceSamplers;
+        for(size_t p = 0; p < shaderDef->Params.size(); p++)
+        {
+            const auto& param = shaderDef->Params[p];
+            sourceParams.push_back(Param(param.name, param.buffer, param.offset, param.size, static_cast<int>(p)));
+        }
+        for(const auto& sampler : shaderDef->Samplers)
+            sourceSamplers.push_back(SourceShaderSampler(sampler.name, sampler.binding));
+
+        std::vector<ShaderParam>   params;
+        std::vector<ShaderSampler> samplers;
+        ASSERT_TRUE(Decode(ShaderReflection::Encode(sourceParams, sourceSamplers), params, samplers));
+        ASSERT_EQ(params.size(), shaderDef->Params.size());
+        for(size_t p = 0; p < params.size(); p++)
+        {
+            EXPECT_EQ(params[p].name, shaderDef->Params[p].name);
+            EXPECT_EQ(params[p].buffer, shaderDef->Params[p].buffer);
+            EXPECT_EQ(params[p].offset, shaderDef->Params[p].offset);
+            EXPECT_EQ(params[p].size, shaderDef->Params[p].size);
+        }
+        ASSERT_EQ(samplers.size(), shaderDef->Samplers.size());
+        for(size_t s = 0; s < samplers.size(); s++)
+        {
+            EXPECT_EQ(samplers[s].name, shaderDef->Samplers[s].name);
+            EXPECT_EQ(samplers[s].binding, shaderDef->Samplers[s].binding);
+        }
+    }
+}
@@ -0,0 +1,538 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "SoftwareRenderer.h"
+#include "SpirvBuilder.h"
+#include "GLSL.std.450.h"
+#include "RetroArch/stock/StockStockShaderDef.h"
+#include "RetroArch/stock/StockNearestPresetDef.h"
+#include "RetroArch/crt/shaders/CrtShadersCrtLottesShaderDef.h"
+#include "RetroArch/crt/CrtCrtLottesPresetDef.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+using namespace spv;
+
+// gl_Position = MVP * Position, vTexCoord = TexCoord * scale
+static std::vector<uint32_t> VertexShader(float scale)
+{
+    SpirvBuilder s;
+    s.Header();
+    const auto main = s.Id(), perVertex = s.Id(), pv = s.Id(), position = s.Id(), vTexCoord = s.Id(), texCoord = s.Id(), ubo = s.Id(), global = s.Id();
+    s.EntryPoint(ExecutionModelVertex, main, {pv, position, vTexCoord, texCoord});
+    s.Op(OpMemberDecorate, {perVertex, 0, DecorationBuiltIn, BuiltInPosition});
+    s.Op(OpDecorate, {perVertex, DecorationBlock});
+    s.Op(OpMemberDecorate, {ubo, 0, DecorationColMajor});
+    s.Op(OpMemberDecorate, {ubo, 0, DecorationOffset, 0});
+    s.Op(OpMemberDecorate, {ubo, 0, DecorationMatrixStride, 16});
+    s.Op(OpDecorate, {ubo, DecorationBlock});
+    s.Op(OpDecorate, {global, DecorationDescriptorSet, 0});
+    s.Op(OpDecorate, {global, DecorationBinding, 0});
+    s.Op(OpDecorate, {position, DecorationLocation, 0});
+    s.Op(OpDecorate, {vTexCoord, DecorationLocation, 0});
+    s.Op(OpDecorate, {texCoord, DecorationLocation, 1});
+
+    const auto tVoid  = s.Define(OpTypeVoid);
+    const auto tMain  = s.Define(OpTypeFunction, {tVoid});
+    const auto tFloat = s.Define(OpTypeFloat, {32});
+    const auto tVec4  = s.Define(OpTypeVector, {tFloat, 4});
+    const auto tVec2  = s.Define(OpTypeVector, {tFloat, 2});
+    const auto tInt   = s.Define(OpTypeInt, {32, 1});
+    const auto tMat4  = s.Define(OpTypeMatrix, {tVec4, 4});
+    s.Define(OpTypeStruct, {tVec4}, perVertex);
+    s.Define(OpTypeStruct, {tMat4}, ubo);
+    const auto int0      = s.Value(OpConstant, tInt, {0});
+    const auto scaleBy   = s.Float(tFloat, scale);
+    const auto pOutPv    = s.Define(OpTypePointer, {StorageClassOutput, perVertex});
+    const auto pUbo      = s.Define(OpTypePointer, {StorageClassUniform, ubo});
+    const auto pUboMat4  = s.Define(OpTypePointer, {StorageClassUniform, tMat4});
+    const auto pInVec4   = s.Define(OpTypePointer, {StorageClassInput, tVec4});
+    const auto pOutVec4  = s.Define(OpTypePointer, {StorageClassOutput, tVec4});
+    const auto pInVec2   = s.Define(OpTypePointer, {StorageClassInput, tVec2});
+    const auto pOutVec2  = s.Define(OpTypePointer, {StorageClassOutput, tVec2});
+    s.Value(OpVariable, pOutPv, {StorageClassOutput}, pv);
+    s.Value(OpVariable, pUbo, {StorageClassUniform}, global);
+    s.Value(OpVariable, pInVec4, {StorageClassInput}, position);
+    s.Value(OpVariable, pOutVec2, {StorageClassOutput}, vTexCoord);
+    s.Value(OpVariable, pInVec2, {StorageClassInput}, texCoord);
+
+    s.Value(OpFunction, tVoid, {FunctionControlMaskNone, tMain}, main);
+    s.Define(OpLabel);
+    const auto mvp = s.Value(OpLoad, tMat4, {s.Value(OpAccessChain, pUboMat4, {global, int0})});
+    const auto pos = s.Value(OpMatrixTimesVector, tVec4, {mvp, s.Value(OpLoad, tVec4, {position})});
+    s.Op(OpStore, {s.Value(OpAccessChain, pOutVec4, {pv, int0}), pos});
+    s.Op(OpStore, {vTexCoord, s.Value(OpVectorTimesScalar, tVec2, {s.Value(OpLoad, tVec2, {texCoord}), scaleBy})});
+    s.Op(OpReturn, {});
+    s.Op(OpFunctionEnd, {});
+    return s.Words();
+}
+
+// Source with red counting quarters of 4u in the top half and red and blue swapped in the bottom, rgb by
+// STRENGTH, alpha from derivative of u and FragCoord
+static std::vector<uint32_t> MarkShader()
+{
+    SpirvBuilder s;
+    const auto   glsl = s.Header();
+    const auto   main = s.Id(), push = s.Id(), params = s.Id(), source = s.Id(), vTexCoord = s.Id(), fragColor = s.Id(), fragCoord = s.Id();
+    s.EntryPoint(ExecutionModelFragment, main, {vTexCoord, fragColor, fragCoord});
+    s.Op(OpExecutionMode, {main, ExecutionModeOriginUpperLeft});
+    s.Op(OpMemberDecorate, {push, 0, DecorationOffset, 0});
+    s.Op(OpMemberDecorate, {push, 1, DecorationOffset, 16});
+    s.Op(OpMemberDecorate, {push, 2, DecorationOffset, 32});
+    s.Op(OpMemberDecorate, {push, 3, DecorationOffset, 36});
+    s.Op(OpDecorate, {push, DecorationBlock});
+    s.Op(OpDecorate, {vTexCoord, DecorationLocation, 0});
+    s.Op(OpDecorate, {fragColor, DecorationLocation, 0});
+    s.Op(OpDecorate, {source, DecorationDescriptorSet, 0});
+    s.Op(OpDecorate, {source, DecorationBinding, 2});
+    s.Op(OpDecorate, {fragCoord, DecorationBuiltIn, BuiltInFragCoord});
+
+    const auto tVoid  = s.Define(OpTypeVoid);
+    const auto tMain  = s.Define(OpTypeFunction, {tVoid});
+    const auto tFloat = s.Define(OpTypeFloat, {32});
+    const auto tVec2  = s.Define(OpTypeVector, {tFloat, 2});
+    const auto tVec3  = s.Define(OpTypeVector, {tFloat, 3});
+    const auto tVec4  = s.Define(OpTypeVector, {tFloat, 4});
+    const auto tInt   = s.Define(OpTypeInt, {32, 1});
+    const auto tUint  = s.Define(OpTypeInt, {32, 0});
+    const auto tBool  = s.Define(OpTypeBool);
+    const auto int0   = s.Value(OpConstant, tInt, {0});
+    const auto int1   = s.Value(OpConstant, tInt, {1});
+    const auto int3   = s.Value(OpConstant, tInt, {3});
+    const auto zero   = s.Float(tFloat, 0.0f);
+    const auto quart  = s.Float(tFloat, 0.25f);
+    const auto half   = s.Float(tFloat, 0.5f);
+    const auto four   = s.Float(tFloat, 4.0f);
+    s.Define(OpTypeStruct, {tVec4, tVec4, tUint, tFloat}, push);
+    const auto pPush      = s.Define(OpTypePointer, {StorageClassPushConstant, push});
+    const auto pPushFloat = s.Define(OpTypePointer, {StorageClassPushConstant, tFloat});
+    const auto pPushVec4  = s.Define(OpTypePointer, {StorageClassPushConstant, tVec4});
+    const auto tImage     = s.Define(OpTypeImage, {tFloat, Dim2D, 0, 0, 0, 1, ImageFormatUnknown});
+    const auto tSampled   = s.Define(OpTypeSampledImage, {tImage});
+    const auto pSampled   = s.Define(OpTypePointer, {StorageClassUniformConstant, tSampled});
+    const auto pInVec2    = s.Define(OpTypePointer, {StorageClassInput, tVec2});
+    const auto pInVec4    = s.Define(OpTypePointer, {StorageClassInput, tVec4});
+    const auto pOutVec4   = s.Define(OpTypePointer, {StorageClassOutput, tVec4});
+    const auto pFuncVec4  = s.Define(OpTypePointer, {StorageClassFunction, tVec4});
+    const auto pFuncFloat = s.Define(OpTypePointer, {StorageClassFunction, tFloat});
+    s.Value(OpVariable, pPush, {StorageClassPushConstant}, params);
+    s.Value(OpVariable, pSampled, {StorageClassUniformConstant}, source);
+    s.Value(OpVariable, pInVec2, {StorageClassInput}, vTexCoord);
+    s.Value(OpVariable, pInVec4, {StorageClassInput}, fragCoord);
+    s.Value(OpVariable, pOutVec4, {StorageClassOutput}, fragColor);
+
+    const auto header = s.Id(), cond = s.Id(), body = s.Id(), cont = s.Id(), merge = s.Id(), then = s.Id(), otherwise = s.Id(), done = s.Id();
+    const auto next = s.Id(), accNext = s.Id();
+    s.Value(OpFunction, tVoid, {FunctionControlMaskNone, tMain}, main);
+    const auto entry = s.Define(OpLabel);
+    const auto color = s.Value(OpVariable, pFuncVec4, {StorageClassFunction});
+    const auto tc    = s.Value(OpLoad, tVec2, {vTexCoord});
+    s.Op(OpStore, {color, s.Value(OpImageSampleImplicitLod, tVec4, {s.Value(OpLoad, tSampled, {source}), tc})});
+    const auto u = s.Value(OpCompositeExtract, tFloat, {tc, 0});
+    const auto n = s.Value(OpConvertFToS, tInt, {s.Value(OpFMul, tFloat, {u, four})});
+    s.Op(OpBranch, {header});
+
+    s.Define(OpLabel, {}, header);
+    const auto i   = s.Value(OpPhi, tInt, {int0, entry, next, cont});
+    const auto acc = s.Value(OpPhi, tFloat, {zero, entry, accNext, cont});
+    s.Op(OpLoopMerge, {merge, cont, LoopControlMaskNone});
+    s.Op(OpBranch, {cond});
+    s.Define(OpLabel, {}, cond);
+    s.Op(OpBranchConditional, {s.Value(OpSLessThan, tBool, {i, n}), body, merge});
+    s.Define(OpLabel, {}, body);
+    s.Value(OpFAdd, tFloat, {acc, quart}, accNext);
+    s.Op(OpBranch, {cont});
+    s.Define(OpLabel, {}, cont);
+    s.Value(OpIAdd, tInt, {i, int1}, next);
+    s.Op(OpBranch, {header});
+
+    s.Define(OpLabel, {}, merge);
+    const auto v = s.Value(OpCompositeExtract, tFloat, {tc, 1});
+    s.Op(OpSelectionMerge, {done, SelectionControlMaskNone});
+    s.Op(OpBranchConditional, {s.Value(OpFOrdGreaterThan, tBool, {v, half}), then, otherwise});
+    s.Define(OpLabel, {}, then);
+    const auto loaded = s.Value(OpLoad, tVec4, {color});
+    s.Op(OpStore, {color, s.Value(OpVectorShuffle, tVec4, {loaded, loaded, 2, 1, 0, 3})});
+    s.Op(OpBranch, {done});
+    s.Define(OpLabel, {}, otherwise);
+    s.Op(OpStore, {s.Value(OpAccessChain, pFuncFloat, {color, int0}), acc});
+    s.Op(OpBranch, {done});
+
+    s.Define(OpLabel, {}, done);
+    const auto strength = s.Value(OpLoad, tFloat, {s.Value(OpAccessChain, pPushFloat, {params, int3})});
+    const auto final    = s.Value(OpLoad, tVec4, {color});
+    const auto rgb      = s.Value(OpVectorTimesScalar, tVec3, {s.Value(OpVectorShuffle, tVec3, {final, final, 0, 1, 2}), strength});
+    const auto outputX  = s.Value(OpCompositeExtract, tFloat, {s.Value(OpLoad, tVec4, {s.Value(OpAccessChain, pPushVec4, {params, int1})}), 0});
+    const auto dx       = s.Value(OpFMul, tFloat, {s.Value(OpDPdx, tFloat, {u}), outputX});
+    const auto fragX    = s.Value(OpCompositeExtract, tFloat, {s.Value(OpLoad, tVec4, {fragCoord}), 0});
+    const auto fract    = s.ExtInst(tFloat, glsl, GLSLstd450Fract, {fragX});
+    const auto alpha    = s.Value(OpFMul, tFloat, {s.Value(OpFAdd, tFloat, {dx, fract}), quart});
+    s.Op(OpStore, {fragColor, s.Value(OpCompositeConstruct, tVec4, {rgb, alpha})});
+    s.Op(OpReturn, {});
+    s.Op(OpFunctionEnd, {});
+    return s.Words();
+}
+
+// filtered Source mixed with arithmetic of the coordinates, goes through the float ops run on whole lanes
+static std::vector<uint32_t> OpsShader()
+{
+    SpirvBuilder s;
+    const auto   glsl = s.Header();
+    const auto   main = s.Id(), source = s.Id(), vTexCoord = s.Id(), fragColor = s.Id();
+    s.EntryPoint(ExecutionModelFragment, main, {vTexCoord, fragColor});
+    s.Op(OpExecutionMode, {main, ExecutionModeOriginUpperLeft});
+    s.Op(OpDecorate, {vTexCoord, DecorationLocation, 0});
+    s.Op(OpDecorate, {fragColor, DecorationLocation, 0});
+    s.Op(OpDecorate, {source, DecorationDescriptorSet, 0});
+    s.Op(OpDecorate, {source, DecorationBinding, 2});
+
+    const auto tVoid    = s.Define(OpTypeVoid);
+    const auto tMain    = s.Define(OpTypeFunction, {tVoid});
+    const auto tFloat   = s.Define(OpTypeFloat, {32});
+    const auto tVec2    = s.Define(OpTypeVector, {tFloat, 2});
+    const auto tVec3    = s.Define(OpTypeVector, {tFloat, 3});
+    const auto tVec4    = s.Define(OpTypeVector, {tFloat, 4});
+    const auto tBool    = s.Define(OpTypeBool);
+    const auto zero     = s.Float(tFloat, 0.0f);
+    const auto one      = s.Float(tFloat, 1.0f);
+    const auto quart    = s.Float(tFloat, 0.25f);
+    const auto half     = s.Float(tFloat, 0.5f);
+    const auto onehalf  = s.Float(tFloat, 1.5f);
+    const auto hundredth = s.Float(tFloat, 0.01f);
+    const auto lumaR    = s.Float(tFloat, 0.299f);
+    const auto lumaG    = s.Float(tFloat, 0.587f);
+    const auto lumaB    = s.Float(tFloat, 0.114f);
+    const auto luma     = s.Value(OpConstantComposite, tVec3, {lumaR, lumaG, lumaB});
+    const auto mixBy    = s.Value(OpConstantComposite, tVec4, {quart, quart, half, quart});
+    const auto tImage   = s.Define(OpTypeImage, {tFloat, Dim2D, 0, 0, 0, 1, ImageFormatUnknown});
+    const auto tSampled = s.Define(OpTypeSampledImage, {tImage});
+    const auto pSampled = s.Define(OpTypePointer, {StorageClassUniformConstant, tSampled});
+    const auto pInVec2  = s.Define(OpTypePointer, {StorageClassInput, tVec2});
+    const auto pOutVec4 = s.Define(OpTypePointer, {StorageClassOutput, tVec4});
+    s.Value(OpVariable, pSampled, {StorageClassUniformConstant}, source);
+    s.Value(OpVariable, pInVec2, {StorageClassInput}, vTexCoord);
+    s.Value(OpVariable, pOutVec4, {StorageClassOutput}, fragColor);
+
+    auto ext = [&](uint32_t type, GLSLstd450 instruction, std::initializer_list<uint32_t> operands) { return s.ExtInst(type, glsl, instruction, operands); };
+
+    s.Value(OpFunction, tVoid, {FunctionControlMaskNone, tMain}, main);
+    s.Define(OpLabel);
+    const auto tc     = s.Value(OpLoad, tVec2, {vTexCoord});
+    const auto sample = s.Value(OpImageSampleImplicitLod, tVec4, {s.Value(OpLoad, tSampled, {source}), tc});
+    const auto u      = s.Value(OpCompositeExtract, tFloat, {tc, 0});
+    const auto v      = s.Value(OpCompositeExtract, tFloat, {tc, 1});
+    const auto y      = s.Value(OpDot, tFloat, {s.Value(OpVectorShuffle, tVec3, {sample, sample, 0, 1, 2}), luma});
+
+    // r = clamp(1.5u - 0.25, 0, 1), g = mix(luma, sqrt(v), 0.5)
+    const auto r = ext(tFloat, GLSLstd450FClamp, {s.Value(OpFSub, tFloat, {s.Value(OpFMul, tFloat, {u, onehalf}), quart}), zero, one});
+    const auto g = ext(tFloat, GLSLstd450FMix, {y, ext(tFloat, GLSLstd450Sqrt, {v}), half});
+
+    // b = (|u - v| * step(0.5, u) + min(u, v) / max(u, v + 0.01)) / 2
+    const auto diff  = ext(tFloat, GLSLstd450FAbs, {s.Value(OpFSub, tFloat, {u, v})});
+    const auto ratio = s.Value(OpFDiv, tFloat, {ext(tFloat, GLSLstd450FMin, {u, v}), ext(tFloat, GLSLstd450FMax, {u, s.Value(OpFAdd, tFloat, {v, hundredth})})});
+    const auto b     = s.Value(OpFMul, tFloat, {ext(tFloat, GLSLstd450Fma, {diff, ext(tFloat, GLSLstd450Step, {half, u}), ratio}), half});
+
+    // a = u < v && !(luma < 0.25) ? 1 : 0.5
+    const auto above = s.Value(OpLogicalAnd, tBool, {s.Value(OpFOrdLessThan, tBool, {u, v}), s.Value(OpFUnordGreaterThanEqual, tBool, {y, quart})});
+    const auto a     = s.Value(OpSelect, tFloat, {above, one, half});
+
+    const auto color = s.Value(OpCompositeConstruct, tVec4, {r, g, b, a});
+    s.Op(OpStore, {fragColor, ext(tVec4, GLSLstd450FMix, {color, sample, mixBy})});
+    s.Op(OpReturn, {});
+    s.Op(OpFunctionEnd, {});
+    return s.Words();
+}
+
+// SPIR-V lives with the test's ShaderDefs
+struct TestPass
+{
+    std::vector<uint32_t> vertex;
+    std::vector<uint32_t> fragment;
+};
+
+static ShaderDef Pass(TestPass& pass, const char* sampler, bool strength)
+{
+    ShaderDef shaderDef;
+    shaderDef.Name                = sampler;
+    shaderDef.VertexSPIRV         = pass.vertex.data();
+    shaderDef.VertexSPIRVLength   = pass.vertex.size();
+    shaderDef.FragmentSPIRV       = pass.fragment.data();
+    shaderDef.FragmentSPIRVLength = pass.fragment.size();
+    shaderDef.Params.push_back(ShaderParam("MVP", 0, 0, 64, 0.0f, 0.0f, 0.0f));
+    if(strength)
+    {
+        shaderDef.Params.push_back(ShaderParam("SourceSize", -1, 0, 16, 0.0f, 0.0f, 0.0f));
+        shaderDef.Params.push_back(ShaderParam("OutputSize", -1, 16, 16, 0.0f, 0.0f, 0.0f));
+        shaderDef.Params.push_back(ShaderParam("FrameCount", -1, 32, 4, 0.0f, 0.0f, 0.0f));
+        shaderDef.Params.push_back(ShaderParam("STRENGTH", -1, 36, 4, 0.0f, 2.0f, 1.0f));
+    }
+    shaderDef.Samplers.push_back(ShaderSampler(sampler, 2));
+    return shaderDef;
+}
+
+static SoftwareTexture Gradient(int width, int height)
+{
+    SoftwareTexture texture(width, height);
+    for(int y = 0; y < height; y++)
+    {
+        for(int x = 0; x < width; x++)
+        {
+            auto* texel = texture.Texel(x, y);
+            texel[0]    = x / (width - 1.0f);
+            texel[1]    = y / (height - 1.0f);
+            texel[2]    = ((x * 7 + y * 3) % 16) / 15.0f;
+            texel[3]    = 1.0f;
+        }
+    }
+    return texture;
+}
+
+static float Unorm8(float value)
+{
+    value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+    return std::round(value * 255.0f) / 255.0f;
+}
+
+// binary PAM, RGBA 8 bits per channel
+static bool ReadPam(const std::string& path, int& width, int& height, std::vector<uint8_t>& data)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::string   line, key;
+    width = height = 0;
+    while(std::getline(file, line) && line != "ENDHDR")
+    {
+        std::istringstream fields(line);
+        fields >> key;
+        if(key == "WIDTH")
+            fields >> width;
+        else if(key == "HEIGHT")
+            fields >> height;
+    }
+    data.resize(static_cast<size_t>(width) * height * 4);
+    file.read(reinterpret_cast<char*>(data.data()), data.size());
+    return width && height && file.gcount() == static_cast<std::streamsize>(data.size());
+}
+
+static void WritePam(const std::string& path, const SoftwareTexture& texture)
+{
+    std::vector<uint8_t> data;
+    texture.ToRGBA8(data);
+    std::ofstream file(path, std::ios::binary);
+    file << "P7\nWIDTH " << texture.Width() << "\nHEIGHT " << texture.Height() << "\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n";
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+// rendered output against Tests/Golden/<name>.pam within one step of 8 bits, SHADERGC_UPDATE_GOLDEN rewrites them
+static void ExpectGolden(const std::string& name, const SoftwareTexture& output)
+{
+    const auto path = std::string(SHADERGC_TESTS_DIR) + "/Golden/" + name + ".pam";
+    if(std::getenv("SHADERGC_UPDATE_GOLDEN"))
+        WritePam(path, output);
+
+    int                  width, height;
+    std::vector<uint8_t> golden, rendered;
+    ASSERT_TRUE(ReadPam(path, width, height, golden)) << path;
+    ASSERT_EQ(width, output.Width());
+    ASSERT_EQ(height, output.Height());
+    output.ToRGBA8(rendered);
+    int mismatches = 0;
+    for(size_t i = 0; i < golden.size(); i++)
+    {
+        if(std::abs(golden[i] - rendered[i]) > 1 && mismatches++ < 10)
+            ADD_FAILURE() << name << " pixel " << i / 4 % width << "," << i / 4 / width << " channel " << i % 4 << " got " << int(rendered[i]) << " expected " << int(golden[i]);
+    }
+    EXPECT_EQ(mismatches, 0);
+}
+
+TEST(SoftwareRenderer, MatchesReference)
+{
+    TestPass  mark {VertexShader(1.0001f), MarkShader()};
+    PresetDef presetDef;
+    presetDef.ShaderDefs.push_back(Pass(mark, "Source", true));
+    presetDef.OverrideParam("STRENGTH", 0.5f);
+
+    const int       inputWidth = 7, inputHeight = 5, width = 9, height = 6;
+    SoftwareTexture input(inputWidth, inputHeight);
+    for(int y = 0; y < inputHeight; y++)
+    {
+        for(int x = 0; x < inputWidth; x++)
+        {
+            auto* texel = input.Texel(x, y);
+            texel[0]    = x / 8.0f;
+            texel[1]    = y / 8.0f;
+            texel[2]    = (x + y) / 16.0f;
+            texel[3]    = 1.0f;
+        }
+    }
+
+    for(unsigned threads : {1u, 3u})
+    {
+        SoftwareRenderer renderer(presetDef, threads);
+        const auto&      output = renderer.Render(input, width, height);
+        for(int py = 0; py < height; py++)
+        {
+            for(int px = 0; px < width; px++)
+            {
+                // point sampled, texture coordinates are scaled by the vertex shader
+                const auto u      = (px + 0.5f) / width * 1.0001f;
+                const auto v      = (py + 0.5f) / height * 1.0001f;
+                const auto tx     = static_cast<int>(std::floor(u * inputWidth));
+                const auto ty     = static_cast<int>(std::floor(v * inputHeight));
+                float      c[4]   = {0.0f, 0.0f, 0.0f, 0.0f};
+                float      acc    = 0.0f;
+                const auto quarts = static_cast<int>(u * 4);
+                if(tx < inputWidth && ty < inputHeight)
+                    memcpy(c, input.Texel(tx, ty), sizeof(c));
+                for(int q = 0; q < quarts; q++)
+                    acc += 0.25f;
+                if(v > 0.5f)
+                    std::swap(c[0], c[2]);
+                else
+                    c[0] = acc;
+
+                const float expected[4] = {Unorm8(c[0] * 0.5f), Unorm8(c[1] * 0.5f), Unorm8(c[2] * 0.5f), Unorm8((1.0001f + 0.5f) * 0.25f)};
+                const auto* texel       = output.Texel(px, py);
+                for(int k = 0; k < 4; k++)
+                    EXPECT_NEAR(texel[k], expected[k], 1e-6f) << "threads " << threads << " pixel " << px << "," << py << " channel " << k;
+            }
+        }
+    }
+}
+
+TEST(SoftwareRenderer, HistoryFeedbackAndAlias)
+{
+    // pass 0 reads two frames back, pass 1 its own previous output and the last pass reads pass 0 by alias
+    TestPass  mark {VertexShader(1.0001f), MarkShader()};
+    PresetDef presetDef;
+    for(auto sampler : {"OriginalHistory2", "PassFeedback1", "First"})
+        presetDef.ShaderDefs.push_back(Pass(mark, sampler, true));
+    presetDef.ShaderDefs[0].Param("alias", "First").Param("scale_type", "viewport").Param("scale", "0.5").Param("float_framebuffer", "true");
+
+    SoftwareTexture input(5, 4);
+    for(int y = 0; y < 4; y++)
+    {
+        for(int x = 0; x < 5; x++)
+            std::fill(input.Texel(x, y), input.Texel(x, y) + 4, 1.0f);
+    }
+
+    SoftwareRenderer renderer(presetDef, 2);
+    for(int frame = 0; frame < 4; frame++)
+    {
+        const auto* texel = renderer.Render(input, 10, 8).Texel(7, 6);
+        for(int c = 0; c < 3; c++)
+            EXPECT_EQ(texel[c], frame < 2 ? 0.0f : 1.0f) << "frame " << frame;
+        EXPECT_FLOAT_EQ(texel[3], Unorm8((1.0001f + 0.5f) * 0.25f));
+    }
+
+    renderer.Reset();
+    EXPECT_EQ(renderer.Render(input, 10, 8).Texel(7, 6)[0], 0.0f);
+}
+
+TEST(SoftwareRenderer, GoldenOps)
+{
+    TestPass  ops {VertexShader(1.0f), OpsShader()};
+    PresetDef presetDef;
+    presetDef.ShaderDefs.push_back(Pass(ops, "Source", false));
+    presetDef.ShaderDefs[0].Param("filter_linear", "true");
+
+    SoftwareRenderer renderer(presetDef, 1);
+    ExpectGolden("ops", renderer.Render(Gradient(16, 12), 37, 22));
+}
+
+TEST(SoftwareRenderer, GoldenChain)
+{
+    // half-size float pass filtered up by the final one
+    TestPass  ops {VertexShader(1.0f), OpsShader()};
+    TestPass  mark {VertexShader(1.0001f), MarkShader()};
+    PresetDef presetDef;
+    presetDef.ShaderDefs.push_back(Pass(ops, "Source", false));
+    presetDef.ShaderDefs.push_back(Pass(mark, "Source", true));
+    presetDef.ShaderDefs[0].Param("scale_type", "viewport").Param("scale", "0.5").Param("float_framebuffer", "true").Param("filter_linear", "true");
+    presetDef.ShaderDefs[1].Param("filter_linear", "true");
+    presetDef.OverrideParam("STRENGTH", 0.75f);
+
+    SoftwareRenderer renderer(presetDef, 1);
+    ExpectGolden("chain", renderer.Render(Gradient(16, 12), 40, 30));
+}
+
+TEST(SoftwareRenderer, ThreadsRenderAlike)
+{
+    TestPass  ops {VertexShader(1.0f), OpsShader()};
+    TestPass  mark {VertexShader(1.0001f), MarkShader()};
+    PresetDef presetDef;
+    presetDef.ShaderDefs.push_back(Pass(ops, "Source", false));
+    presetDef.ShaderDefs.push_back(Pass(mark, "Source", true));
+    presetDef.ShaderDefs[0].Param("filter_linear", "true");
+
+    const auto       input = Gradient(23, 17);
+    SoftwareRenderer single(presetDef, 1), several(presetDef, 4);
+    const auto&      expected = single.Render(input, 51, 33);
+    const auto&      output   = several.Render(input, 51, 33);
+    for(int y = 0; y < output.Height(); y++)
+    {
+        for(int x = 0; x < output.Width(); x++)
+            ASSERT_EQ(memcmp(output.Texel(x, y), expected.Texel(x, y), 4 * sizeof(float)), 0) << x << "," << y;
+    }
+}
+
+// built-in presets render once the library is regenerated with SPIR-V, until then their passes carry none
+static bool HasSPIRV(const PresetDef& presetDef)
+{
+    for(const auto& shaderDef : presetDef.ShaderDefs)
+    {
+        if(!shaderDef.VertexSPIRV || !shaderDef.FragmentSPIRV)
+            return false;
+    }
+    return true;
+}
+
+TEST(SoftwareRenderer, BuiltinStock)
+{
+    RetroArch::StockNearestPresetDef presetDef;
+    presetDef.Build();
+    if(!HasSPIRV(presetDef))
+        GTEST_SKIP() << "generated ShaderDefs have no SPIR-V";
+
+    // point sampled at the input size, stock passes its input through
+    const auto       input = Gradient(16, 12);
+    SoftwareRenderer renderer(presetDef, 1);
+    const auto&      output = renderer.Render(input, input.Width(), input.Height());
+    for(int y = 0; y < output.Height(); y++)
+    {
+        for(int x = 0; x < output.Width(); x++)
+        {
+            for(int c = 0; c < 4; c++)
+                ASSERT_NEAR(output.Texel(x, y)[c], input.Texel(x, y)[c], 1.0f / 255) << x << "," << y << " channel " << c;
+        }
+    }
+}
+
+TEST(SoftwareRenderer, GoldenCrtLottes)
+{
+    RetroArch::CrtCrtLottesPresetDef presetDef;
+    presetDef.Build();
+    if(!HasSPIRV(presetDef))
+        GTEST_SKIP() << "generated ShaderDefs have no SPIR-V";
+
+    // Golden/crt-lottes.pam is recorded with SHADERGC_UPDATE_GOLDEN from the first regenerated library
+    SoftwareRenderer renderer(presetDef, 1);
+    ExpectGolden("crt-lottes", renderer.Render(Gradient(32, 24), 96, 72));
+}
+
+TEST(SoftwareRenderer, NoSPIRV)
+{
+    PresetDef presetDef;
+    presetDef.ShaderDefs.push_back(ShaderDef());
+    EXPECT_THROW(SoftwareRenderer renderer(presetDef), std::runtime_error);
+}
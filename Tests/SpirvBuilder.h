@@ -0,0 +1,106 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include "spirv.hpp"
+
+#include <bit>
+#include <initializer_list>
+
+// writes SPIR-V words of test shaders, ids come from Id() so branches and phis can refer to labels defined later
+class SpirvBuilder
+{
+public:
+    uint32_t Id()
+    {
+        return m_bound++;
+    }
+
+    // instruction with operands as they go in the binary
+    void Op(spv::Op op, std::initializer_list<uint32_t> operands)
+    {
+        m_words.push_back(static_cast<uint32_t>(operands.size() + 1) << 16 | op);
+        m_words.insert(m_words.end(), operands);
+    }
+
+    // instruction defining id, for types, labels and others without a result type
+    uint32_t Define(spv::Op op, std::initializer_list<uint32_t> operands = {}, uint32_t id = 0)
+    {
+        id = id ? id : Id();
+        m_words.push_back(static_cast<uint32_t>(operands.size() + 2) << 16 | op);
+        m_words.push_back(id);
+        m_words.insert(m_words.end(), operands);
+        return id;
+    }
+
+    // instruction with a result type
+    uint32_t Value(spv::Op op, uint32_t type, std::initializer_list<uint32_t> operands, uint32_t id = 0)
+    {
+        id = id ? id : Id();
+        m_words.push_back(static_cast<uint32_t>(operands.size() + 3) << 16 | op);
+        m_words.push_back(type);
+        m_words.push_back(id);
+        m_words.insert(m_words.end(), operands);
+        return id;
+    }
+
+    // instruction of an extended set like GLSL.std.450
+    uint32_t ExtInst(uint32_t type, uint32_t set, uint32_t instruction, std::initializer_list<uint32_t> operands)
+    {
+        const auto id = Id();
+        m_words.push_back(static_cast<uint32_t>(operands.size() + 5) << 16 | spv::OpExtInst);
+        m_words.push_back(type);
+        m_words.push_back(id);
+        m_words.push_back(set);
+        m_words.push_back(instruction);
+        m_words.insert(m_words.end(), operands);
+        return id;
+    }
+
+    uint32_t Float(uint32_t type, float value)
+    {
+        return Value(spv::OpConstant, type, {std::bit_cast<uint32_t>(value)});
+    }
+
+    // "main" of given stage with its interface variables
+    void EntryPoint(spv::ExecutionModel model, uint32_t function, std::initializer_list<uint32_t> interface)
+    {
+        m_words.push_back(static_cast<uint32_t>(interface.size() + 5) << 16 | spv::OpEntryPoint);
+        m_words.push_back(model);
+        m_words.push_back(function);
+        m_words.push_back('m' | 'a' << 8 | 'i' << 16 | 'n' << 24);
+        m_words.push_back(0);
+        m_words.insert(m_words.end(), interface);
+    }
+
+    // capability, memory model and GLSL.std.450 whose id is returned
+    uint32_t Header()
+    {
+        const auto glsl = Id();
+        m_words.push_back(2 << 16 | spv::OpCapability);
+        m_words.push_back(spv::CapabilityShader);
+        m_words.push_back(6 << 16 | spv::OpExtInstImport);
+        m_words.push_back(glsl);
+        for(auto c : {"GLSL", ".std", ".450"})
+            m_words.push_back(c[0] | c[1] << 8 | c[2] << 16 | c[3] << 24);
+        m_words.push_back(0);
+        Op(spv::OpMemoryModel, {spv::AddressingModelLogical, spv::MemoryModelGLSL450});
+        return glsl;
+    }
+
+    std::vector<uint32_t> Words() const
+    {
+        std::vector<uint32_t> words {spv::MagicNumber, 0x10000, 0, m_bound, 0};
+        words.insert(words.end(), m_words.begin(), m_words.end());
+        return words;
+    }
+
+private:
+    std::vector<uint32_t> m_words {};
+    uint32_t              m_bound {1};
+};
@@ -0,0 +1,179 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "TexCoordTransform.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+// captured frame of captureW x captureH shown at offset in a destW x destH window, preprocessed at pixel size scale
+struct Capture
+{
+    int   captureW;
+    int   captureH;
+    int   destW;
+    int   destH;
+    float scale;
+    int   offsetX;
+    int   offsetY;
+    bool  flipH;
+    bool  flipV;
+
+    // preprocess MVP as ShaderGlass computes it for window glass
+    void MVP(float& sx, float& sy, float& tx, float& ty) const
+    {
+        sx = 1.0f * captureW / destW;
+        sy = 1.0f * captureH / destH;
+        tx = -(2.0f * offsetX - captureW) / destW - 1.0f;
+        ty = (2.0f * offsetY - captureH) / destH + 1.0f;
+        if(flipH)
+        {
+            sx *= -1;
+            tx *= -1;
+        }
+        if(flipV)
+        {
+            sy *= -1;
+            ty *= -1;
+        }
+        tx += 0.0001f;
+        ty += 0.0001f;
+    }
+
+    int Width() const
+    {
+        return static_cast<int>(destW / scale);
+    }
+
+    int Height() const
+    {
+        return static_cast<int>(destH / scale);
+    }
+};
+
+static TexCoordTransform Transform(const Capture& c)
+{
+    float sx, sy, tx, ty;
+    c.MVP(sx, sy, tx, ty);
+    return TexCoordTransform::FromPreprocess(sx, sy, tx, ty);
+}
+
+// rasterizes the preprocess quad and counts texels of the preprocessed frame whose captured texel the transform gets wrong,
+// if the frame is texel aligned anywhere within a preprocessed texel has to land on the same captured texel
+static int Mismatches(const Capture& c)
+{
+    float sx, sy, tx, ty;
+    c.MVP(sx, sy, tx, ty);
+    const auto transform   = TexCoordTransform::FromPreprocess(sx, sy, tx, ty);
+    const auto aligned     = transform.IsTexelAligned(c.Width(), c.Height(), c.captureW, c.captureH, 0.25f);
+    const auto sourceTexel = [&](float u, float v, int& i, int& j) {
+        float tu, tv;
+        transform.Apply(u, v, tu, tv);
+        i = static_cast<int>(std::floor(tu * c.captureW));
+        j = static_cast<int>(std::floor(tv * c.captureH));
+    };
+
+    int mismatches = 0;
+    for(int y = 0; y < c.Height(); y += 7)
+    {
+        for(int x = 0; x < c.Width(); x += 7)
+        {
+            // texel centre to clip space, back through the MVP to the quad's texcoords
+            const float u  = (x + 0.5f) / c.Width();
+            const float v  = (y + 0.5f) / c.Height();
+            const float qx = (2 * u - 1 - tx) / sx;
+            const float qy = (1 - 2 * v - ty) / sy;
+            const int   ci = static_cast<int>(std::floor((qx + 1) / 2 * c.captureW));
+            const int   cj = static_cast<int>(std::floor((1 - qy) / 2 * c.captureH));
+
+            int i, j;
+            sourceTexel(u, v, i, j);
+            if(i != ci || j != cj)
+                mismatches++;
+            sourceTexel((x + 0.9f) / c.Width(), (y + 0.1f) / c.Height(), i, j);
+            if(aligned && (i != ci || j != cj))
+                mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+TEST(TexCoordTransform, DefaultIsIdentity)
+{
+    TexCoordTransform transform;
+    EXPECT_TRUE(transform.IsIdentity(0.0f));
+    float u, v;
+    transform.Apply(0.25f, 0.75f, u, v);
+    EXPECT_FLOAT_EQ(u, 0.25f);
+    EXPECT_FLOAT_EQ(v, 0.75f);
+}
+
+TEST(TexCoordTransform, FullScreen)
+{
+    const Capture capture {1920, 1080, 1920, 1080, 1.0f, 0, 0, false, false};
+    const auto    transform = Transform(capture);
+    EXPECT_TRUE(transform.IsIdentity(0.001f));
+    EXPECT_TRUE(transform.IsTexelAligned(capture.Width(), capture.Height(), capture.captureW, capture.captureH, 0.25f));
+    EXPECT_EQ(Mismatches(capture), 0);
+}
+
+TEST(TexCoordTransform, CroppedWindow)
+{
+    const Capture capture {1920, 1080, 800, 600, 1.0f, 100, 50, false, false};
+    const auto    transform = Transform(capture);
+    EXPECT_FALSE(transform.IsIdentity(0.001f));
+    EXPECT_TRUE(transform.IsTexelAligned(capture.Width(), capture.Height(), capture.captureW, capture.captureH, 0.25f));
+    EXPECT_EQ(Mismatches(capture), 0);
+}
+
+TEST(TexCoordTransform, Flips)
+{
+    for(auto flipH : {false, true})
+    {
+        for(auto flipV : {false, true})
+        {
+            const Capture capture {1920, 1080, 800, 600, 1.0f, 100, 50, flipH, flipV};
+            EXPECT_TRUE(Transform(capture).IsTexelAligned(capture.Width(), capture.Height(), capture.captureW, capture.captureH, 0.25f)) << flipH << flipV;
+            EXPECT_EQ(Mismatches(capture), 0) << flipH << flipV;
+        }
+    }
+}
+
+TEST(TexCoordTransform, PixelSizeIsNotAligned)
+{
+    // larger pixels average several captured texels, so the first pass can't sample the capture directly
+    for(auto scale : {2.0f, 3.0f})
+    {
+        const Capture capture {1920, 1080, 800, 600, scale, 100, 50, false, false};
+        EXPECT_FALSE(Transform(capture).IsTexelAligned(capture.Width(), capture.Height(), capture.captureW, capture.captureH, 0.25f)) << scale;
+        EXPECT_EQ(Mismatches(capture), 0) << scale;
+    }
+
+    // the transform is still the identity, only the sizes differ
+    const Capture fullScreen {1920, 1080, 1920, 1080, 2.0f, 0, 0, false, false};
+    EXPECT_TRUE(Transform(fullScreen).IsIdentity(0.001f));
+    EXPECT_FALSE(Transform(fullScreen).IsTexelAligned(fullScreen.Width(), fullScreen.Height(), fullScreen.captureW, fullScreen.captureH, 0.25f));
+}
+
+TEST(TexCoordTransform, WindowOutsideCapture)
+{
+    // part of the window lies beyond the captured frame, which would sample its border instead of blanks
+    const Capture capture {1920, 1080, 800, 600, 1.0f, 1500, 50, false, false};
+    EXPECT_FALSE(Transform(capture).IsTexelAligned(capture.Width(), capture.Height(), capture.captureW, capture.captureH, 0.25f));
+    EXPECT_EQ(Mismatches(capture), 0);
+}
+
+TEST(TexCoordTransform, HalfTexelOffsetIsNotAligned)
+{
+    const TexCoordTransform transform(800.0f / 1920.0f, 600.0f / 1080.0f, 100.5f / 1920.0f, 50.0f / 1080.0f);
+    EXPECT_FALSE(transform.IsTexelAligned(800, 600, 1920, 1080, 0.25f));
+    EXPECT_TRUE(TexCoordTransform(800.0f / 1920.0f, 600.0f / 1080.0f, 100.0f / 1920.0f, 50.0f / 1080.0f).IsTexelAligned(800, 600, 1920, 1080, 0.25f));
+    EXPECT_FALSE(transform.IsTexelAligned(0, 600, 1920, 1080, 0.25f));
+}
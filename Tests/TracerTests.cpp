@@ -0,0 +1,132 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "Tracer.h"
+#include "json.hpp"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+// spans in the dump by thread name, the tracer is shared by the whole process so it is cleared first
+static std::map<std::string, std::vector<nlohmann::json>> Dump()
+{
+    std::ostringstream out;
+    Tracer::WriteJson(out);
+    const auto json = nlohmann::json::parse(out.str());
+
+    std::map<int, std::string>                         names;
+    std::map<std::string, std::vector<nlohmann::json>> spans;
+    for(const auto& event : json["traceEvents"])
+    {
+        if(event["ph"] == "M")
+            names[event["tid"].get<int>()] = event["args"]["name"].get<std::string>();
+    }
+    for(const auto& event : json["traceEvents"])
+    {
+        if(event["ph"] == "X")
+            spans[names.at(event["tid"].get<int>())].push_back(event);
+    }
+    return spans;
+}
+
+static void RecordSpans(const char* thread, int count)
+{
+    Tracer::NameThread(thread);
+    for(int i = 0; i < count; i++)
+        Tracer::Span span("test", "Span", "i", i);
+}
+
+TEST(Tracer, DisabledRecordsNothing)
+{
+    Tracer::Enable(false);
+    Tracer::Clear();
+    std::thread(RecordSpans, "disabled", 100).join();
+    EXPECT_FALSE(Tracer::IsEnabled());
+    EXPECT_TRUE(Dump().empty());
+}
+
+TEST(Tracer, RecordsSpans)
+{
+    Tracer::Enable(false);
+    Tracer::Clear();
+    Tracer::Enable(true);
+    std::thread([]() {
+        Tracer::NameThread("render \"main\"");
+        {
+            Tracer::Span outer("render", "Frame");
+            Tracer::Span inner("render", "Pass", "pass", 3);
+        }
+    }).join();
+    Tracer::Enable(false);
+
+    const auto spans = Dump();
+    ASSERT_EQ(spans.size(), 1u);
+    const auto& thread = spans.at("render \"main\"");
+    ASSERT_EQ(thread.size(), 2u);
+
+    // inner span ends first
+    EXPECT_EQ(thread[0]["name"], "Pass");
+    EXPECT_EQ(thread[0]["cat"], "render");
+    EXPECT_EQ(thread[0]["args"]["pass"], 3);
+    EXPECT_EQ(thread[1]["name"], "Frame");
+    EXPECT_FALSE(thread[1].contains("args"));
+    EXPECT_LE(thread[1]["ts"].get<double>(), thread[0]["ts"].get<double>());
+    EXPECT_GE(thread[1]["dur"].get<double>(), thread[0]["dur"].get<double>());
+}
+
+TEST(Tracer, KeepsSpansOfExitedThreads)
+{
+    Tracer::Enable(false);
+    Tracer::Clear();
+    Tracer::Enable(true);
+    // one after the other, so the later threads would take over the ring of the earlier ones
+    std::thread(RecordSpans, "first", 10).join();
+    std::thread(RecordSpans, "second", 20).join();
+    auto spans = Dump();
+    ASSERT_EQ(spans.size(), 2u);
+    EXPECT_EQ(spans.at("first").size(), 10u);
+    EXPECT_EQ(spans.at("second").size(), 20u);
+
+    // once written out their rings are reused, which drops what they held
+    std::thread(RecordSpans, "third", 30).join();
+    Tracer::Enable(false);
+    spans = Dump();
+    EXPECT_EQ(spans.at("third").size(), 30u);
+    EXPECT_EQ(spans.count("first") + spans.count("second"), 1u);
+}
+
+TEST(Tracer, KeepsLatestSpansOfEachThread)
+{
+    Tracer::Enable(false);
+    Tracer::Clear();
+    Tracer::Enable(true);
+    const auto               total = static_cast<int>(Tracer::RingSize) + 1000;
+    std::vector<std::thread> threads;
+    threads.emplace_back(RecordSpans, "first", total);
+    threads.emplace_back(RecordSpans, "second", total);
+    threads.emplace_back(RecordSpans, "short", 10);
+    for(auto& t : threads)
+        t.join();
+    Tracer::Enable(false);
+
+    const auto spans = Dump();
+    for(const auto* name : {"first", "second"})
+    {
+        const auto& thread = spans.at(name);
+        ASSERT_EQ(thread.size(), Tracer::RingSize - 1) << name;
+        EXPECT_EQ(thread.front()["args"]["i"], total - static_cast<int>(Tracer::RingSize - 1)) << name;
+        EXPECT_EQ(thread.back()["args"]["i"], total - 1) << name;
+    }
+    EXPECT_EQ(spans.at("short").size(), 10u);
+
+    // and forgets them when cleared
+    Tracer::Clear();
+    EXPECT_TRUE(Dump().empty());
+}